@@ -1,3 +1,5 @@
 cd build/
 ./test_image_painter
+./bench_image_painter --sizes vga --output bench_image_painter.json
+./diff_image_painter
 cd ..
\ No newline at end of file
@@ -3,9 +3,15 @@
 
 #include "basic_type.h"
 #include "datatype_image.h"
+#include "Eigen/Sparse"
+#include "array"
+#include "limits"
+#include "image_painter_color_map.h"
 
 namespace image_painter {
 
+class SpatialIndex;
+
 /* Class Image Painter Declaration. */
 class ImagePainter final {
 
@@ -23,10 +29,202 @@ public:
         float ortho_scale = 1.0f;
     };
 
+    // Axis-aligned box, covering cols [x, x + width - 1] and rows [y, y + height - 1].
+    struct Rectangle {
+        int32_t x = 0;
+        int32_t y = 0;
+        int32_t width = 0;
+        int32_t height = 0;
+    };
+
+    // Text label with its left-top corner at (x, y).
+    struct Label {
+        std::string text;
+        int32_t x = 0;
+        int32_t y = 0;
+    };
+
+    // Batch of items in structure-of-arrays layout, where each column holds one attribute of all items. Eigen::Map of contiguous buffers
+    // can be passed without copy.
+    using PointsBatch = Eigen::Ref<const Eigen::Matrix<int32_t, Eigen::Dynamic, 2>>;   // x, y.
+    using LinesBatch = Eigen::Ref<const Eigen::Matrix<int32_t, Eigen::Dynamic, 4>>;    // x1, y1, x2, y2.
+    using CirclesBatch = Eigen::Ref<const Eigen::Matrix<int32_t, Eigen::Dynamic, 3>>;  // center_x, center_y, radius.
+    using GaussiansBatch = Eigen::Ref<const Eigen::Matrix<float, Eigen::Dynamic, 5>>;  // center_x, center_y, cov_xx, cov_xy, cov_yy.
+    // Point cloud in world frame, where each column is one point.
+    using PointCloudBatch = Eigen::Ref<const Eigen::Matrix<float, 3, Eigen::Dynamic>>;
+    // Symmetric 3x3 covariances in world frame, where each column is xx, xy, xz, yy, yz, zz of one covariance.
+    using CovarianceCloudBatch = Eigen::Ref<const Eigen::Matrix<float, 6, Eigen::Dynamic>>;
+
+    // Instruction set used by convertion kernels. kScalar is the reference implementation.
+    enum class SimdLevel : uint8_t {
+        kScalar = 0,
+        kSse41 = 1,
+        kAvx2 = 2,
+        kNeon = 3,
+    };
+
+    // Geometry convertion of image. Rotations are clockwise.
+    enum class ImageGeometry : uint8_t {
+        kIdentity = 0,
+        kFlipVertical = 1,
+        kFlipHorizontal = 2,
+        kRotate90 = 3,
+        kRotate180 = 4,
+        kRotate270 = 5,
+        kTranspose = 6,
+    };
+
+    // Normalization of matrix value before color map lookup. Abs ones map |value| in [0, max_value] to the whole lut,
+    // and symmetric one maps [-max_value, max_value] to the whole lut, which suits diverging color maps.
+    enum class ValueNormalization : uint8_t {
+        kAbsLinear = 0,
+        kAbsLog = 1,
+        kSymmetric = 2,
+    };
+
+    // Aggregation of matrix cells which are downsampled into one pixel.
+    enum class CellAggregation : uint8_t {
+        kMaxAbs = 0,
+        kMean = 1,
+        kNonZeroCount = 2,
+    };
+
+    // Blend of drawn color over image. Alpha blend mixes color with image by alpha, while additive and max blend scale color by alpha
+    // first, and then saturated add it to image or keep the max of them.
+    enum class BlendMode : uint8_t {
+        kOpaque = 0,
+        kAlpha = 1,
+        kAdditive = 2,
+        kMax = 3,
+    };
+
+    // Shape of thick polyline at its inner vertices and at its two ends. Miter join falls back to bevel one if the miter is longer than
+    // kMaxMiterRatio times line width.
+    enum class LineJoin : uint8_t {
+        kMiter = 0,
+        kBevel = 1,
+        kRound = 2,
+    };
+    enum class LineCap : uint8_t {
+        kButt = 0,
+        kSquare = 1,
+        kRound = 2,
+    };
+    static constexpr float kMaxMiterRatio = 4.0f;
+
+    struct Blend {
+        Blend(BlendMode mode = BlendMode::kOpaque, uint8_t alpha = 255) : mode(mode), alpha(alpha) {}
+        BlendMode mode;
+        uint8_t alpha;
+    };
+
+    // Color of yuv420 image, which is converted from rgb once and written into its planes directly.
+    struct YuvPixel {
+        uint8_t y = 0;
+        uint8_t u = 128;
+        uint8_t v = 128;
+    };
+    // Matrix and range of rgb -> yuv convertion. Video range maps luma into [16, 235] and chroma into [16, 240].
+    enum class YuvColorSpace : uint8_t {
+        kBt601 = 0,
+        kBt709 = 1,
+        kBt601FullRange = 2,
+    };
+    // Chroma planes of yuv420 image. Nv12 interleaves u and v in one plane, while i420 has separated u and v planes.
+    enum class YuvLayout : uint8_t {
+        kNv12 = 0,
+        kI420 = 1,
+    };
+
+    // Primitives recorded by profiling, one for each draw / render call.
+    enum class Primitive : uint8_t {
+        kSolidRectangle = 0,
+        kSolidRectangles,
+        kHollowRectangle,
+        kBressenhanLine,
+        kNaiveLine,
+        kDashedLine,
+        kSolidCircle,
+        kHollowCircle,
+        kMidBresenhamEllipse,
+        kSolidEllipse,
+        kTrustRegionOfGaussian,
+        kSolidTrustRegionOfGaussian,
+        kCharacter,
+        kString,
+        kSolidPolygon,
+        kThickLine,
+        kThickPolyline,
+        kPoints,
+        kLines,
+        kCircles,
+        kPolyline,
+        kTrustRegionsOfGaussian,
+        kStrings,
+        kTextInCameraView,
+        kPointInCameraView,
+        kPointsInCameraView,
+        kPointsInCameraViewOfIndex,
+        kLineSegmentInCameraView,
+        kLineSegmentsInCameraViewOfIndex,
+        kDashedLineSegmentInCameraView,
+        kEllipseInCameraView,
+        kEllipsesInCameraView,
+        kPointInCameraViewWithDepthTest,
+        kPointsInCameraViewWithDepthTest,
+        kPointsInCameraViewWithDepthColor,
+        kLineSegmentInCameraViewWithDepthTest,
+        kEllipseInCameraViewWithDepthTest,
+        kFlushDisplayList,
+        kPresentRetainedCanvas,
+        kNumOfPrimitives,
+    };
+    struct ProfileCounter {
+        int64_t num_of_calls = 0;
+        int64_t num_of_written_pixels = 0;
+        // Pixels dropped by bounds checks and span clipping of pixel writers, and by clipping of solid rectangles.
+        int64_t num_of_rejected_pixels = 0;
+        int64_t time_ns = 0;
+    };
+    // Counters of each primitive are indexed by pixel type of image, which is kProfileIndex of PixelTraits. Pixel types without it, like
+    // rgba or uint16 ones, are profiled as other.
+    enum class ProfileImageType : int32_t {
+        kGray = 0,
+        kRgb,
+        kYuv420,
+        kOther,
+        kNumOfProfileImageTypes,
+    };
+    using ProfileSnapshot = std::array<std::array<ProfileCounter, static_cast<size_t>(ProfileImageType::kNumOfProfileImageTypes)>,
+                                       static_cast<size_t>(Primitive::kNumOfPrimitives)>;
+
 public:
     ImagePainter() = default;
     virtual ~ImagePainter() = default;
 
+    // Support for simd dispatch. The best level supported by cpu is selected by default.
+    static bool IsSimdLevelSupported(SimdLevel level);
+    static SimdLevel GetSupportedSimdLevel();
+    static SimdLevel GetSimdLevel();
+    static bool SetSimdLevel(SimdLevel level);
+
+    // Support for multi-thread. Parallel jobs use at most this number of threads, which is the number of cpu cores by default.
+    static int32_t GetMaxNumberOfThreads();
+    static void SetMaxNumberOfThreads(int32_t max_num_of_threads);
+
+    // Support for profiling, which is compiled only with IMAGE_PAINTER_ENABLE_PROFILE, and is disabled by default. Each top-level draw /
+    // render call is recorded once by its primitive, including the calls it makes and pixels written by its worker threads. Counters are
+    // thread-local, so snapshot and reset only cover calls of the calling thread. SetProfilingEnabled returns false if it is not compiled.
+    static bool IsProfilingSupported();
+    static bool SetProfilingEnabled(bool is_enabled);
+    static bool IsProfilingEnabled();
+    static ProfileSnapshot GetProfileSnapshot();
+    static void ResetProfile();
+    static const char *GetNameOfPrimitive(Primitive primitive);
+    static const char *GetNameOfProfileImageType(ProfileImageType type);
+    // Report the recorded primitives of snapshot by log reporter, sorted by time in descending order.
+    static void ReportProfile(const ProfileSnapshot &snapshot);
+
     // Support for convertion.
     template <typename Scalar>
     static uint8_t ConvertValueToUint8(Scalar value, Scalar max_value);
@@ -34,35 +232,148 @@ public:
     static bool ConvertMatrixToImage(const TMat<Scalar> &matrix, GrayImage &image, Scalar max_value = 1e3, int32_t scale = 4);
     template <typename Scalar>
     static bool ConvertMatrixToImage(const TMat<Scalar> &matrix, RgbImage &image, Scalar max_value = 1e3, int32_t scale = 4);
+    template <typename Scalar>
+    static bool ConvertMatrixToImage(const TMat<Scalar> &matrix, GrayImage &image, const ColorMap &color_map, Scalar max_value = 1e3, int32_t scale = 4,
+                                     ValueNormalization normalization = ValueNormalization::kAbsLinear);
+    template <typename Scalar>
+    static bool ConvertMatrixToImage(const TMat<Scalar> &matrix, RgbImage &image, const ColorMap &color_map, Scalar max_value = 1e3, int32_t scale = 4,
+                                     ValueNormalization normalization = ValueNormalization::kAbsLinear);
+    // Downsample matrix which is larger than image, so each pixel aggregates a block of about (matrix.rows() / image.rows()) x
+    // (matrix.cols() / image.cols()) cells. Matrix is streamed once, in parallel over row blocks. For kNonZeroCount, max_value is
+    // the count of nonzero cells which gets the last color of color map.
+    template <typename Scalar>
+    static bool ConvertMatrixToImageWithDownsample(const TMat<Scalar> &matrix, GrayImage &image, const ColorMap &color_map, Scalar max_value,
+                                                   CellAggregation aggregation, ValueNormalization normalization = ValueNormalization::kAbsLinear);
+    template <typename Scalar>
+    static bool ConvertMatrixToImageWithDownsample(const TMat<Scalar> &matrix, RgbImage &image, const ColorMap &color_map, Scalar max_value,
+                                                   CellAggregation aggregation, ValueNormalization normalization = ValueNormalization::kAbsLinear);
+    // Paint sparse matrix without densifying it. Canvas is cleared with the color of zero, and then only stored nonzeros are visited in
+    // column major order. Scale, downsample and max value work in the same way as dense matrix.
+    template <typename Scalar>
+    static bool ConvertSparseMatrixToImage(const Eigen::SparseMatrix<Scalar> &matrix, GrayImage &image, const ColorMap &color_map, Scalar max_value = 1e3,
+                                           int32_t scale = 4, ValueNormalization normalization = ValueNormalization::kAbsLinear);
+    template <typename Scalar>
+    static bool ConvertSparseMatrixToImage(const Eigen::SparseMatrix<Scalar> &matrix, RgbImage &image, const ColorMap &color_map, Scalar max_value = 1e3,
+                                           int32_t scale = 4, ValueNormalization normalization = ValueNormalization::kAbsLinear);
+    template <typename Scalar>
+    static bool ConvertSparseMatrixToImageWithDownsample(const Eigen::SparseMatrix<Scalar> &matrix, GrayImage &image, const ColorMap &color_map,
+                                                         Scalar max_value, CellAggregation aggregation,
+                                                         ValueNormalization normalization = ValueNormalization::kAbsLinear);
+    template <typename Scalar>
+    static bool ConvertSparseMatrixToImageWithDownsample(const Eigen::SparseMatrix<Scalar> &matrix, RgbImage &image, const ColorMap &color_map,
+                                                         Scalar max_value, CellAggregation aggregation,
+                                                         ValueNormalization normalization = ValueNormalization::kAbsLinear);
     static void ConvertUint8ToRgb(const uint8_t *gray, uint8_t *rgb, int32_t gray_size);
+    // Simd levels use fixed-point luma weights, whose result differs from kScalar by at most 1.
     static void ConvertRgbToUint8(const uint8_t *rgb, uint8_t *gray, int32_t gray_size);
     static void ConvertUint8ToRgbAndUpsideDown(const uint8_t *gray, uint8_t *rgb, int32_t gray_rows, int32_t gray_cols);
     static void ConvertRgbToBgr(const uint8_t *rgb, uint8_t *converted_rgb, int32_t rgb_rows, int32_t rgb_cols);
     static void ConvertRgbToBgrAndUpsideDown(const uint8_t *rgb, uint8_t *converted_rgb, int32_t rgb_rows, int32_t rgb_cols);
+    static YuvPixel ConvertRgbToYuv(const RgbPixel &color, YuvColorSpace color_space = YuvColorSpace::kBt601);
+    // Converted image can share buffer with image. It works in place for flips and rotate 180, and for rotate 90 / 270 and
+    // transpose only if image is square. Rgb <-> bgr swap can be fused, so each pixel is read and written once.
+    static bool ConvertImageGeometry(const GrayImage &image, GrayImage &converted_image, ImageGeometry geometry);
+    static bool ConvertImageGeometry(const RgbImage &image, RgbImage &converted_image, ImageGeometry geometry, bool swap_rgb_bgr = false);
 
-    // Support for image draw.
+    // Support for image draw. Each pixel is written once by one primitive, so blended primitives never blend a pixel twice. Gray and rgb
+    // images are instantiated in library. Include image_painter_draw.h to inline them, or to draw images of other PixelTraits, like rgba,
+    // uint16 or float ones. Yuv420Image of image_painter_yuv.h is instantiated with YuvPixel for draws and renders in camera view.
+    template <typename ImageType, typename PixelType>
+    static void DrawSolidRectangle(ImageType &image, int32_t x, int32_t y, int32_t width, int32_t height, const PixelType &color,
+                                   const Blend &blend = Blend());
+    // Draw a batch of boxes with the same color, such as detection results of one frame.
+    template <typename ImageType, typename PixelType>
+    static void DrawSolidRectangles(ImageType &image, const std::vector<Rectangle> &rectangles, const PixelType &color, const Blend &blend = Blend());
+    // Thick edges grow inside from the 1-pixel edges, so the box keeps its outer bound.
     template <typename ImageType, typename PixelType>
-    static void DrawSolidRectangle(ImageType &image, int32_t x, int32_t y, int32_t width, int32_t height, const PixelType &color);
+    static void DrawHollowRectangle(ImageType &image, int32_t x, int32_t y, int32_t width, int32_t height, const PixelType &color, int32_t line_width = 1,
+                                    const Blend &blend = Blend());
     template <typename ImageType, typename PixelType>
-    static void DrawHollowRectangle(ImageType &image, int32_t x, int32_t y, int32_t width, int32_t height, const PixelType &color);
+    static void DrawBressenhanLine(ImageType &image, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const PixelType &color, const Blend &blend = Blend());
     template <typename ImageType, typename PixelType>
-    static void DrawBressenhanLine(ImageType &image, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const PixelType &color);
+    static void DrawNaiveLine(ImageType &image, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const PixelType &color, const Blend &blend = Blend());
     template <typename ImageType, typename PixelType>
-    static void DrawNaiveLine(ImageType &image, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const PixelType &color);
+    static void DrawSolidCircle(ImageType &image, int32_t center_x, int32_t center_y, int32_t radius, const PixelType &color, const Blend &blend = Blend());
+    // Ring covers pixels whose distance to center is in (radius - line_width - 0.1, radius).
     template <typename ImageType, typename PixelType>
-    static void DrawSolidCircle(ImageType &image, int32_t center_x, int32_t center_y, int32_t radius, const PixelType &color);
+    static void DrawHollowCircle(ImageType &image, int32_t center_x, int32_t center_y, int32_t radius, const PixelType &color, int32_t line_width = 1,
+                                 const Blend &blend = Blend());
     template <typename ImageType, typename PixelType>
-    static void DrawHollowCircle(ImageType &image, int32_t center_x, int32_t center_y, int32_t radius, const PixelType &color);
+    static void DrawMidBresenhamEllipse(ImageType &image, int32_t center_x, int32_t center_y, int32_t radius_x, int32_t radius_y, const PixelType &color,
+                                        const Blend &blend = Blend());
     template <typename ImageType, typename PixelType>
-    static void DrawMidBresenhamEllipse(ImageType &image, int32_t center_x, int32_t center_y, int32_t radius_x, int32_t radius_y, const PixelType &color);
+    static void DrawSolidEllipse(ImageType &image, int32_t center_x, int32_t center_y, int32_t radius_x, int32_t radius_y, const PixelType &color,
+                                 const Blend &blend = Blend());
+    // Trust region of gaussian is d^T * covariance^-1 * d <= (0.5 * sigma_scale)^2. Its conic is rasterized row by row without eigen
+    // decomposition, and its boundary is 8-connected pixels inside it, each of which is written once.
     template <typename ImageType, typename PixelType>
-    static void DrawTrustRegionOfGaussian(ImageType &image, const Vec2 &center, const Mat2 &covariance, const PixelType &color, const float sigma_scale = 3.0f);
+    static void DrawTrustRegionOfGaussian(ImageType &image, const Vec2 &center, const Mat2 &covariance, const PixelType &color, const float sigma_scale = 3.0f,
+                                          const Blend &blend = Blend());
     template <typename ImageType, typename PixelType>
-    static void DrawCharacter(ImageType &image, char character, int32_t x, int32_t y, const PixelType &color, int32_t font_size = 12);
+    static void DrawSolidTrustRegionOfGaussian(ImageType &image, const Vec2 &center, const Mat2 &covariance, const PixelType &color,
+                                               const float sigma_scale = 3.0f, const Blend &blend = Blend());
+    // Font size other than 12 / 16 / 24 is scaled from the nearest ascii fonts, and clamped into [6, 256]. If smoothing is enabled, edges of
+    // scaled glyphs are blended with their coverage.
     template <typename ImageType, typename PixelType>
-    static void DrawString(ImageType &image, const std::string &str, int32_t x, int32_t y, const PixelType &color, int32_t font_size = 12);
+    static void DrawCharacter(ImageType &image, char character, int32_t x, int32_t y, const PixelType &color, int32_t font_size = 12,
+                              bool is_smooth = false, const Blend &blend = Blend());
     template <typename ImageType, typename PixelType>
-    static void DrawDashedLine(ImageType &image, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t step, const PixelType &color);
+    static void DrawString(ImageType &image, const std::string &str, int32_t x, int32_t y, const PixelType &color, int32_t font_size = 12,
+                           bool is_smooth = false, const Blend &blend = Blend());
+    template <typename ImageType, typename PixelType>
+    static void DrawDashedLine(ImageType &image, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t step, const PixelType &color,
+                               const Blend &blend = Blend());
+
+    // Support for polygon and thick line draw. They are filled by scanlines, so each covered pixel is written once. Polygon is filled by
+    // nonzero winding rule with half open edges, so polygon of a rectangle covers the same pixels as DrawSolidRectangle.
+    template <typename ImageType, typename PixelType>
+    static void DrawSolidPolygon(ImageType &image, const PointsBatch &points, const PixelType &color, const Blend &blend = Blend());
+    // Stroke covers pixels whose distance to the segments is less than half of line width, together with joins and caps.
+    template <typename ImageType, typename PixelType>
+    static void DrawThickLine(ImageType &image, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t line_width, const PixelType &color,
+                              LineCap cap = LineCap::kButt, const Blend &blend = Blend());
+    template <typename ImageType, typename PixelType>
+    static void DrawThickPolyline(ImageType &image, const PointsBatch &points, int32_t line_width, const PixelType &color, bool is_closed = false,
+                                  LineJoin join = LineJoin::kMiter, LineCap cap = LineCap::kButt, const Blend &blend = Blend());
+
+    // Support for batch draw. Colors contain one color shared by all items, or one color per item. Validation runs once per batch.
+    // If multi-thread is enabled, image is split into row tiles, which are drawn in parallel.
+    template <typename ImageType, typename PixelType>
+    static void DrawPoints(ImageType &image, const PointsBatch &points, const std::vector<PixelType> &colors, bool use_multi_thread = false,
+                           const Blend &blend = Blend());
+    // Lines are drawn by DrawBressenhanLine.
+    template <typename ImageType, typename PixelType>
+    static void DrawLines(ImageType &image, const LinesBatch &lines, const std::vector<PixelType> &colors, bool use_multi_thread = false,
+                          const Blend &blend = Blend());
+    template <typename ImageType, typename PixelType>
+    static void DrawCircles(ImageType &image, const CirclesBatch &circles, const std::vector<PixelType> &colors, bool is_solid = true,
+                            bool use_multi_thread = false, const Blend &blend = Blend());
+    // Segments are drawn by DrawBressenhanLine one by one, so shared vertices are blended by both of their segments.
+    template <typename ImageType, typename PixelType>
+    static void DrawPolyline(ImageType &image, const PointsBatch &points, const PixelType &color, bool is_closed = false, bool use_multi_thread = false,
+                             const Blend &blend = Blend());
+    // Conics of gaussians are computed once, and then drawn in row tiles. Each pixel of one gaussian is blended once.
+    template <typename ImageType, typename PixelType>
+    static void DrawTrustRegionsOfGaussian(ImageType &image, const GaussiansBatch &gaussians, const std::vector<PixelType> &colors, bool is_solid = false,
+                                           const float sigma_scale = 3.0f, bool use_multi_thread = false, const Blend &blend = Blend());
+    // Labels are drawn by DrawString with the same font size.
+    template <typename ImageType, typename PixelType>
+    static void DrawStrings(ImageType &image, const std::vector<Label> &labels, const std::vector<PixelType> &colors, int32_t font_size = 12,
+                            bool is_smooth = false, bool use_multi_thread = false, const Blend &blend = Blend());
+
+    // Support for projection in camera view, which is shared by render functions. Return false if primitive is behind the near plane.
+    static constexpr float kMinValidViewDepth = 0.1f;
+    // Depth in camera frame is also output if required.
+    static bool ProjectPointInCameraView(const CameraView &cam, const Vec3 &p_w, Pixel &pixel_uv, float *depth = nullptr);
+    static bool ProjectLineSegmentInCameraView(const CameraView &cam, const Vec3 &line_s_point, const Vec3 &line_e_point, Pixel &pixel_uv_s,
+                                               Pixel &pixel_uv_e, float *depth_s = nullptr, float *depth_e = nullptr);
+    static bool ProjectGaussianInCameraView(const CameraView &cam, const Vec3 &mid_p_w, const Mat3 &covariance, Vec2 &pixel_uv, Mat2 &pixel_cov,
+                                            float *depth = nullptr);
+    // Project points in bulk, with the same result as ProjectPointInCameraView. Outputs have points_in_w.cols() items. Points behind the
+    // near plane, or farther than margin pixels out of image of rows x cols, are marked by kInvalidPixel.
+    static constexpr int32_t kInvalidPixel = std::numeric_limits<int32_t>::min();
+    static void ProjectPointsInCameraView(const CameraView &cam, const PointCloudBatch &points_in_w, int32_t rows, int32_t cols, int32_t margin,
+                                          int32_t *pixel_u, int32_t *pixel_v, float *depth = nullptr);
 
     // Support for render in camera view.
     template <typename ImageType, typename PixelType>
@@ -70,14 +381,35 @@ public:
                                        const int32_t font_size = 12);
     template <typename ImageType, typename PixelType>
     static void RenderPointInCameraView(ImageType &image, const CameraView &cam, const Vec3 &point_in_w, const PixelType color, const int32_t radius = 1);
+    // Render point cloud in bulk, which is the same as calling RenderPointInCameraView on each point. Points are projected in blocks, and
+    // stamped with the precomputed spans of radius. Colors contain one color shared by all points, or one color per point. If multi-thread
+    // is enabled, points are projected in parallel chunks, and stamped in parallel row tiles.
+    template <typename ImageType, typename PixelType>
+    static void RenderPointsInCameraView(ImageType &image, const CameraView &cam, const PointCloudBatch &points_in_w, const std::vector<PixelType> &colors,
+                                         const int32_t radius = 1, bool use_multi_thread = false);
     template <typename ImageType, typename PixelType>
     static void RenderLineSegmentInCameraView(ImageType &image, const CameraView &cam, const Vec3 &line_s_point, const Vec3 &line_e_point,
                                               const PixelType color);
+    // Render points and line segments of spatial index, which only projects the items in voxels inside view frustum. Result is the same
+    // as rendering all of them in added order. Colors contain one color shared by all items, or one color per item.
+    template <typename ImageType, typename PixelType>
+    static void RenderPointsInCameraView(ImageType &image, const CameraView &cam, const SpatialIndex &index, const std::vector<PixelType> &colors,
+                                         const int32_t radius = 1, bool use_multi_thread = false);
+    template <typename ImageType, typename PixelType>
+    static void RenderLineSegmentsInCameraView(ImageType &image, const CameraView &cam, const SpatialIndex &index, const std::vector<PixelType> &colors);
     template <typename ImageType, typename PixelType>
     static void RenderDashedLineSegmentInCameraView(ImageType &image, const CameraView &cam, const Vec3 &line_s_point, const Vec3 &line_e_point,
                                                     const int32_t dot_step, const PixelType color);
     template <typename ImageType, typename PixelType>
     static void RenderEllipseInCameraView(ImageType &image, const CameraView &cam, const Vec3 &mid_p_w, const Mat3 &covariance, const PixelType color);
+    // Render ellipses of 3d gaussians in bulk with the same sigma scale as RenderEllipseInCameraView. Gaussians are propagated into pixel
+    // frame in blocks with one precomputed rotation, and ellipses behind the near plane or out of image are culled before rasterization.
+    // Colors contain one color shared by all ellipses, or one color per ellipse. If multi-thread is enabled, gaussians are propagated in
+    // parallel chunks, and ellipses are drawn in parallel row tiles.
+    template <typename ImageType, typename PixelType>
+    static void RenderEllipsesInCameraView(ImageType &image, const CameraView &cam, const PointCloudBatch &means_in_w,
+                                           const CovarianceCloudBatch &covariances, const std::vector<PixelType> &colors, bool is_solid = false,
+                                           bool use_multi_thread = false);
 };
 
 }  // namespace image_painter
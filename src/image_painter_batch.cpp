@@ -0,0 +1,202 @@
+#include "image_painter.h"
+#include "image_painter_blend.h"
+#include "image_painter_glyph.h"
+#include "image_painter_parallel.h"
+#include "image_painter_pixel.h"
+#include "image_painter_profile.h"
+#include "image_painter_raster.h"
+#include "image_painter_tile.h"
+
+#include "slam_log_reporter.h"
+#include "slam_operations.h"
+
+namespace image_painter {
+
+namespace {
+    constexpr int32_t kMinRowsOfTile = 32;
+
+    template <typename PixelType>
+    bool CheckColorsOfBatch(const std::vector<PixelType> &colors, int32_t size) {
+        if (colors.size() != 1 && static_cast<int32_t>(colors.size()) != size) {
+            ReportError("[ImagePainter] Size of colors " << colors.size() << " should be 1 or size of batch " << size << ".");
+            return false;
+        }
+        return true;
+    }
+
+    // Run function(tile, row_offset) on row tiles of image. Each tile is a view of some rows of image, so its pixels are written by
+    // only one thread. Primitives in tile are shifted by -row_offset, which keeps integer rasterization unchanged.
+    template <typename ImageType, typename Function>
+    void DrawInRowTiles(ImageType &image, bool use_multi_thread, const Function &function) {
+        ParallelFor(0, image.rows(), use_multi_thread ? kMinRowsOfTile : image.rows(), [&](int32_t row_begin, int32_t row_end) {
+            ImageType tile = GetRowTileOfImage(image, row_begin, row_end - row_begin);
+            function(tile, row_begin);
+        });
+    }
+}  // namespace
+
+template void ImagePainter::DrawPoints<GrayImage, uint8_t>(GrayImage &image, const PointsBatch &points, const std::vector<uint8_t> &colors,
+                                                           bool use_multi_thread, const Blend &blend);
+template void ImagePainter::DrawPoints<RgbImage, RgbPixel>(RgbImage &image, const PointsBatch &points, const std::vector<RgbPixel> &colors,
+                                                           bool use_multi_thread, const Blend &blend);
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawPoints(ImageType &image, const PointsBatch &points, const std::vector<PixelType> &colors, bool use_multi_thread,
+                             const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kPoints, image);
+    const int32_t size = static_cast<int32_t>(points.rows());
+    RETURN_IF(image.data() == nullptr || size == 0 || !CheckColorsOfBatch(colors, size));
+    const int32_t color_step = colors.size() == 1 ? 0 : 1;
+
+    DrawInRowTiles(image, use_multi_thread, [&](ImageType &tile, int32_t row_offset) {
+        for (int32_t i = 0; i < size; ++i) {
+            const int32_t x = points(i, 0);
+            const int32_t y = points(i, 1) - row_offset;
+            CONTINUE_IF(x < 0 || x >= tile.cols() || y < 0 || y >= tile.rows());
+            PixelWriter<ImageType, PixelType>(tile, colors[i * color_step], blend).SetPixelUnchecked(y, x);
+        }
+    });
+}
+
+template void ImagePainter::DrawLines<GrayImage, uint8_t>(GrayImage &image, const LinesBatch &lines, const std::vector<uint8_t> &colors, bool use_multi_thread,
+                                                          const Blend &blend);
+template void ImagePainter::DrawLines<RgbImage, RgbPixel>(RgbImage &image, const LinesBatch &lines, const std::vector<RgbPixel> &colors, bool use_multi_thread,
+                                                          const Blend &blend);
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawLines(ImageType &image, const LinesBatch &lines, const std::vector<PixelType> &colors, bool use_multi_thread, const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kLines, image);
+    const int32_t size = static_cast<int32_t>(lines.rows());
+    RETURN_IF(image.data() == nullptr || size == 0 || !CheckColorsOfBatch(colors, size));
+    const int32_t color_step = colors.size() == 1 ? 0 : 1;
+
+    DrawInRowTiles(image, use_multi_thread, [&](ImageType &tile, int32_t row_offset) {
+        for (int32_t i = 0; i < size; ++i) {
+            const int32_t y1 = lines(i, 1) - row_offset;
+            const int32_t y2 = lines(i, 3) - row_offset;
+            CONTINUE_IF(std::max(y1, y2) < 0 || std::min(y1, y2) >= tile.rows());
+            DrawBressenhanLine(tile, lines(i, 0), y1, lines(i, 2), y2, colors[i * color_step], blend);
+        }
+    });
+}
+
+template void ImagePainter::DrawCircles<GrayImage, uint8_t>(GrayImage &image, const CirclesBatch &circles, const std::vector<uint8_t> &colors, bool is_solid,
+                                                            bool use_multi_thread, const Blend &blend);
+template void ImagePainter::DrawCircles<RgbImage, RgbPixel>(RgbImage &image, const CirclesBatch &circles, const std::vector<RgbPixel> &colors, bool is_solid,
+                                                            bool use_multi_thread, const Blend &blend);
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawCircles(ImageType &image, const CirclesBatch &circles, const std::vector<PixelType> &colors, bool is_solid, bool use_multi_thread,
+                              const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kCircles, image);
+    const int32_t size = static_cast<int32_t>(circles.rows());
+    RETURN_IF(image.data() == nullptr || size == 0 || !CheckColorsOfBatch(colors, size));
+    const int32_t color_step = colors.size() == 1 ? 0 : 1;
+
+    DrawInRowTiles(image, use_multi_thread, [&](ImageType &tile, int32_t row_offset) {
+        for (int32_t i = 0; i < size; ++i) {
+            const int32_t center_y = circles(i, 1) - row_offset;
+            const int32_t radius = circles(i, 2);
+            CONTINUE_IF(radius < 0 || center_y + radius <= 0 || center_y - radius >= tile.rows() - 1);
+            if (is_solid) {
+                DrawSolidCircle(tile, circles(i, 0), center_y, radius, colors[i * color_step], blend);
+            } else {
+                DrawHollowCircle(tile, circles(i, 0), center_y, radius, colors[i * color_step], 1, blend);
+            }
+        }
+    });
+}
+
+template void ImagePainter::DrawTrustRegionsOfGaussian<GrayImage, uint8_t>(GrayImage &image, const GaussiansBatch &gaussians,
+                                                                           const std::vector<uint8_t> &colors, bool is_solid, const float sigma_scale,
+                                                                           bool use_multi_thread, const Blend &blend);
+template void ImagePainter::DrawTrustRegionsOfGaussian<RgbImage, RgbPixel>(RgbImage &image, const GaussiansBatch &gaussians,
+                                                                           const std::vector<RgbPixel> &colors, bool is_solid, const float sigma_scale,
+                                                                           bool use_multi_thread, const Blend &blend);
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawTrustRegionsOfGaussian(ImageType &image, const GaussiansBatch &gaussians, const std::vector<PixelType> &colors, bool is_solid,
+                                              const float sigma_scale, bool use_multi_thread, const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kTrustRegionsOfGaussian, image);
+    const int32_t size = static_cast<int32_t>(gaussians.rows());
+    RETURN_IF(image.data() == nullptr || size == 0 || !CheckColorsOfBatch(colors, size));
+    const int32_t color_step = colors.size() == 1 ? 0 : 1;
+
+    // Conics are shared by all tiles. Invalid covariances and ellipses out of image are skipped here.
+    std::vector<GaussianConic> conics;
+    std::vector<int32_t> indices;
+    conics.reserve(size);
+    indices.reserve(size);
+    for (int32_t i = 0; i < size; ++i) {
+        Mat2 covariance;
+        covariance << gaussians(i, 2), gaussians(i, 3), gaussians(i, 3), gaussians(i, 4);
+        GaussianConic conic;
+        CONTINUE_IF(!ComputeGaussianConic(Vec2(gaussians(i, 0), gaussians(i, 1)), covariance, sigma_scale, conic));
+        CONTINUE_IF(conic.row_max < 0 || conic.row_min >= image.rows());
+        conics.emplace_back(conic);
+        indices.emplace_back(i);
+    }
+
+    DrawInRowTiles(image, use_multi_thread, [&](ImageType &tile, int32_t row_offset) {
+        for (int32_t i = 0; i < static_cast<int32_t>(conics.size()); ++i) {
+            const GaussianConic &conic = conics[i];
+            CONTINUE_IF(conic.row_max < row_offset || conic.row_min >= row_offset + tile.rows());
+            const PixelWriter<ImageType, PixelType> writer(tile, colors[indices[i] * color_step], blend);
+            TraverseGaussianConic(conic, is_solid, row_offset, row_offset + tile.rows() - 1,
+                                  [&](int32_t row, int32_t col_begin, int32_t col_end) { writer.FillSpan(row - row_offset, col_begin, col_end); });
+        }
+    });
+}
+
+template void ImagePainter::DrawPolyline<GrayImage, uint8_t>(GrayImage &image, const PointsBatch &points, const uint8_t &color, bool is_closed,
+                                                             bool use_multi_thread, const Blend &blend);
+template void ImagePainter::DrawPolyline<RgbImage, RgbPixel>(RgbImage &image, const PointsBatch &points, const RgbPixel &color, bool is_closed,
+                                                             bool use_multi_thread, const Blend &blend);
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawPolyline(ImageType &image, const PointsBatch &points, const PixelType &color, bool is_closed, bool use_multi_thread,
+                                const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kPolyline, image);
+    const int32_t size = static_cast<int32_t>(points.rows());
+    RETURN_IF(image.data() == nullptr || size < 2);
+    const int32_t num_of_segments = is_closed && size > 2 ? size : size - 1;
+
+    DrawInRowTiles(image, use_multi_thread, [&](ImageType &tile, int32_t row_offset) {
+        for (int32_t i = 0; i < num_of_segments; ++i) {
+            const int32_t j = i + 1 == size ? 0 : i + 1;
+            const int32_t y1 = points(i, 1) - row_offset;
+            const int32_t y2 = points(j, 1) - row_offset;
+            CONTINUE_IF(std::max(y1, y2) < 0 || std::min(y1, y2) >= tile.rows());
+            DrawBressenhanLine(tile, points(i, 0), y1, points(j, 0), y2, color, blend);
+        }
+    });
+}
+
+template void ImagePainter::DrawStrings<GrayImage, uint8_t>(GrayImage &image, const std::vector<Label> &labels, const std::vector<uint8_t> &colors,
+                                                            int32_t font_size, bool is_smooth, bool use_multi_thread, const Blend &blend);
+template void ImagePainter::DrawStrings<RgbImage, RgbPixel>(RgbImage &image, const std::vector<Label> &labels, const std::vector<RgbPixel> &colors,
+                                                            int32_t font_size, bool is_smooth, bool use_multi_thread, const Blend &blend);
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawStrings(ImageType &image, const std::vector<Label> &labels, const std::vector<PixelType> &colors, int32_t font_size,
+                               bool is_smooth, bool use_multi_thread, const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kStrings, image);
+    const int32_t size = static_cast<int32_t>(labels.size());
+    RETURN_IF(image.data() == nullptr || size == 0 || !CheckColorsOfBatch(colors, size));
+    const int32_t color_step = colors.size() == 1 ? 0 : 1;
+    const auto atlas_ptr = GlyphAtlas::Get(font_size, is_smooth);
+    const GlyphAtlas &atlas = *atlas_ptr;
+
+    DrawInRowTiles(image, use_multi_thread, [&](ImageType &tile, int32_t row_offset) {
+        for (int32_t i = 0; i < size; ++i) {
+            const Label &label = labels[i];
+            const int64_t y = static_cast<int64_t>(label.y) - row_offset;
+            CONTINUE_IF(y >= tile.rows() || y + atlas.rows() <= 0 || label.x >= tile.cols());
+            const PixelWriter<ImageType, PixelType> writer(tile, colors[i * color_step], blend);
+            int32_t x = label.x;
+            for (const auto &chr: label.text) {
+                DrawGlyph(writer, atlas, chr, x, static_cast<int32_t>(y));
+                x += atlas.cols();
+                if (x >= tile.cols()) {
+                    break;
+                }
+            }
+        }
+    });
+}
+
+}  // namespace image_painter
@@ -0,0 +1,187 @@
+#ifndef _IMAGE_PAINTER_BLEND_H_
+#define _IMAGE_PAINTER_BLEND_H_
+
+#include "basic_type.h"
+#include "datatype_image.h"
+#include "image_painter.h"
+#include "image_painter_pixel.h"
+#include "image_painter_simd.h"
+
+#include "cmath"
+#include "type_traits"
+
+namespace image_painter {
+
+// Blend one byte of color over one byte of image, which is the same as blend kernels.
+inline uint8_t BlendByte(uint8_t value, uint8_t color, const ImagePainter::Blend &blend) {
+    switch (blend.mode) {
+        case ImagePainter::BlendMode::kAlpha:
+            return DivideBy255(value * (255 - blend.alpha) + color * blend.alpha);
+        case ImagePainter::BlendMode::kAdditive:
+            return static_cast<uint8_t>(std::min(value + DivideBy255(color * blend.alpha), 255));
+        case ImagePainter::BlendMode::kMax:
+            return std::max(value, DivideBy255(color * blend.alpha));
+        default:
+            return color;
+    }
+}
+
+// Blend one channel of color over one channel of image. Byte channels are blended by BlendByte, and the others in float, which are
+// rounded and saturated to [0, kMaxValue] if they are integers.
+template <typename ImageType>
+inline typename PixelTraits<ImageType>::ChannelType BlendChannel(typename PixelTraits<ImageType>::ChannelType value,
+                                                                 typename PixelTraits<ImageType>::ChannelType color,
+                                                                 const ImagePainter::Blend &blend) {
+    using ChannelType = typename PixelTraits<ImageType>::ChannelType;
+    if constexpr (std::is_same<ChannelType, uint8_t>::value) {
+        return BlendByte(value, color, blend);
+    } else {
+        const float alpha = static_cast<float>(blend.alpha) / 255.0f;
+        const float max_value = static_cast<float>(PixelTraits<ImageType>::kMaxValue);
+        float result = static_cast<float>(color);
+        switch (blend.mode) {
+            case ImagePainter::BlendMode::kAlpha:
+                result = static_cast<float>(value) * (1.0f - alpha) + static_cast<float>(color) * alpha;
+                break;
+            case ImagePainter::BlendMode::kAdditive:
+                result = std::min(static_cast<float>(value) + static_cast<float>(color) * alpha, max_value);
+                break;
+            case ImagePainter::BlendMode::kMax:
+                result = std::max(static_cast<float>(value), static_cast<float>(color) * alpha);
+                break;
+            default:
+                break;
+        }
+        if constexpr (std::is_integral<ChannelType>::value) {
+            return static_cast<ChannelType>(std::min(std::max(std::round(result), 0.0f), max_value));
+        } else {
+            return static_cast<ChannelType>(result);
+        }
+    }
+}
+
+template <typename ImageType>
+inline void BlendPixelUnchecked(ImageType &image, int32_t row, int32_t col, const typename PixelTraits<ImageType>::PixelType &color,
+                                const ImagePainter::Blend &blend) {
+    IMAGE_PAINTER_PROFILE_WRITTEN_PIXELS(1);
+    typename PixelTraits<ImageType>::ChannelType *pixel = GetPixelUnchecked(image, row, col);
+    for (int32_t c = 0; c < PixelTraits<ImageType>::kChannels; ++c) {
+        pixel[c] = BlendChannel<ImageType>(pixel[c], PixelTraits<ImageType>::GetChannel(color, c), blend);
+    }
+}
+
+// Blend of pixel partially covered by primitive, whose alpha is scaled by coverage. Opaque blend is mixed with image by coverage.
+inline ImagePainter::Blend ScaleBlendByCoverage(const ImagePainter::Blend &blend, uint8_t coverage) {
+    const ImagePainter::BlendMode mode = blend.mode == ImagePainter::BlendMode::kOpaque ? ImagePainter::BlendMode::kAlpha : blend.mode;
+    return ImagePainter::Blend(mode, DivideBy255(blend.alpha * coverage));
+}
+
+/* Class PixelWriter Declaration. It writes pixels of one primitive with its color and blend, so pattern of blend kernels is built once,
+   and spans of byte channels are blended by simd kernels. Opaque blend writes pixels directly. */
+template <typename ImageType, typename PixelType>
+class PixelWriter {
+
+private:
+    using Traits = PixelTraits<ImageType>;
+    // Blend pattern repeats color over its bytes, so it should hold whole pixels.
+    static constexpr bool kIsSimdBlendable = std::is_same<typename Traits::ChannelType, uint8_t>::value && kBlendPatternSize % Traits::kChannels == 0;
+
+public:
+    PixelWriter(ImageType &image, const PixelType &color, const ImagePainter::Blend &blend)
+        : image_(image), color_(color), blend_(blend) {
+        // Alpha blend with full alpha is the same as opaque one.
+        if (blend_.mode == ImagePainter::BlendMode::kAlpha && blend_.alpha == 255) {
+            blend_.mode = ImagePainter::BlendMode::kOpaque;
+        }
+        RETURN_IF(blend_.mode == ImagePainter::BlendMode::kOpaque || !kIsSimdBlendable);
+
+        pattern_.mode = blend_.mode;
+        pattern_.alpha = blend_.alpha;
+        for (int32_t i = 0; i < kBlendPatternSize; ++i) {
+            const uint8_t byte = static_cast<uint8_t>(Traits::GetChannel(color, i % Traits::kChannels));
+            pattern_.weighted[i] = static_cast<uint16_t>(byte * blend_.alpha + 128);
+            pattern_.scaled[i] = DivideBy255(byte * blend_.alpha);
+        }
+        blend_span_ = GetSimdKernels().blend_span;
+    }
+    virtual ~PixelWriter() = default;
+
+    // Nothing is changed by blend with zero alpha, so primitives can be skipped.
+    bool IsVisible() const { return blend_.mode == ImagePainter::BlendMode::kOpaque || blend_.alpha > 0; }
+
+    void SetPixelUnchecked(int32_t row, int32_t col) const {
+        if (blend_.mode == ImagePainter::BlendMode::kOpaque) {
+            SetPixelValueUnchecked(image_, row, col, color_);
+        } else {
+            BlendPixelUnchecked(image_, row, col, color_, blend_);
+        }
+    }
+
+    // Blend fragment of glyph by blend of writer scaled by coverage.
+    void BlendFragmentUnchecked(int32_t row, int32_t col, uint8_t coverage) const {
+        BlendPixelUnchecked(image_, row, col, color_, ScaleBlendByCoverage(blend_, coverage));
+    }
+
+    void SetPixel(int32_t row, int32_t col) const {
+        if (row < 0 || row >= image_.rows() || col < 0 || col >= image_.cols()) {
+            IMAGE_PAINTER_PROFILE_REJECTED_PIXELS(1);
+            return;
+        }
+        SetPixelUnchecked(row, col);
+    }
+
+    // Write [col_begin, col_end] of one row.
+    void FillSpanUnchecked(int32_t row, int32_t col_begin, int32_t col_end) const {
+        if (blend_.mode == ImagePainter::BlendMode::kOpaque) {
+            image_painter::FillSpanUnchecked(image_, row, col_begin, col_end, color_);
+        } else if constexpr (kIsSimdBlendable) {
+            IMAGE_PAINTER_PROFILE_WRITTEN_PIXELS(col_end - col_begin + 1);
+            blend_span_(GetPixelUnchecked(image_, row, col_begin), (col_end - col_begin + 1) * Traits::kChannels, pattern_);
+        } else {
+            for (int32_t col = col_begin; col <= col_end; ++col) {
+                BlendPixelUnchecked(image_, row, col, color_, blend_);
+            }
+        }
+    }
+
+    // Clip [col_begin, col_end] of one row into image, and write it.
+    void FillSpan(int32_t row, int32_t col_begin, int32_t col_end) const {
+        RETURN_IF(col_begin > col_end);
+        if (row < 0 || row >= image_.rows()) {
+            IMAGE_PAINTER_PROFILE_REJECTED_PIXELS(static_cast<int64_t>(col_end) - col_begin + 1);
+            return;
+        }
+        const int32_t clipped_col_begin = std::max(col_begin, 0);
+        const int32_t clipped_col_end = std::min(col_end, image_.cols() - 1);
+        IMAGE_PAINTER_PROFILE_REJECTED_PIXELS(static_cast<int64_t>(col_end) - col_begin + 1 - std::max(clipped_col_end - clipped_col_begin + 1, 0));
+        RETURN_IF(clipped_col_begin > clipped_col_end);
+        FillSpanUnchecked(row, clipped_col_begin, clipped_col_end);
+    }
+
+    // Opaque rectangle is filled by copying its first row, while blended one blends each row.
+    void FillRectangleUnchecked(int32_t row_begin, int32_t row_end, int32_t col_begin, int32_t col_end) const {
+        if (blend_.mode == ImagePainter::BlendMode::kOpaque) {
+            image_painter::FillRectangleUnchecked(image_, row_begin, row_end, col_begin, col_end, color_);
+            return;
+        }
+        for (int32_t row = row_begin; row <= row_end; ++row) {
+            FillSpanUnchecked(row, col_begin, col_end);
+        }
+    }
+
+    // Reference for member variables.
+    ImageType &image() const { return image_; }
+    const PixelType &color() const { return color_; }
+    const ImagePainter::Blend &blend() const { return blend_; }
+
+private:
+    ImageType &image_;
+    PixelType color_;
+    ImagePainter::Blend blend_;
+    BlendPattern pattern_;
+    void (*blend_span_)(uint8_t *span, int32_t size, const BlendPattern &pattern) = nullptr;
+};
+
+}  // namespace image_painter
+
+#endif  // end of _IMAGE_PAINTER_BLEND_H_
@@ -0,0 +1,108 @@
+#include "image_painter_color_map.h"
+#include "image_painter_simd.h"
+
+#include "slam_log_reporter.h"
+
+namespace image_painter {
+
+namespace {
+    uint8_t ConvertUnitToUint8(float value) { return static_cast<uint8_t>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f); }
+
+    RgbPixel ConvertUnitToRgbPixel(float r, float g, float b) { return RgbPixel{ConvertUnitToUint8(r), ConvertUnitToUint8(g), ConvertUnitToUint8(b)}; }
+
+    // Evaluate polynomial c[0] + c[1] * t + ... + c[N - 1] * t^(N - 1).
+    template <int32_t N>
+    float EvaluatePolynomial(const std::array<float, N> &c, float t) {
+        float value = c[N - 1];
+        for (int32_t i = N - 2; i >= 0; --i) {
+            value = value * t + c[i];
+        }
+        return value;
+    }
+
+    RgbPixel ComputeColorOfMap(ColorMap::Type type, float t) {
+        switch (type) {
+            default:
+            case ColorMap::Type::kGray:
+                return ConvertUnitToRgbPixel(t, t, t);
+            case ColorMap::Type::kInverseGray:
+                return ConvertUnitToRgbPixel(1.0f - t, 1.0f - t, 1.0f - t);
+            case ColorMap::Type::kJet:
+                return ConvertUnitToRgbPixel(1.5f - std::fabs(4.0f * t - 3.0f), 1.5f - std::fabs(4.0f * t - 2.0f), 1.5f - std::fabs(4.0f * t - 1.0f));
+            case ColorMap::Type::kTurbo: {
+                // Polynomial approximation of turbo color map.
+                static const std::array<float, 6> kR = {0.13572138f, 4.61539260f, -42.66032258f, 132.13108234f, -152.94239396f, 59.28637943f};
+                static const std::array<float, 6> kG = {0.09140261f, 2.19418839f, 4.84296658f, -14.18503333f, 4.27729857f, 2.82956604f};
+                static const std::array<float, 6> kB = {0.10667330f, 12.64194608f, -60.58204836f, 110.36276771f, -89.90310912f, 27.34824973f};
+                return ConvertUnitToRgbPixel(EvaluatePolynomial<6>(kR, t), EvaluatePolynomial<6>(kG, t), EvaluatePolynomial<6>(kB, t));
+            }
+            case ColorMap::Type::kViridis: {
+                // Polynomial approximation of viridis color map.
+                static const std::array<float, 7> kR = {0.2777273272234177f, 0.1050930431085774f, -0.3308618287255563f, -4.634230498983486f,
+                                                        6.228269936347081f,  4.776384997670288f,  -5.435455855934631f};
+                static const std::array<float, 7> kG = {0.005407344544966578f, 1.404613529898575f, 0.214847559468213f, -5.799100973351585f,
+                                                        14.17993336680509f,    -13.74514537774601f, 4.645852612178535f};
+                static const std::array<float, 7> kB = {0.3340998053353061f, 1.384590162594685f, 0.09509516302823659f, -19.33244095627987f,
+                                                        56.69055260068105f,  -65.35303263337234f, 26.3124352495832f};
+                return ConvertUnitToRgbPixel(EvaluatePolynomial<7>(kR, t), EvaluatePolynomial<7>(kG, t), EvaluatePolynomial<7>(kB, t));
+            }
+            case ColorMap::Type::kHot:
+                return ConvertUnitToRgbPixel(3.0f * t, 3.0f * t - 1.0f, 3.0f * t - 2.0f);
+            case ColorMap::Type::kCoolWarm: {
+                // Diverging map from blue to white to red, used with symmetric normalization.
+                const float s = 2.0f * t - 1.0f;
+                return s < 0.0f ? ConvertUnitToRgbPixel(1.0f + s, 1.0f + s, 1.0f) : ConvertUnitToRgbPixel(1.0f, 1.0f - s, 1.0f - s);
+            }
+        }
+    }
+}  // namespace
+
+ColorMap::ColorMap(Type type) {
+    for (int32_t i = 0; i < kLutSize; ++i) {
+        lut_[i] = ComputeColorOfMap(type, static_cast<float>(i) / static_cast<float>(kLutSize - 1));
+    }
+    UpdateGrayLut();
+}
+
+ColorMap::ColorMap(const std::vector<RgbPixel> &colors) {
+    if (colors.empty()) {
+        ReportError("[ColorMap] User-supplied colors are empty.");
+        UpdateGrayLut();
+        return;
+    }
+    if (colors.size() == 1) {
+        lut_.fill(colors.front());
+        UpdateGrayLut();
+        return;
+    }
+
+    const float segment = static_cast<float>(colors.size() - 1) / static_cast<float>(kLutSize - 1);
+    for (int32_t i = 0; i < kLutSize; ++i) {
+        const float position = static_cast<float>(i) * segment;
+        const int32_t idx = std::min(static_cast<int32_t>(position), static_cast<int32_t>(colors.size()) - 2);
+        const float w = position - static_cast<float>(idx);
+        const RgbPixel &c0 = colors[idx];
+        const RgbPixel &c1 = colors[idx + 1];
+        lut_[i] = RgbPixel{static_cast<uint8_t>(c0.r + (c1.r - c0.r) * w + 0.5f), static_cast<uint8_t>(c0.g + (c1.g - c0.g) * w + 0.5f),
+                           static_cast<uint8_t>(c0.b + (c1.b - c0.b) * w + 0.5f)};
+    }
+    UpdateGrayLut();
+}
+
+const ColorMap &ColorMap::Get(Type type) {
+    static const std::array<ColorMap, 7> kColorMaps = {
+        ColorMap(Type::kGray), ColorMap(Type::kInverseGray), ColorMap(Type::kJet),      ColorMap(Type::kTurbo),
+        ColorMap(Type::kViridis), ColorMap(Type::kHot),      ColorMap(Type::kCoolWarm),
+    };
+    const int32_t idx = static_cast<int32_t>(type);
+    return idx < static_cast<int32_t>(kColorMaps.size()) ? kColorMaps[idx] : kColorMaps[0];
+}
+
+void ColorMap::UpdateGrayLut() {
+    for (int32_t i = 0; i < kLutSize; ++i) {
+        const RgbPixel &c = lut_[i];
+        gray_lut_[i] = static_cast<uint8_t>((c.r * kLumaWeightR + c.g * kLumaWeightG + c.b * kLumaWeightB) >> kLumaWeightShift);
+    }
+}
+
+}  // namespace image_painter
@@ -0,0 +1,50 @@
+#ifndef _IMAGE_PAINTER_COLOR_MAP_H_
+#define _IMAGE_PAINTER_COLOR_MAP_H_
+
+#include "array"
+#include "basic_type.h"
+#include "datatype_image.h"
+
+namespace image_painter {
+
+/* Class ColorMap Declaration. */
+class ColorMap {
+
+public:
+    // Index 0 of each lut is the color of zero, and the last index is the color of max value.
+    enum class Type : uint8_t {
+        kGray = 0,
+        kInverseGray = 1,
+        kJet = 2,
+        kTurbo = 3,
+        kViridis = 4,
+        kHot = 5,
+        kCoolWarm = 6,
+    };
+    static constexpr int32_t kLutSize = 256;
+
+public:
+    ColorMap() = default;
+    explicit ColorMap(Type type);
+    // User-supplied color map. Colors are evenly placed from index 0 to the last one, and linearly interpolated between them.
+    explicit ColorMap(const std::vector<RgbPixel> &colors);
+    virtual ~ColorMap() = default;
+
+    // Prebuilt color maps, which are created once on first use.
+    static const ColorMap &Get(Type type);
+
+    const std::array<RgbPixel, kLutSize> &lut() const { return lut_; }
+    // Gray lut is the luma of rgb lut, used when painting GrayImage.
+    const std::array<uint8_t, kLutSize> &gray_lut() const { return gray_lut_; }
+
+private:
+    void UpdateGrayLut();
+
+private:
+    std::array<RgbPixel, kLutSize> lut_ = {};
+    std::array<uint8_t, kLutSize> gray_lut_ = {};
+};
+
+}  // namespace image_painter
+
+#endif  // end of _IMAGE_PAINTER_COLOR_MAP_H_
@@ -1,4 +1,6 @@
 #include "image_painter.h"
+#include "image_painter_parallel.h"
+#include "image_painter_simd.h"
 
 #include "slam_log_reporter.h"
 #include "slam_memory.h"
@@ -6,59 +8,571 @@
 
 namespace image_painter {
 
-void ImagePainter::ConvertUint8ToRgb(const uint8_t *gray, uint8_t *rgb, int32_t gray_size) {
-    for (int32_t i = 0; i < gray_size; ++i) {
-        const int32_t idx = i * 3;
-        std::fill_n(rgb + idx, 3, gray[i]);
+namespace {
+    // Size of square tiles for rotations and transpose, in pixels. A 32x32 rgb tile and its destination lines stay in l1 cache.
+    constexpr int32_t kGeometryTileSize = 32;
+
+    template <int32_t kChannels, bool kSwapRgbBgr>
+    inline void CopyPixel(const uint8_t *src, uint8_t *dst) {
+        if constexpr (kChannels == 1) {
+            dst[0] = src[0];
+        } else if constexpr (kSwapRgbBgr) {
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+        } else {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+        }
     }
-}
 
-void ImagePainter::ConvertRgbToUint8(const uint8_t *rgb, uint8_t *gray, int32_t gray_size) {
-    for (int32_t i = 0; i < gray_size; ++i) {
-        const int32_t idx = i * 3;
-        gray[i] =
-            static_cast<uint8_t>(static_cast<float>(rgb[idx]) * 0.299f + static_cast<float>(rgb[idx + 1]) * 0.587f + static_cast<float>(rgb[idx + 2]) * 0.114f);
+    // Exchange two pixels. It also works when a equals b.
+    template <int32_t kChannels, bool kSwapRgbBgr>
+    inline void ExchangePixel(uint8_t *a, uint8_t *b) {
+        uint8_t temp[kChannels];
+        CopyPixel<kChannels, false>(a, temp);
+        CopyPixel<kChannels, kSwapRgbBgr>(b, a);
+        CopyPixel<kChannels, kSwapRgbBgr>(temp, b);
+    }
+
+    // Copy each row of source into destination, with optional rgb <-> bgr swap. Destination index of source pixel (row, col) is
+    // offset + row * row_step + col.
+    template <int32_t kChannels, bool kSwapRgbBgr>
+    void CopyRows(const uint8_t *src, int32_t rows, int32_t cols, uint8_t *dst, int32_t offset, int32_t row_step) {
+        const SimdKernels &kernels = GetSimdKernels();
+        for (int32_t row = 0; row < rows; ++row) {
+            const uint8_t *src_row = src + row * cols * kChannels;
+            uint8_t *dst_row = dst + (offset + row * row_step) * kChannels;
+            if constexpr (kSwapRgbBgr) {
+                kernels.convert_rgb_to_bgr(src_row, dst_row, cols);
+            } else {
+                std::copy_n(src_row, cols * kChannels, dst_row);
+            }
+        }
+    }
+
+    // Copy source into destination tile by tile. Destination index of source pixel (row, col) is offset + row * row_step + col * col_step.
+    template <int32_t kChannels, bool kSwapRgbBgr>
+    void CopyTiles(const uint8_t *src, int32_t rows, int32_t cols, uint8_t *dst, int32_t offset, int32_t row_step, int32_t col_step) {
+        for (int32_t tile_row = 0; tile_row < rows; tile_row += kGeometryTileSize) {
+            const int32_t max_row = std::min(tile_row + kGeometryTileSize, rows);
+            for (int32_t tile_col = 0; tile_col < cols; tile_col += kGeometryTileSize) {
+                const int32_t max_col = std::min(tile_col + kGeometryTileSize, cols);
+                for (int32_t row = tile_row; row < max_row; ++row) {
+                    const uint8_t *src_pixel = src + (row * cols + tile_col) * kChannels;
+                    int32_t dst_index = offset + row * row_step + tile_col * col_step;
+                    for (int32_t col = tile_col; col < max_col; ++col) {
+                        CopyPixel<kChannels, kSwapRgbBgr>(src_pixel, dst + dst_index * kChannels);
+                        src_pixel += kChannels;
+                        dst_index += col_step;
+                    }
+                }
+            }
+        }
+    }
+
+    template <int32_t kChannels, bool kSwapRgbBgr>
+    void ConvertGeometryWithBuffer(const uint8_t *src, int32_t rows, int32_t cols, uint8_t *dst, ImagePainter::ImageGeometry geometry) {
+        using ImageGeometry = ImagePainter::ImageGeometry;
+        switch (geometry) {
+            default:
+            case ImageGeometry::kIdentity:
+                CopyRows<kChannels, kSwapRgbBgr>(src, rows, cols, dst, 0, cols);
+                break;
+            case ImageGeometry::kFlipVertical:
+                CopyRows<kChannels, kSwapRgbBgr>(src, rows, cols, dst, (rows - 1) * cols, -cols);
+                break;
+            case ImageGeometry::kFlipHorizontal:
+                CopyTiles<kChannels, kSwapRgbBgr>(src, rows, cols, dst, cols - 1, cols, -1);
+                break;
+            case ImageGeometry::kRotate90:
+                CopyTiles<kChannels, kSwapRgbBgr>(src, rows, cols, dst, rows - 1, -1, rows);
+                break;
+            case ImageGeometry::kRotate180:
+                CopyTiles<kChannels, kSwapRgbBgr>(src, rows, cols, dst, rows * cols - 1, -cols, -1);
+                break;
+            case ImageGeometry::kRotate270:
+                CopyTiles<kChannels, kSwapRgbBgr>(src, rows, cols, dst, (cols - 1) * rows, 1, -rows);
+                break;
+            case ImageGeometry::kTranspose:
+                CopyTiles<kChannels, kSwapRgbBgr>(src, rows, cols, dst, 0, 1, rows);
+                break;
+        }
+    }
+
+    template <int32_t kChannels, bool kSwapRgbBgr>
+    void FlipRowsInPlace(uint8_t *data, int32_t rows, int32_t cols) {
+        for (int32_t row = 0; row < rows; ++row) {
+            uint8_t *left = data + row * cols * kChannels;
+            uint8_t *right = left + (cols - 1) * kChannels;
+            for (; left <= right; left += kChannels, right -= kChannels) {
+                ExchangePixel<kChannels, kSwapRgbBgr>(left, right);
+            }
+        }
     }
-}
+
+    template <int32_t kChannels, bool kSwapRgbBgr>
+    void FlipColsInPlace(uint8_t *data, int32_t rows, int32_t cols) {
+        const int32_t stride = cols * kChannels;
+        std::vector<uint8_t> temp_row(stride);
+        for (int32_t row = 0; row < rows / 2; ++row) {
+            uint8_t *top = data + row * stride;
+            uint8_t *bottom = data + (rows - row - 1) * stride;
+            std::copy_n(top, stride, temp_row.data());
+            CopyRows<kChannels, kSwapRgbBgr>(bottom, 1, cols, top, 0, 0);
+            CopyRows<kChannels, kSwapRgbBgr>(temp_row.data(), 1, cols, bottom, 0, 0);
+        }
+        if (kSwapRgbBgr && rows % 2) {
+            uint8_t *middle = data + rows / 2 * stride;
+            CopyRows<kChannels, kSwapRgbBgr>(middle, 1, cols, middle, 0, 0);
+        }
+    }
+
+    // Transpose a square image by exchanging tiles on both sides of the diagonal.
+    template <int32_t kChannels, bool kSwapRgbBgr>
+    void TransposeInPlace(uint8_t *data, int32_t size) {
+        for (int32_t tile_row = 0; tile_row < size; tile_row += kGeometryTileSize) {
+            const int32_t max_row = std::min(tile_row + kGeometryTileSize, size);
+            for (int32_t tile_col = tile_row; tile_col < size; tile_col += kGeometryTileSize) {
+                const int32_t max_col = std::min(tile_col + kGeometryTileSize, size);
+                for (int32_t row = tile_row; row < max_row; ++row) {
+                    for (int32_t col = std::max(tile_col, row); col < max_col; ++col) {
+                        ExchangePixel<kChannels, kSwapRgbBgr>(data + (row * size + col) * kChannels, data + (col * size + row) * kChannels);
+                    }
+                }
+            }
+        }
+    }
+
+    template <int32_t kChannels, bool kSwapRgbBgr>
+    bool ConvertGeometryInPlace(uint8_t *data, int32_t rows, int32_t cols, ImagePainter::ImageGeometry geometry) {
+        using ImageGeometry = ImagePainter::ImageGeometry;
+        switch (geometry) {
+            default:
+            case ImageGeometry::kIdentity:
+                if constexpr (kSwapRgbBgr) {
+                    CopyRows<kChannels, kSwapRgbBgr>(data, rows, cols, data, 0, cols);
+                }
+                return true;
+            case ImageGeometry::kFlipVertical:
+                FlipColsInPlace<kChannels, kSwapRgbBgr>(data, rows, cols);
+                return true;
+            case ImageGeometry::kFlipHorizontal:
+                FlipRowsInPlace<kChannels, kSwapRgbBgr>(data, rows, cols);
+                return true;
+            case ImageGeometry::kRotate180:
+                // Rotate 180 reverses the order of all pixels.
+                FlipRowsInPlace<kChannels, kSwapRgbBgr>(data, 1, rows * cols);
+                return true;
+            case ImageGeometry::kRotate90:
+            case ImageGeometry::kRotate270:
+            case ImageGeometry::kTranspose:
+                break;
+        }
+
+        RETURN_FALSE_IF(rows != cols);
+        TransposeInPlace<kChannels, kSwapRgbBgr>(data, rows);
+        if (geometry == ImageGeometry::kRotate90) {
+            FlipRowsInPlace<kChannels, false>(data, rows, cols);
+        } else if (geometry == ImageGeometry::kRotate270) {
+            FlipColsInPlace<kChannels, false>(data, rows, cols);
+        }
+        return true;
+    }
+
+    template <int32_t kChannels, bool kSwapRgbBgr>
+    bool ConvertGeometry(const uint8_t *src, int32_t rows, int32_t cols, uint8_t *dst, ImagePainter::ImageGeometry geometry) {
+        if (src == dst) {
+            return ConvertGeometryInPlace<kChannels, kSwapRgbBgr>(dst, rows, cols, geometry);
+        }
+        ConvertGeometryWithBuffer<kChannels, kSwapRgbBgr>(src, rows, cols, dst, geometry);
+        return true;
+    }
+
+    bool IsGeometrySwapRowsAndCols(ImagePainter::ImageGeometry geometry) {
+        return geometry == ImagePainter::ImageGeometry::kRotate90 || geometry == ImagePainter::ImageGeometry::kRotate270 ||
+               geometry == ImagePainter::ImageGeometry::kTranspose;
+    }
+
+    // Quantize matrix value into index of color map lut. Nan is quantized to 0.
+    template <typename Scalar, ImagePainter::ValueNormalization kNormalization>
+    class ValueQuantizer {
+    public:
+        explicit ValueQuantizer(Scalar max_value) : max_value_(max_value) {
+            switch (kNormalization) {
+                default:
+                case ImagePainter::ValueNormalization::kAbsLinear:
+                    scale_ = static_cast<Scalar>(ColorMap::kLutSize) / max_value;
+                    break;
+                case ImagePainter::ValueNormalization::kAbsLog:
+                    scale_ = static_cast<Scalar>(ColorMap::kLutSize) / std::log1p(max_value);
+                    break;
+                case ImagePainter::ValueNormalization::kSymmetric:
+                    scale_ = static_cast<Scalar>(ColorMap::kLutSize / 2) / max_value;
+                    break;
+            }
+        }
+
+        int32_t operator()(Scalar value) const {
+            Scalar normalized = 0;
+            switch (kNormalization) {
+                default:
+                case ImagePainter::ValueNormalization::kAbsLinear:
+                    normalized = std::min(std::fabs(value), max_value_) * scale_;
+                    break;
+                case ImagePainter::ValueNormalization::kAbsLog:
+                    normalized = std::log1p(std::min(std::fabs(value), max_value_)) * scale_;
+                    break;
+                case ImagePainter::ValueNormalization::kSymmetric:
+                    normalized = (std::min(std::max(value, -max_value_), max_value_) + max_value_) * scale_;
+                    break;
+            }
+            // Comparison with nan is always false, so nan goes to 0.
+            return normalized > 0 ? std::min(static_cast<int32_t>(normalized), ColorMap::kLutSize - 1) : 0;
+        }
+
+    private:
+        Scalar max_value_ = 0;
+        Scalar scale_ = 0;
+    };
+
+    // Quantize each matrix value and look up its color in one pass. Each matrix row fills the first image row of its blocks,
+    // which is then copied to the other rows. Nan value is marked with a gray diagonal line in its block.
+    template <typename Scalar, int32_t kChannels, ImagePainter::ValueNormalization kNormalization>
+    void ConvertMatrixToImageWithQuantizer(const TMat<Scalar> &matrix, uint8_t *data, const uint8_t *lut, Scalar max_value, int32_t scale) {
+        const ValueQuantizer<Scalar, kNormalization> quantizer(max_value);
+        const int32_t stride = static_cast<int32_t>(matrix.cols()) * scale * kChannels;
+        std::vector<int32_t> nan_cols;
+
+        for (int32_t row = 0; row < matrix.rows(); ++row) {
+            uint8_t *first_row = data + row * scale * stride;
+            uint8_t *pixel = first_row;
+            nan_cols.clear();
+            for (int32_t col = 0; col < matrix.cols(); ++col) {
+                const Scalar value = matrix(row, col);
+                const uint8_t *color = lut + quantizer(value) * kChannels;
+                for (int32_t i = 0; i < scale; ++i) {
+                    std::copy_n(color, kChannels, pixel);
+                    pixel += kChannels;
+                }
+                if (std::isnan(value)) {
+                    nan_cols.emplace_back(col);
+                }
+            }
+
+            // Fill the other rows of blocks.
+            for (int32_t i = 1; i < scale; ++i) {
+                std::copy_n(first_row, stride, first_row + i * stride);
+            }
+
+            // Draw delete line if value is nan.
+            for (const int32_t col: nan_cols) {
+                for (int32_t i = 0; i < scale; ++i) {
+                    std::fill_n(first_row + i * stride + (col * scale + i) * kChannels, kChannels, 127);
+                }
+            }
+        }
+    }
+
+    // Call function with std::integral_constant of normalization, so each normalization has its own specialized kernel.
+    template <typename Function>
+    void DispatchValueNormalization(ImagePainter::ValueNormalization normalization, const Function &function) {
+        using ValueNormalization = ImagePainter::ValueNormalization;
+        switch (normalization) {
+            default:
+            case ValueNormalization::kAbsLinear:
+                function(std::integral_constant<ValueNormalization, ValueNormalization::kAbsLinear>());
+                break;
+            case ValueNormalization::kAbsLog:
+                function(std::integral_constant<ValueNormalization, ValueNormalization::kAbsLog>());
+                break;
+            case ValueNormalization::kSymmetric:
+                function(std::integral_constant<ValueNormalization, ValueNormalization::kSymmetric>());
+                break;
+        }
+    }
+
+    // Call function with std::integral_constant of aggregation, so each aggregation has its own specialized kernel.
+    template <typename Function>
+    void DispatchCellAggregation(ImagePainter::CellAggregation aggregation, const Function &function) {
+        using CellAggregation = ImagePainter::CellAggregation;
+        switch (aggregation) {
+            default:
+            case CellAggregation::kMaxAbs:
+                function(std::integral_constant<CellAggregation, CellAggregation::kMaxAbs>());
+                break;
+            case CellAggregation::kMean:
+                function(std::integral_constant<CellAggregation, CellAggregation::kMean>());
+                break;
+            case CellAggregation::kNonZeroCount:
+                function(std::integral_constant<CellAggregation, CellAggregation::kNonZeroCount>());
+                break;
+        }
+    }
+
+    // Fill the whole image with one color.
+    template <int32_t kChannels>
+    void FillImage(uint8_t *data, int32_t rows, int32_t cols, const uint8_t *color) {
+        if constexpr (kChannels == 1) {
+            std::fill_n(data, rows * cols, color[0]);
+        } else {
+            const int32_t stride = cols * kChannels;
+            for (int32_t col = 0; col < cols; ++col) {
+                std::copy_n(color, kChannels, data + col * kChannels);
+            }
+            for (int32_t row = 1; row < rows; ++row) {
+                std::copy_n(data, stride, data + row * stride);
+            }
+        }
+    }
+
+    // Paint stored nonzeros of sparse matrix onto the canvas, which has been cleared with the color of zero.
+    template <typename Scalar, int32_t kChannels, ImagePainter::ValueNormalization kNormalization>
+    void ConvertSparseMatrixToImageWithQuantizer(const Eigen::SparseMatrix<Scalar> &matrix, uint8_t *data, const uint8_t *lut, Scalar max_value,
+                                                 int32_t scale) {
+        const ValueQuantizer<Scalar, kNormalization> quantizer(max_value);
+        const int32_t stride = static_cast<int32_t>(matrix.cols()) * scale * kChannels;
+        FillImage<kChannels>(data, static_cast<int32_t>(matrix.rows()) * scale, static_cast<int32_t>(matrix.cols()) * scale,
+                             lut + quantizer(0) * kChannels);
+
+        for (int32_t col = 0; col < matrix.outerSize(); ++col) {
+            for (typename Eigen::SparseMatrix<Scalar>::InnerIterator it(matrix, col); it; ++it) {
+                const Scalar value = it.value();
+                const uint8_t *color = lut + quantizer(value) * kChannels;
+                uint8_t *block = data + static_cast<int32_t>(it.row()) * scale * stride + col * scale * kChannels;
+                for (int32_t i = 0; i < scale; ++i) {
+                    uint8_t *pixel = block + i * stride;
+                    for (int32_t j = 0; j < scale; ++j) {
+                        std::copy_n(color, kChannels, pixel);
+                        pixel += kChannels;
+                    }
+                }
+
+                // Draw delete line if value is nan.
+                if (std::isnan(value)) {
+                    for (int32_t i = 0; i < scale; ++i) {
+                        std::fill_n(block + i * stride + i * kChannels, kChannels, 127);
+                    }
+                }
+            }
+        }
+    }
+
+    // Accumulate a run of contiguous matrix cells into the value of their pixel. Max abs keeps the signed value with max magnitude,
+    // so symmetric normalization still works on it. Sum is reduced in independent lanes to break the dependency chain.
+    template <typename Scalar, ImagePainter::CellAggregation kAggregation>
+    inline void AccumulateCells(const Scalar *cells, int32_t size, Scalar &value) {
+        constexpr int32_t kLanes = 4;
+        int32_t i = 0;
+        if constexpr (kAggregation == ImagePainter::CellAggregation::kMaxAbs) {
+            Scalar max_value = value;
+            Scalar min_value = value;
+            for (; i < size; ++i) {
+                max_value = std::max(max_value, cells[i]);
+                min_value = std::min(min_value, cells[i]);
+            }
+            value = max_value >= -min_value ? max_value : min_value;
+        } else if constexpr (kAggregation == ImagePainter::CellAggregation::kMean) {
+            Scalar sum_lanes[kLanes] = {value, 0, 0, 0};
+            for (; i + kLanes <= size; i += kLanes) {
+                for (int32_t k = 0; k < kLanes; ++k) {
+                    sum_lanes[k] += cells[i + k];
+                }
+            }
+            for (; i < size; ++i) {
+                sum_lanes[0] += cells[i];
+            }
+            value = (sum_lanes[0] + sum_lanes[1]) + (sum_lanes[2] + sum_lanes[3]);
+        } else {
+            int32_t count = 0;
+            for (; i < size; ++i) {
+                count += static_cast<int32_t>(cells[i] != 0);
+            }
+            value += static_cast<Scalar>(count);
+        }
+    }
+
+    // Cell (row, col) of matrix is downsampled into pixel (row * image_rows / matrix_rows, col * image_cols / matrix_cols).
+    // Return the first matrix index of each image index, and the end of matrix index at last.
+    std::vector<int32_t> GetMatrixIndexBeginOfImageIndex(int32_t image_size, int32_t matrix_size) {
+        std::vector<int32_t> begins(image_size + 1);
+        for (int32_t i = 0; i <= image_size; ++i) {
+            begins[i] = static_cast<int32_t>((static_cast<int64_t>(i) * matrix_size + image_size - 1) / image_size);
+        }
+        return begins;
+    }
+
+    // Each pixel reduces its block of cells in registers and is written directly, so there is no intermediate buffer. Blocks are
+    // visited column by column, so each block reads a few contiguous runs of the column major matrix.
+    template <typename Scalar, int32_t kChannels, ImagePainter::CellAggregation kAggregation, ImagePainter::ValueNormalization kNormalization>
+    void DownsampleMatrixToImageWithQuantizer(const TMat<Scalar> &matrix, uint8_t *data, int32_t image_rows, int32_t image_cols, const uint8_t *lut,
+                                              Scalar max_value) {
+        constexpr int32_t kMinImageRowsPerThread = 16;
+        const ValueQuantizer<Scalar, kNormalization> quantizer(max_value);
+        const std::vector<int32_t> matrix_row_begins = GetMatrixIndexBeginOfImageIndex(image_rows, static_cast<int32_t>(matrix.rows()));
+        const std::vector<int32_t> matrix_col_begins = GetMatrixIndexBeginOfImageIndex(image_cols, static_cast<int32_t>(matrix.cols()));
+
+        ParallelFor(0, image_rows, kMinImageRowsPerThread, [&](int32_t image_row_begin, int32_t image_row_end) {
+            for (int32_t image_col = 0; image_col < image_cols; ++image_col) {
+                const int32_t matrix_col_begin = matrix_col_begins[image_col];
+                const int32_t matrix_col_end = matrix_col_begins[image_col + 1];
+                uint8_t *pixel = data + (image_row_begin * image_cols + image_col) * kChannels;
+                for (int32_t image_row = image_row_begin; image_row < image_row_end; ++image_row) {
+                    const int32_t matrix_row_begin = matrix_row_begins[image_row];
+                    const int32_t num_of_rows = matrix_row_begins[image_row + 1] - matrix_row_begin;
+                    Scalar value = 0;
+                    for (int32_t col = matrix_col_begin; col < matrix_col_end; ++col) {
+                        AccumulateCells<Scalar, kAggregation>(matrix.col(col).data() + matrix_row_begin, num_of_rows, value);
+                    }
+                    if constexpr (kAggregation == ImagePainter::CellAggregation::kMean) {
+                        value /= static_cast<Scalar>(num_of_rows * (matrix_col_end - matrix_col_begin));
+                    }
+                    std::copy_n(lut + quantizer(value) * kChannels, kChannels, pixel);
+                    pixel += image_cols * kChannels;
+                }
+            }
+        });
+    }
+
+    // Only stored nonzeros of sparse matrix are accumulated, and the implicit zeros are counted when computing mean. Accumulators of
+    // pixels are kept in column major order, so each thread owns a contiguous part of them.
+    template <typename Scalar, int32_t kChannels, ImagePainter::CellAggregation kAggregation, ImagePainter::ValueNormalization kNormalization>
+    void DownsampleSparseMatrixToImageWithQuantizer(const Eigen::SparseMatrix<Scalar> &matrix, uint8_t *data, int32_t image_rows, int32_t image_cols,
+                                                    const uint8_t *lut, Scalar max_value) {
+        constexpr int32_t kMinImageColsPerThread = 16;
+        const ValueQuantizer<Scalar, kNormalization> quantizer(max_value);
+        const int64_t matrix_rows = matrix.rows();
+        const std::vector<int32_t> matrix_row_begins = GetMatrixIndexBeginOfImageIndex(image_rows, static_cast<int32_t>(matrix.rows()));
+        const std::vector<int32_t> matrix_col_begins = GetMatrixIndexBeginOfImageIndex(image_cols, static_cast<int32_t>(matrix.cols()));
+        std::vector<Scalar> accumulators(image_rows * image_cols, 0);
+
+        ParallelFor(0, image_cols, kMinImageColsPerThread, [&](int32_t image_col_begin, int32_t image_col_end) {
+            for (int32_t image_col = image_col_begin; image_col < image_col_end; ++image_col) {
+                Scalar *accumulator_col = accumulators.data() + image_col * image_rows;
+                const int32_t matrix_col_begin = matrix_col_begins[image_col];
+                const int32_t matrix_col_end = matrix_col_begins[image_col + 1];
+                for (int32_t col = matrix_col_begin; col < matrix_col_end; ++col) {
+                    for (typename Eigen::SparseMatrix<Scalar>::InnerIterator it(matrix, col); it; ++it) {
+                        const Scalar value = it.value();
+                        const int32_t image_row = static_cast<int32_t>(it.row() * image_rows / matrix_rows);
+                        AccumulateCells<Scalar, kAggregation>(&value, 1, accumulator_col[image_row]);
+                    }
+                }
+
+                // Convert accumulated values into pixels.
+                uint8_t *pixel = data + image_col * kChannels;
+                for (int32_t image_row = 0; image_row < image_rows; ++image_row) {
+                    Scalar value = accumulator_col[image_row];
+                    if constexpr (kAggregation == ImagePainter::CellAggregation::kMean) {
+                        value /= static_cast<Scalar>((matrix_row_begins[image_row + 1] - matrix_row_begins[image_row]) * (matrix_col_end - matrix_col_begin));
+                    }
+                    std::copy_n(lut + quantizer(value) * kChannels, kChannels, pixel);
+                    pixel += image_cols * kChannels;
+                }
+            }
+        });
+    }
+
+    // Flatten rgb lut of color map into bytes.
+    std::array<uint8_t, ColorMap::kLutSize * 3> FlattenRgbLut(const ColorMap &color_map) {
+        std::array<uint8_t, ColorMap::kLutSize * 3> lut = {};
+        for (int32_t i = 0; i < ColorMap::kLutSize; ++i) {
+            const RgbPixel &color = color_map.lut()[i];
+            lut[i * 3] = color.r;
+            lut[i * 3 + 1] = color.g;
+            lut[i * 3 + 2] = color.b;
+        }
+        return lut;
+    }
+}  // namespace
+
+void ImagePainter::ConvertUint8ToRgb(const uint8_t *gray, uint8_t *rgb, int32_t gray_size) { GetSimdKernels().convert_gray_to_rgb(gray, rgb, gray_size); }
+
+void ImagePainter::ConvertRgbToUint8(const uint8_t *rgb, uint8_t *gray, int32_t gray_size) { GetSimdKernels().convert_rgb_to_gray(rgb, gray, gray_size); }
 
 void ImagePainter::ConvertUint8ToRgbAndUpsideDown(const uint8_t *gray, uint8_t *rgb, int32_t gray_rows, int32_t gray_cols) {
+    const SimdKernels &kernels = GetSimdKernels();
     const int32_t gray_cols_3 = 3 * gray_cols;
-
     for (int32_t row = 0; row < gray_rows; ++row) {
-        for (int32_t col = 0; col < gray_cols; ++col) {
-            const int32_t offset = (gray_rows - row - 1) * gray_cols_3 + 3 * col;
-            std::fill_n(rgb + offset, 3, gray[col + row * gray_cols]);
-        }
+        kernels.convert_gray_to_rgb(gray + row * gray_cols, rgb + (gray_rows - row - 1) * gray_cols_3, gray_cols);
     }
 }
 
 void ImagePainter::ConvertRgbToBgr(const uint8_t *rgb, uint8_t *converted_rgb, int32_t rgb_rows, int32_t rgb_cols) {
-    const int32_t rgb_stride = rgb_cols * 3;
-    for (int32_t row = 0; row < rgb_rows; ++row) {
-        for (int32_t col = 0; col < rgb_cols; ++col) {
-            const int32_t offset_col = 3 * col;
-            const int32_t offset = row * rgb_stride + offset_col;
-            converted_rgb[offset] = rgb[offset + 2];
-            converted_rgb[offset + 1] = rgb[offset + 1];
-            converted_rgb[offset + 2] = rgb[offset];
-        }
-    }
+    GetSimdKernels().convert_rgb_to_bgr(rgb, converted_rgb, rgb_rows * rgb_cols);
 }
 
 void ImagePainter::ConvertRgbToBgrAndUpsideDown(const uint8_t *rgb, uint8_t *converted_rgb, int32_t rgb_rows, int32_t rgb_cols) {
+    const SimdKernels &kernels = GetSimdKernels();
     const int32_t rgb_stride = rgb_cols * 3;
     for (int32_t row = 0; row < rgb_rows; ++row) {
-        for (int32_t col = 0; col < rgb_cols; ++col) {
-            const int32_t offset_col = 3 * col;
-            const int32_t offset = row * rgb_stride + offset_col;
-            const int32_t offset_converted = (rgb_rows - row - 1) * rgb_stride + offset_col;
-            converted_rgb[offset_converted] = rgb[offset + 2];
-            converted_rgb[offset_converted + 1] = rgb[offset + 1];
-            converted_rgb[offset_converted + 2] = rgb[offset];
-        }
+        kernels.convert_rgb_to_bgr(rgb + row * rgb_stride, converted_rgb + (rgb_rows - row - 1) * rgb_stride, rgb_cols);
     }
 }
 
+ImagePainter::YuvPixel ImagePainter::ConvertRgbToYuv(const RgbPixel &color, YuvColorSpace color_space) {
+    // Rows of y, u, v weights of r, g, b, and offsets of y, u, v.
+    struct Matrix {
+        float weights[3][3];
+        float offsets[3];
+    };
+    static const Matrix kBt601 = {{{0.256788f, 0.504129f, 0.097906f}, {-0.148223f, -0.290993f, 0.439216f}, {0.439216f, -0.367788f, -0.071427f}},
+                                  {16.0f, 128.0f, 128.0f}};
+    static const Matrix kBt709 = {{{0.182586f, 0.614231f, 0.062007f}, {-0.100644f, -0.338572f, 0.439216f}, {0.439216f, -0.398942f, -0.040274f}},
+                                  {16.0f, 128.0f, 128.0f}};
+    static const Matrix kBt601FullRange = {{{0.299f, 0.587f, 0.114f}, {-0.168736f, -0.331264f, 0.5f}, {0.5f, -0.418688f, -0.081312f}},
+                                           {0.0f, 128.0f, 128.0f}};
+    const Matrix &matrix = color_space == YuvColorSpace::kBt709 ? kBt709 : (color_space == YuvColorSpace::kBt601FullRange ? kBt601FullRange : kBt601);
+
+    uint8_t yuv[3] = {};
+    for (int32_t i = 0; i < 3; ++i) {
+        const float value = matrix.weights[i][0] * color.r + matrix.weights[i][1] * color.g + matrix.weights[i][2] * color.b + matrix.offsets[i];
+        yuv[i] = static_cast<uint8_t>(std::min(std::max(std::round(value), 0.0f), 255.0f));
+    }
+    return YuvPixel{yuv[0], yuv[1], yuv[2]};
+}
+
+bool ImagePainter::ConvertImageGeometry(const GrayImage &image, GrayImage &converted_image, ImageGeometry geometry) {
+    if (image.data() == nullptr || converted_image.data() == nullptr) {
+        ReportError("[ImagePainter] GrayImage buffer is empty.");
+        return false;
+    }
+    const bool swap_rows_and_cols = IsGeometrySwapRowsAndCols(geometry);
+    if (converted_image.rows() != (swap_rows_and_cols ? image.cols() : image.rows()) ||
+        converted_image.cols() != (swap_rows_and_cols ? image.rows() : image.cols())) {
+        ReportError("[ImagePainter] Converted GrayImage buffer size does not match geometry.");
+        return false;
+    }
+
+    if (!ConvertGeometry<1, false>(image.data(), image.rows(), image.cols(), converted_image.data(), geometry)) {
+        ReportError("[ImagePainter] GrayImage must be square to be rotated or transposed in place.");
+        return false;
+    }
+    return true;
+}
+
+bool ImagePainter::ConvertImageGeometry(const RgbImage &image, RgbImage &converted_image, ImageGeometry geometry, bool swap_rgb_bgr) {
+    if (image.data() == nullptr || converted_image.data() == nullptr) {
+        ReportError("[ImagePainter] RgbImage buffer is empty.");
+        return false;
+    }
+    const bool swap_rows_and_cols = IsGeometrySwapRowsAndCols(geometry);
+    if (converted_image.rows() != (swap_rows_and_cols ? image.cols() : image.rows()) ||
+        converted_image.cols() != (swap_rows_and_cols ? image.rows() : image.cols())) {
+        ReportError("[ImagePainter] Converted RgbImage buffer size does not match geometry.");
+        return false;
+    }
+
+    const bool result = swap_rgb_bgr ? ConvertGeometry<3, true>(image.data(), image.rows(), image.cols(), converted_image.data(), geometry)
+                                     : ConvertGeometry<3, false>(image.data(), image.rows(), image.cols(), converted_image.data(), geometry);
+    if (!result) {
+        ReportError("[ImagePainter] RgbImage must be square to be rotated or transposed in place.");
+        return false;
+    }
+    return true;
+}
+
 template uint8_t ImagePainter::ConvertValueToUint8<float>(float value, float max_value);
 template uint8_t ImagePainter::ConvertValueToUint8<double>(double value, double max_value);
 template <typename Scalar>
@@ -76,6 +590,23 @@ template bool ImagePainter::ConvertMatrixToImage<float>(const TMat<float> &matri
 template bool ImagePainter::ConvertMatrixToImage<double>(const TMat<double> &matrix, GrayImage &image, double max_value, int32_t scale);
 template <typename Scalar>
 bool ImagePainter::ConvertMatrixToImage(const TMat<Scalar> &matrix, GrayImage &image, Scalar max_value, int32_t scale) {
+    return ConvertMatrixToImage(matrix, image, ColorMap::Get(ColorMap::Type::kInverseGray), max_value, scale, ValueNormalization::kAbsLinear);
+}
+
+template bool ImagePainter::ConvertMatrixToImage<float>(const TMat<float> &matrix, RgbImage &image, float max_value, int32_t scale);
+template bool ImagePainter::ConvertMatrixToImage<double>(const TMat<double> &matrix, RgbImage &image, double max_value, int32_t scale);
+template <typename Scalar>
+bool ImagePainter::ConvertMatrixToImage(const TMat<Scalar> &matrix, RgbImage &image, Scalar max_value, int32_t scale) {
+    return ConvertMatrixToImage(matrix, image, ColorMap::Get(ColorMap::Type::kInverseGray), max_value, scale, ValueNormalization::kAbsLinear);
+}
+
+template bool ImagePainter::ConvertMatrixToImage<float>(const TMat<float> &matrix, GrayImage &image, const ColorMap &color_map, float max_value, int32_t scale,
+                                                        ValueNormalization normalization);
+template bool ImagePainter::ConvertMatrixToImage<double>(const TMat<double> &matrix, GrayImage &image, const ColorMap &color_map, double max_value,
+                                                         int32_t scale, ValueNormalization normalization);
+template <typename Scalar>
+bool ImagePainter::ConvertMatrixToImage(const TMat<Scalar> &matrix, GrayImage &image, const ColorMap &color_map, Scalar max_value, int32_t scale,
+                                        ValueNormalization normalization) {
     if (image.data() == nullptr) {
         ReportError("[ImagePainter] GrayImage buffer is empty.");
         return false;
@@ -89,35 +620,125 @@ bool ImagePainter::ConvertMatrixToImage(const TMat<Scalar> &matrix, GrayImage &i
         return false;
     }
 
-    // Convert matrix to image.
-    for (int32_t row = 0; row < matrix.rows(); ++row) {
-        for (int32_t col = 0; col < matrix.cols(); ++col) {
-            // Compute image value in the first line.
-            const uint8_t image_value = ConvertValueToUint8(matrix(row, col), max_value);
-            const int32_t image_row = row * scale;
-            const int32_t image_col = col * scale;
+    DispatchValueNormalization(normalization, [&](auto normalization_tag) {
+        ConvertMatrixToImageWithQuantizer<Scalar, 1, decltype(normalization_tag)::value>(matrix, image.data(), color_map.gray_lut().data(), max_value,
+                                                                                           scale);
+    });
+    return true;
+}
 
-            // Fill the block in image.
-            for (int32_t i = 0; i < scale; ++i) {
-                std::fill_n(image.data() + (image_row + i) * image.cols() + image_col, scale, image_value);
-            }
+template bool ImagePainter::ConvertMatrixToImage<float>(const TMat<float> &matrix, RgbImage &image, const ColorMap &color_map, float max_value, int32_t scale,
+                                                        ValueNormalization normalization);
+template bool ImagePainter::ConvertMatrixToImage<double>(const TMat<double> &matrix, RgbImage &image, const ColorMap &color_map, double max_value,
+                                                         int32_t scale, ValueNormalization normalization);
+template <typename Scalar>
+bool ImagePainter::ConvertMatrixToImage(const TMat<Scalar> &matrix, RgbImage &image, const ColorMap &color_map, Scalar max_value, int32_t scale,
+                                        ValueNormalization normalization) {
+    if (image.data() == nullptr) {
+        ReportError("[ImagePainter] RgbImage buffer is empty.");
+        return false;
+    }
+    if (scale < 0) {
+        ReportError("[ImagePainter] Scale must larger than 0.");
+        return false;
+    }
+    if (image.rows() != matrix.rows() * scale || image.cols() != matrix.cols() * scale) {
+        ReportError("[ImagePainter] RgbImage buffer size does not match matrix size.");
+        return false;
+    }
 
-            // Draw delete line if value is nan.
-            if (std::isnan(matrix(row, col))) {
-                for (int32_t i = 0; i < scale; ++i) {
-                    *(image.data() + (image_row + i) * image.cols() + image_col + i) = 127;
-                }
-            }
-        }
+    const std::array<uint8_t, ColorMap::kLutSize * 3> lut = FlattenRgbLut(color_map);
+    DispatchValueNormalization(normalization, [&](auto normalization_tag) {
+        ConvertMatrixToImageWithQuantizer<Scalar, 3, decltype(normalization_tag)::value>(matrix, image.data(), lut.data(), max_value, scale);
+    });
+    return true;
+}
+
+template bool ImagePainter::ConvertMatrixToImageWithDownsample<float>(const TMat<float> &matrix, GrayImage &image, const ColorMap &color_map,
+                                                                      float max_value, CellAggregation aggregation, ValueNormalization normalization);
+template bool ImagePainter::ConvertMatrixToImageWithDownsample<double>(const TMat<double> &matrix, GrayImage &image, const ColorMap &color_map,
+                                                                       double max_value, CellAggregation aggregation, ValueNormalization normalization);
+template <typename Scalar>
+bool ImagePainter::ConvertMatrixToImageWithDownsample(const TMat<Scalar> &matrix, GrayImage &image, const ColorMap &color_map, Scalar max_value,
+                                                      CellAggregation aggregation, ValueNormalization normalization) {
+    if (image.data() == nullptr) {
+        ReportError("[ImagePainter] GrayImage buffer is empty.");
+        return false;
+    }
+    if (image.rows() <= 0 || image.cols() <= 0 || image.rows() > matrix.rows() || image.cols() > matrix.cols()) {
+        ReportError("[ImagePainter] GrayImage buffer size should not be larger than matrix size.");
+        return false;
     }
 
+    DispatchCellAggregation(aggregation, [&](auto aggregation_tag) {
+        DispatchValueNormalization(normalization, [&](auto normalization_tag) {
+            DownsampleMatrixToImageWithQuantizer<Scalar, 1, decltype(aggregation_tag)::value, decltype(normalization_tag)::value>(
+                matrix, image.data(), image.rows(), image.cols(), color_map.gray_lut().data(), max_value);
+        });
+    });
     return true;
 }
 
-template bool ImagePainter::ConvertMatrixToImage<float>(const TMat<float> &matrix, RgbImage &image, float max_value, int32_t scale);
-template bool ImagePainter::ConvertMatrixToImage<double>(const TMat<double> &matrix, RgbImage &image, double max_value, int32_t scale);
+template bool ImagePainter::ConvertMatrixToImageWithDownsample<float>(const TMat<float> &matrix, RgbImage &image, const ColorMap &color_map,
+                                                                      float max_value, CellAggregation aggregation, ValueNormalization normalization);
+template bool ImagePainter::ConvertMatrixToImageWithDownsample<double>(const TMat<double> &matrix, RgbImage &image, const ColorMap &color_map,
+                                                                       double max_value, CellAggregation aggregation, ValueNormalization normalization);
 template <typename Scalar>
-bool ImagePainter::ConvertMatrixToImage(const TMat<Scalar> &matrix, RgbImage &image, Scalar max_value, int32_t scale) {
+bool ImagePainter::ConvertMatrixToImageWithDownsample(const TMat<Scalar> &matrix, RgbImage &image, const ColorMap &color_map, Scalar max_value,
+                                                      CellAggregation aggregation, ValueNormalization normalization) {
+    if (image.data() == nullptr) {
+        ReportError("[ImagePainter] RgbImage buffer is empty.");
+        return false;
+    }
+    if (image.rows() <= 0 || image.cols() <= 0 || image.rows() > matrix.rows() || image.cols() > matrix.cols()) {
+        ReportError("[ImagePainter] RgbImage buffer size should not be larger than matrix size.");
+        return false;
+    }
+
+    const std::array<uint8_t, ColorMap::kLutSize * 3> lut = FlattenRgbLut(color_map);
+    DispatchCellAggregation(aggregation, [&](auto aggregation_tag) {
+        DispatchValueNormalization(normalization, [&](auto normalization_tag) {
+            DownsampleMatrixToImageWithQuantizer<Scalar, 3, decltype(aggregation_tag)::value, decltype(normalization_tag)::value>(
+                matrix, image.data(), image.rows(), image.cols(), lut.data(), max_value);
+        });
+    });
+    return true;
+}
+
+template bool ImagePainter::ConvertSparseMatrixToImage<float>(const Eigen::SparseMatrix<float> &matrix, GrayImage &image, const ColorMap &color_map,
+                                                              float max_value, int32_t scale, ValueNormalization normalization);
+template bool ImagePainter::ConvertSparseMatrixToImage<double>(const Eigen::SparseMatrix<double> &matrix, GrayImage &image, const ColorMap &color_map,
+                                                               double max_value, int32_t scale, ValueNormalization normalization);
+template <typename Scalar>
+bool ImagePainter::ConvertSparseMatrixToImage(const Eigen::SparseMatrix<Scalar> &matrix, GrayImage &image, const ColorMap &color_map, Scalar max_value,
+                                              int32_t scale, ValueNormalization normalization) {
+    if (image.data() == nullptr) {
+        ReportError("[ImagePainter] GrayImage buffer is empty.");
+        return false;
+    }
+    if (scale < 0) {
+        ReportError("[ImagePainter] Scale must larger than 0.");
+        return false;
+    }
+    if (image.rows() != matrix.rows() * scale || image.cols() != matrix.cols() * scale) {
+        ReportError("[ImagePainter] GrayImage buffer size does not match matrix size.");
+        return false;
+    }
+
+    DispatchValueNormalization(normalization, [&](auto normalization_tag) {
+        ConvertSparseMatrixToImageWithQuantizer<Scalar, 1, decltype(normalization_tag)::value>(matrix, image.data(), color_map.gray_lut().data(),
+                                                                                                 max_value, scale);
+    });
+    return true;
+}
+
+template bool ImagePainter::ConvertSparseMatrixToImage<float>(const Eigen::SparseMatrix<float> &matrix, RgbImage &image, const ColorMap &color_map,
+                                                              float max_value, int32_t scale, ValueNormalization normalization);
+template bool ImagePainter::ConvertSparseMatrixToImage<double>(const Eigen::SparseMatrix<double> &matrix, RgbImage &image, const ColorMap &color_map,
+                                                               double max_value, int32_t scale, ValueNormalization normalization);
+template <typename Scalar>
+bool ImagePainter::ConvertSparseMatrixToImage(const Eigen::SparseMatrix<Scalar> &matrix, RgbImage &image, const ColorMap &color_map, Scalar max_value,
+                                              int32_t scale, ValueNormalization normalization) {
     if (image.data() == nullptr) {
         ReportError("[ImagePainter] RgbImage buffer is empty.");
         return false;
@@ -131,21 +752,65 @@ bool ImagePainter::ConvertMatrixToImage(const TMat<Scalar> &matrix, RgbImage &im
         return false;
     }
 
-    // Convert matrix to image.
-    for (int32_t row = 0; row < matrix.rows(); ++row) {
-        for (int32_t col = 0; col < matrix.cols(); ++col) {
-            // Compute image value in the first line.
-            const uint8_t image_value = ConvertValueToUint8(matrix(row, col), max_value);
-            const int32_t image_row = row * scale;
-            const int32_t image_col = col * scale * 3;
+    const std::array<uint8_t, ColorMap::kLutSize * 3> lut = FlattenRgbLut(color_map);
+    DispatchValueNormalization(normalization, [&](auto normalization_tag) {
+        ConvertSparseMatrixToImageWithQuantizer<Scalar, 3, decltype(normalization_tag)::value>(matrix, image.data(), lut.data(), max_value, scale);
+    });
+    return true;
+}
 
-            // Fill the block in image.
-            for (int32_t i = 0; i < scale; ++i) {
-                std::fill_n(image.data() + (image_row + i) * image.cols() + image_col, scale * 3, image_value);
-            }
-        }
+template bool ImagePainter::ConvertSparseMatrixToImageWithDownsample<float>(const Eigen::SparseMatrix<float> &matrix, GrayImage &image,
+                                                                            const ColorMap &color_map, float max_value, CellAggregation aggregation,
+                                                                            ValueNormalization normalization);
+template bool ImagePainter::ConvertSparseMatrixToImageWithDownsample<double>(const Eigen::SparseMatrix<double> &matrix, GrayImage &image,
+                                                                             const ColorMap &color_map, double max_value, CellAggregation aggregation,
+                                                                             ValueNormalization normalization);
+template <typename Scalar>
+bool ImagePainter::ConvertSparseMatrixToImageWithDownsample(const Eigen::SparseMatrix<Scalar> &matrix, GrayImage &image, const ColorMap &color_map,
+                                                            Scalar max_value, CellAggregation aggregation, ValueNormalization normalization) {
+    if (image.data() == nullptr) {
+        ReportError("[ImagePainter] GrayImage buffer is empty.");
+        return false;
+    }
+    if (image.rows() <= 0 || image.cols() <= 0 || image.rows() > matrix.rows() || image.cols() > matrix.cols()) {
+        ReportError("[ImagePainter] GrayImage buffer size should not be larger than matrix size.");
+        return false;
+    }
+
+    DispatchCellAggregation(aggregation, [&](auto aggregation_tag) {
+        DispatchValueNormalization(normalization, [&](auto normalization_tag) {
+            DownsampleSparseMatrixToImageWithQuantizer<Scalar, 1, decltype(aggregation_tag)::value, decltype(normalization_tag)::value>(
+                matrix, image.data(), image.rows(), image.cols(), color_map.gray_lut().data(), max_value);
+        });
+    });
+    return true;
+}
+
+template bool ImagePainter::ConvertSparseMatrixToImageWithDownsample<float>(const Eigen::SparseMatrix<float> &matrix, RgbImage &image,
+                                                                            const ColorMap &color_map, float max_value, CellAggregation aggregation,
+                                                                            ValueNormalization normalization);
+template bool ImagePainter::ConvertSparseMatrixToImageWithDownsample<double>(const Eigen::SparseMatrix<double> &matrix, RgbImage &image,
+                                                                             const ColorMap &color_map, double max_value, CellAggregation aggregation,
+                                                                             ValueNormalization normalization);
+template <typename Scalar>
+bool ImagePainter::ConvertSparseMatrixToImageWithDownsample(const Eigen::SparseMatrix<Scalar> &matrix, RgbImage &image, const ColorMap &color_map,
+                                                            Scalar max_value, CellAggregation aggregation, ValueNormalization normalization) {
+    if (image.data() == nullptr) {
+        ReportError("[ImagePainter] RgbImage buffer is empty.");
+        return false;
+    }
+    if (image.rows() <= 0 || image.cols() <= 0 || image.rows() > matrix.rows() || image.cols() > matrix.cols()) {
+        ReportError("[ImagePainter] RgbImage buffer size should not be larger than matrix size.");
+        return false;
     }
 
+    const std::array<uint8_t, ColorMap::kLutSize * 3> lut = FlattenRgbLut(color_map);
+    DispatchCellAggregation(aggregation, [&](auto aggregation_tag) {
+        DispatchValueNormalization(normalization, [&](auto normalization_tag) {
+            DownsampleSparseMatrixToImageWithQuantizer<Scalar, 3, decltype(aggregation_tag)::value, decltype(normalization_tag)::value>(
+                matrix, image.data(), image.rows(), image.cols(), lut.data(), max_value);
+        });
+    });
     return true;
 }
 
@@ -0,0 +1,352 @@
+#include "image_painter_display_list.h"
+#include "image_painter_glyph.h"
+#include "image_painter_pixel.h"
+#include "image_painter_profile.h"
+#include "image_painter_tile.h"
+
+#include "slam_log_reporter.h"
+
+namespace image_painter {
+
+namespace {
+    constexpr int32_t kRowsOfTile = 32;
+    constexpr int64_t kMinRowOfUnknownBound = std::numeric_limits<int32_t>::min();
+    constexpr int64_t kMaxRowOfUnknownBound = std::numeric_limits<int32_t>::max();
+
+    int32_t ClampToInt32(int64_t value) { return static_cast<int32_t>(std::min(std::max(value, kMinRowOfUnknownBound), kMaxRowOfUnknownBound)); }
+
+    template <typename PixelType>
+    bool CheckColorsOfBatch(const std::vector<PixelType> &colors, int32_t size) {
+        if (colors.size() != 1 && static_cast<int32_t>(colors.size()) != size) {
+            ReportError("[DisplayList] Size of colors " << colors.size() << " should be 1 or size of batch " << size << ".");
+            return false;
+        }
+        return true;
+    }
+}  // namespace
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::AddCommand(CommandType type, const std::array<int32_t, 5> &args, int32_t row_min, int32_t row_max,
+                                                   const PixelType &color, int32_t data_index) {
+    Command command;
+    command.type = type;
+    command.args = args;
+    command.row_min = row_min;
+    command.row_max = row_max;
+    command.data_index = data_index;
+    command.color = color;
+    commands_.emplace_back(command);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawPoint(int32_t x, int32_t y, const PixelType &color) {
+    AddCommand(CommandType::kPoint, {x, y}, y, y, color);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawSolidRectangle(int32_t x, int32_t y, int32_t width, int32_t height, const PixelType &color) {
+    AddCommand(CommandType::kSolidRectangle, {x, y, width, height}, y, ClampToInt32(static_cast<int64_t>(y) + height - 1), color);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawSolidRectangles(const std::vector<ImagePainter::Rectangle> &rectangles, const PixelType &color) {
+    for (const auto &rectangle: rectangles) {
+        DrawSolidRectangle(rectangle.x, rectangle.y, rectangle.width, rectangle.height, color);
+    }
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawHollowRectangle(int32_t x, int32_t y, int32_t width, int32_t height, const PixelType &color) {
+    AddCommand(CommandType::kHollowRectangle, {x, y, width, height}, y, ClampToInt32(static_cast<int64_t>(y) + height), color);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawBressenhanLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, const PixelType &color) {
+    AddCommand(CommandType::kBressenhanLine, {x1, y1, x2, y2}, std::min(y1, y2), std::max(y1, y2), color);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawNaiveLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, const PixelType &color) {
+    // Float interpolation may fall out of endpoints by one pixel.
+    AddCommand(CommandType::kNaiveLine, {x1, y1, x2, y2}, ClampToInt32(static_cast<int64_t>(std::min(y1, y2)) - 1),
+               ClampToInt32(static_cast<int64_t>(std::max(y1, y2)) + 1), color);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawDashedLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t step, const PixelType &color) {
+    AddCommand(CommandType::kDashedLine, {x1, y1, x2, y2, step}, ClampToInt32(static_cast<int64_t>(std::min(y1, y2)) - 1),
+               ClampToInt32(static_cast<int64_t>(std::max(y1, y2)) + 1), color);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawSolidCircle(int32_t center_x, int32_t center_y, int32_t radius, const PixelType &color) {
+    AddCommand(CommandType::kSolidCircle, {center_x, center_y, radius}, ClampToInt32(static_cast<int64_t>(center_y) - radius),
+               ClampToInt32(static_cast<int64_t>(center_y) + radius), color);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawHollowCircle(int32_t center_x, int32_t center_y, int32_t radius, const PixelType &color) {
+    AddCommand(CommandType::kHollowCircle, {center_x, center_y, radius}, ClampToInt32(static_cast<int64_t>(center_y) - radius),
+               ClampToInt32(static_cast<int64_t>(center_y) + radius), color);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawMidBresenhamEllipse(int32_t center_x, int32_t center_y, int32_t radius_x, int32_t radius_y,
+                                                                const PixelType &color) {
+    const int64_t radius = std::abs(static_cast<int64_t>(radius_y)) + 1;
+    AddCommand(CommandType::kMidBresenhamEllipse, {center_x, center_y, radius_x, radius_y}, ClampToInt32(center_y - radius),
+               ClampToInt32(center_y + radius), color);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawSolidEllipse(int32_t center_x, int32_t center_y, int32_t radius_x, int32_t radius_y, const PixelType &color) {
+    AddCommand(CommandType::kSolidEllipse, {center_x, center_y, radius_x, radius_y}, ClampToInt32(static_cast<int64_t>(center_y) - radius_y),
+               ClampToInt32(static_cast<int64_t>(center_y) + radius_y), color);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawTrustRegionOfGaussian(const Vec2 &center, const Mat2 &covariance, const PixelType &color,
+                                                                  const float sigma_scale) {
+    // Eigen solver only reads the lower triangle. Frobenius norm of the symmetric matrix bounds its eigen values, so it bounds the radius
+    // of ellipse. Non-finite ellipse may be drawn anywhere.
+    const float norm = std::sqrt(covariance(0, 0) * covariance(0, 0) + 2.0f * covariance(1, 0) * covariance(1, 0) + covariance(1, 1) * covariance(1, 1));
+    const float radius = std::sqrt(norm) * 0.5f * std::fabs(sigma_scale) + 2.0f;
+    const float row_min = center.y() - radius;
+    const float row_max = center.y() + radius;
+    const bool is_bounded = std::isfinite(row_min) && std::isfinite(row_max) && std::isfinite(center.x()) && std::fabs(row_min) < 1e9f &&
+                            std::fabs(row_max) < 1e9f;
+
+    gaussians_.emplace_back(Gaussian{center, covariance, sigma_scale});
+    AddCommand(CommandType::kTrustRegionOfGaussian, {}, is_bounded ? static_cast<int32_t>(std::floor(row_min)) : ClampToInt32(kMinRowOfUnknownBound),
+               is_bounded ? static_cast<int32_t>(std::ceil(row_max)) : ClampToInt32(kMaxRowOfUnknownBound), color,
+               static_cast<int32_t>(gaussians_.size()) - 1);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawCharacter(char character, int32_t x, int32_t y, const PixelType &color, int32_t font_size,
+                                                      bool is_smooth) {
+    font_size = GlyphAtlas::GetValidFontSize(font_size);
+    AddCommand(CommandType::kCharacter, {static_cast<int32_t>(character), x, y, font_size, is_smooth}, y,
+               ClampToInt32(static_cast<int64_t>(y) + font_size), color);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawString(const std::string &str, int32_t x, int32_t y, const PixelType &color, int32_t font_size,
+                                                   bool is_smooth) {
+    font_size = GlyphAtlas::GetValidFontSize(font_size);
+    strings_.emplace_back(str);
+    AddCommand(CommandType::kString, {x, y, font_size, is_smooth}, y, ClampToInt32(static_cast<int64_t>(y) + font_size), color,
+               static_cast<int32_t>(strings_.size()) - 1);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawPoints(const ImagePainter::PointsBatch &points, const std::vector<PixelType> &colors) {
+    const int32_t size = static_cast<int32_t>(points.rows());
+    RETURN_IF(size == 0 || !CheckColorsOfBatch(colors, size));
+    const int32_t color_step = colors.size() == 1 ? 0 : 1;
+    for (int32_t i = 0; i < size; ++i) {
+        DrawPoint(points(i, 0), points(i, 1), colors[i * color_step]);
+    }
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawLines(const ImagePainter::LinesBatch &lines, const std::vector<PixelType> &colors) {
+    const int32_t size = static_cast<int32_t>(lines.rows());
+    RETURN_IF(size == 0 || !CheckColorsOfBatch(colors, size));
+    const int32_t color_step = colors.size() == 1 ? 0 : 1;
+    for (int32_t i = 0; i < size; ++i) {
+        DrawBressenhanLine(lines(i, 0), lines(i, 1), lines(i, 2), lines(i, 3), colors[i * color_step]);
+    }
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawCircles(const ImagePainter::CirclesBatch &circles, const std::vector<PixelType> &colors, bool is_solid) {
+    const int32_t size = static_cast<int32_t>(circles.rows());
+    RETURN_IF(size == 0 || !CheckColorsOfBatch(colors, size));
+    const int32_t color_step = colors.size() == 1 ? 0 : 1;
+    for (int32_t i = 0; i < size; ++i) {
+        if (is_solid) {
+            DrawSolidCircle(circles(i, 0), circles(i, 1), circles(i, 2), colors[i * color_step]);
+        } else {
+            DrawHollowCircle(circles(i, 0), circles(i, 1), circles(i, 2), colors[i * color_step]);
+        }
+    }
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawPolyline(const ImagePainter::PointsBatch &points, const PixelType &color, bool is_closed) {
+    const int32_t size = static_cast<int32_t>(points.rows());
+    RETURN_IF(size < 2);
+    const int32_t num_of_segments = is_closed && size > 2 ? size : size - 1;
+    for (int32_t i = 0; i < num_of_segments; ++i) {
+        const int32_t j = i + 1 == size ? 0 : i + 1;
+        DrawBressenhanLine(points(i, 0), points(i, 1), points(j, 0), points(j, 1), color);
+    }
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::DrawStrings(const std::vector<ImagePainter::Label> &labels, const std::vector<PixelType> &colors, int32_t font_size,
+                                                    bool is_smooth) {
+    RETURN_IF(labels.empty() || !CheckColorsOfBatch(colors, static_cast<int32_t>(labels.size())));
+    const int32_t color_step = colors.size() == 1 ? 0 : 1;
+    for (int32_t i = 0; i < static_cast<int32_t>(labels.size()); ++i) {
+        DrawString(labels[i].text, labels[i].x, labels[i].y, colors[i * color_step], font_size, is_smooth);
+    }
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::RenderTextInCameraView(const CameraView &cam, const Vec3 &p_w, const std::string &str, const PixelType color,
+                                                               const int32_t font_size) {
+    Pixel pixel_uv = Pixel::Zero();
+    RETURN_IF(!ImagePainter::ProjectPointInCameraView(cam, p_w, pixel_uv));
+    DrawString(str, pixel_uv.x(), pixel_uv.y(), color, font_size);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::RenderPointInCameraView(const CameraView &cam, const Vec3 &point_in_w, const PixelType color, const int32_t radius) {
+    Pixel pixel_uv = Pixel::Zero();
+    RETURN_IF(!ImagePainter::ProjectPointInCameraView(cam, point_in_w, pixel_uv));
+    DrawSolidCircle(pixel_uv.x(), pixel_uv.y(), radius, color);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::RenderLineSegmentInCameraView(const CameraView &cam, const Vec3 &line_s_point, const Vec3 &line_e_point,
+                                                                      const PixelType color) {
+    Pixel pixel_uv_i = Pixel::Zero();
+    Pixel pixel_uv_j = Pixel::Zero();
+    RETURN_IF(!ImagePainter::ProjectLineSegmentInCameraView(cam, line_s_point, line_e_point, pixel_uv_i, pixel_uv_j));
+    DrawBressenhanLine(pixel_uv_i.x(), pixel_uv_i.y(), pixel_uv_j.x(), pixel_uv_j.y(), color);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::RenderDashedLineSegmentInCameraView(const CameraView &cam, const Vec3 &line_s_point, const Vec3 &line_e_point,
+                                                                            const int32_t dot_step, const PixelType color) {
+    Pixel pixel_uv_i = Pixel::Zero();
+    Pixel pixel_uv_j = Pixel::Zero();
+    RETURN_IF(!ImagePainter::ProjectLineSegmentInCameraView(cam, line_s_point, line_e_point, pixel_uv_i, pixel_uv_j));
+    DrawDashedLine(pixel_uv_i.x(), pixel_uv_i.y(), pixel_uv_j.x(), pixel_uv_j.y(), dot_step, color);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::RenderEllipseInCameraView(const CameraView &cam, const Vec3 &mid_p_w, const Mat3 &covariance, const PixelType color) {
+    Vec2 pixel_uv = Vec2::Zero();
+    Mat2 pixel_cov = Mat2::Zero();
+    RETURN_IF(!ImagePainter::ProjectGaussianInCameraView(cam, mid_p_w, covariance, pixel_uv, pixel_cov));
+    DrawTrustRegionOfGaussian(pixel_uv, pixel_cov, color);
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::ExecuteCommand(const Command &command, ImageType &tile, int32_t row_offset) const {
+    // Integer rasterizers are invariant to translation, so they draw into tile with shifted rows.
+    const auto &args = command.args;
+    const PixelType &color = command.color;
+    switch (command.type) {
+        case CommandType::kPoint: {
+            const int32_t row = args[1] - row_offset;
+            if (args[0] >= 0 && args[0] < tile.cols() && row >= 0 && row < tile.rows()) {
+                SetPixelValueUnchecked(tile, row, args[0], color);
+            }
+            break;
+        }
+        case CommandType::kSolidRectangle:
+            ImagePainter::DrawSolidRectangle(tile, args[0], args[1] - row_offset, args[2], args[3], color);
+            break;
+        case CommandType::kHollowRectangle:
+            ImagePainter::DrawHollowRectangle(tile, args[0], args[1] - row_offset, args[2], args[3], color);
+            break;
+        case CommandType::kBressenhanLine:
+            ImagePainter::DrawBressenhanLine(tile, args[0], args[1] - row_offset, args[2], args[3] - row_offset, color);
+            break;
+        case CommandType::kNaiveLine:
+            DrawNaiveLineInTile(tile, row_offset, args[0], args[1], args[2], args[3], color);
+            break;
+        case CommandType::kDashedLine:
+            DrawDashedLineInTile(tile, row_offset, args[0], args[1], args[2], args[3], args[4], color);
+            break;
+        case CommandType::kSolidCircle:
+            ImagePainter::DrawSolidCircle(tile, args[0], args[1] - row_offset, args[2], color);
+            break;
+        case CommandType::kHollowCircle:
+            ImagePainter::DrawHollowCircle(tile, args[0], args[1] - row_offset, args[2], color);
+            break;
+        case CommandType::kMidBresenhamEllipse:
+            ImagePainter::DrawMidBresenhamEllipse(tile, args[0], args[1] - row_offset, args[2], args[3], color);
+            break;
+        case CommandType::kSolidEllipse:
+            ImagePainter::DrawSolidEllipse(tile, args[0], args[1] - row_offset, args[2], args[3], color);
+            break;
+        case CommandType::kTrustRegionOfGaussian: {
+            const Gaussian &gaussian = gaussians_[command.data_index];
+            DrawTrustRegionOfGaussianInTile(tile, row_offset, gaussian.center, gaussian.covariance, color, gaussian.sigma_scale);
+            break;
+        }
+        case CommandType::kCharacter:
+            ImagePainter::DrawCharacter(tile, static_cast<char>(args[0]), args[1], args[2] - row_offset, color, args[3], args[4]);
+            break;
+        case CommandType::kString:
+            ImagePainter::DrawString(tile, strings_[command.data_index], args[0], args[1] - row_offset, color, args[2], args[3]);
+            break;
+        default:
+            break;
+    }
+}
+
+template <typename ImageType, typename PixelType>
+bool DisplayList<ImageType, PixelType>::Flush(ImageType &image) const {
+    IMAGE_PAINTER_PROFILE_SCOPE(kFlushDisplayList, image);
+    if (image.data() == nullptr || image.rows() <= 0 || image.cols() <= 0) {
+        ReportError("[DisplayList] Image to flush is empty.");
+        return false;
+    }
+
+    // Bin commands by tiles of rows. Each bin keeps the recorded order.
+    std::vector<int32_t> offsets_of_tiles;
+    std::vector<int32_t> commands_in_tiles;
+    BinItemsIntoRowTiles(static_cast<int32_t>(commands_.size()), image.rows(), kRowsOfTile, [&](int32_t i, int32_t &row_min, int32_t &row_max) {
+        row_min = commands_[i].row_min;
+        row_max = commands_[i].row_max;
+        return true;
+    }, offsets_of_tiles, commands_in_tiles);
+
+    // Tiles are fetched dynamically by workers, since commands are usually not evenly distributed on image.
+    ForEachTileInParallel(static_cast<int32_t>(offsets_of_tiles.size()) - 1, [&](int32_t tile_index) {
+        RETURN_IF(offsets_of_tiles[tile_index] == offsets_of_tiles[tile_index + 1]);
+        const int32_t row_offset = tile_index * kRowsOfTile;
+        ImageType tile = GetRowTileOfImage(image, row_offset, std::min(kRowsOfTile, image.rows() - row_offset));
+        for (int32_t k = offsets_of_tiles[tile_index]; k < offsets_of_tiles[tile_index + 1]; ++k) {
+            ExecuteCommand(commands_[commands_in_tiles[k]], tile, row_offset);
+        }
+    });
+    return true;
+}
+
+template <typename ImageType, typename PixelType>
+bool DisplayList<ImageType, PixelType>::IsSameCommand(int32_t index, const DisplayList &other, int32_t other_index) const {
+    const Command &command = commands_[index];
+    const Command &other_command = other.commands_[other_index];
+    RETURN_FALSE_IF(command.type != other_command.type || command.args != other_command.args || !IsSamePixelValue(command.color, other_command.color));
+    switch (command.type) {
+        case CommandType::kTrustRegionOfGaussian: {
+            const Gaussian &gaussian = gaussians_[command.data_index];
+            const Gaussian &other_gaussian = other.gaussians_[other_command.data_index];
+            return gaussian.center == other_gaussian.center && gaussian.covariance == other_gaussian.covariance &&
+                   gaussian.sigma_scale == other_gaussian.sigma_scale;
+        }
+        case CommandType::kString:
+            return strings_[command.data_index] == other.strings_[other_command.data_index];
+        default:
+            return true;
+    }
+}
+
+template <typename ImageType, typename PixelType>
+void DisplayList<ImageType, PixelType>::Clear() {
+    commands_.clear();
+    gaussians_.clear();
+    strings_.clear();
+}
+
+template class DisplayList<GrayImage, uint8_t>;
+template class DisplayList<RgbImage, RgbPixel>;
+
+}  // namespace image_painter
@@ -0,0 +1,109 @@
+#ifndef _IMAGE_PAINTER_DISPLAY_LIST_H_
+#define _IMAGE_PAINTER_DISPLAY_LIST_H_
+
+#include "basic_type.h"
+#include "datatype_image.h"
+#include "image_painter.h"
+
+namespace image_painter {
+
+/* Class DisplayList Declaration. */
+template <typename ImageType, typename PixelType>
+class DisplayList {
+
+public:
+    using CameraView = ImagePainter::CameraView;
+
+    enum class CommandType : uint8_t {
+        kPoint = 0,
+        kSolidRectangle = 1,
+        kHollowRectangle = 2,
+        kBressenhanLine = 3,
+        kNaiveLine = 4,
+        kDashedLine = 5,
+        kSolidCircle = 6,
+        kHollowCircle = 7,
+        kMidBresenhamEllipse = 8,
+        kSolidEllipse = 9,
+        kTrustRegionOfGaussian = 10,
+        kCharacter = 11,
+        kString = 12,
+    };
+
+    // Recorded draw command. Rows [row_min, row_max] bound all pixels it may write, which are used for binning.
+    struct Command {
+        CommandType type = CommandType::kPoint;
+        std::array<int32_t, 5> args = {};
+        int32_t row_min = 0;
+        int32_t row_max = 0;
+        // Index of gaussian or string of this command.
+        int32_t data_index = -1;
+        PixelType color = PixelType();
+    };
+
+    struct Gaussian {
+        Vec2 center = Vec2::Zero();
+        Mat2 covariance = Mat2::Identity();
+        float sigma_scale = 3.0f;
+    };
+
+public:
+    DisplayList() = default;
+    virtual ~DisplayList() = default;
+
+    // Record draw commands without executing them. Arguments are the same as ImagePainter.
+    void DrawPoint(int32_t x, int32_t y, const PixelType &color);
+    void DrawSolidRectangle(int32_t x, int32_t y, int32_t width, int32_t height, const PixelType &color);
+    void DrawSolidRectangles(const std::vector<ImagePainter::Rectangle> &rectangles, const PixelType &color);
+    void DrawHollowRectangle(int32_t x, int32_t y, int32_t width, int32_t height, const PixelType &color);
+    void DrawBressenhanLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, const PixelType &color);
+    void DrawNaiveLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, const PixelType &color);
+    void DrawDashedLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t step, const PixelType &color);
+    void DrawSolidCircle(int32_t center_x, int32_t center_y, int32_t radius, const PixelType &color);
+    void DrawHollowCircle(int32_t center_x, int32_t center_y, int32_t radius, const PixelType &color);
+    void DrawMidBresenhamEllipse(int32_t center_x, int32_t center_y, int32_t radius_x, int32_t radius_y, const PixelType &color);
+    void DrawSolidEllipse(int32_t center_x, int32_t center_y, int32_t radius_x, int32_t radius_y, const PixelType &color);
+    void DrawTrustRegionOfGaussian(const Vec2 &center, const Mat2 &covariance, const PixelType &color, const float sigma_scale = 3.0f);
+    void DrawCharacter(char character, int32_t x, int32_t y, const PixelType &color, int32_t font_size = 12, bool is_smooth = false);
+    void DrawString(const std::string &str, int32_t x, int32_t y, const PixelType &color, int32_t font_size = 12, bool is_smooth = false);
+    void DrawPoints(const ImagePainter::PointsBatch &points, const std::vector<PixelType> &colors);
+    void DrawLines(const ImagePainter::LinesBatch &lines, const std::vector<PixelType> &colors);
+    void DrawCircles(const ImagePainter::CirclesBatch &circles, const std::vector<PixelType> &colors, bool is_solid = true);
+    void DrawPolyline(const ImagePainter::PointsBatch &points, const PixelType &color, bool is_closed = false);
+    void DrawStrings(const std::vector<ImagePainter::Label> &labels, const std::vector<PixelType> &colors, int32_t font_size = 12,
+                     bool is_smooth = false);
+
+    // Render commands are projected when recorded, and the projected primitives are recorded.
+    void RenderTextInCameraView(const CameraView &cam, const Vec3 &p_w, const std::string &str, const PixelType color, const int32_t font_size = 12);
+    void RenderPointInCameraView(const CameraView &cam, const Vec3 &point_in_w, const PixelType color, const int32_t radius = 1);
+    void RenderLineSegmentInCameraView(const CameraView &cam, const Vec3 &line_s_point, const Vec3 &line_e_point, const PixelType color);
+    void RenderDashedLineSegmentInCameraView(const CameraView &cam, const Vec3 &line_s_point, const Vec3 &line_e_point, const int32_t dot_step,
+                                             const PixelType color);
+    void RenderEllipseInCameraView(const CameraView &cam, const Vec3 &mid_p_w, const Mat3 &covariance, const PixelType color);
+
+    // Execute all commands on image. Commands are binned into tiles of rows, and tiles are rasterized in parallel. Each tile executes its
+    // commands in recorded order, so the result is the same as drawing them one by one. Commands are kept after flush.
+    bool Flush(ImageType &image) const;
+    void Clear();
+
+    // Execute one command on tile, which is a view of rows [row_offset, row_offset + tile.rows()) of the whole image.
+    void ExecuteCommandInTile(int32_t index, ImageType &tile, int32_t row_offset) const { ExecuteCommand(commands_[index], tile, row_offset); }
+    // Return true if command of index draws the same pixels as command of other_index in other display list.
+    bool IsSameCommand(int32_t index, const DisplayList &other, int32_t other_index) const;
+
+    const std::vector<Command> &commands() const { return commands_; }
+
+private:
+    void AddCommand(CommandType type, const std::array<int32_t, 5> &args, int32_t row_min, int32_t row_max, const PixelType &color,
+                    int32_t data_index = -1);
+    void ExecuteCommand(const Command &command, ImageType &tile, int32_t row_offset) const;
+
+private:
+    std::vector<Command> commands_;
+    std::vector<Gaussian> gaussians_;
+    std::vector<std::string> strings_;
+};
+
+}  // namespace image_painter
+
+#endif  // end of _IMAGE_PAINTER_DISPLAY_LIST_H_
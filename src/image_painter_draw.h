@@ -0,0 +1,447 @@
+#ifndef _IMAGE_PAINTER_DRAW_H_
+#define _IMAGE_PAINTER_DRAW_H_
+
+#include "image_painter.h"
+#include "image_painter_blend.h"
+#include "image_painter_glyph.h"
+#include "image_painter_pixel.h"
+#include "image_painter_polygon.h"
+#include "image_painter_profile.h"
+#include "image_painter_raster.h"
+#include "image_painter_tile.h"
+#include "image_painter_yuv.h"
+
+#include "slam_log_reporter.h"
+#include "slam_memory.h"
+#include "slam_operations.h"
+
+/* Definitions of draw primitives of ImagePainter. Gray and rgb images are explicitly instantiated in library, so this header is only
+   needed to inline draws into hot loops of client, or to draw images of other PixelTraits. */
+namespace image_painter {
+
+// Minor coordinate of lines which interpolate it in float.
+inline int32_t InterpolateMinorCoordinate(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x) {
+    const float lambda = static_cast<float>(static_cast<int64_t>(x) - x1) / static_cast<float>(static_cast<int64_t>(x2) - x1);
+    return static_cast<int32_t>(static_cast<float>(y1) * (1.0f - lambda) + static_cast<float>(y2) * lambda);
+}
+
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawSolidRectangle(ImageType &image, int32_t x, int32_t y, int32_t width, int32_t height, const PixelType &color, const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kSolidRectangle, image);
+    if (image.data() == nullptr || width < 0 || height < 0) {
+        return;
+    }
+    int32_t row_begin = y;
+    int32_t row_end = y + height - 1;
+    int32_t col_begin = x;
+    int32_t col_end = x + width - 1;
+    if (!ClipRectangle(image, row_begin, row_end, col_begin, col_end)) {
+        IMAGE_PAINTER_PROFILE_REJECTED_PIXELS(static_cast<int64_t>(width) * height);
+        return;
+    }
+    IMAGE_PAINTER_PROFILE_REJECTED_PIXELS(static_cast<int64_t>(width) * height - static_cast<int64_t>(row_end - row_begin + 1) * (col_end - col_begin + 1));
+    PixelWriter<ImageType, PixelType>(image, color, blend).FillRectangleUnchecked(row_begin, row_end, col_begin, col_end);
+}
+
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawSolidRectangles(ImageType &image, const std::vector<Rectangle> &rectangles, const PixelType &color, const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kSolidRectangles, image);
+    RETURN_IF(image.data() == nullptr);
+    const PixelWriter<ImageType, PixelType> writer(image, color, blend);
+    RETURN_IF(!writer.IsVisible());
+    for (const auto &rectangle: rectangles) {
+        CONTINUE_IF(rectangle.width < 0 || rectangle.height < 0);
+        int32_t row_begin = rectangle.y;
+        int32_t row_end = rectangle.y + rectangle.height - 1;
+        int32_t col_begin = rectangle.x;
+        int32_t col_end = rectangle.x + rectangle.width - 1;
+        const bool is_visible = ClipRectangle(image, row_begin, row_end, col_begin, col_end);
+        IMAGE_PAINTER_PROFILE_REJECTED_PIXELS(static_cast<int64_t>(rectangle.width) * rectangle.height -
+                                              (is_visible ? static_cast<int64_t>(row_end - row_begin + 1) * (col_end - col_begin + 1) : 0));
+        CONTINUE_IF(!is_visible);
+        writer.FillRectangleUnchecked(row_begin, row_end, col_begin, col_end);
+    }
+}
+
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawHollowRectangle(ImageType &image, int32_t x, int32_t y, int32_t width, int32_t height, const PixelType &color, int32_t line_width,
+                                       const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kHollowRectangle, image);
+    if (image.data() == nullptr || width < 0 || height < 0) {
+        return;
+    }
+
+    const int32_t x0 = x;
+    const int32_t x1 = x + width;
+    const int32_t y0 = y;
+    const int32_t y1 = y + height;
+    const PixelWriter<ImageType, PixelType> writer(image, color, blend);
+
+    // Thick box covers [x0, x1] x [y0, y1], and its hole is reversed against it.
+    if (line_width > 1) {
+        const Vec2 outer[4] = {Vec2(x0, y0), Vec2(x1 + 1, y0), Vec2(x1 + 1, y1 + 1), Vec2(x0, y1 + 1)};
+        const Vec2 inner[4] = {Vec2(x0 + line_width, y0 + line_width), Vec2(x0 + line_width, y1 + 1 - line_width),
+                               Vec2(x1 + 1 - line_width, y1 + 1 - line_width), Vec2(x1 + 1 - line_width, y0 + line_width)};
+        ScanlineFiller filler;
+        filler.AddContour(outer, 4);
+        if (2 * line_width <= std::min(width, height)) {
+            filler.AddContour(inner, 4);
+        }
+        filler.Fill(image.rows(), image.cols(), [&](int32_t row, int32_t col_begin, int32_t col_end) { writer.FillSpanUnchecked(row, col_begin, col_end); });
+        return;
+    }
+
+    // Top and bottom edges cover [x0, x1 - 1], and left and right edges cover [y0, y1 - 1]. The left-top corner is already covered by
+    // the top edge if it is not empty.
+    writer.FillSpan(y0, x0, x1 - 1);
+    if (y1 != y0) {
+        writer.FillSpan(y1, x0, x1 - 1);
+    }
+
+    const int32_t row_end = std::min(y1 - 1, image.rows() - 1);
+    if (x0 >= 0 && x0 < image.cols() && x1 != x0) {
+        for (int32_t v = std::max(y0 + 1, 0); v <= row_end; ++v) {
+            writer.SetPixelUnchecked(v, x0);
+        }
+    }
+    if (x1 >= 0 && x1 < image.cols()) {
+        for (int32_t v = std::max(y0, 0); v <= row_end; ++v) {
+            writer.SetPixelUnchecked(v, x1);
+        }
+    }
+}
+
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawBressenhanLine(ImageType &image, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const PixelType &color, const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kBressenhanLine, image);
+    if (image.data() == nullptr) {
+        return;
+    }
+    const PixelWriter<ImageType, PixelType> writer(image, color, blend);
+    TraverseBressenhanLine(x1, y1, x2, y2, image.rows(), image.cols(),
+                           [&](int32_t row, int32_t col, int64_t, int64_t) { writer.SetPixelUnchecked(row, col); });
+}
+
+template <typename ImageType, typename PixelType>
+void DrawNaiveLineInTile(ImageType &tile, int32_t row_offset, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const PixelType &color,
+                         const ImagePainter::Blend &blend) {
+    RETURN_IF(tile.data() == nullptr);
+    bool is_steep = false;
+
+    if (std::abs(static_cast<int64_t>(x1) - x2) < std::abs(static_cast<int64_t>(y1) - y2)) {
+        SlamOperation::ExchangeValue(x1, y1);
+        SlamOperation::ExchangeValue(x2, y2);
+        is_steep = true;
+    }
+
+    if (x1 > x2) {
+        SlamOperation::ExchangeValue(x1, x2);
+        SlamOperation::ExchangeValue(y1, y2);
+    }
+    // Interpolation of single point is undefined, which draws nothing.
+    RETURN_IF(x1 == x2);
+
+    // Clip major axis into tile. Minor axis is still checked per pixel, so cost is bounded by tile size.
+    const int32_t major_offset = is_steep ? row_offset : 0;
+    const int32_t minor_offset = is_steep ? 0 : row_offset;
+    const int32_t major_size = is_steep ? tile.rows() : tile.cols();
+    const int32_t minor_size = is_steep ? tile.cols() : tile.rows();
+    int64_t step_begin = 0;
+    int64_t step_end = static_cast<int64_t>(x2) - x1;
+    ClipStepsInAxis(static_cast<int64_t>(x1) - major_offset, 1, major_size, step_begin, step_end);
+
+    const PixelWriter<ImageType, PixelType> writer(tile, color, blend);
+    for (int64_t k = step_begin; k <= step_end; ++k) {
+        const int32_t x = static_cast<int32_t>(x1 + k);
+        const int32_t y = InterpolateMinorCoordinate(x1, y1, x2, y2, x);
+        CONTINUE_IF(y < minor_offset || y - minor_offset >= minor_size);
+        if (is_steep) {
+            writer.SetPixelUnchecked(x - major_offset, y);
+        } else {
+            writer.SetPixelUnchecked(y - minor_offset, x);
+        }
+    }
+}
+
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawNaiveLine(ImageType &image, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const PixelType &color, const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kNaiveLine, image);
+    DrawNaiveLineInTile(image, 0, x1, y1, x2, y2, color, blend);
+}
+
+template <typename ImageType, typename PixelType>
+void DrawDashedLineInTile(ImageType &tile, int32_t row_offset, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t step, const PixelType &color,
+                          const ImagePainter::Blend &blend) {
+    RETURN_IF(tile.data() == nullptr || step <= 0);
+    bool is_steep = false;
+
+    if (std::abs(static_cast<int64_t>(x1) - x2) < std::abs(static_cast<int64_t>(y1) - y2)) {
+        SlamOperation::ExchangeValue(x1, y1);
+        SlamOperation::ExchangeValue(x2, y2);
+        is_steep = true;
+    }
+
+    if (x1 > x2) {
+        SlamOperation::ExchangeValue(x1, x2);
+        SlamOperation::ExchangeValue(y1, y2);
+    }
+    // Interpolation of single point is undefined, which draws nothing.
+    RETURN_IF(x1 == x2);
+
+    // Clip dashes on major axis into tile. Minor axis is still checked per pixel.
+    const int32_t major_offset = is_steep ? row_offset : 0;
+    const int32_t minor_offset = is_steep ? 0 : row_offset;
+    const int32_t major_size = is_steep ? tile.rows() : tile.cols();
+    const int32_t minor_size = is_steep ? tile.cols() : tile.rows();
+    int64_t step_begin = 0;
+    int64_t step_end = (static_cast<int64_t>(x2) - x1) / step;
+    ClipStepsInAxis(static_cast<int64_t>(x1) - major_offset, step, major_size, step_begin, step_end);
+
+    const PixelWriter<ImageType, PixelType> writer(tile, color, blend);
+    for (int64_t k = step_begin; k <= step_end; ++k) {
+        const int32_t x = static_cast<int32_t>(x1 + k * step);
+        const int32_t y = InterpolateMinorCoordinate(x1, y1, x2, y2, x);
+        CONTINUE_IF(y < minor_offset || y - minor_offset >= minor_size);
+        if (is_steep) {
+            writer.SetPixelUnchecked(x - major_offset, y);
+        } else {
+            writer.SetPixelUnchecked(y - minor_offset, x);
+        }
+    }
+
+    // Draw the end point, unless it is the last dash.
+    RETURN_IF((static_cast<int64_t>(x2) - x1) % step == 0);
+    const int32_t y = InterpolateMinorCoordinate(x1, y1, x2, y2, x2);
+    if (is_steep) {
+        writer.SetPixel(x2 - major_offset, y);
+    } else {
+        writer.SetPixel(y - minor_offset, x2);
+    }
+}
+
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawDashedLine(ImageType &image, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t step, const PixelType &color,
+                                  const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kDashedLine, image);
+    DrawDashedLineInTile(image, 0, x1, y1, x2, y2, step, color, blend);
+}
+
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawSolidCircle(ImageType &image, int32_t center_x, int32_t center_y, int32_t radius, const PixelType &color, const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kSolidCircle, image);
+    if (image.data() == nullptr || radius < 0) {
+        return;
+    }
+
+    // Pixel is inside if its distance to center is less than radius, which is dx^2 + dy^2 < r^2 in integer. Only visible rows are visited,
+    // and each of them is filled as one span.
+    const int64_t radius_2 = static_cast<int64_t>(radius) * radius;
+    const int32_t row_begin = std::max(center_y - radius + 1, 0);
+    const int32_t row_end = std::min(center_y + radius - 1, image.rows() - 1);
+    const PixelWriter<ImageType, PixelType> writer(image, color, blend);
+    for (int32_t row = row_begin; row <= row_end; ++row) {
+        const int64_t dy = row - center_y;
+        const int32_t half_width = ComputeMaxHalfWidth(radius_2 - dy * dy - 1);
+        writer.FillSpan(row, center_x - half_width, center_x + half_width);
+    }
+}
+
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawHollowCircle(ImageType &image, int32_t center_x, int32_t center_y, int32_t radius, const PixelType &color, int32_t line_width,
+                                    const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kHollowCircle, image);
+    if (image.data() == nullptr || radius < 0) {
+        return;
+    }
+
+    // Pixel is on the ring if its distance to center is in (radius - line_width - 0.1, radius). Each visible row has at most two spans,
+    // which are between the half widths of inner and outer circles.
+    const int64_t radius_2 = static_cast<int64_t>(radius) * radius;
+    const float radius_in = static_cast<float>(radius) - static_cast<float>(std::max(line_width, 1)) - 0.1f;
+    const int64_t radius_in_2 = radius_in < 0.0f ? -1 : static_cast<int64_t>(std::floor(static_cast<double>(radius_in) * static_cast<double>(radius_in)));
+    const int32_t row_begin = std::max(center_y - radius + 1, 0);
+    const int32_t row_end = std::min(center_y + radius - 1, image.rows() - 1);
+    const PixelWriter<ImageType, PixelType> writer(image, color, blend);
+    for (int32_t row = row_begin; row <= row_end; ++row) {
+        const int64_t dy = row - center_y;
+        const int32_t half_width_out = ComputeMaxHalfWidth(radius_2 - dy * dy - 1);
+        const int32_t half_width_in = radius_in_2 < 0 ? -1 : ComputeMaxHalfWidth(radius_in_2 - dy * dy);
+        if (half_width_in < 0) {
+            writer.FillSpan(row, center_x - half_width_out, center_x + half_width_out);
+        } else if (half_width_in < half_width_out) {
+            writer.FillSpan(row, center_x - half_width_out, center_x - half_width_in - 1);
+            writer.FillSpan(row, center_x + half_width_in + 1, center_x + half_width_out);
+        }
+    }
+}
+
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawMidBresenhamEllipse(ImageType &image, int32_t center_x, int32_t center_y, int32_t radius_x, int32_t radius_y, const PixelType &color,
+                                           const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kMidBresenhamEllipse, image);
+    RETURN_IF(image.data() == nullptr);
+    const PixelWriter<ImageType, PixelType> writer(image, color, blend);
+    // Symmetric points on axes are the same pixel, which is written once.
+    auto set_pixels = [&](int32_t y, int32_t x) {
+        writer.SetPixel(center_y + y, center_x + x);
+        if (x != 0) {
+            writer.SetPixel(center_y + y, center_x - x);
+        }
+        if (y != 0) {
+            writer.SetPixel(center_y - y, center_x + x);
+            if (x != 0) {
+                writer.SetPixel(center_y - y, center_x - x);
+            }
+        }
+    };
+
+    int32_t y = 0;
+    int32_t x = radius_x;
+    const float a = radius_y;
+    const float b = radius_x;
+    const float a2 = a * a;
+    const float b2 = b * b;
+    set_pixels(y, x);
+
+    float d1 = b2 + a2 * (0.5f - b);
+    while (b2 * (y + 1) < a2 * (x - 0.5f)) {
+        if (d1 <= 0) {
+            d1 += b2 * (2 * y + 3);
+            ++y;
+        } else {
+            d1 += b2 * (2 * y + 3) + a2 * (2 - 2 * x);
+            ++y;
+            --x;
+        }
+        set_pixels(y, x);
+    }
+
+    float d2 = b2 * (y + 0.5f) * (y + 0.5f) + a2 * (x - 1) * (x - 1) - a2 * b2;
+    while (x > 0) {
+        if (d2 <= 0) {
+            d2 += b2 * (2 * y + 2) + a2 * (3 - 2 * x);
+            ++y;
+            --x;
+        } else {
+            d2 += a2 * (3 - 2 * x);
+            --x;
+        }
+        set_pixels(y, x);
+    }
+}
+
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawSolidEllipse(ImageType &image, int32_t center_x, int32_t center_y, int32_t radius_x, int32_t radius_y, const PixelType &color,
+                                    const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kSolidEllipse, image);
+    if (image.data() == nullptr || radius_x < 0 || radius_y < 0) {
+        return;
+    }
+
+    // Pixel is inside if (dx / rx)^2 + (dy / ry)^2 <= 1, which is dx^2 <= (rx^2 * ry^2 - dy^2 * rx^2) / ry^2 in integer. Only visible
+    // rows are visited, and each of them is filled as one span.
+    const int64_t radius_x_2 = static_cast<int64_t>(radius_x) * radius_x;
+    const int64_t radius_y_2 = static_cast<int64_t>(radius_y) * radius_y;
+    const int32_t row_begin = std::max(center_y - radius_y, 0);
+    const int32_t row_end = std::min(center_y + radius_y, image.rows() - 1);
+    const PixelWriter<ImageType, PixelType> writer(image, color, blend);
+    for (int32_t row = row_begin; row <= row_end; ++row) {
+        const int64_t dy = row - center_y;
+        const int32_t half_width = radius_y == 0 ? radius_x : ComputeMaxHalfWidth((radius_y_2 - dy * dy) * radius_x_2 / radius_y_2);
+        writer.FillSpan(row, center_x - half_width, center_x + half_width);
+    }
+}
+
+template <typename ImageType, typename PixelType>
+void DrawTrustRegionOfGaussianInTile(ImageType &tile, int32_t row_offset, const Vec2 &center, const Mat2 &covariance, const PixelType &color,
+                                     const float sigma_scale, bool is_solid, const ImagePainter::Blend &blend) {
+    RETURN_IF(tile.data() == nullptr);
+    const PixelWriter<ImageType, PixelType> writer(tile, color, blend);
+    TraverseTrustRegionOfGaussian(center, covariance, sigma_scale, is_solid, row_offset, row_offset + tile.rows() - 1,
+                                  [&](int32_t row, int32_t col_begin, int32_t col_end) { writer.FillSpan(row - row_offset, col_begin, col_end); });
+}
+
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawTrustRegionOfGaussian(ImageType &image, const Vec2 &center, const Mat2 &covariance, const PixelType &color, const float sigma_scale,
+                                             const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kTrustRegionOfGaussian, image);
+    DrawTrustRegionOfGaussianInTile(image, 0, center, covariance, color, sigma_scale, false, blend);
+}
+
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawSolidTrustRegionOfGaussian(ImageType &image, const Vec2 &center, const Mat2 &covariance, const PixelType &color,
+                                                  const float sigma_scale, const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kSolidTrustRegionOfGaussian, image);
+    DrawTrustRegionOfGaussianInTile(image, 0, center, covariance, color, sigma_scale, true, blend);
+}
+
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawCharacter(ImageType &image, char character, int32_t x, int32_t y, const PixelType &color, int32_t font_size, bool is_smooth,
+                                 const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kCharacter, image);
+    RETURN_IF(image.data() == nullptr);
+    DrawGlyph(PixelWriter<ImageType, PixelType>(image, color, blend), *GlyphAtlas::Get(font_size, is_smooth), character, x, y);
+}
+
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawString(ImageType &image, const std::string &str, int32_t x, int32_t y, const PixelType &color, int32_t font_size, bool is_smooth,
+                              const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kString, image);
+    RETURN_IF(image.data() == nullptr || y >= image.rows() || x >= image.cols());
+    const auto atlas = GlyphAtlas::Get(font_size, is_smooth);
+    const PixelWriter<ImageType, PixelType> writer(image, color, blend);
+    for (const auto &chr: str) {
+        DrawGlyph(writer, *atlas, chr, x, y);
+        x += atlas->cols();
+        if (x >= image.cols()) {
+            break;
+        }
+    }
+}
+
+template <typename ImageType, typename PixelType>
+inline void FillByScanlines(ImageType &image, const ScanlineFiller &filler, const PixelType &color, const ImagePainter::Blend &blend) {
+    const PixelWriter<ImageType, PixelType> writer(image, color, blend);
+    RETURN_IF(!writer.IsVisible());
+    filler.Fill(image.rows(), image.cols(), [&](int32_t row, int32_t col_begin, int32_t col_end) { writer.FillSpanUnchecked(row, col_begin, col_end); });
+}
+
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawSolidPolygon(ImageType &image, const PointsBatch &points, const PixelType &color, const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kSolidPolygon, image);
+    const int32_t size = static_cast<int32_t>(points.rows());
+    RETURN_IF(image.data() == nullptr || size < 3);
+
+    std::vector<Vec2> vertices(size);
+    for (int32_t i = 0; i < size; ++i) {
+        vertices[i] = Vec2(static_cast<float>(points(i, 0)), static_cast<float>(points(i, 1)));
+    }
+    ScanlineFiller filler;
+    filler.AddContour(vertices.data(), size);
+    FillByScanlines(image, filler, color, blend);
+}
+
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawThickLine(ImageType &image, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t line_width, const PixelType &color,
+                                 LineCap cap, const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kThickLine, image);
+    Eigen::Matrix<int32_t, 2, 2> points;
+    points << x1, y1, x2, y2;
+    DrawThickPolyline(image, points, line_width, color, false, LineJoin::kMiter, cap, blend);
+}
+
+template <typename ImageType, typename PixelType>
+void ImagePainter::DrawThickPolyline(ImageType &image, const PointsBatch &points, int32_t line_width, const PixelType &color, bool is_closed,
+                                     LineJoin join, LineCap cap, const Blend &blend) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kThickPolyline, image);
+    RETURN_IF(image.data() == nullptr || points.rows() == 0);
+
+    // All pieces of stroke are unioned by one filler, so overlapped joins and segments are written once.
+    ScanlineFiller filler;
+    AddStrokeOfPolyline(filler, points, 0.5f * static_cast<float>(std::max(line_width, 1)), is_closed, join, cap);
+    FillByScanlines(image, filler, color, blend);
+}
+
+}  // namespace image_painter
+
+#endif  // end of _IMAGE_PAINTER_DRAW_H_
@@ -0,0 +1,178 @@
+#include "image_painter_glyph.h"
+#include "assic_fonts.h"
+
+#include "list"
+#include "mutex"
+#include "unordered_map"
+
+namespace image_painter {
+
+namespace {
+    // Each column of glyph is packed into whole bytes from top to bottom, with the highest bit first.
+    template <size_t N>
+    void ExpandGlyphs(const std::array<std::array<uint8_t, N>, GlyphAtlas::kNumOfCharacters> &fonts, int32_t rows, int32_t cols,
+                      std::vector<uint8_t> &masks) {
+        const int32_t bytes_of_col = (rows + 7) / 8;
+        masks.assign(GlyphAtlas::kNumOfCharacters * rows * cols, 0);
+        for (int32_t idx = 0; idx < GlyphAtlas::kNumOfCharacters; ++idx) {
+            uint8_t *mask = masks.data() + idx * rows * cols;
+            for (int32_t col = 0; col < cols; ++col) {
+                for (int32_t row = 0; row < rows; ++row) {
+                    const uint8_t item = fonts[idx][col * bytes_of_col + row / 8];
+                    if (item & (0x80 >> (row % 8))) {
+                        mask[row * cols + col] = 255;
+                    }
+                }
+            }
+        }
+    }
+
+    // Ascii fonts whose size is the nearest to font size. Larger fonts are preferred on ties, since downscaling keeps more strokes.
+    int32_t GetNearestAssicFontSize(int32_t font_size) {
+        int32_t nearest = 24;
+        for (const int32_t size: {16, 12}) {
+            if (std::abs(size - font_size) < std::abs(nearest - font_size)) {
+                nearest = size;
+            }
+        }
+        return nearest;
+    }
+
+    // Scale masks of src_rows x src_cols into rows x cols. Each pixel samples samples x samples points of source by nearest neighbor, and its
+    // coverage is the fraction of covered points.
+    void ScaleGlyphs(const std::vector<uint8_t> &src_masks, int32_t src_rows, int32_t src_cols, int32_t rows, int32_t cols, int32_t samples,
+                     std::vector<uint8_t> &masks) {
+        std::vector<int32_t> src_row_indices(rows * samples);
+        std::vector<int32_t> src_col_indices(cols * samples);
+        for (int32_t i = 0; i < rows * samples; ++i) {
+            src_row_indices[i] = static_cast<int32_t>((2 * static_cast<int64_t>(i) + 1) * src_rows / (2 * rows * samples));
+        }
+        for (int32_t i = 0; i < cols * samples; ++i) {
+            src_col_indices[i] = static_cast<int32_t>((2 * static_cast<int64_t>(i) + 1) * src_cols / (2 * cols * samples));
+        }
+
+        const int32_t num_of_samples = samples * samples;
+        masks.assign(GlyphAtlas::kNumOfCharacters * rows * cols, 0);
+        for (int32_t idx = 0; idx < GlyphAtlas::kNumOfCharacters; ++idx) {
+            const uint8_t *src_mask = src_masks.data() + idx * src_rows * src_cols;
+            uint8_t *mask = masks.data() + idx * rows * cols;
+            for (int32_t row = 0; row < rows; ++row) {
+                for (int32_t col = 0; col < cols; ++col) {
+                    int32_t covered = 0;
+                    for (int32_t i = 0; i < samples; ++i) {
+                        const uint8_t *src_row = src_mask + src_row_indices[row * samples + i] * src_cols;
+                        for (int32_t j = 0; j < samples; ++j) {
+                            covered += src_row[src_col_indices[col * samples + j]] ? 1 : 0;
+                        }
+                    }
+                    mask[row * cols + col] = static_cast<uint8_t>((covered * 255 + num_of_samples / 2) / num_of_samples);
+                }
+            }
+        }
+    }
+}  // namespace
+
+GlyphAtlas::GlyphAtlas(int32_t font_size, bool is_smooth) {
+    font_size_ = GetValidFontSize(font_size);
+    rows_ = font_size_;
+    cols_ = font_size_ >> 1;
+
+    // Expand the nearest ascii fonts, and scale it if font size is different.
+    const int32_t src_font_size = GetNearestAssicFontSize(font_size_);
+    is_smooth_ = is_smooth && src_font_size != font_size_;
+    std::vector<uint8_t> src_masks;
+    switch (src_font_size) {
+        default:
+        case 12:
+            ExpandGlyphs(AssicFonts::ascii_1206(), src_font_size, src_font_size >> 1, src_masks);
+            break;
+        case 16:
+            ExpandGlyphs(AssicFonts::ascii_1608(), src_font_size, src_font_size >> 1, src_masks);
+            break;
+        case 24:
+            ExpandGlyphs(AssicFonts::ascii_2412(), src_font_size, src_font_size >> 1, src_masks);
+            break;
+    }
+    if (src_font_size == font_size_) {
+        masks_.swap(src_masks);
+    } else {
+        constexpr int32_t kSamplesOfSmoothPixel = 4;
+        ScaleGlyphs(src_masks, src_font_size, src_font_size >> 1, rows_, cols_, is_smooth_ ? kSamplesOfSmoothPixel : 1, masks_);
+    }
+
+    // Collect spans of fully covered pixels in each row, and fragments of partially covered pixels.
+    for (int32_t idx = 0; idx < kNumOfCharacters; ++idx) {
+        const uint8_t *mask = masks_.data() + idx * rows_ * cols_;
+        for (int32_t row = 0; row < rows_; ++row) {
+            for (int32_t col = 0; col < cols_; ++col) {
+                const uint8_t coverage = mask[row * cols_ + col];
+                CONTINUE_IF(coverage == 0);
+                if (coverage < 255) {
+                    fragments_[idx].emplace_back(Fragment{row, col, coverage});
+                } else if (!spans_[idx].empty() && spans_[idx].back().row == row && spans_[idx].back().col_end == col - 1) {
+                    spans_[idx].back().col_end = col;
+                } else {
+                    spans_[idx].emplace_back(Span{row, col, col});
+                }
+            }
+        }
+    }
+}
+
+std::shared_ptr<const GlyphAtlas> GlyphAtlas::Get(int32_t font_size, bool is_smooth) {
+    // Ascii fonts are always kept.
+    static const std::shared_ptr<const GlyphAtlas> kAtlas1206 = std::make_shared<const GlyphAtlas>(12);
+    static const std::shared_ptr<const GlyphAtlas> kAtlas1608 = std::make_shared<const GlyphAtlas>(16);
+    static const std::shared_ptr<const GlyphAtlas> kAtlas2412 = std::make_shared<const GlyphAtlas>(24);
+    font_size = GetValidFontSize(font_size);
+    switch (font_size) {
+        case 12:
+            return kAtlas1206;
+        case 16:
+            return kAtlas1608;
+        case 24:
+            return kAtlas2412;
+        default:
+            break;
+    }
+
+    // Scaled fonts are kept in lru cache, whose front is the most recently used. Evicted atlas is still valid for its users.
+    using CachedAtlases = std::list<std::pair<int32_t, std::shared_ptr<const GlyphAtlas>>>;
+    static std::mutex mutex;
+    static CachedAtlases cached_atlases;
+    static std::unordered_map<int32_t, CachedAtlases::iterator> cached_indices;
+
+    const int32_t key = font_size * 2 + (is_smooth ? 1 : 0);
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = cached_indices.find(key);
+    if (it != cached_indices.end()) {
+        cached_atlases.splice(cached_atlases.begin(), cached_atlases, it->second);
+        return it->second->second;
+    }
+    if (static_cast<int32_t>(cached_atlases.size()) >= kMaxNumOfCachedAtlases) {
+        cached_indices.erase(cached_atlases.back().first);
+        cached_atlases.pop_back();
+    }
+    cached_atlases.emplace_front(key, std::make_shared<const GlyphAtlas>(font_size, is_smooth));
+    cached_indices[key] = cached_atlases.begin();
+    return cached_atlases.front().second;
+}
+
+const uint8_t *GlyphAtlas::GetMask(char character) const {
+    const int32_t idx = static_cast<int32_t>(character - kFirstCharacter);
+    return idx >= 0 && idx < kNumOfCharacters ? masks_.data() + idx * rows_ * cols_ : nullptr;
+}
+
+const std::vector<GlyphAtlas::Span> &GlyphAtlas::GetSpans(char character) const {
+    static const std::vector<Span> kEmptySpans;
+    const int32_t idx = static_cast<int32_t>(character - kFirstCharacter);
+    return idx >= 0 && idx < kNumOfCharacters ? spans_[idx] : kEmptySpans;
+}
+
+const std::vector<GlyphAtlas::Fragment> &GlyphAtlas::GetFragments(char character) const {
+    static const std::vector<Fragment> kEmptyFragments;
+    const int32_t idx = static_cast<int32_t>(character - kFirstCharacter);
+    return idx >= 0 && idx < kNumOfCharacters ? fragments_[idx] : kEmptyFragments;
+}
+
+}  // namespace image_painter
@@ -0,0 +1,93 @@
+#ifndef _IMAGE_PAINTER_GLYPH_H_
+#define _IMAGE_PAINTER_GLYPH_H_
+
+#include "basic_type.h"
+#include "datatype_image.h"
+#include "image_painter_blend.h"
+
+#include "array"
+#include "memory"
+
+namespace image_painter {
+
+/* Class GlyphAtlas Declaration. */
+class GlyphAtlas {
+
+public:
+    static constexpr char kFirstCharacter = ' ';
+    static constexpr int32_t kNumOfCharacters = 95;
+    static constexpr int32_t kMinFontSize = 6;
+    static constexpr int32_t kMaxFontSize = 256;
+    // Atlases of font sizes other than ascii fonts are kept in a lru cache with this capacity.
+    static constexpr int32_t kMaxNumOfCachedAtlases = 8;
+
+    // Fully covered pixels [col_begin, col_end] in one row of glyph.
+    struct Span {
+        int32_t row = 0;
+        int32_t col_begin = 0;
+        int32_t col_end = 0;
+    };
+
+    // Partially covered pixel of smoothed glyph, which is blended with coverage.
+    struct Fragment {
+        int32_t row = 0;
+        int32_t col = 0;
+        uint8_t coverage = 0;
+    };
+
+public:
+    // Expand bit-packed ascii fonts into row-major coverage masks, and collect spans of covered pixels. Font size other than 12 / 16 / 24
+    // is scaled from the nearest ascii fonts. If smoothing is enabled, coverage of scaled pixels is the fraction of covered source pixels.
+    explicit GlyphAtlas(int32_t font_size, bool is_smooth = false);
+    virtual ~GlyphAtlas() = default;
+
+    // Atlas of font size, which is built once on first use. Font size is clamped into [kMinFontSize, kMaxFontSize]. Smoothing is ignored
+    // for font size 12 / 16 / 24, which need no scaling.
+    static std::shared_ptr<const GlyphAtlas> Get(int32_t font_size, bool is_smooth = false);
+    static int32_t GetValidFontSize(int32_t font_size) { return std::min(std::max(font_size, kMinFontSize), kMaxFontSize); }
+
+    // Coverage mask of character with rows() x cols() items, where 255 is fully covered. Return nullptr if character has no glyph.
+    const uint8_t *GetMask(char character) const;
+    // Spans and fragments of character, which are empty if character has no glyph.
+    const std::vector<Span> &GetSpans(char character) const;
+    const std::vector<Fragment> &GetFragments(char character) const;
+
+    // Reference for member variables.
+    int32_t font_size() const { return font_size_; }
+    bool is_smooth() const { return is_smooth_; }
+    int32_t rows() const { return rows_; }
+    int32_t cols() const { return cols_; }
+
+private:
+    int32_t font_size_ = 12;
+    bool is_smooth_ = false;
+    int32_t rows_ = 0;
+    int32_t cols_ = 0;
+    std::vector<uint8_t> masks_;
+    std::array<std::vector<Span>, kNumOfCharacters> spans_;
+    std::array<std::vector<Fragment>, kNumOfCharacters> fragments_;
+};
+
+// Blit spans of glyph with its left-top corner at (x, y), and blend its fragments with blend of writer scaled by coverage. Pixels are
+// clipped into image.
+template <typename ImageType, typename PixelType>
+inline void DrawGlyph(const PixelWriter<ImageType, PixelType> &writer, const GlyphAtlas &atlas, char character, int32_t x, int32_t y) {
+    ImageType &image = writer.image();
+    RETURN_IF(y >= image.rows() || static_cast<int64_t>(y) + atlas.rows() <= 0 || x >= image.cols() || static_cast<int64_t>(x) + atlas.cols() <= 0);
+    for (const GlyphAtlas::Span &span: atlas.GetSpans(character)) {
+        writer.FillSpan(y + span.row, x + span.col_begin, x + span.col_end);
+    }
+    for (const GlyphAtlas::Fragment &fragment: atlas.GetFragments(character)) {
+        const int32_t row = y + fragment.row;
+        const int32_t col = x + fragment.col;
+        if (row < 0 || row >= image.rows() || col < 0 || col >= image.cols()) {
+            IMAGE_PAINTER_PROFILE_REJECTED_PIXELS(1);
+            continue;
+        }
+        writer.BlendFragmentUnchecked(row, col, fragment.coverage);
+    }
+}
+
+}  // namespace image_painter
+
+#endif  // end of _IMAGE_PAINTER_GLYPH_H_
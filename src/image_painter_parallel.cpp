@@ -0,0 +1,111 @@
+#include "image_painter_parallel.h"
+
+#include "algorithm"
+#include "atomic"
+
+namespace image_painter {
+
+namespace {
+    std::atomic<int32_t> &MaxNumberOfThreads() {
+        static std::atomic<int32_t> max_num_of_threads(std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency())));
+        return max_num_of_threads;
+    }
+
+    // Workers and the thread running a job are inside tasks, so nested parallel jobs run in place.
+    bool &IsInTaskOfThread() {
+        thread_local bool is_in_task = false;
+        return is_in_task;
+    }
+}  // namespace
+
+int32_t ImagePainter::GetMaxNumberOfThreads() { return MaxNumberOfThreads().load(std::memory_order_relaxed); }
+
+void ImagePainter::SetMaxNumberOfThreads(int32_t max_num_of_threads) { MaxNumberOfThreads().store(std::max(1, max_num_of_threads), std::memory_order_relaxed); }
+
+/* Class ThreadPool Definition. */
+ThreadPool &ThreadPool::GetInstance() {
+    static ThreadPool thread_pool;
+    return thread_pool;
+}
+
+ThreadPool::~ThreadPool() { Stop(); }
+
+bool ThreadPool::Run(int32_t num_of_tasks, const std::function<void(int32_t)> &task) {
+    bool &is_in_task = IsInTaskOfThread();
+    RETURN_FALSE_IF(is_in_task);
+    std::unique_lock<std::mutex> job_lock(job_mutex_, std::try_to_lock);
+    RETURN_FALSE_IF(!job_lock.owns_lock());
+
+    Resize(ImagePainter::GetMaxNumberOfThreads() - 1);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        num_of_tasks_ = num_of_tasks;
+        next_task_index_.store(0, std::memory_order_relaxed);
+        num_of_pending_workers_ = static_cast<int32_t>(workers_.size());
+        ++generation_;
+    }
+    wake_condition_.notify_all();
+
+    is_in_task = true;
+    RunTasks();
+    is_in_task = false;
+
+    // Every worker takes part in every job, so none of them reads the task after this.
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_condition_.wait(lock, [this]() { return num_of_pending_workers_ == 0; });
+    task_ = nullptr;
+    return true;
+}
+
+void ThreadPool::Resize(int32_t num_of_workers) {
+    num_of_workers = std::max(num_of_workers, 0);
+    RETURN_IF(static_cast<int32_t>(workers_.size()) == num_of_workers);
+    Stop();
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_stopped_ = false;
+        generation = generation_;
+    }
+    workers_.reserve(num_of_workers);
+    for (int32_t i = 0; i < num_of_workers; ++i) {
+        workers_.emplace_back(&ThreadPool::Work, this, generation);
+    }
+}
+
+void ThreadPool::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_stopped_ = true;
+    }
+    wake_condition_.notify_all();
+    for (auto &worker: workers_) {
+        worker.join();
+    }
+    workers_.clear();
+}
+
+void ThreadPool::Work(uint64_t generation) {
+    IsInTaskOfThread() = true;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_condition_.wait(lock, [&]() { return is_stopped_ || generation_ != generation; });
+        RETURN_IF(is_stopped_);
+        generation = generation_;
+        lock.unlock();
+        RunTasks();
+        lock.lock();
+        if (--num_of_pending_workers_ == 0) {
+            done_condition_.notify_one();
+        }
+    }
+}
+
+void ThreadPool::RunTasks() {
+    for (int32_t index = next_task_index_++; index < num_of_tasks_; index = next_task_index_++) {
+        (*task_)(index);
+    }
+}
+
+}  // namespace image_painter
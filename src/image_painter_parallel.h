@@ -0,0 +1,94 @@
+#ifndef _IMAGE_PAINTER_PARALLEL_H_
+#define _IMAGE_PAINTER_PARALLEL_H_
+
+#include "basic_type.h"
+#include "image_painter.h"
+#include "image_painter_profile.h"
+
+#include "atomic"
+#include "condition_variable"
+#include "functional"
+#include "mutex"
+#include "thread"
+#include "vector"
+
+namespace image_painter {
+
+/* Class ThreadPool Declaration. Workers are started by the first parallel job, and restarted when max number of threads changes. They
+   wait on condition variable between jobs, and are joined at exit. */
+class ThreadPool {
+
+public:
+    static ThreadPool &GetInstance();
+    virtual ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Run task(index) on each index in [0, num_of_tasks) by workers and the calling thread, and return after all tasks are finished.
+    // Return false without running any task if pool is busy with job of another thread, or if it is called inside a task.
+    bool Run(int32_t num_of_tasks, const std::function<void(int32_t)> &task);
+
+private:
+    ThreadPool() = default;
+
+    void Resize(int32_t num_of_workers);
+    void Stop();
+    void Work(uint64_t generation);
+    void RunTasks();
+
+private:
+    // Held by the thread whose job is running.
+    std::mutex job_mutex_;
+    // Guards the job and the state of workers below.
+    std::mutex mutex_;
+    std::condition_variable wake_condition_;
+    std::condition_variable done_condition_;
+    std::vector<std::thread> workers_;
+    const std::function<void(int32_t)> *task_ = nullptr;
+    int32_t num_of_tasks_ = 0;
+    std::atomic<int32_t> next_task_index_{0};
+    int32_t num_of_pending_workers_ = 0;
+    uint64_t generation_ = 0;
+    bool is_stopped_ = false;
+};
+
+// Split [begin, end) into contiguous chunks of at least min_chunk_size items, and run function(chunk_begin, chunk_end) on each
+// of them in parallel by workers of thread pool and the calling thread. This returns after all chunks are finished. Pixels profiled by
+// workers are added to the calling thread, so they are recorded by its profile scope. If pool is busy with job of another thread, or
+// this is called inside a parallel job, function runs on the whole range in the calling thread.
+template <typename Function>
+void ParallelFor(int32_t begin, int32_t end, int32_t min_chunk_size, const Function &function) {
+    RETURN_IF(end <= begin);
+    const int32_t size = end - begin;
+    const int32_t max_num_of_chunks = std::max(1, size / std::max(1, min_chunk_size));
+    const int32_t num_of_chunks = std::min(ImagePainter::GetMaxNumberOfThreads(), max_num_of_chunks);
+    if (num_of_chunks <= 1) {
+        function(begin, end);
+        return;
+    }
+
+    // Chunks run by workers are profiled into their own tallies, and chunks run by the calling thread are profiled directly.
+    const std::thread::id calling_thread_id = std::this_thread::get_id();
+    std::vector<ProfileTally> tallies_of_chunks(num_of_chunks);
+    const bool is_run = ThreadPool::GetInstance().Run(num_of_chunks, [&](int32_t index) {
+        const int32_t chunk_begin = begin + static_cast<int32_t>(static_cast<int64_t>(size) * index / num_of_chunks);
+        const int32_t chunk_end = begin + static_cast<int32_t>(static_cast<int64_t>(size) * (index + 1) / num_of_chunks);
+        if (std::this_thread::get_id() == calling_thread_id) {
+            function(chunk_begin, chunk_end);
+        } else {
+            const ProfileWorkerScope profile_worker_scope(tallies_of_chunks[index]);
+            function(chunk_begin, chunk_end);
+        }
+    });
+    if (!is_run) {
+        function(begin, end);
+        return;
+    }
+    for (const auto &tally: tallies_of_chunks) {
+        MergeProfileTallyIntoThread(tally);
+    }
+}
+
+}  // namespace image_painter
+
+#endif  // end of _IMAGE_PAINTER_PARALLEL_H_
@@ -0,0 +1,157 @@
+#ifndef _IMAGE_PAINTER_PIXEL_H_
+#define _IMAGE_PAINTER_PIXEL_H_
+
+#include "basic_type.h"
+#include "datatype_image.h"
+#include "image_painter_profile.h"
+
+#include "cmath"
+#include "cstring"
+#include "vector"
+
+namespace image_painter {
+
+/* Pixel traits of image, whose pixels are kChannels channels of ChannelType stored in row major order without padding. Images of other
+   pixel types, like rgba, uint16 or float ones, can be drawn by the templates of image_painter_draw.h after specializing it. Blend of
+   integer channels is scaled by kMaxValue. Optional kProfileIndex selects the profile counters of image, which are the other ones by
+   default. */
+template <typename ImageType>
+struct PixelTraits;
+
+template <>
+struct PixelTraits<GrayImage> {
+    using PixelType = uint8_t;
+    using ChannelType = uint8_t;
+    static constexpr int32_t kChannels = 1;
+    static constexpr ChannelType kMaxValue = 255;
+    static constexpr int32_t kProfileIndex = static_cast<int32_t>(ImagePainter::ProfileImageType::kGray);
+    static ChannelType GetChannel(const PixelType &pixel, int32_t) { return pixel; }
+};
+
+template <>
+struct PixelTraits<RgbImage> {
+    using PixelType = RgbPixel;
+    using ChannelType = uint8_t;
+    static constexpr int32_t kChannels = 3;
+    static constexpr ChannelType kMaxValue = 255;
+    static constexpr int32_t kProfileIndex = static_cast<int32_t>(ImagePainter::ProfileImageType::kRgb);
+    static ChannelType GetChannel(const PixelType &pixel, int32_t channel) { return channel == 0 ? pixel.r : (channel == 1 ? pixel.g : pixel.b); }
+};
+
+template <typename ImageType>
+inline constexpr int32_t GetChannelsOfImage(const ImageType &) {
+    return PixelTraits<ImageType>::kChannels;
+}
+
+inline bool IsSamePixelValue(uint8_t a, uint8_t b) { return a == b; }
+inline bool IsSamePixelValue(const RgbPixel &a, const RgbPixel &b) { return a.r == b.r && a.g == b.g && a.b == b.b; }
+
+template <typename ImageType>
+inline typename PixelTraits<ImageType>::ChannelType *GetPixelUnchecked(ImageType &image, int32_t row, int32_t col) {
+    return image.data() + (static_cast<int64_t>(row) * image.cols() + col) * PixelTraits<ImageType>::kChannels;
+}
+
+template <typename ImageType>
+inline void StorePixel(typename PixelTraits<ImageType>::ChannelType *pixel, const typename PixelTraits<ImageType>::PixelType &color) {
+    for (int32_t c = 0; c < PixelTraits<ImageType>::kChannels; ++c) {
+        pixel[c] = PixelTraits<ImageType>::GetChannel(color, c);
+    }
+}
+
+/* Unchecked pixel writes. Callers should clip the pixels into image before. */
+template <typename ImageType>
+inline void SetPixelValueUnchecked(ImageType &image, int32_t row, int32_t col, const typename PixelTraits<ImageType>::PixelType &color) {
+    IMAGE_PAINTER_PROFILE_WRITTEN_PIXELS(1);
+    StorePixel<ImageType>(GetPixelUnchecked(image, row, col), color);
+}
+
+// Fill [col_begin, col_end] of one row. Single byte channel is filled by memset. Otherwise the first pixels are written one by one, and
+// then the pattern is extended by doubling memcpy.
+template <typename ImageType>
+inline void FillSpanUnchecked(ImageType &image, int32_t row, int32_t col_begin, int32_t col_end, const typename PixelTraits<ImageType>::PixelType &color) {
+    using Traits = PixelTraits<ImageType>;
+    IMAGE_PAINTER_PROFILE_WRITTEN_PIXELS(col_end - col_begin + 1);
+    typename Traits::ChannelType *span = GetPixelUnchecked(image, row, col_begin);
+    const int32_t size = col_end - col_begin + 1;
+    if constexpr (Traits::kChannels == 1 && sizeof(typename Traits::ChannelType) == 1) {
+        std::memset(span, Traits::GetChannel(color, 0), size);
+    } else {
+        constexpr int32_t kMinPatternSize = 8;
+        const int32_t pattern_size = std::min(size, kMinPatternSize);
+        for (int32_t i = 0; i < pattern_size; ++i) {
+            StorePixel<ImageType>(span + i * Traits::kChannels, color);
+        }
+        constexpr int32_t kBytesOfPixel = Traits::kChannels * sizeof(typename Traits::ChannelType);
+        for (int32_t filled = pattern_size; filled < size;) {
+            const int32_t copy_size = std::min(filled, size - filled);
+            std::memcpy(span + filled * Traits::kChannels, span, copy_size * kBytesOfPixel);
+            filled += copy_size;
+        }
+    }
+}
+
+// Clip [col_begin, col_end] of one row into image, and fill it.
+template <typename ImageType, typename PixelType>
+inline void FillSpan(ImageType &image, int32_t row, int32_t col_begin, int32_t col_end, const PixelType &color) {
+    RETURN_IF(col_begin > col_end);
+    if (row < 0 || row >= image.rows()) {
+        IMAGE_PAINTER_PROFILE_REJECTED_PIXELS(static_cast<int64_t>(col_end) - col_begin + 1);
+        return;
+    }
+    const int32_t clipped_col_begin = std::max(col_begin, 0);
+    const int32_t clipped_col_end = std::min(col_end, image.cols() - 1);
+    IMAGE_PAINTER_PROFILE_REJECTED_PIXELS(static_cast<int64_t>(col_end) - col_begin + 1 - std::max(clipped_col_end - clipped_col_begin + 1, 0));
+    RETURN_IF(clipped_col_begin > clipped_col_end);
+    FillSpanUnchecked(image, row, clipped_col_begin, clipped_col_end, color);
+}
+
+// Return the max w >= 0 which satisfies w * w <= limit, or -1 if limit is negative. It is the half width of span in circle rasterizers.
+inline int32_t ComputeMaxHalfWidth(int64_t limit) {
+    if (limit < 0) {
+        return -1;
+    }
+    int64_t half_width = static_cast<int64_t>(std::sqrt(static_cast<double>(limit)));
+    while (half_width * half_width > limit) {
+        --half_width;
+    }
+    while ((half_width + 1) * (half_width + 1) <= limit) {
+        ++half_width;
+    }
+    return static_cast<int32_t>(half_width);
+}
+
+// Half widths of rows [-radius + 1, radius - 1] of solid circle sprite, which is the same as DrawSolidCircle.
+inline std::vector<int32_t> ComputeHalfWidthsOfCircleSprite(int32_t radius) {
+    std::vector<int32_t> half_widths(std::max(2 * radius - 1, 0));
+    for (int32_t dy = -radius + 1; dy < radius; ++dy) {
+        half_widths[dy + radius - 1] = ComputeMaxHalfWidth(static_cast<int64_t>(radius) * radius - static_cast<int64_t>(dy) * dy - 1);
+    }
+    return half_widths;
+}
+
+// Clip rectangle [col_begin, col_end] x [row_begin, row_end] into image. Return false if nothing is left.
+template <typename ImageType>
+inline bool ClipRectangle(const ImageType &image, int32_t &row_begin, int32_t &row_end, int32_t &col_begin, int32_t &col_end) {
+    row_begin = std::max(row_begin, 0);
+    row_end = std::min(row_end, image.rows() - 1);
+    col_begin = std::max(col_begin, 0);
+    col_end = std::min(col_end, image.cols() - 1);
+    return row_begin <= row_end && col_begin <= col_end;
+}
+
+// Fill the first row of rectangle, and copy it to the other rows.
+template <typename ImageType, typename PixelType>
+inline void FillRectangleUnchecked(ImageType &image, int32_t row_begin, int32_t row_end, int32_t col_begin, int32_t col_end, const PixelType &color) {
+    using Traits = PixelTraits<ImageType>;
+    FillSpanUnchecked(image, row_begin, col_begin, col_end, color);
+    const typename Traits::ChannelType *first_span = GetPixelUnchecked(image, row_begin, col_begin);
+    const int32_t span_size = (col_end - col_begin + 1) * Traits::kChannels * sizeof(typename Traits::ChannelType);
+    IMAGE_PAINTER_PROFILE_WRITTEN_PIXELS(static_cast<int64_t>(row_end - row_begin) * (col_end - col_begin + 1));
+    for (int32_t row = row_begin + 1; row <= row_end; ++row) {
+        std::memcpy(GetPixelUnchecked(image, row, col_begin), first_span, span_size);
+    }
+}
+
+}  // namespace image_painter
+
+#endif  // end of _IMAGE_PAINTER_PIXEL_H_
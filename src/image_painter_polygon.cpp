@@ -0,0 +1,189 @@
+#include "image_painter_polygon.h"
+#include "image_painter_draw.h"
+
+namespace image_painter {
+
+namespace {
+    constexpr float kPi = 3.14159265358979f;
+    // Direction of segments shorter than this is undefined, so their points are merged.
+    constexpr float kMinSegmentLength = 1e-3f;
+
+    float ComputeSignedArea(const Vec2 *points, int32_t size) {
+        float area = 0.0f;
+        for (int32_t i = 0; i < size; ++i) {
+            const Vec2 &point_s = points[i];
+            const Vec2 &point_e = points[i + 1 == size ? 0 : i + 1];
+            area += point_s.x() * point_e.y() - point_e.x() * point_s.y();
+        }
+        return 0.5f * area;
+    }
+
+    // Regular polygon inscribed in circle. Its vertices are dense enough that its edges are no more than about 2 pixels.
+    void AddDisc(ScanlineFiller &filler, const Vec2 &center, float radius) {
+        constexpr int32_t kMinNumOfVertices = 8;
+        constexpr int32_t kMaxNumOfVertices = 128;
+        const int32_t num_of_vertices = std::min(std::max(static_cast<int32_t>(std::ceil(kPi * radius)), kMinNumOfVertices), kMaxNumOfVertices);
+        std::vector<Vec2> vertices(num_of_vertices);
+        for (int32_t i = 0; i < num_of_vertices; ++i) {
+            const float angle = 2.0f * kPi * static_cast<float>(i) / static_cast<float>(num_of_vertices);
+            vertices[i] = center + radius * Vec2(std::cos(angle), std::sin(angle));
+        }
+        filler.AddConvexContour(vertices.data(), num_of_vertices);
+    }
+
+    // Quad of segment, which covers points whose distance to the segment line is less than half width.
+    void AddSegment(ScanlineFiller &filler, const Vec2 &point_s, const Vec2 &point_e, float half_width) {
+        const Vec2 direction = (point_e - point_s).normalized();
+        const Vec2 offset = half_width * Vec2(-direction.y(), direction.x());
+        const Vec2 quad[4] = {point_s + offset, point_e + offset, point_e - offset, point_s - offset};
+        filler.AddConvexContour(quad, 4);
+    }
+
+    // Join fills the gap between quads of two segments at the outer side of their vertex.
+    void AddJoin(ScanlineFiller &filler, const Vec2 &point_prev, const Vec2 &point, const Vec2 &point_next, float half_width,
+                 ImagePainter::LineJoin join) {
+        if (join == ImagePainter::LineJoin::kRound) {
+            AddDisc(filler, point, half_width);
+            return;
+        }
+
+        const Vec2 direction_in = (point - point_prev).normalized();
+        const Vec2 direction_out = (point_next - point).normalized();
+        const float cross = direction_in.x() * direction_out.y() - direction_in.y() * direction_out.x();
+        const float dot = direction_in.dot(direction_out);
+        // Straight vertex needs no join.
+        RETURN_IF(std::fabs(cross) < 1e-6f && dot > 0.0f);
+
+        // Outer side is against the turn direction.
+        const float side = cross > 0.0f ? -half_width : half_width;
+        const Vec2 normal_in = Vec2(-direction_in.y(), direction_in.x());
+        const Vec2 normal_out = Vec2(-direction_out.y(), direction_out.x());
+        const Vec2 corner_in = point + side * normal_in;
+        const Vec2 corner_out = point + side * normal_out;
+
+        // Miter length is half_width / cos(theta / 2), where |normal_in + normal_out| is 2 * cos(theta / 2).
+        const Vec2 bisector = normal_in + normal_out;
+        const float bisector_norm_2 = bisector.squaredNorm();
+        if (join == ImagePainter::LineJoin::kMiter && bisector_norm_2 > 0.0f &&
+            2.0f / std::sqrt(bisector_norm_2) <= ImagePainter::kMaxMiterRatio) {
+            const Vec2 quad[4] = {point, corner_in, point + side * bisector * (2.0f / bisector_norm_2), corner_out};
+            filler.AddConvexContour(quad, 4);
+        } else {
+            const Vec2 triangle[3] = {point, corner_in, corner_out};
+            filler.AddConvexContour(triangle, 3);
+        }
+    }
+}  // namespace
+
+void AddStrokeOfPolyline(ScanlineFiller &filler, const ImagePainter::PointsBatch &points, float half_width, bool is_closed,
+                         ImagePainter::LineJoin join, ImagePainter::LineCap cap) {
+    // Merge duplicated neighbor points, since they have no direction.
+    std::vector<Vec2> vertices;
+    vertices.reserve(points.rows());
+    for (int32_t i = 0; i < points.rows(); ++i) {
+        const Vec2 point(static_cast<float>(points(i, 0)), static_cast<float>(points(i, 1)));
+        CONTINUE_IF(!vertices.empty() && (point - vertices.back()).norm() < kMinSegmentLength);
+        vertices.emplace_back(point);
+    }
+    if (is_closed && vertices.size() > 2 && (vertices.front() - vertices.back()).norm() < kMinSegmentLength) {
+        vertices.pop_back();
+    }
+    const int32_t size = static_cast<int32_t>(vertices.size());
+    RETURN_IF(size == 0);
+
+    // Single point is covered by its caps only.
+    if (size == 1) {
+        if (cap == ImagePainter::LineCap::kRound) {
+            AddDisc(filler, vertices.front(), half_width);
+        } else if (cap == ImagePainter::LineCap::kSquare) {
+            const Vec2 &point = vertices.front();
+            const Vec2 square[4] = {point + Vec2(-half_width, -half_width), point + Vec2(half_width, -half_width),
+                                    point + Vec2(half_width, half_width), point + Vec2(-half_width, half_width)};
+            filler.AddConvexContour(square, 4);
+        }
+        return;
+    }
+
+    is_closed = is_closed && size > 2;
+    if (!is_closed) {
+        if (cap == ImagePainter::LineCap::kSquare) {
+            vertices.front() -= half_width * (vertices[1] - vertices.front()).normalized();
+            vertices.back() += half_width * (vertices.back() - vertices[size - 2]).normalized();
+        } else if (cap == ImagePainter::LineCap::kRound) {
+            AddDisc(filler, vertices.front(), half_width);
+            AddDisc(filler, vertices.back(), half_width);
+        }
+    }
+
+    const int32_t num_of_segments = is_closed ? size : size - 1;
+    for (int32_t i = 0; i < num_of_segments; ++i) {
+        AddSegment(filler, vertices[i], vertices[(i + 1) % size], half_width);
+    }
+    const int32_t idx_begin = is_closed ? 0 : 1;
+    const int32_t idx_end = is_closed ? size : size - 1;
+    for (int32_t i = idx_begin; i < idx_end; ++i) {
+        AddJoin(filler, vertices[(i + size - 1) % size], vertices[i], vertices[(i + 1) % size], half_width, join);
+    }
+}
+
+void ScanlineFiller::AddEdge(const Vec2 &point_s, const Vec2 &point_e) {
+    // Horizontal edge crosses no scanline.
+    RETURN_IF(point_s.y() == point_e.y());
+
+    const bool is_downward = point_s.y() < point_e.y();
+    const Vec2 &point_top = is_downward ? point_s : point_e;
+    const Vec2 &point_bottom = is_downward ? point_e : point_s;
+    Edge edge;
+    edge.x_top = point_top.x();
+    edge.y_top = point_top.y();
+    edge.dx_dy = (point_bottom.x() - point_top.x()) / (point_bottom.y() - point_top.y());
+    // Scanline of row crosses edge if y_top <= row < y_bottom.
+    constexpr float kMaxRow = static_cast<float>(1 << 30);
+    edge.row_begin = static_cast<int32_t>(std::ceil(std::min(std::max(point_top.y(), -kMaxRow), kMaxRow)));
+    edge.row_end = static_cast<int32_t>(std::ceil(std::min(std::max(point_bottom.y(), -kMaxRow), kMaxRow))) - 1;
+    edge.winding = is_downward ? 1 : -1;
+    RETURN_IF(edge.row_begin > edge.row_end);
+    edges_.emplace_back(edge);
+}
+
+void ScanlineFiller::AddContour(const Vec2 *points, int32_t size) {
+    RETURN_IF(points == nullptr || size < 3);
+    for (int32_t i = 0; i < size; ++i) {
+        AddEdge(points[i], points[i + 1 == size ? 0 : i + 1]);
+    }
+}
+
+void ScanlineFiller::AddConvexContour(const Vec2 *points, int32_t size) {
+    RETURN_IF(points == nullptr || size < 3);
+    if (ComputeSignedArea(points, size) >= 0.0f) {
+        AddContour(points, size);
+        return;
+    }
+    // Reverse each edge of contour.
+    for (int32_t i = 0; i < size; ++i) {
+        AddEdge(points[i + 1 == size ? 0 : i + 1], points[i]);
+    }
+}
+
+// Gray, rgb and yuv420 images are instantiated here, while the definitions are in image_painter_draw.h.
+template void ImagePainter::DrawSolidPolygon<GrayImage, uint8_t>(GrayImage &image, const PointsBatch &points, const uint8_t &color, const Blend &blend);
+template void ImagePainter::DrawSolidPolygon<RgbImage, RgbPixel>(RgbImage &image, const PointsBatch &points, const RgbPixel &color, const Blend &blend);
+template void ImagePainter::DrawSolidPolygon<Yuv420Image, ImagePainter::YuvPixel>(Yuv420Image &image, const PointsBatch &points, const YuvPixel &color,
+                                                                                  const Blend &blend);
+
+template void ImagePainter::DrawThickLine<GrayImage, uint8_t>(GrayImage &image, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t line_width,
+                                                              const uint8_t &color, LineCap cap, const Blend &blend);
+template void ImagePainter::DrawThickLine<RgbImage, RgbPixel>(RgbImage &image, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t line_width,
+                                                              const RgbPixel &color, LineCap cap, const Blend &blend);
+template void ImagePainter::DrawThickLine<Yuv420Image, ImagePainter::YuvPixel>(Yuv420Image &image, int32_t x1, int32_t y1, int32_t x2, int32_t y2,
+                                                                               int32_t line_width, const YuvPixel &color, LineCap cap, const Blend &blend);
+
+template void ImagePainter::DrawThickPolyline<GrayImage, uint8_t>(GrayImage &image, const PointsBatch &points, int32_t line_width, const uint8_t &color,
+                                                                  bool is_closed, LineJoin join, LineCap cap, const Blend &blend);
+template void ImagePainter::DrawThickPolyline<RgbImage, RgbPixel>(RgbImage &image, const PointsBatch &points, int32_t line_width, const RgbPixel &color,
+                                                                  bool is_closed, LineJoin join, LineCap cap, const Blend &blend);
+template void ImagePainter::DrawThickPolyline<Yuv420Image, ImagePainter::YuvPixel>(Yuv420Image &image, const PointsBatch &points, int32_t line_width,
+                                                                                   const YuvPixel &color, bool is_closed, LineJoin join, LineCap cap,
+                                                                                   const Blend &blend);
+
+}  // namespace image_painter
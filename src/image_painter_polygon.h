@@ -0,0 +1,121 @@
+#ifndef _IMAGE_PAINTER_POLYGON_H_
+#define _IMAGE_PAINTER_POLYGON_H_
+
+#include "basic_type.h"
+#include "image_painter.h"
+
+#include "algorithm"
+#include "cmath"
+
+namespace image_painter {
+
+/* Class ScanlineFiller Declaration. It fills union of contours by nonzero winding rule with an active edge table. Pixel (row, col) is
+   covered if point (col, row) is inside, where edges are top-inclusive and left-inclusive. So each covered pixel is written once, even if
+   it is covered by many contours, and polygon (0, 0) - (w, 0) - (w, h) - (0, h) covers the same pixels as DrawSolidRectangle(0, 0, w, h). */
+class ScanlineFiller {
+
+public:
+    struct Edge {
+        float x_top = 0.0f;
+        float y_top = 0.0f;
+        float dx_dy = 0.0f;
+        // Covered rows [row_begin, row_end].
+        int32_t row_begin = 0;
+        int32_t row_end = 0;
+        // 1 if edge goes downward, or -1 if it goes upward.
+        int32_t winding = 1;
+    };
+
+public:
+    ScanlineFiller() = default;
+    virtual ~ScanlineFiller() = default;
+
+    void AddEdge(const Vec2 &point_s, const Vec2 &point_e);
+    // Closed contour. Orientation of contours decides the winding, so holes should be reversed against their outer contour.
+    void AddContour(const Vec2 *points, int32_t size);
+    // Convex contour is reoriented, so all convex contours are unioned whatever their orientations are.
+    void AddConvexContour(const Vec2 *points, int32_t size);
+    void Clear() { edges_.clear(); }
+
+    // Run fill_span(row, col_begin, col_end) for each covered span inside [0, rows) x [0, cols), in row major order.
+    template <typename Function>
+    void Fill(int32_t rows, int32_t cols, const Function &fill_span) const;
+
+    const std::vector<Edge> &edges() const { return edges_; }
+
+private:
+    std::vector<Edge> edges_;
+};
+
+// Clamp float coordinate into int32_t, keeping it out of [0, size) if it is.
+inline int32_t ClampToPixelRange(float value, int32_t size) {
+    return static_cast<int32_t>(std::min(std::max(value, -1.0f), static_cast<float>(size)));
+}
+
+// Add stroke of polyline with half width, joins and caps into filler. Neighbor points which are too close are merged.
+void AddStrokeOfPolyline(ScanlineFiller &filler, const ImagePainter::PointsBatch &points, float half_width, bool is_closed,
+                         ImagePainter::LineJoin join, ImagePainter::LineCap cap);
+
+/* Class ScanlineFiller Definition. */
+template <typename Function>
+void ScanlineFiller::Fill(int32_t rows, int32_t cols, const Function &fill_span) const {
+    const int32_t num_of_edges = static_cast<int32_t>(edges_.size());
+    RETURN_IF(num_of_edges == 0 || rows <= 0 || cols <= 0);
+
+    // Edge table, sorted by first covered row.
+    std::vector<int32_t> edge_table(num_of_edges);
+    for (int32_t i = 0; i < num_of_edges; ++i) {
+        edge_table[i] = i;
+    }
+    std::sort(edge_table.begin(), edge_table.end(), [&](int32_t a, int32_t b) { return edges_[a].row_begin < edges_[b].row_begin; });
+
+    std::vector<int32_t> active_edges;
+    std::vector<std::pair<float, int32_t>> crossings;
+    int32_t next = 0;
+    int32_t row = std::max(edges_[edge_table.front()].row_begin, 0);
+    while (row < rows) {
+        // Update active edges of this row.
+        while (next < num_of_edges && edges_[edge_table[next]].row_begin <= row) {
+            active_edges.emplace_back(edge_table[next]);
+            ++next;
+        }
+        active_edges.erase(std::remove_if(active_edges.begin(), active_edges.end(), [&](int32_t i) { return edges_[i].row_end < row; }),
+                           active_edges.end());
+        if (active_edges.empty()) {
+            if (next == num_of_edges) {
+                break;
+            }
+            row = edges_[edge_table[next]].row_begin;
+            continue;
+        }
+
+        // Crossings of this row are sorted by x, and spans are where winding number is nonzero.
+        crossings.clear();
+        for (const int32_t i: active_edges) {
+            const Edge &edge = edges_[i];
+            crossings.emplace_back(edge.x_top + (static_cast<float>(row) - edge.y_top) * edge.dx_dy, edge.winding);
+        }
+        std::sort(crossings.begin(), crossings.end());
+        int32_t winding = 0;
+        int32_t col_begin = 0;
+        for (const auto &crossing: crossings) {
+            const int32_t col = ClampToPixelRange(std::ceil(crossing.first), cols);
+            if (winding == 0) {
+                col_begin = col;
+            }
+            winding += crossing.second;
+            if (winding == 0) {
+                const int32_t span_begin = std::max(col_begin, 0);
+                const int32_t span_end = std::min(col - 1, cols - 1);
+                if (span_begin <= span_end) {
+                    fill_span(row, span_begin, span_end);
+                }
+            }
+        }
+        ++row;
+    }
+}
+
+}  // namespace image_painter
+
+#endif  // end of _IMAGE_PAINTER_POLYGON_H_
@@ -0,0 +1,150 @@
+#include "image_painter_profile.h"
+
+#include "slam_log_reporter.h"
+
+#include "algorithm"
+#include "vector"
+
+namespace image_painter {
+
+namespace {
+    ImagePainter::ProfileSnapshot &GetProfileSnapshotOfThread() {
+        thread_local ImagePainter::ProfileSnapshot snapshot = {};
+        return snapshot;
+    }
+}  // namespace
+
+void ProfileScope::Begin(ImagePainter::Primitive primitive, int32_t index_of_image) {
+    is_active_ = true;
+    is_recorded_ = GetProfileDepthOfThread() == 0;
+    ++GetProfileDepthOfThread();
+    RETURN_IF(!is_recorded_);
+    primitive_ = primitive;
+    index_of_image_ = index_of_image;
+    tally_begin_ = GetProfileTallyOfThread();
+    time_begin_ = std::chrono::steady_clock::now();
+}
+
+void ProfileScope::End() {
+    --GetProfileDepthOfThread();
+    RETURN_IF(!is_recorded_);
+    const ProfileTally &tally = GetProfileTallyOfThread();
+    ImagePainter::ProfileCounter &counter = GetProfileSnapshotOfThread()[static_cast<int32_t>(primitive_)][index_of_image_];
+    ++counter.num_of_calls;
+    counter.num_of_written_pixels += tally.num_of_written_pixels - tally_begin_.num_of_written_pixels;
+    counter.num_of_rejected_pixels += tally.num_of_rejected_pixels - tally_begin_.num_of_rejected_pixels;
+    counter.time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - time_begin_).count();
+}
+
+bool ImagePainter::IsProfilingSupported() {
+#ifdef IMAGE_PAINTER_ENABLE_PROFILE
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool ImagePainter::SetProfilingEnabled(bool is_enabled) {
+    if (!IsProfilingSupported()) {
+        return false;
+    }
+    ProfilingEnabledFlag().store(is_enabled, std::memory_order_relaxed);
+    return true;
+}
+
+bool ImagePainter::IsProfilingEnabled() { return IsProfilingActive(); }
+
+ImagePainter::ProfileSnapshot ImagePainter::GetProfileSnapshot() { return GetProfileSnapshotOfThread(); }
+
+void ImagePainter::ResetProfile() { GetProfileSnapshotOfThread() = ProfileSnapshot{}; }
+
+const char *ImagePainter::GetNameOfPrimitive(Primitive primitive) {
+    static const char *names[] = {
+        "DrawSolidRectangle",
+        "DrawSolidRectangles",
+        "DrawHollowRectangle",
+        "DrawBressenhanLine",
+        "DrawNaiveLine",
+        "DrawDashedLine",
+        "DrawSolidCircle",
+        "DrawHollowCircle",
+        "DrawMidBresenhamEllipse",
+        "DrawSolidEllipse",
+        "DrawTrustRegionOfGaussian",
+        "DrawSolidTrustRegionOfGaussian",
+        "DrawCharacter",
+        "DrawString",
+        "DrawSolidPolygon",
+        "DrawThickLine",
+        "DrawThickPolyline",
+        "DrawPoints",
+        "DrawLines",
+        "DrawCircles",
+        "DrawPolyline",
+        "DrawTrustRegionsOfGaussian",
+        "DrawStrings",
+        "RenderTextInCameraView",
+        "RenderPointInCameraView",
+        "RenderPointsInCameraView",
+        "RenderPointsInCameraView(SpatialIndex)",
+        "RenderLineSegmentInCameraView",
+        "RenderLineSegmentsInCameraView(SpatialIndex)",
+        "RenderDashedLineSegmentInCameraView",
+        "RenderEllipseInCameraView",
+        "RenderEllipsesInCameraView",
+        "RenderContext::RenderPointInCameraView",
+        "RenderContext::RenderPointsInCameraView",
+        "RenderContext::RenderPointsInCameraViewWithDepthColor",
+        "RenderContext::RenderLineSegmentInCameraView",
+        "RenderContext::RenderEllipseInCameraView",
+        "DisplayList::Flush",
+        "RetainedCanvas::Present",
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(Primitive::kNumOfPrimitives), "Each primitive should have its name.");
+    const int32_t index = static_cast<int32_t>(primitive);
+    return index >= 0 && index < static_cast<int32_t>(Primitive::kNumOfPrimitives) ? names[index] : "Unknown";
+}
+
+const char *ImagePainter::GetNameOfProfileImageType(ProfileImageType type) {
+    static const char *names[] = {
+        "gray",
+        "rgb",
+        "yuv420",
+        "other",
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(ProfileImageType::kNumOfProfileImageTypes),
+                  "Each profile image type should have its name.");
+    const int32_t index = static_cast<int32_t>(type);
+    return index >= 0 && index < static_cast<int32_t>(ProfileImageType::kNumOfProfileImageTypes) ? names[index] : "unknown";
+}
+
+void ImagePainter::ReportProfile(const ProfileSnapshot &snapshot) {
+    struct Item {
+        int32_t primitive = 0;
+        int32_t index_of_image = 0;
+    };
+    std::vector<Item> items;
+    int64_t total_time_ns = 0;
+    for (int32_t i = 0; i < static_cast<int32_t>(snapshot.size()); ++i) {
+        for (int32_t j = 0; j < static_cast<int32_t>(snapshot[i].size()); ++j) {
+            CONTINUE_IF(snapshot[i][j].num_of_calls == 0);
+            items.emplace_back(Item{i, j});
+            total_time_ns += snapshot[i][j].time_ns;
+        }
+    }
+    std::stable_sort(items.begin(), items.end(), [&](const Item &a, const Item &b) {
+        return snapshot[a.primitive][a.index_of_image].time_ns > snapshot[b.primitive][b.index_of_image].time_ns;
+    });
+
+    ReportInfo("[ImagePainter] Profile of " << items.size() << " primitives, total time " << static_cast<float>(total_time_ns) * 1e-6f << " ms.");
+    for (const auto &item: items) {
+        const ProfileCounter &counter = snapshot[item.primitive][item.index_of_image];
+        const float ratio = total_time_ns > 0 ? static_cast<float>(counter.time_ns) / static_cast<float>(total_time_ns) * 100.0f : 0.0f;
+        ReportInfo("[ImagePainter]   " << GetNameOfPrimitive(static_cast<Primitive>(item.primitive)) << " ("
+                                       << GetNameOfProfileImageType(static_cast<ProfileImageType>(item.index_of_image)) << "): calls " << counter.num_of_calls
+                                       << ", written pixels " << counter.num_of_written_pixels << ", rejected pixels " << counter.num_of_rejected_pixels
+                                       << ", time " << static_cast<float>(counter.time_ns) * 1e-6f << " ms (" << ratio << "%).");
+    }
+}
+
+}  // namespace image_painter
@@ -0,0 +1,143 @@
+#ifndef _IMAGE_PAINTER_PROFILE_H_
+#define _IMAGE_PAINTER_PROFILE_H_
+
+#include "basic_type.h"
+#include "datatype_image.h"
+#include "image_painter.h"
+
+#include "atomic"
+#include "chrono"
+#include "type_traits"
+
+namespace image_painter {
+
+// Pixels written and rejected by pixel writers of one thread. Profile scopes record the difference between their begin and end.
+struct ProfileTally {
+    int64_t num_of_written_pixels = 0;
+    int64_t num_of_rejected_pixels = 0;
+};
+
+inline std::atomic<bool> &ProfilingEnabledFlag() {
+    static std::atomic<bool> is_enabled(false);
+    return is_enabled;
+}
+
+inline bool IsProfilingActive() { return ProfilingEnabledFlag().load(std::memory_order_relaxed); }
+
+inline ProfileTally &GetProfileTallyOfThread() {
+    thread_local ProfileTally tally;
+    return tally;
+}
+
+// Depth of profile scopes in this thread. Only the outermost scope is recorded.
+inline int32_t &GetProfileDepthOfThread() {
+    thread_local int32_t depth = 0;
+    return depth;
+}
+
+inline void AddProfileWrittenPixels(int64_t num_of_pixels) {
+    if (IsProfilingActive()) {
+        GetProfileTallyOfThread().num_of_written_pixels += num_of_pixels;
+    }
+}
+
+inline void AddProfileRejectedPixels(int64_t num_of_pixels) {
+    if (IsProfilingActive()) {
+        GetProfileTallyOfThread().num_of_rejected_pixels += num_of_pixels;
+    }
+}
+
+template <typename ImageType>
+struct PixelTraits;
+
+template <typename Traits, typename = void>
+struct ProfileIndexOfTraits {
+    static constexpr int32_t kValue = static_cast<int32_t>(ImagePainter::ProfileImageType::kOther);
+};
+
+template <typename Traits>
+struct ProfileIndexOfTraits<Traits, std::void_t<decltype(Traits::kProfileIndex)>> {
+    static constexpr int32_t kValue = Traits::kProfileIndex;
+};
+
+// Images are profiled by kProfileIndex of their PixelTraits, or as other if it is not given.
+template <typename ImageType>
+inline int32_t GetProfileIndexOfImage(const ImageType &) {
+    return ProfileIndexOfTraits<PixelTraits<ImageType>>::kValue;
+}
+
+/* Class ProfileScope Declaration. It records one call of primitive when profiling is enabled, with the pixels written and rejected by this
+   thread during its life. */
+class ProfileScope {
+
+public:
+    ProfileScope(ImagePainter::Primitive primitive, int32_t index_of_image) {
+        RETURN_IF(!IsProfilingActive());
+        Begin(primitive, index_of_image);
+    }
+    virtual ~ProfileScope() {
+        RETURN_IF(!is_active_);
+        End();
+    }
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    void Begin(ImagePainter::Primitive primitive, int32_t index_of_image);
+    void End();
+
+private:
+    bool is_active_ = false;
+    bool is_recorded_ = false;
+    ImagePainter::Primitive primitive_ = ImagePainter::Primitive::kSolidRectangle;
+    int32_t index_of_image_ = 0;
+    ProfileTally tally_begin_;
+    std::chrono::steady_clock::time_point time_begin_;
+};
+
+/* Class ProfileWorkerScope Declaration. Worker threads of parallel jobs are nested in the profile scope of the calling thread. Their
+   pixels are output into tally, which should be added to the calling thread after join. */
+class ProfileWorkerScope {
+
+public:
+    explicit ProfileWorkerScope(ProfileTally &tally) : tally_(tally) {
+        RETURN_IF(!IsProfilingActive());
+        is_active_ = true;
+        ++GetProfileDepthOfThread();
+        tally_begin_ = GetProfileTallyOfThread();
+    }
+    virtual ~ProfileWorkerScope() {
+        RETURN_IF(!is_active_);
+        --GetProfileDepthOfThread();
+        tally_.num_of_written_pixels = GetProfileTallyOfThread().num_of_written_pixels - tally_begin_.num_of_written_pixels;
+        tally_.num_of_rejected_pixels = GetProfileTallyOfThread().num_of_rejected_pixels - tally_begin_.num_of_rejected_pixels;
+    }
+    ProfileWorkerScope(const ProfileWorkerScope &) = delete;
+    ProfileWorkerScope &operator=(const ProfileWorkerScope &) = delete;
+
+private:
+    ProfileTally &tally_;
+    ProfileTally tally_begin_;
+    bool is_active_ = false;
+};
+
+inline void MergeProfileTallyIntoThread(const ProfileTally &tally) {
+    GetProfileTallyOfThread().num_of_written_pixels += tally.num_of_written_pixels;
+    GetProfileTallyOfThread().num_of_rejected_pixels += tally.num_of_rejected_pixels;
+}
+
+}  // namespace image_painter
+
+// Profiling hooks, which are compiled out without IMAGE_PAINTER_ENABLE_PROFILE.
+#ifdef IMAGE_PAINTER_ENABLE_PROFILE
+#define IMAGE_PAINTER_PROFILE_SCOPE(primitive, image) \
+    const ProfileScope profile_scope(ImagePainter::Primitive::primitive, GetProfileIndexOfImage(image))
+#define IMAGE_PAINTER_PROFILE_WRITTEN_PIXELS(num_of_pixels) AddProfileWrittenPixels(num_of_pixels)
+#define IMAGE_PAINTER_PROFILE_REJECTED_PIXELS(num_of_pixels) AddProfileRejectedPixels(num_of_pixels)
+#else
+#define IMAGE_PAINTER_PROFILE_SCOPE(primitive, image)
+#define IMAGE_PAINTER_PROFILE_WRITTEN_PIXELS(num_of_pixels)
+#define IMAGE_PAINTER_PROFILE_REJECTED_PIXELS(num_of_pixels)
+#endif
+
+#endif  // end of _IMAGE_PAINTER_PROFILE_H_
@@ -0,0 +1,269 @@
+#ifndef _IMAGE_PAINTER_RASTER_H_
+#define _IMAGE_PAINTER_RASTER_H_
+
+#include "basic_type.h"
+#include "slam_operations.h"
+
+#include "algorithm"
+#include "array"
+#include "cmath"
+
+namespace image_painter {
+
+inline int64_t FloorDiv(int64_t a, int64_t b) { return a / b - ((a % b != 0) && ((a < 0) != (b < 0))); }
+inline int64_t CeilDiv(int64_t a, int64_t b) { return a / b + ((a % b != 0) && ((a < 0) == (b < 0))); }
+
+// Floor and ceil of (2 * a * b + c) / (2 * d), where a and b are in [0, 2^32), d is positive and a * b / d fits in int64. Product a * b is
+// formed in uint64, so it does not overflow like 2 * a * b in int64.
+inline int64_t FloorDivOfDoubledProduct(int64_t a, int64_t b, int64_t c, int64_t d) {
+    const uint64_t product = static_cast<uint64_t>(a) * static_cast<uint64_t>(b);
+    const int64_t remainder = static_cast<int64_t>(product % static_cast<uint64_t>(d));
+    return static_cast<int64_t>(product / static_cast<uint64_t>(d)) + FloorDiv(2 * remainder + c, 2 * d);
+}
+inline int64_t CeilDivOfDoubledProduct(int64_t a, int64_t b, int64_t c, int64_t d) {
+    const uint64_t product = static_cast<uint64_t>(a) * static_cast<uint64_t>(b);
+    const int64_t remainder = static_cast<int64_t>(product % static_cast<uint64_t>(d));
+    return static_cast<int64_t>(product / static_cast<uint64_t>(d)) + CeilDiv(2 * remainder + c, 2 * d);
+}
+
+// Narrow [begin, end] to the steps k, whose coordinate start + k * step is inside [0, size - 1]. Step should not be zero.
+inline void ClipStepsInAxis(int64_t start, int64_t step, int64_t size, int64_t &begin, int64_t &end) {
+    if (step > 0) {
+        begin = std::max(begin, CeilDiv(-start, step));
+        end = std::min(end, FloorDiv(size - 1 - start, step));
+    } else {
+        begin = std::max(begin, CeilDiv(start - size + 1, -step));
+        end = std::min(end, FloorDiv(start, -step));
+    }
+}
+
+// Visit pixels of bresenham line which are inside [0, rows) x [0, cols), by function(row, col, step, num_of_steps). Pixel of step k is at
+// k / num_of_steps of the line, so attributes like depth can be interpolated.
+template <typename Function>
+void TraverseBressenhanLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t rows, int32_t cols, const Function &function) {
+    int64_t delta_x = static_cast<int64_t>(x2) - x1;
+    int64_t delta_y = static_cast<int64_t>(y2) - y1;
+    bool is_larger_than_45_deg = false;
+    if (std::abs(delta_x) < std::abs(delta_y)) {
+        is_larger_than_45_deg = true;
+        SlamOperation::ExchangeValue(x1, y1);
+        SlamOperation::ExchangeValue(delta_x, delta_y);
+    }
+
+    // Precompute some temp variables. Deltas are in [0, 2^32), so products of two deltas fit in uint64 but not in int64 after doubling.
+    const int64_t dx = std::abs(delta_x);
+    const int64_t dy = std::abs(delta_y);
+    const int32_t ix = delta_x > 0 ? 1 : -1;
+    const int32_t iy = delta_y > 0 ? 1 : -1;
+    const int32_t major_size = is_larger_than_45_deg ? rows : cols;
+    const int32_t minor_size = is_larger_than_45_deg ? cols : rows;
+
+    // Step k in [0, dx) draws pixel (x1 + k * ix, y1 + s(k + 1) * iy), where s(k) = floor((2 * dy * k + dx) / (2 * dx)) is the number of
+    // minor steps before step k. Clip the steps into image with these exact integer coordinates, so visible pixels are unchanged.
+    int64_t step_begin = 0;
+    int64_t step_end = dx - 1;
+    ClipStepsInAxis(x1, ix, major_size, step_begin, step_end);
+    if (dy == 0) {
+        RETURN_IF(y1 < 0 || y1 >= minor_size);
+    } else {
+        // Minor steps s(k + 1) are in [0, dy], so bounds of visible minor steps are only applied inside it, where products are bounded.
+        const int64_t s_min = iy > 0 ? -static_cast<int64_t>(y1) : static_cast<int64_t>(y1) - minor_size + 1;
+        const int64_t s_max = iy > 0 ? static_cast<int64_t>(minor_size) - 1 - y1 : static_cast<int64_t>(y1);
+        RETURN_IF(s_min > dy || s_max < 0);
+        if (s_min > 0) {
+            step_begin = std::max(step_begin, CeilDivOfDoubledProduct(dx, s_min, -dx, dy) - 1);
+        }
+        if (s_max < dy) {
+            step_end = std::min(step_end, FloorDivOfDoubledProduct(dx, s_max + 1, -dx - 1, dy) - 1);
+        }
+    }
+    RETURN_IF(step_begin > step_end);
+
+    // Restore the state before the first visible step. Error term 2 * (dy * step_begin - dx * num_of_minor_steps) is within [-dx, dx], so
+    // it is exact in wrapped uint64 arithmetic.
+    const int64_t dy_2 = dy * 2;
+    const int64_t dy_dx_2 = (dy - dx) * 2;
+    const int64_t num_of_minor_steps = FloorDivOfDoubledProduct(dy, step_begin, dx, dx);
+    const int64_t error_of_begin = static_cast<int64_t>(static_cast<uint64_t>(dy) * static_cast<uint64_t>(step_begin) -
+                                                        static_cast<uint64_t>(dx) * static_cast<uint64_t>(num_of_minor_steps));
+    int64_t dy_2_dx = dy_2 - dx + 2 * error_of_begin;
+    int32_t cx = static_cast<int32_t>(x1 + step_begin * ix);
+    int32_t cy = static_cast<int32_t>(y1 + num_of_minor_steps * iy);
+
+    // Draw line.
+    for (int64_t k = step_begin; k <= step_end; ++k) {
+        if (dy_2_dx < 0) {
+            dy_2_dx += dy_2;
+        } else {
+            cy += iy;
+            dy_2_dx += dy_dx_2;
+        }
+
+        if (is_larger_than_45_deg) {
+            function(cx, cy, k, dx);
+        } else {
+            function(cy, cx, k, dx);
+        }
+        cx += ix;
+    }
+}
+
+/* Conic of gaussian trust region, which is d^T * covariance^-1 * d <= r^2 with d = (col, row) - center and r = 0.5 * sigma_scale. It is
+   evaluated without inverse or eigen decomposition: chord of row dy is centered at dx = cov_xy / cov_yy * dy, and its half width is
+   sqrt(det * (r^2 * cov_yy - dy^2)) / cov_yy. Pixel is inside if its center is on the chord. */
+struct GaussianConic {
+    double center_x = 0.0;
+    double center_y = 0.0;
+    // Shift of chord center per row.
+    double shift = 0.0;
+    double det = 0.0;
+    double radius_2 = 0.0;
+    double cov_xx = 0.0;
+    double cov_yy = 0.0;
+    // Rows [row_min, row_max] of ellipse.
+    int64_t row_min = 0;
+    int64_t row_max = -1;
+    // Ellipse which covers no pixel center in y is kept as its middle chord in the nearest row.
+    bool is_single_row = false;
+};
+
+// Span [col_begin, col_end] in one row, which is empty if col_begin > col_end.
+struct RowSpan {
+    int64_t col_begin = 1;
+    int64_t col_end = 0;
+
+    bool IsEmpty() const { return col_begin > col_end; }
+};
+
+// Return false if covariance is not finite or not positive semi-definite. Only lower triangle of covariance is read.
+inline bool ComputeGaussianConic(const Vec2 &center, const Mat2 &covariance, const float sigma_scale, GaussianConic &conic) {
+    // Coordinates are clamped far out of any image, so spans can be cast into int32_t.
+    constexpr double kMaxCoordinate = static_cast<double>(1 << 30);
+    conic.center_x = center.x();
+    conic.center_y = center.y();
+    conic.cov_xx = covariance(0, 0);
+    conic.cov_yy = covariance(1, 1);
+    const double cov_xy = covariance(1, 0);
+    RETURN_FALSE_IF(!std::isfinite(conic.center_x) || !std::isfinite(conic.center_y) || !std::isfinite(conic.cov_xx) || !std::isfinite(conic.cov_yy) ||
+                    !std::isfinite(cov_xy) || !std::isfinite(sigma_scale));
+    RETURN_FALSE_IF(conic.cov_xx < 0.0 || conic.cov_yy < 0.0);
+    // Tiny negative determinant comes from rounding of degenerate covariance.
+    conic.det = conic.cov_xx * conic.cov_yy - cov_xy * cov_xy;
+    RETURN_FALSE_IF(conic.det < -1e-6 * conic.cov_xx * conic.cov_yy - 1e-12);
+    conic.det = std::max(conic.det, 0.0);
+    conic.radius_2 = 0.25 * static_cast<double>(sigma_scale) * sigma_scale;
+
+    // Horizontal ellipse has no valid shift, and its middle chord is its major axis.
+    constexpr double kMinCovariance = 1e-12;
+    const double half_height = std::sqrt(conic.radius_2 * conic.cov_yy);
+    conic.shift = conic.cov_yy > kMinCovariance ? cov_xy / conic.cov_yy : 0.0;
+    conic.row_min = static_cast<int64_t>(std::ceil(std::max(conic.center_y - half_height, -kMaxCoordinate)));
+    conic.row_max = static_cast<int64_t>(std::floor(std::min(conic.center_y + half_height, kMaxCoordinate)));
+    conic.is_single_row = conic.cov_yy <= kMinCovariance || conic.row_min > conic.row_max;
+    if (conic.is_single_row) {
+        conic.row_min = static_cast<int64_t>(std::floor(std::min(std::max(conic.center_y + 0.5, -kMaxCoordinate), kMaxCoordinate)));
+        conic.row_max = conic.row_min;
+    }
+    return true;
+}
+
+// Chord of conic in row, whose pixel centers are inside. Chord which is narrower than one pixel keeps the pixel nearest to its center.
+inline RowSpan ComputeChordOfGaussianConic(const GaussianConic &conic, int64_t row) {
+    constexpr double kMaxCoordinate = static_cast<double>(1 << 30);
+    RowSpan span;
+    if (row < conic.row_min || row > conic.row_max) {
+        return span;
+    }
+    const double dy = conic.is_single_row ? 0.0 : static_cast<double>(row) - conic.center_y;
+    const double center_x = conic.center_x + conic.shift * dy;
+    const double half_width = conic.cov_yy <= 1e-12 ? std::sqrt(conic.radius_2 * conic.cov_xx)
+                                                    : std::sqrt(std::max(conic.det * (conic.radius_2 * conic.cov_yy - dy * dy), 0.0)) / conic.cov_yy;
+    span.col_begin = static_cast<int64_t>(std::ceil(std::min(std::max(center_x - half_width, -kMaxCoordinate), kMaxCoordinate)));
+    span.col_end = static_cast<int64_t>(std::floor(std::min(std::max(center_x + half_width, -kMaxCoordinate), kMaxCoordinate)));
+    if (span.IsEmpty()) {
+        span.col_begin = static_cast<int64_t>(std::floor(std::min(std::max(center_x + 0.5, -kMaxCoordinate), kMaxCoordinate)));
+        span.col_end = span.col_begin;
+    }
+    return span;
+}
+
+// Extend span toward chords of its upper and lower rows, so that chords of a thin or flat ellipse are 8-connected. Gap between two rows
+// is split, and the upper row takes the smaller half. It only depends on the three chords, so any row range gives the same spans.
+inline RowSpan BridgeChordsOfGaussianConic(const RowSpan &upper, const RowSpan &span, const RowSpan &lower) {
+    RowSpan bridged = span;
+    if (span.IsEmpty()) {
+        return bridged;
+    }
+    if (!upper.IsEmpty()) {
+        if (upper.col_begin > span.col_end + 1) {
+            const int64_t gap = upper.col_begin - span.col_end - 1;
+            bridged.col_end = std::max(bridged.col_end, span.col_end + gap - gap / 2);
+        } else if (upper.col_end < span.col_begin - 1) {
+            const int64_t gap = span.col_begin - upper.col_end - 1;
+            bridged.col_begin = std::min(bridged.col_begin, span.col_begin - (gap - gap / 2));
+        }
+    }
+    if (!lower.IsEmpty()) {
+        if (lower.col_begin > span.col_end + 1) {
+            bridged.col_end = std::max(bridged.col_end, span.col_end + (lower.col_begin - span.col_end - 1) / 2);
+        } else if (lower.col_end < span.col_begin - 1) {
+            bridged.col_begin = std::min(bridged.col_begin, span.col_begin - (span.col_begin - lower.col_end - 1) / 2);
+        }
+    }
+    return bridged;
+}
+
+// Visit spans of conic in rows [row_begin, row_end] by function(row, col_begin, col_end), where columns are not clipped. Each row costs one
+// square root. If is_solid is false, only boundary pixels, which have any 4-neighbor outside, are visited. Each pixel is visited once.
+template <typename Function>
+void TraverseGaussianConic(const GaussianConic &conic, bool is_solid, int32_t row_begin, int32_t row_end, const Function &function) {
+    const int64_t first_row = std::max(static_cast<int64_t>(row_begin), conic.row_min);
+    const int64_t last_row = std::min(static_cast<int64_t>(row_end), conic.row_max);
+    RETURN_IF(first_row > last_row);
+
+    // Sliding window of chords in rows [row - 2, row + 2], and bridged spans in rows [row - 1, row + 1].
+    std::array<RowSpan, 5> chords;
+    for (int32_t i = 0; i < 5; ++i) {
+        chords[i] = ComputeChordOfGaussianConic(conic, first_row - 2 + i);
+    }
+    std::array<RowSpan, 3> spans;
+    for (int32_t i = 0; i < 3; ++i) {
+        spans[i] = BridgeChordsOfGaussianConic(chords[i], chords[i + 1], chords[i + 2]);
+    }
+
+    for (int64_t row = first_row; row <= last_row; ++row) {
+        const RowSpan &span = spans[1];
+        if (!span.IsEmpty()) {
+            // Pixels covered by span and its both neighbors are interior ones.
+            RowSpan interior;
+            if (!is_solid && !spans[0].IsEmpty() && !spans[2].IsEmpty()) {
+                interior.col_begin = std::max({span.col_begin + 1, spans[0].col_begin, spans[2].col_begin});
+                interior.col_end = std::min({span.col_end - 1, spans[0].col_end, spans[2].col_end});
+            }
+            if (is_solid || interior.IsEmpty()) {
+                function(static_cast<int32_t>(row), static_cast<int32_t>(span.col_begin), static_cast<int32_t>(span.col_end));
+            } else {
+                function(static_cast<int32_t>(row), static_cast<int32_t>(span.col_begin), static_cast<int32_t>(interior.col_begin - 1));
+                function(static_cast<int32_t>(row), static_cast<int32_t>(interior.col_end + 1), static_cast<int32_t>(span.col_end));
+            }
+        }
+
+        std::rotate(chords.begin(), chords.begin() + 1, chords.end());
+        chords[4] = ComputeChordOfGaussianConic(conic, row + 3);
+        std::rotate(spans.begin(), spans.begin() + 1, spans.end());
+        spans[2] = BridgeChordsOfGaussianConic(chords[2], chords[3], chords[4]);
+    }
+}
+
+// Visit spans of gaussian trust region in rows [row_begin, row_end] by function(row, col_begin, col_end).
+template <typename Function>
+void TraverseTrustRegionOfGaussian(const Vec2 &center, const Mat2 &covariance, const float sigma_scale, bool is_solid, int32_t row_begin, int32_t row_end,
+                                   const Function &function) {
+    GaussianConic conic;
+    RETURN_IF(!ComputeGaussianConic(center, covariance, sigma_scale, conic));
+    TraverseGaussianConic(conic, is_solid, row_begin, row_end, function);
+}
+
+}  // namespace image_painter
+
+#endif  // end of _IMAGE_PAINTER_RASTER_H_
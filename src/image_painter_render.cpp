@@ -1,5 +1,12 @@
 #include "assic_fonts.h"
 #include "image_painter.h"
+#include "image_painter_parallel.h"
+#include "image_painter_pixel.h"
+#include "image_painter_profile.h"
+#include "image_painter_raster.h"
+#include "image_painter_spatial_index.h"
+#include "image_painter_tile.h"
+#include "image_painter_yuv.h"
 
 #include "slam_log_reporter.h"
 #include "slam_memory.h"
@@ -8,8 +15,6 @@
 namespace image_painter {
 
 namespace {
-    constexpr float kMinValidViewDepth = 0.1f;
-
     // Project a camera-frame point into a pixel position. Perspective divides by depth;
     // orthographic uses a constant pixels-per-world-unit scale. The near plane reject /
     // clip is kept for both modes so the cpu and gpu pipelines stay pixel-identical.
@@ -19,19 +24,251 @@ namespace {
         }
         return Vec2(p_c.x() / p_c.z() * cam.fx + cam.cx, p_c.y() / p_c.z() * cam.fy + cam.cy);
     }
+
+    constexpr int32_t kPointsOfBlock = 1024;
+    constexpr int32_t kMinPointsOfChunk = 16384;
+    constexpr int32_t kRowsOfTile = 32;
+    // Sigma scale of ellipses rendered in camera view.
+    constexpr float kSigmaScaleOfEllipse = 3.0f;
+
+    // Propagate gaussians in blocks into conics of pixel frame, with the same projection as ProjectGaussianInCameraView. Ellipses behind the
+    // near plane, or whose bounding box is out of image of rows x cols, keep empty conics.
+    void ProjectGaussiansInCameraView(const ImagePainter::CameraView &cam, const Mat3 &rotation_cw, const ImagePainter::PointCloudBatch &means_in_w,
+                                      const ImagePainter::CovarianceCloudBatch &covariances, int32_t rows, int32_t cols, float sigma_scale,
+                                      GaussianConic *conics) {
+        using Array = Eigen::Array<float, 1, Eigen::Dynamic>;
+        // Index of item (i, j) of symmetric covariance in its column.
+        constexpr std::array<int32_t, 9> kIndicesOfCovariance = {0, 1, 2, 1, 3, 4, 2, 4, 5};
+        const Mat3 &r = rotation_cw;
+        const float radius = 0.5f * sigma_scale;
+
+        const int32_t size = static_cast<int32_t>(means_in_w.cols());
+        for (int32_t block_begin = 0; block_begin < size; block_begin += kPointsOfBlock) {
+            const int32_t n = std::min(kPointsOfBlock, size - block_begin);
+            const Array x = means_in_w.row(0).segment(block_begin, n).array() - cam.p_wc.x();
+            const Array y = means_in_w.row(1).segment(block_begin, n).array() - cam.p_wc.y();
+            const Array z = means_in_w.row(2).segment(block_begin, n).array() - cam.p_wc.z();
+            const Array p_c_x = r(0, 0) * x + r(0, 1) * y + r(0, 2) * z;
+            const Array p_c_y = r(1, 0) * x + r(1, 1) * y + r(1, 2) * z;
+            const Array p_c_z = r(2, 0) * x + r(2, 1) * y + r(2, 2) * z;
+
+            // cov_c = r * cov_w * r^T, where r_cov = r * cov_w.
+            std::array<Array, 9> r_cov;
+            for (int32_t i = 0; i < 3; ++i) {
+                for (int32_t j = 0; j < 3; ++j) {
+                    r_cov[i * 3 + j] = r(i, 0) * covariances.row(kIndicesOfCovariance[j]).segment(block_begin, n).array() +
+                                       r(i, 1) * covariances.row(kIndicesOfCovariance[3 + j]).segment(block_begin, n).array() +
+                                       r(i, 2) * covariances.row(kIndicesOfCovariance[6 + j]).segment(block_begin, n).array();
+                }
+            }
+            auto cov_c = [&](int32_t i, int32_t j) -> Array { return r_cov[i * 3] * r(j, 0) + r_cov[i * 3 + 1] * r(j, 1) + r_cov[i * 3 + 2] * r(j, 2); };
+            const Array cov_c_xx = cov_c(0, 0);
+            const Array cov_c_xy = cov_c(0, 1);
+            const Array cov_c_yy = cov_c(1, 1);
+
+            // Jacobian of projection is [a, 0, c; 0, b, d].
+            Array u(n);
+            Array v(n);
+            Array cov_xx(n);
+            Array cov_xy(n);
+            Array cov_yy(n);
+            if (cam.is_ortho) {
+                const float scale_2 = cam.ortho_scale * cam.ortho_scale;
+                u = p_c_x * cam.ortho_scale + cam.cx;
+                v = p_c_y * cam.ortho_scale + cam.cy;
+                cov_xx = cov_c_xx * scale_2;
+                cov_xy = cov_c_xy * scale_2;
+                cov_yy = cov_c_yy * scale_2;
+            } else {
+                const Array cov_c_xz = cov_c(0, 2);
+                const Array cov_c_yz = cov_c(1, 2);
+                const Array cov_c_zz = cov_c(2, 2);
+                const Array inv_depth = p_c_z.inverse();
+                const Array a = cam.fx * inv_depth;
+                const Array b = cam.fy * inv_depth;
+                const Array c = -a * p_c_x * inv_depth;
+                const Array d = -b * p_c_y * inv_depth;
+                u = p_c_x * a + cam.cx;
+                v = p_c_y * b + cam.cy;
+                cov_xx = a * a * cov_c_xx + 2.0f * a * c * cov_c_xz + c * c * cov_c_zz;
+                cov_xy = a * b * cov_c_xy + a * d * cov_c_xz + c * b * cov_c_yz + c * d * cov_c_zz;
+                cov_yy = b * b * cov_c_yy + 2.0f * b * d * cov_c_yz + d * d * cov_c_zz;
+            }
+
+            // Cull by depth and bounding box in float, which also rejects nan, and only build conics of the others.
+            const Array half_width = radius * cov_xx.max(0.0f).sqrt();
+            const Array half_height = radius * cov_yy.max(0.0f).sqrt();
+            for (int32_t i = 0; i < n; ++i) {
+                GaussianConic &conic = conics[block_begin + i];
+                conic = GaussianConic();
+                CONTINUE_IF(!(p_c_z[i] >= ImagePainter::kMinValidViewDepth && u[i] + half_width[i] > -1.0f && u[i] - half_width[i] < cols &&
+                              v[i] + half_height[i] > -1.0f && v[i] - half_height[i] < rows));
+                Mat2 covariance;
+                covariance << cov_xx[i], cov_xy[i], cov_xy[i], cov_yy[i];
+                if (!ComputeGaussianConic(Vec2(u[i], v[i]), covariance, sigma_scale, conic)) {
+                    conic = GaussianConic();
+                }
+            }
+        }
+    }
+
+    // Stamp solid circle sprite, whose half widths of rows [-radius + 1, radius - 1] are precomputed. Rows are shifted by row_offset.
+    template <typename ImageType, typename PixelType>
+    void StampSprite(ImageType &image, int32_t center_x, int32_t center_y, const std::vector<int32_t> &half_widths, const PixelType &color) {
+        const int32_t radius = (static_cast<int32_t>(half_widths.size()) + 1) / 2;
+        if (radius == 1) {
+            if (center_x >= 0 && center_x < image.cols() && center_y >= 0 && center_y < image.rows()) {
+                SetPixelValueUnchecked(image, center_y, center_x, color);
+            }
+            return;
+        }
+        // Sprites inside image are written without clipping. Spans of sprites are short, so pixels are written one by one.
+        if (center_x >= radius && center_x < image.cols() - radius && center_y >= radius && center_y < image.rows() - radius) {
+            for (int32_t dy = -radius + 1; dy < radius; ++dy) {
+                const int32_t half_width = half_widths[dy + radius - 1];
+                for (int32_t col = center_x - half_width; col <= center_x + half_width; ++col) {
+                    SetPixelValueUnchecked(image, center_y + dy, col, color);
+                }
+            }
+            return;
+        }
+        const int32_t dy_begin = std::max(-radius + 1, -center_y);
+        const int32_t dy_end = std::min(radius - 1, image.rows() - 1 - center_y);
+        for (int32_t dy = dy_begin; dy <= dy_end; ++dy) {
+            const int32_t half_width = half_widths[dy + radius - 1];
+            FillSpan(image, center_y + dy, center_x - half_width, center_x + half_width, color);
+        }
+    }
+}
+
+bool ImagePainter::ProjectPointInCameraView(const CameraView &cam, const Vec3 &p_w, Pixel &pixel_uv, float *depth) {
+    const Vec3 p_c = cam.q_wc.inverse() * (p_w - cam.p_wc);
+    RETURN_FALSE_IF(p_c.z() < kMinValidViewDepth);
+    const Vec2 pixel_uv_float = ProjectPointInCameraViewToPixel(cam, p_c);
+    pixel_uv = pixel_uv_float.cast<int32_t>();
+    if (depth != nullptr) {
+        *depth = p_c.z();
+    }
+    return true;
+}
+
+bool ImagePainter::ProjectLineSegmentInCameraView(const CameraView &cam, const Vec3 &line_s_point, const Vec3 &line_e_point, Pixel &pixel_uv_s,
+                                                  Pixel &pixel_uv_e, float *depth_s, float *depth_e) {
+    Vec3 p_c_i = cam.q_wc.inverse() * (line_s_point - cam.p_wc);
+    Vec3 p_c_j = cam.q_wc.inverse() * (line_e_point - cam.p_wc);
+    RETURN_FALSE_IF(p_c_i.z() < kMinValidViewDepth && p_c_j.z() < kMinValidViewDepth);
+
+    // If one point of line is outside, cut this line to make the two points of new line all visilbe.
+    if (p_c_i.z() < kMinValidViewDepth || p_c_j.z() < kMinValidViewDepth) {
+        const float w = (p_c_i.z() - kMinValidViewDepth) / (p_c_i.z() - p_c_j.z());
+        const Vec3 p_c_mid = Vec3(w * p_c_j.x() + (1.0f - w) * p_c_i.x(), w * p_c_j.y() + (1.0f - w) * p_c_i.y(), w * p_c_j.z() + (1.0f - w) * p_c_i.z());
+        if (p_c_i.z() < kMinValidViewDepth) {
+            p_c_i = p_c_mid;
+        } else {
+            p_c_j = p_c_mid;
+        }
+    }
+
+    pixel_uv_s = ProjectPointInCameraViewToPixel(cam, p_c_i).cast<int32_t>();
+    pixel_uv_e = ProjectPointInCameraViewToPixel(cam, p_c_j).cast<int32_t>();
+    if (depth_s != nullptr && depth_e != nullptr) {
+        *depth_s = p_c_i.z();
+        *depth_e = p_c_j.z();
+    }
+    return true;
+}
+
+bool ImagePainter::ProjectGaussianInCameraView(const CameraView &cam, const Vec3 &mid_p_w, const Mat3 &covariance, Vec2 &pixel_uv, Mat2 &pixel_cov,
+                                               float *depth) {
+    // Transform gaussian ellipse into camera frame.
+    const Vec3 p_c = cam.q_wc.inverse() * (mid_p_w - cam.p_wc);
+    const Mat3 cov_c = cam.q_wc.inverse() * covariance * cam.q_wc;
+    RETURN_FALSE_IF(p_c.z() < kMinValidViewDepth);
+    if (depth != nullptr) {
+        *depth = p_c.z();
+    }
+
+    if (cam.is_ortho) {
+        // Orthographic projection is linear: the 2d gaussian keeps the in-plane part of
+        // the covariance, scaled by the constant pixels-per-world-unit factor.
+        pixel_uv = Vec2(p_c.x() * cam.ortho_scale + cam.cx, p_c.y() * cam.ortho_scale + cam.cy);
+        pixel_cov = cov_c.block<2, 2>(0, 0) * (cam.ortho_scale * cam.ortho_scale);
+        return true;
+    }
+
+    // Transform 3d gaussian into 2d gaussian, whose rows are scaled by fx and fy respectively.
+    const float inv_depth = 1.0f / p_c.z();
+    const float inv_depth_2 = inv_depth * inv_depth;
+    Mat2x3 jacobian_2d_3d = Mat2x3::Zero();
+    if (!std::isnan(inv_depth)) {
+        jacobian_2d_3d << cam.fx * inv_depth, 0, -cam.fx * p_c(0) * inv_depth_2, 0, cam.fy * inv_depth, -cam.fy * p_c(1) * inv_depth_2;
+    }
+    pixel_cov = jacobian_2d_3d * cov_c * jacobian_2d_3d.transpose();
+    pixel_uv = ProjectPointInCameraViewToPixel(cam, p_c);
+    return true;
+}
+
+void ImagePainter::ProjectPointsInCameraView(const CameraView &cam, const PointCloudBatch &points_in_w, int32_t rows, int32_t cols, int32_t margin,
+                                             int32_t *pixel_u, int32_t *pixel_v, float *depth) {
+    // Rotation follows the order of operations of quaternion * vector in Eigen, so pixels are the same as ProjectPointInCameraView.
+    using Array = Eigen::Array<float, 1, Eigen::Dynamic>;
+    const Quat q_cw = cam.q_wc.inverse();
+    const float qw = q_cw.w();
+    const float qx = q_cw.x();
+    const float qy = q_cw.y();
+    const float qz = q_cw.z();
+    const float min_u = -static_cast<float>(margin) - 1.0f;
+    const float max_u = static_cast<float>(cols + margin);
+    const float min_v = -static_cast<float>(margin) - 1.0f;
+    const float max_v = static_cast<float>(rows + margin);
+
+    const int32_t size = static_cast<int32_t>(points_in_w.cols());
+    Array u(kPointsOfBlock);
+    Array v(kPointsOfBlock);
+    for (int32_t block_begin = 0; block_begin < size; block_begin += kPointsOfBlock) {
+        const int32_t n = std::min(kPointsOfBlock, size - block_begin);
+        const Array x = points_in_w.row(0).segment(block_begin, n).array() - cam.p_wc.x();
+        const Array y = points_in_w.row(1).segment(block_begin, n).array() - cam.p_wc.y();
+        const Array z = points_in_w.row(2).segment(block_begin, n).array() - cam.p_wc.z();
+        // uv = 2 * (q.vec() x p), p_c = p + q.w() * uv + q.vec() x uv.
+        const Array uv_x = 2.0f * (qy * z - qz * y);
+        const Array uv_y = 2.0f * (qz * x - qx * z);
+        const Array uv_z = 2.0f * (qx * y - qy * x);
+        const Array p_c_x = x + qw * uv_x + (qy * uv_z - qz * uv_y);
+        const Array p_c_y = y + qw * uv_y + (qz * uv_x - qx * uv_z);
+        const Array p_c_z = z + qw * uv_z + (qx * uv_y - qy * uv_x);
+        if (cam.is_ortho) {
+            u.head(n) = p_c_x * cam.ortho_scale + cam.cx;
+            v.head(n) = p_c_y * cam.ortho_scale + cam.cy;
+        } else {
+            u.head(n) = p_c_x / p_c_z * cam.fx + cam.cx;
+            v.head(n) = p_c_y / p_c_z * cam.fy + cam.cy;
+        }
+
+        // Reject in float before cast, which also rejects nan.
+        for (int32_t i = 0; i < n; ++i) {
+            const bool is_valid = p_c_z[i] >= kMinValidViewDepth && u[i] > min_u && u[i] < max_u && v[i] > min_v && v[i] < max_v;
+            pixel_u[block_begin + i] = is_valid ? static_cast<int32_t>(u[i]) : kInvalidPixel;
+            pixel_v[block_begin + i] = is_valid ? static_cast<int32_t>(v[i]) : kInvalidPixel;
+        }
+        if (depth != nullptr) {
+            Eigen::Map<Array>(depth + block_begin, n) = p_c_z;
+        }
+    }
 }
 
 template void ImagePainter::RenderTextInCameraView<GrayImage, uint8_t>(GrayImage &image, const CameraView &cam, const Vec3 &p_w, const std::string &str,
                                                                        const uint8_t color, const int32_t font_size);
 template void ImagePainter::RenderTextInCameraView<RgbImage, RgbPixel>(RgbImage &image, const CameraView &cam, const Vec3 &p_w, const std::string &str,
                                                                        const RgbPixel color, const int32_t font_size);
+template void ImagePainter::RenderTextInCameraView<Yuv420Image, ImagePainter::YuvPixel>(Yuv420Image &image, const CameraView &cam, const Vec3 &p_w,
+                                                                                        const std::string &str, const YuvPixel color, const int32_t font_size);
 template <typename ImageType, typename PixelType>
 void ImagePainter::RenderTextInCameraView(ImageType &image, const CameraView &cam, const Vec3 &p_w, const std::string &str, const PixelType color,
                                           const int32_t font_size) {
-    const Vec3 p_c = cam.q_wc.inverse() * (p_w - cam.p_wc);
-    RETURN_IF(p_c.z() < kMinValidViewDepth);
-    const Vec2 pixel_uv_float = ProjectPointInCameraViewToPixel(cam, p_c);
-    const Pixel pixel_uv = pixel_uv_float.cast<int32_t>();
+    IMAGE_PAINTER_PROFILE_SCOPE(kTextInCameraView, image);
+    Pixel pixel_uv = Pixel::Zero();
+    RETURN_IF(!ProjectPointInCameraView(cam, p_w, pixel_uv));
     DrawString(image, str, pixel_uv.x(), pixel_uv.y(), color, font_size);
 }
 
@@ -39,66 +276,176 @@ template void ImagePainter::RenderPointInCameraView<GrayImage, uint8_t>(GrayImag
                                                                         const int32_t radius);
 template void ImagePainter::RenderPointInCameraView<RgbImage, RgbPixel>(RgbImage &image, const CameraView &cam, const Vec3 &point_in_w, const RgbPixel color,
                                                                         const int32_t radius);
+template void ImagePainter::RenderPointInCameraView<Yuv420Image, ImagePainter::YuvPixel>(Yuv420Image &image, const CameraView &cam, const Vec3 &point_in_w,
+                                                                                         const YuvPixel color, const int32_t radius);
 template <typename ImageType, typename PixelType>
 void ImagePainter::RenderPointInCameraView(ImageType &image, const CameraView &cam, const Vec3 &point_in_w, const PixelType color, const int32_t radius) {
-    const Vec3 p_c = cam.q_wc.inverse() * (point_in_w - cam.p_wc);
-    RETURN_IF(p_c.z() < kMinValidViewDepth);
-    const Vec2 pixel_uv_float = ProjectPointInCameraViewToPixel(cam, p_c);
-    const Pixel pixel_uv = pixel_uv_float.cast<int32_t>();
+    IMAGE_PAINTER_PROFILE_SCOPE(kPointInCameraView, image);
+    Pixel pixel_uv = Pixel::Zero();
+    RETURN_IF(!ProjectPointInCameraView(cam, point_in_w, pixel_uv));
     DrawSolidCircle(image, pixel_uv.x(), pixel_uv.y(), radius, color);
 }
 
+template void ImagePainter::RenderPointsInCameraView<GrayImage, uint8_t>(GrayImage &image, const CameraView &cam, const PointCloudBatch &points_in_w,
+                                                                         const std::vector<uint8_t> &colors, const int32_t radius, bool use_multi_thread);
+template void ImagePainter::RenderPointsInCameraView<RgbImage, RgbPixel>(RgbImage &image, const CameraView &cam, const PointCloudBatch &points_in_w,
+                                                                         const std::vector<RgbPixel> &colors, const int32_t radius, bool use_multi_thread);
+template void ImagePainter::RenderPointsInCameraView<Yuv420Image, ImagePainter::YuvPixel>(Yuv420Image &image, const CameraView &cam,
+                                                                                          const PointCloudBatch &points_in_w,
+                                                                                          const std::vector<YuvPixel> &colors, const int32_t radius,
+                                                                                          bool use_multi_thread);
+template <typename ImageType, typename PixelType>
+void ImagePainter::RenderPointsInCameraView(ImageType &image, const CameraView &cam, const PointCloudBatch &points_in_w, const std::vector<PixelType> &colors,
+                                            const int32_t radius, bool use_multi_thread) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kPointsInCameraView, image);
+    const int32_t size = static_cast<int32_t>(points_in_w.cols());
+    RETURN_IF(image.data() == nullptr || size == 0 || radius <= 0);
+    if (colors.size() != 1 && static_cast<int32_t>(colors.size()) != size) {
+        ReportError("[ImagePainter] Size of colors " << colors.size() << " should be 1 or size of points " << size << ".");
+        return;
+    }
+    const int32_t color_step = colors.size() == 1 ? 0 : 1;
+
+    const std::vector<int32_t> half_widths = ComputeHalfWidthsOfCircleSprite(radius);
+
+    // Without multi-thread, each block of points is stamped right after projection.
+    if (!use_multi_thread || GetMaxNumberOfThreads() <= 1) {
+        std::vector<int32_t> pixel_u(kPointsOfBlock);
+        std::vector<int32_t> pixel_v(kPointsOfBlock);
+        for (int32_t block_begin = 0; block_begin < size; block_begin += kPointsOfBlock) {
+            const int32_t n = std::min(kPointsOfBlock, size - block_begin);
+            ProjectPointsInCameraView(cam, points_in_w.middleCols(block_begin, n), image.rows(), image.cols(), radius, pixel_u.data(), pixel_v.data());
+            for (int32_t i = 0; i < n; ++i) {
+                CONTINUE_IF(pixel_u[i] == kInvalidPixel);
+                StampSprite(image, pixel_u[i], pixel_v[i], half_widths, colors[(block_begin + i) * color_step]);
+            }
+        }
+        return;
+    }
+
+    // Project points in parallel chunks.
+    std::vector<int32_t> pixel_u(size);
+    std::vector<int32_t> pixel_v(size);
+    ParallelFor(0, size, kMinPointsOfChunk, [&](int32_t begin, int32_t end) {
+        ProjectPointsInCameraView(cam, points_in_w.middleCols(begin, end - begin), image.rows(), image.cols(), radius, pixel_u.data() + begin,
+                                  pixel_v.data() + begin);
+    });
+
+    // Bin points into row tiles, so each tile stamps its points in the original order.
+    std::vector<int32_t> offsets_of_tiles;
+    std::vector<int32_t> points_in_tiles;
+    BinItemsIntoRowTiles(size, image.rows(), kRowsOfTile, [&](int32_t i, int32_t &row_min, int32_t &row_max) {
+        // Culled points have invalid pixels, whose row bounds would overflow.
+        RETURN_FALSE_IF(pixel_u[i] == kInvalidPixel);
+        row_min = pixel_v[i] - radius + 1;
+        row_max = pixel_v[i] + radius - 1;
+        return true;
+    }, offsets_of_tiles, points_in_tiles);
+
+    // Stamp tiles in parallel. Each tile is a view of its rows, so its pixels are written by only one thread.
+    ForEachTileInParallel(static_cast<int32_t>(offsets_of_tiles.size()) - 1, [&](int32_t tile_index) {
+        const int32_t row_offset = tile_index * kRowsOfTile;
+        ImageType tile = GetRowTileOfImage(image, row_offset, std::min(kRowsOfTile, image.rows() - row_offset));
+        for (int32_t k = offsets_of_tiles[tile_index]; k < offsets_of_tiles[tile_index + 1]; ++k) {
+            const int32_t i = points_in_tiles[k];
+            StampSprite(tile, pixel_u[i], pixel_v[i] - row_offset, half_widths, colors[i * color_step]);
+        }
+    });
+}
+
 template void ImagePainter::RenderLineSegmentInCameraView<GrayImage, uint8_t>(GrayImage &image, const CameraView &cam, const Vec3 &line_s_point,
                                                                               const Vec3 &line_e_point, const uint8_t color);
 template void ImagePainter::RenderLineSegmentInCameraView<RgbImage, RgbPixel>(RgbImage &image, const CameraView &cam, const Vec3 &line_s_point,
                                                                               const Vec3 &line_e_point, const RgbPixel color);
+template void ImagePainter::RenderLineSegmentInCameraView<Yuv420Image, ImagePainter::YuvPixel>(Yuv420Image &image, const CameraView &cam,
+                                                                                               const Vec3 &line_s_point, const Vec3 &line_e_point,
+                                                                                               const YuvPixel color);
 template <typename ImageType, typename PixelType>
 void ImagePainter::RenderLineSegmentInCameraView(ImageType &image, const CameraView &cam, const Vec3 &line_s_point, const Vec3 &line_e_point,
                                                  const PixelType color) {
-    Vec3 p_c_i = cam.q_wc.inverse() * (line_s_point - cam.p_wc);
-    Vec3 p_c_j = cam.q_wc.inverse() * (line_e_point - cam.p_wc);
-    RETURN_IF(p_c_i.z() < kMinValidViewDepth && p_c_j.z() < kMinValidViewDepth);
+    IMAGE_PAINTER_PROFILE_SCOPE(kLineSegmentInCameraView, image);
+    Pixel pixel_uv_i = Pixel::Zero();
+    Pixel pixel_uv_j = Pixel::Zero();
+    RETURN_IF(!ProjectLineSegmentInCameraView(cam, line_s_point, line_e_point, pixel_uv_i, pixel_uv_j));
+    DrawBressenhanLine(image, pixel_uv_i.x(), pixel_uv_i.y(), pixel_uv_j.x(), pixel_uv_j.y(), color);
+}
 
-    // If one point of line is outside, cut this line to make the two points of new line all visilbe.
-    if (p_c_i.z() < kMinValidViewDepth || p_c_j.z() < kMinValidViewDepth) {
-        const float w = (p_c_i.z() - kMinValidViewDepth) / (p_c_i.z() - p_c_j.z());
-        const Vec3 p_c_mid = Vec3(w * p_c_j.x() + (1.0f - w) * p_c_i.x(), w * p_c_j.y() + (1.0f - w) * p_c_i.y(), w * p_c_j.z() + (1.0f - w) * p_c_i.z());
-        if (p_c_i.z() < kMinValidViewDepth) {
-            p_c_i = p_c_mid;
-        } else {
-            p_c_j = p_c_mid;
+template void ImagePainter::RenderPointsInCameraView<GrayImage, uint8_t>(GrayImage &image, const CameraView &cam, const SpatialIndex &index,
+                                                                         const std::vector<uint8_t> &colors, const int32_t radius, bool use_multi_thread);
+template void ImagePainter::RenderPointsInCameraView<RgbImage, RgbPixel>(RgbImage &image, const CameraView &cam, const SpatialIndex &index,
+                                                                         const std::vector<RgbPixel> &colors, const int32_t radius, bool use_multi_thread);
+template void ImagePainter::RenderPointsInCameraView<Yuv420Image, ImagePainter::YuvPixel>(Yuv420Image &image, const CameraView &cam, const SpatialIndex &index,
+                                                                                          const std::vector<YuvPixel> &colors, const int32_t radius,
+                                                                                          bool use_multi_thread);
+template <typename ImageType, typename PixelType>
+void ImagePainter::RenderPointsInCameraView(ImageType &image, const CameraView &cam, const SpatialIndex &index, const std::vector<PixelType> &colors,
+                                            const int32_t radius, bool use_multi_thread) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kPointsInCameraViewOfIndex, image);
+    const int32_t size = static_cast<int32_t>(index.points().size());
+    RETURN_IF(image.data() == nullptr || size == 0 || radius <= 0);
+    if (colors.size() != 1 && static_cast<int32_t>(colors.size()) != size) {
+        ReportError("[ImagePainter] Size of colors " << colors.size() << " should be 1 or size of points " << size << ".");
+        return;
+    }
+
+    // Gather candidates in added order, and render them in bulk.
+    std::vector<int32_t> indices;
+    index.QueryPointsInCameraView(cam, image.rows(), image.cols(), radius, indices);
+    RETURN_IF(indices.empty());
+    Eigen::Matrix<float, 3, Eigen::Dynamic> points_in_w(3, indices.size());
+    std::vector<PixelType> colors_of_points;
+    if (colors.size() != 1) {
+        colors_of_points.reserve(indices.size());
+    }
+    for (int32_t i = 0; i < static_cast<int32_t>(indices.size()); ++i) {
+        points_in_w.col(i) = index.points()[indices[i]];
+        if (colors.size() != 1) {
+            colors_of_points.emplace_back(colors[indices[i]]);
         }
     }
+    RenderPointsInCameraView(image, cam, points_in_w, colors.size() == 1 ? colors : colors_of_points, radius, use_multi_thread);
+}
 
-    const Pixel pixel_uv_i = ProjectPointInCameraViewToPixel(cam, p_c_i).cast<int32_t>();
-    const Pixel pixel_uv_j = ProjectPointInCameraViewToPixel(cam, p_c_j).cast<int32_t>();
-    DrawBressenhanLine(image, pixel_uv_i.x(), pixel_uv_i.y(), pixel_uv_j.x(), pixel_uv_j.y(), color);
+template void ImagePainter::RenderLineSegmentsInCameraView<GrayImage, uint8_t>(GrayImage &image, const CameraView &cam, const SpatialIndex &index,
+                                                                               const std::vector<uint8_t> &colors);
+template void ImagePainter::RenderLineSegmentsInCameraView<RgbImage, RgbPixel>(RgbImage &image, const CameraView &cam, const SpatialIndex &index,
+                                                                               const std::vector<RgbPixel> &colors);
+template void ImagePainter::RenderLineSegmentsInCameraView<Yuv420Image, ImagePainter::YuvPixel>(Yuv420Image &image, const CameraView &cam,
+                                                                                                const SpatialIndex &index, const std::vector<YuvPixel> &colors);
+template <typename ImageType, typename PixelType>
+void ImagePainter::RenderLineSegmentsInCameraView(ImageType &image, const CameraView &cam, const SpatialIndex &index, const std::vector<PixelType> &colors) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kLineSegmentsInCameraViewOfIndex, image);
+    const int32_t size = static_cast<int32_t>(index.line_segments().size());
+    RETURN_IF(image.data() == nullptr || size == 0);
+    if (colors.size() != 1 && static_cast<int32_t>(colors.size()) != size) {
+        ReportError("[ImagePainter] Size of colors " << colors.size() << " should be 1 or size of line segments " << size << ".");
+        return;
+    }
+    const int32_t color_step = colors.size() == 1 ? 0 : 1;
+
+    // Rounding of both end points and bresenham may move pixels by two at most.
+    std::vector<int32_t> indices;
+    index.QueryLineSegmentsInCameraView(cam, image.rows(), image.cols(), 2, indices);
+    for (const int32_t i: indices) {
+        const SpatialIndex::LineSegment &line_segment = index.line_segments()[i];
+        RenderLineSegmentInCameraView(image, cam, line_segment.s_point, line_segment.e_point, colors[i * color_step]);
+    }
 }
 
 template void ImagePainter::RenderDashedLineSegmentInCameraView<GrayImage, uint8_t>(GrayImage &image, const CameraView &cam, const Vec3 &line_s_point,
                                                                                     const Vec3 &line_e_point, const int32_t dot_step, const uint8_t color);
 template void ImagePainter::RenderDashedLineSegmentInCameraView<RgbImage, RgbPixel>(RgbImage &image, const CameraView &cam, const Vec3 &line_s_point,
                                                                                     const Vec3 &line_e_point, const int32_t dot_step, const RgbPixel color);
+template void ImagePainter::RenderDashedLineSegmentInCameraView<Yuv420Image, ImagePainter::YuvPixel>(Yuv420Image &image, const CameraView &cam,
+                                                                                                     const Vec3 &line_s_point, const Vec3 &line_e_point,
+                                                                                                     const int32_t dot_step, const YuvPixel color);
 template <typename ImageType, typename PixelType>
 void ImagePainter::RenderDashedLineSegmentInCameraView(ImageType &image, const CameraView &cam, const Vec3 &line_s_point, const Vec3 &line_e_point,
                                                        const int32_t dot_step, const PixelType color) {
-    Vec3 p_c_i = cam.q_wc.inverse() * (line_s_point - cam.p_wc);
-    Vec3 p_c_j = cam.q_wc.inverse() * (line_e_point - cam.p_wc);
-    RETURN_IF(p_c_i.z() < kMinValidViewDepth && p_c_j.z() < kMinValidViewDepth);
-
-    // If one point of line is outside, cut this line to make the two points of new line all visilbe.
-    if (p_c_i.z() < kMinValidViewDepth || p_c_j.z() < kMinValidViewDepth) {
-        const float w = (p_c_i.z() - kMinValidViewDepth) / (p_c_i.z() - p_c_j.z());
-        const Vec3 p_c_mid = Vec3(w * p_c_j.x() + (1.0f - w) * p_c_i.x(), w * p_c_j.y() + (1.0f - w) * p_c_i.y(), w * p_c_j.z() + (1.0f - w) * p_c_i.z());
-        if (p_c_i.z() < kMinValidViewDepth) {
-            p_c_i = p_c_mid;
-        } else {
-            p_c_j = p_c_mid;
-        }
-    }
-
-    const Pixel pixel_uv_i = ProjectPointInCameraViewToPixel(cam, p_c_i).cast<int32_t>();
-    const Pixel pixel_uv_j = ProjectPointInCameraViewToPixel(cam, p_c_j).cast<int32_t>();
+    IMAGE_PAINTER_PROFILE_SCOPE(kDashedLineSegmentInCameraView, image);
+    Pixel pixel_uv_i = Pixel::Zero();
+    Pixel pixel_uv_j = Pixel::Zero();
+    RETURN_IF(!ProjectLineSegmentInCameraView(cam, line_s_point, line_e_point, pixel_uv_i, pixel_uv_j));
     DrawDashedLine(image, pixel_uv_i.x(), pixel_uv_i.y(), pixel_uv_j.x(), pixel_uv_j.y(), dot_step, color);
 }
 
@@ -106,38 +453,83 @@ template void ImagePainter::RenderEllipseInCameraView<GrayImage, uint8_t>(GrayIm
                                                                           const uint8_t color);
 template void ImagePainter::RenderEllipseInCameraView<RgbImage, RgbPixel>(RgbImage &image, const CameraView &cam, const Vec3 &mid_p_w, const Mat3 &covariance,
                                                                           const RgbPixel color);
+template void ImagePainter::RenderEllipseInCameraView<Yuv420Image, ImagePainter::YuvPixel>(Yuv420Image &image, const CameraView &cam, const Vec3 &mid_p_w,
+                                                                                           const Mat3 &covariance, const YuvPixel color);
 template <typename ImageType, typename PixelType>
 void ImagePainter::RenderEllipseInCameraView(ImageType &image, const CameraView &cam, const Vec3 &mid_p_w, const Mat3 &covariance, const PixelType color) {
-    // Transform gaussian ellipse into camera frame.
-    const Vec3 p_c = cam.q_wc.inverse() * (mid_p_w - cam.p_wc);
-    const Mat3 cov_c = cam.q_wc.inverse() * covariance * cam.q_wc;
-    RETURN_IF(p_c.z() < kMinValidViewDepth);
+    IMAGE_PAINTER_PROFILE_SCOPE(kEllipseInCameraView, image);
+    Vec2 pixel_uv = Vec2::Zero();
+    Mat2 pixel_cov = Mat2::Zero();
+    RETURN_IF(!ProjectGaussianInCameraView(cam, mid_p_w, covariance, pixel_uv, pixel_cov));
+    // Draw boundary of 2d gaussian ellipse.
+    DrawTrustRegionOfGaussian(image, pixel_uv, pixel_cov, color, kSigmaScaleOfEllipse);
+}
 
-    if (cam.is_ortho) {
-        // Orthographic projection is linear: the 2d gaussian keeps the in-plane part of
-        // the covariance, scaled by the constant pixels-per-world-unit factor.
-        const Vec2 pixel_uv = Vec2(p_c.x() * cam.ortho_scale + cam.cx, p_c.y() * cam.ortho_scale + cam.cy);
-        const Mat2 pixel_cov = cov_c.block<2, 2>(0, 0) * (cam.ortho_scale * cam.ortho_scale);
-        DrawTrustRegionOfGaussian(image, pixel_uv, pixel_cov, color);
+template void ImagePainter::RenderEllipsesInCameraView<GrayImage, uint8_t>(GrayImage &image, const CameraView &cam, const PointCloudBatch &means_in_w,
+                                                                           const CovarianceCloudBatch &covariances, const std::vector<uint8_t> &colors,
+                                                                           bool is_solid, bool use_multi_thread);
+template void ImagePainter::RenderEllipsesInCameraView<RgbImage, RgbPixel>(RgbImage &image, const CameraView &cam, const PointCloudBatch &means_in_w,
+                                                                           const CovarianceCloudBatch &covariances, const std::vector<RgbPixel> &colors,
+                                                                           bool is_solid, bool use_multi_thread);
+template void ImagePainter::RenderEllipsesInCameraView<Yuv420Image, ImagePainter::YuvPixel>(Yuv420Image &image, const CameraView &cam,
+                                                                                            const PointCloudBatch &means_in_w,
+                                                                                            const CovarianceCloudBatch &covariances,
+                                                                                            const std::vector<YuvPixel> &colors, bool is_solid,
+                                                                                            bool use_multi_thread);
+template <typename ImageType, typename PixelType>
+void ImagePainter::RenderEllipsesInCameraView(ImageType &image, const CameraView &cam, const PointCloudBatch &means_in_w,
+                                              const CovarianceCloudBatch &covariances, const std::vector<PixelType> &colors, bool is_solid,
+                                              bool use_multi_thread) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kEllipsesInCameraView, image);
+    const int32_t size = static_cast<int32_t>(means_in_w.cols());
+    RETURN_IF(image.data() == nullptr || size == 0);
+    if (covariances.cols() != size) {
+        ReportError("[ImagePainter] Size of covariances " << covariances.cols() << " should be size of means " << size << ".");
+        return;
+    }
+    if (colors.size() != 1 && static_cast<int32_t>(colors.size()) != size) {
+        ReportError("[ImagePainter] Size of colors " << colors.size() << " should be 1 or size of means " << size << ".");
         return;
     }
+    const int32_t color_step = colors.size() == 1 ? 0 : 1;
 
-    // Compute focus of camera.
-    const float focus = 0.5f * (cam.fx + cam.fy);
+    // Propagate gaussians into conics of pixel frame. Culled ellipses keep empty conics.
+    const Mat3 rotation_cw = cam.q_wc.inverse().toRotationMatrix();
+    std::vector<GaussianConic> conics(size);
+    ParallelFor(0, size, use_multi_thread ? kMinPointsOfChunk : size, [&](int32_t begin, int32_t end) {
+        ProjectGaussiansInCameraView(cam, rotation_cw, means_in_w.middleCols(begin, end - begin), covariances.middleCols(begin, end - begin),
+                                     image.rows(), image.cols(), kSigmaScaleOfEllipse, conics.data() + begin);
+    });
 
-    // Transform 3d gaussian into 2d gaussian.
-    const float inv_depth = 1.0f / p_c.z();
-    const float inv_depth_2 = inv_depth * inv_depth;
-    Mat2x3 jacobian_2d_3d = Mat2x3::Zero();
-    if (!std::isnan(inv_depth)) {
-        jacobian_2d_3d << inv_depth, 0, -p_c(0) * inv_depth_2, 0, inv_depth, -p_c(1) * inv_depth_2;
-        jacobian_2d_3d = jacobian_2d_3d * focus;
+    if (!use_multi_thread || GetMaxNumberOfThreads() <= 1) {
+        for (int32_t i = 0; i < size; ++i) {
+            CONTINUE_IF(conics[i].row_min > conics[i].row_max);
+            TraverseGaussianConic(conics[i], is_solid, 0, image.rows() - 1, [&](int32_t row, int32_t col_begin, int32_t col_end) {
+                FillSpan(image, row, col_begin, col_end, colors[i * color_step]);
+            });
+        }
+        return;
     }
-    const Mat2 pixel_cov = jacobian_2d_3d * cov_c * jacobian_2d_3d.transpose();
-    const Vec2 pixel_uv = p_c.head<2>() * inv_depth * focus + Vec2(cam.cx, cam.cy);
 
-    // Draw boundary of 2d gaussian ellipse.
-    DrawTrustRegionOfGaussian(image, pixel_uv, pixel_cov, color);
+    // Bin ellipses into row tiles, so each tile draws its ellipses in the original order.
+    std::vector<int32_t> offsets_of_tiles;
+    std::vector<int32_t> ellipses_in_tiles;
+    BinItemsIntoRowTiles(size, image.rows(), kRowsOfTile, [&](int32_t i, int32_t &row_min, int32_t &row_max) {
+        row_min = static_cast<int32_t>(conics[i].row_min);
+        row_max = static_cast<int32_t>(conics[i].row_max);
+        return conics[i].row_min <= conics[i].row_max;
+    }, offsets_of_tiles, ellipses_in_tiles);
+
+    ForEachTileInParallel(static_cast<int32_t>(offsets_of_tiles.size()) - 1, [&](int32_t tile_index) {
+        const int32_t row_offset = tile_index * kRowsOfTile;
+        ImageType tile = GetRowTileOfImage(image, row_offset, std::min(kRowsOfTile, image.rows() - row_offset));
+        for (int32_t k = offsets_of_tiles[tile_index]; k < offsets_of_tiles[tile_index + 1]; ++k) {
+            const int32_t i = ellipses_in_tiles[k];
+            TraverseGaussianConic(conics[i], is_solid, row_offset, row_offset + tile.rows() - 1, [&](int32_t row, int32_t col_begin, int32_t col_end) {
+                FillSpan(tile, row - row_offset, col_begin, col_end, colors[i * color_step]);
+            });
+        }
+    });
 }
 
 }  // namespace image_painter
@@ -0,0 +1,233 @@
+#include "image_painter_render_context.h"
+#include "image_painter_parallel.h"
+#include "image_painter_pixel.h"
+#include "image_painter_profile.h"
+#include "image_painter_raster.h"
+#include "image_painter_tile.h"
+
+#include "slam_log_reporter.h"
+#include "slam_operations.h"
+
+namespace image_painter {
+
+namespace {
+    constexpr int32_t kPointsOfBlock = 1024;
+    constexpr int32_t kMinPointsOfChunk = 16384;
+    constexpr int32_t kRowsOfTile = 32;
+
+    // Stamp solid circle sprite with depth test. Depth buffer has the same rows as image, which may be a tile of the whole image.
+    template <typename ImageType, typename PixelType>
+    void StampSpriteWithDepthTest(ImageType &image, float *depth_buffer, int32_t center_x, int32_t center_y, float depth,
+                                  const std::vector<int32_t> &half_widths, const PixelType &color) {
+        const int32_t radius = (static_cast<int32_t>(half_widths.size()) + 1) / 2;
+        const int32_t dy_begin = std::max(-radius + 1, -center_y);
+        const int32_t dy_end = std::min(radius - 1, image.rows() - 1 - center_y);
+        for (int32_t dy = dy_begin; dy <= dy_end; ++dy) {
+            const int32_t row = center_y + dy;
+            const int32_t half_width = half_widths[dy + radius - 1];
+            const int32_t col_begin = std::max(center_x - half_width, 0);
+            const int32_t col_end = std::min(center_x + half_width, image.cols() - 1);
+            float *depth_of_row = depth_buffer + row * image.cols();
+            for (int32_t col = col_begin; col <= col_end; ++col) {
+                CONTINUE_IF(depth > depth_of_row[col]);
+                depth_of_row[col] = depth;
+                SetPixelValueUnchecked(image, row, col, color);
+            }
+        }
+    }
+
+    const std::array<uint8_t, ColorMap::kLutSize> &GetLutOfImage(const ColorMap &color_map, const GrayImage &) { return color_map.gray_lut(); }
+    const std::array<RgbPixel, ColorMap::kLutSize> &GetLutOfImage(const ColorMap &color_map, const RgbImage &) { return color_map.lut(); }
+}  // namespace
+
+RenderContext::RenderContext(const CameraView &cam, int32_t rows, int32_t cols) : cam_(cam) { ResizeDepthBuffer(rows, cols); }
+
+void RenderContext::ResizeDepthBuffer(int32_t rows, int32_t cols) {
+    rows_ = std::max(rows, 0);
+    cols_ = std::max(cols, 0);
+    depth_buffer_.resize(static_cast<size_t>(rows_) * cols_);
+    ClearDepthBuffer();
+}
+
+void RenderContext::ClearDepthBuffer() { std::fill(depth_buffer_.begin(), depth_buffer_.end(), std::numeric_limits<float>::infinity()); }
+
+template <typename ImageType>
+bool RenderContext::CheckSizeOfImage(const ImageType &image) const {
+    if (image.data() == nullptr || image.rows() != rows_ || image.cols() != cols_) {
+        ReportError("[RenderContext] Size of image " << image.rows() << " x " << image.cols() << " does not match depth buffer " << rows_ << " x "
+                                                     << cols_ << ".");
+        return false;
+    }
+    return true;
+}
+
+template bool RenderContext::RenderPointInCameraView<GrayImage, uint8_t>(GrayImage &image, const Vec3 &point_in_w, const uint8_t color, const int32_t radius);
+template bool RenderContext::RenderPointInCameraView<RgbImage, RgbPixel>(RgbImage &image, const Vec3 &point_in_w, const RgbPixel color, const int32_t radius);
+template <typename ImageType, typename PixelType>
+bool RenderContext::RenderPointInCameraView(ImageType &image, const Vec3 &point_in_w, const PixelType color, const int32_t radius) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kPointInCameraViewWithDepthTest, image);
+    RETURN_FALSE_IF(!CheckSizeOfImage(image));
+    Pixel pixel_uv = Pixel::Zero();
+    float depth = 0.0f;
+    if (radius > 0 && ImagePainter::ProjectPointInCameraView(cam_, point_in_w, pixel_uv, &depth)) {
+        StampSpriteWithDepthTest(image, depth_buffer_.data(), pixel_uv.x(), pixel_uv.y(), depth, ComputeHalfWidthsOfCircleSprite(radius), color);
+    }
+    return true;
+}
+
+template <typename ImageType, typename ColorFunction>
+void RenderContext::RenderPointsWithDepthTest(ImageType &image, const PointCloudBatch &points_in_w, const ColorFunction &get_color, const int32_t radius,
+                                              bool use_multi_thread) {
+    const int32_t size = static_cast<int32_t>(points_in_w.cols());
+    RETURN_IF(size == 0 || radius <= 0);
+    const std::vector<int32_t> half_widths = ComputeHalfWidthsOfCircleSprite(radius);
+
+    // Without multi-thread, each block of points is stamped right after projection.
+    if (!use_multi_thread || ImagePainter::GetMaxNumberOfThreads() <= 1) {
+        std::vector<int32_t> pixel_u(kPointsOfBlock);
+        std::vector<int32_t> pixel_v(kPointsOfBlock);
+        std::vector<float> depth(kPointsOfBlock);
+        for (int32_t block_begin = 0; block_begin < size; block_begin += kPointsOfBlock) {
+            const int32_t n = std::min(kPointsOfBlock, size - block_begin);
+            ImagePainter::ProjectPointsInCameraView(cam_, points_in_w.middleCols(block_begin, n), rows_, cols_, radius, pixel_u.data(), pixel_v.data(),
+                                                    depth.data());
+            for (int32_t i = 0; i < n; ++i) {
+                CONTINUE_IF(pixel_u[i] == ImagePainter::kInvalidPixel);
+                StampSpriteWithDepthTest(image, depth_buffer_.data(), pixel_u[i], pixel_v[i], depth[i], half_widths, get_color(block_begin + i, depth[i]));
+            }
+        }
+        return;
+    }
+
+    // Project points in parallel chunks, and bin them into row tiles.
+    std::vector<int32_t> pixel_u(size);
+    std::vector<int32_t> pixel_v(size);
+    std::vector<float> depth(size);
+    ParallelFor(0, size, kMinPointsOfChunk, [&](int32_t begin, int32_t end) {
+        ImagePainter::ProjectPointsInCameraView(cam_, points_in_w.middleCols(begin, end - begin), rows_, cols_, radius, pixel_u.data() + begin,
+                                                pixel_v.data() + begin, depth.data() + begin);
+    });
+    std::vector<int32_t> offsets_of_tiles;
+    std::vector<int32_t> points_in_tiles;
+    BinItemsIntoRowTiles(size, rows_, kRowsOfTile, [&](int32_t i, int32_t &row_min, int32_t &row_max) {
+        // Culled points have invalid pixels, whose row bounds would overflow.
+        RETURN_FALSE_IF(pixel_u[i] == ImagePainter::kInvalidPixel);
+        row_min = pixel_v[i] - radius + 1;
+        row_max = pixel_v[i] + radius - 1;
+        return true;
+    }, offsets_of_tiles, points_in_tiles);
+
+    // Depth buffer is split by the same tiles as image, so each pixel and its depth are tested and written by only one thread.
+    ForEachTileInParallel(static_cast<int32_t>(offsets_of_tiles.size()) - 1, [&](int32_t tile_index) {
+        const int32_t row_offset = tile_index * kRowsOfTile;
+        ImageType tile = GetRowTileOfImage(image, row_offset, std::min(kRowsOfTile, rows_ - row_offset));
+        float *depth_buffer_of_tile = depth_buffer_.data() + static_cast<int64_t>(row_offset) * cols_;
+        for (int32_t k = offsets_of_tiles[tile_index]; k < offsets_of_tiles[tile_index + 1]; ++k) {
+            const int32_t i = points_in_tiles[k];
+            StampSpriteWithDepthTest(tile, depth_buffer_of_tile, pixel_u[i], pixel_v[i] - row_offset, depth[i], half_widths, get_color(i, depth[i]));
+        }
+    });
+}
+
+template bool RenderContext::RenderPointsInCameraView<GrayImage, uint8_t>(GrayImage &image, const PointCloudBatch &points_in_w,
+                                                                          const std::vector<uint8_t> &colors, const int32_t radius, bool use_multi_thread);
+template bool RenderContext::RenderPointsInCameraView<RgbImage, RgbPixel>(RgbImage &image, const PointCloudBatch &points_in_w,
+                                                                          const std::vector<RgbPixel> &colors, const int32_t radius, bool use_multi_thread);
+template <typename ImageType, typename PixelType>
+bool RenderContext::RenderPointsInCameraView(ImageType &image, const PointCloudBatch &points_in_w, const std::vector<PixelType> &colors,
+                                             const int32_t radius, bool use_multi_thread) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kPointsInCameraViewWithDepthTest, image);
+    RETURN_FALSE_IF(!CheckSizeOfImage(image));
+    const int32_t size = static_cast<int32_t>(points_in_w.cols());
+    if (colors.size() != 1 && static_cast<int32_t>(colors.size()) != size) {
+        ReportError("[RenderContext] Size of colors " << colors.size() << " should be 1 or size of points " << size << ".");
+        return false;
+    }
+    const int32_t color_step = colors.size() == 1 ? 0 : 1;
+    RenderPointsWithDepthTest(image, points_in_w, [&](int32_t i, float) { return colors[i * color_step]; }, radius, use_multi_thread);
+    return true;
+}
+
+template bool RenderContext::RenderPointsInCameraViewWithDepthColor<GrayImage>(GrayImage &image, const PointCloudBatch &points_in_w,
+                                                                               const ColorMap &color_map, float min_depth, float max_depth,
+                                                                               const int32_t radius, bool use_multi_thread);
+template bool RenderContext::RenderPointsInCameraViewWithDepthColor<RgbImage>(RgbImage &image, const PointCloudBatch &points_in_w,
+                                                                              const ColorMap &color_map, float min_depth, float max_depth,
+                                                                              const int32_t radius, bool use_multi_thread);
+template <typename ImageType>
+bool RenderContext::RenderPointsInCameraViewWithDepthColor(ImageType &image, const PointCloudBatch &points_in_w, const ColorMap &color_map,
+                                                           float min_depth, float max_depth, const int32_t radius, bool use_multi_thread) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kPointsInCameraViewWithDepthColor, image);
+    RETURN_FALSE_IF(!CheckSizeOfImage(image));
+    if (!(max_depth > min_depth)) {
+        ReportError("[RenderContext] Depth range [" << min_depth << ", " << max_depth << "] is invalid.");
+        return false;
+    }
+    const auto &lut = GetLutOfImage(color_map, image);
+    const float scale = static_cast<float>(ColorMap::kLutSize - 1) / (max_depth - min_depth);
+    RenderPointsWithDepthTest(image, points_in_w, [&](int32_t, float depth) {
+        const float index = std::min(std::max((depth - min_depth) * scale, 0.0f), static_cast<float>(ColorMap::kLutSize - 1));
+        return lut[static_cast<int32_t>(index + 0.5f)];
+    }, radius, use_multi_thread);
+    return true;
+}
+
+template bool RenderContext::RenderLineSegmentInCameraView<GrayImage, uint8_t>(GrayImage &image, const Vec3 &line_s_point, const Vec3 &line_e_point,
+                                                                               const uint8_t color);
+template bool RenderContext::RenderLineSegmentInCameraView<RgbImage, RgbPixel>(RgbImage &image, const Vec3 &line_s_point, const Vec3 &line_e_point,
+                                                                               const RgbPixel color);
+template <typename ImageType, typename PixelType>
+bool RenderContext::RenderLineSegmentInCameraView(ImageType &image, const Vec3 &line_s_point, const Vec3 &line_e_point, const PixelType color) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kLineSegmentInCameraViewWithDepthTest, image);
+    RETURN_FALSE_IF(!CheckSizeOfImage(image));
+    Pixel pixel_uv_s = Pixel::Zero();
+    Pixel pixel_uv_e = Pixel::Zero();
+    float depth_s = 0.0f;
+    float depth_e = 0.0f;
+    if (!ImagePainter::ProjectLineSegmentInCameraView(cam_, line_s_point, line_e_point, pixel_uv_s, pixel_uv_e, &depth_s, &depth_e)) {
+        return true;
+    }
+
+    // Depth is linear in pixels for orthographic projection, while its inverse is linear for perspective projection.
+    const bool is_ortho = cam_.is_ortho;
+    const float value_s = is_ortho ? depth_s : 1.0f / depth_s;
+    const float value_e = is_ortho ? depth_e : 1.0f / depth_e;
+    TraverseBressenhanLine(pixel_uv_s.x(), pixel_uv_s.y(), pixel_uv_e.x(), pixel_uv_e.y(), rows_, cols_,
+                           [&](int32_t row, int32_t col, int64_t step, int64_t num_of_steps) {
+                               const float t = static_cast<float>(step) / static_cast<float>(num_of_steps);
+                               const float value = value_s + (value_e - value_s) * t;
+                               const float depth = is_ortho ? value : 1.0f / value;
+                               float &depth_of_pixel = depth_buffer_[static_cast<int64_t>(row) * cols_ + col];
+                               RETURN_IF(depth > depth_of_pixel);
+                               depth_of_pixel = depth;
+                               SetPixelValueUnchecked(image, row, col, color);
+                           });
+    return true;
+}
+
+template bool RenderContext::RenderEllipseInCameraView<GrayImage, uint8_t>(GrayImage &image, const Vec3 &mid_p_w, const Mat3 &covariance, const uint8_t color);
+template bool RenderContext::RenderEllipseInCameraView<RgbImage, RgbPixel>(RgbImage &image, const Vec3 &mid_p_w, const Mat3 &covariance, const RgbPixel color);
+template <typename ImageType, typename PixelType>
+bool RenderContext::RenderEllipseInCameraView(ImageType &image, const Vec3 &mid_p_w, const Mat3 &covariance, const PixelType color) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kEllipseInCameraViewWithDepthTest, image);
+    RETURN_FALSE_IF(!CheckSizeOfImage(image));
+    Vec2 pixel_uv = Vec2::Zero();
+    Mat2 pixel_cov = Mat2::Zero();
+    float depth = 0.0f;
+    if (!ImagePainter::ProjectGaussianInCameraView(cam_, mid_p_w, covariance, pixel_uv, pixel_cov, &depth)) {
+        return true;
+    }
+
+    // Draw boundary of 2d gaussian ellipse with the same sigma scale as ImagePainter.
+    TraverseTrustRegionOfGaussian(pixel_uv, pixel_cov, 3.0f, false, 0, rows_ - 1, [&](int32_t row, int32_t col_begin, int32_t col_end) {
+        for (int32_t col = std::max(col_begin, 0); col <= std::min(col_end, cols_ - 1); ++col) {
+            float &depth_of_pixel = depth_buffer_[static_cast<int64_t>(row) * cols_ + col];
+            CONTINUE_IF(depth > depth_of_pixel);
+            depth_of_pixel = depth;
+            SetPixelValueUnchecked(image, row, col, color);
+        }
+    });
+    return true;
+}
+
+}  // namespace image_painter
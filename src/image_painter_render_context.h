@@ -0,0 +1,72 @@
+#ifndef _IMAGE_PAINTER_RENDER_CONTEXT_H_
+#define _IMAGE_PAINTER_RENDER_CONTEXT_H_
+
+#include "basic_type.h"
+#include "datatype_image.h"
+#include "image_painter.h"
+#include "image_painter_color_map.h"
+
+namespace image_painter {
+
+/* Class RenderContext Declaration. */
+class RenderContext {
+
+public:
+    using CameraView = ImagePainter::CameraView;
+    using PointCloudBatch = ImagePainter::PointCloudBatch;
+
+public:
+    RenderContext() = default;
+    RenderContext(const CameraView &cam, int32_t rows, int32_t cols);
+    virtual ~RenderContext() = default;
+
+    // Depth buffer is row-major with the same size as image, and is cleared to infinity. Clear it before rendering each frame.
+    void ResizeDepthBuffer(int32_t rows, int32_t cols);
+    void ClearDepthBuffer();
+
+    // Render with depth test, whose depth is z in camera frame. A pixel is written only if it is not farther than depth buffer, and then
+    // depth buffer is updated. Pixels of equal depth are overwritten, so primitives without occlusion keep painter's order. Return false
+    // if size of image does not match depth buffer.
+    template <typename ImageType, typename PixelType>
+    bool RenderPointInCameraView(ImageType &image, const Vec3 &point_in_w, const PixelType color, const int32_t radius = 1);
+    template <typename ImageType, typename PixelType>
+    bool RenderPointsInCameraView(ImageType &image, const PointCloudBatch &points_in_w, const std::vector<PixelType> &colors, const int32_t radius = 1,
+                                  bool use_multi_thread = false);
+    // Color points by depth, where [min_depth, max_depth] is mapped to the whole color map.
+    template <typename ImageType>
+    bool RenderPointsInCameraViewWithDepthColor(ImageType &image, const PointCloudBatch &points_in_w, const ColorMap &color_map, float min_depth,
+                                                float max_depth, const int32_t radius = 1, bool use_multi_thread = false);
+    // Depth of line segment is interpolated in perspective-correct way.
+    template <typename ImageType, typename PixelType>
+    bool RenderLineSegmentInCameraView(ImageType &image, const Vec3 &line_s_point, const Vec3 &line_e_point, const PixelType color);
+    // Boundary of ellipse is tested with depth of its center.
+    template <typename ImageType, typename PixelType>
+    bool RenderEllipseInCameraView(ImageType &image, const Vec3 &mid_p_w, const Mat3 &covariance, const PixelType color);
+
+    // Reference for member variables.
+    CameraView &cam() { return cam_; }
+    int32_t rows() const { return rows_; }
+    int32_t cols() const { return cols_; }
+    float *depth_buffer() { return depth_buffer_.data(); }
+
+    // Const reference for member variables.
+    const CameraView &cam() const { return cam_; }
+    const float *depth_buffer() const { return depth_buffer_.data(); }
+
+private:
+    template <typename ImageType>
+    bool CheckSizeOfImage(const ImageType &image) const;
+    template <typename ImageType, typename ColorFunction>
+    void RenderPointsWithDepthTest(ImageType &image, const PointCloudBatch &points_in_w, const ColorFunction &get_color, const int32_t radius,
+                                   bool use_multi_thread);
+
+private:
+    CameraView cam_;
+    int32_t rows_ = 0;
+    int32_t cols_ = 0;
+    std::vector<float> depth_buffer_;
+};
+
+}  // namespace image_painter
+
+#endif  // end of _IMAGE_PAINTER_RENDER_CONTEXT_H_
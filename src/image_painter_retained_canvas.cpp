@@ -0,0 +1,122 @@
+#include "image_painter_retained_canvas.h"
+#include "image_painter_parallel.h"
+#include "image_painter_pixel.h"
+#include "image_painter_profile.h"
+#include "image_painter_tile.h"
+
+#include "slam_log_reporter.h"
+
+#include "cstring"
+
+namespace image_painter {
+
+template <typename ImageType, typename PixelType>
+bool RetainedCanvas<ImageType, PixelType>::SetBackground(const ImageType &background) {
+    if (background.data() == nullptr || background.rows() <= 0 || background.cols() <= 0) {
+        ReportError("[RetainedCanvas] Background is empty.");
+        return false;
+    }
+    rows_ = background.rows();
+    cols_ = background.cols();
+    const int64_t size = static_cast<int64_t>(rows_) * cols_ * GetChannelsOfImage(background);
+    background_.assign(background.data(), background.data() + size);
+    is_valid_ = false;
+    return true;
+}
+
+template <typename ImageType, typename PixelType>
+bool RetainedCanvas<ImageType, PixelType>::Present(const FrameType &frame, ImageType &canvas, bool use_multi_thread) {
+    IMAGE_PAINTER_PROFILE_SCOPE(kPresentRetainedCanvas, canvas);
+    if (background_.empty()) {
+        ReportError("[RetainedCanvas] Background should be set before presenting.");
+        return false;
+    }
+    if (canvas.data() == nullptr || canvas.rows() != rows_ || canvas.cols() != cols_) {
+        ReportError("[RetainedCanvas] Size of canvas " << canvas.rows() << " x " << canvas.cols() << " does not match background " << rows_ << " x "
+                                                       << cols_ << ".");
+        return false;
+    }
+    // Content of another canvas is unknown.
+    if (canvas.data() != last_canvas_data_) {
+        is_valid_ = false;
+    }
+
+    // Bin commands of this frame into tiles.
+    const std::vector<typename FrameType::Command> &commands = frame.commands();
+    std::vector<int32_t> offsets_of_tiles;
+    std::vector<int32_t> commands_in_tiles;
+    BinItemsIntoRowTiles(static_cast<int32_t>(commands.size()), rows_, kRowsOfTile, [&](int32_t i, int32_t &row_min, int32_t &row_max) {
+        row_min = commands[i].row_min;
+        row_max = commands[i].row_max;
+        return true;
+    }, offsets_of_tiles, commands_in_tiles);
+
+    // Tile is dirty if its sequence of commands changes.
+    const int32_t num_of_tiles = static_cast<int32_t>(offsets_of_tiles.size()) - 1;
+    std::vector<int32_t> dirty_tiles;
+    for (int32_t tile_index = 0; tile_index < num_of_tiles; ++tile_index) {
+        bool is_dirty = !is_valid_;
+        const int32_t begin = offsets_of_tiles[tile_index];
+        const int32_t size = offsets_of_tiles[tile_index + 1] - begin;
+        if (!is_dirty) {
+            const int32_t last_begin = last_offsets_of_tiles_[tile_index];
+            is_dirty = size != last_offsets_of_tiles_[tile_index + 1] - last_begin;
+            for (int32_t k = 0; k < size && !is_dirty; ++k) {
+                is_dirty = !frame.IsSameCommand(commands_in_tiles[begin + k], last_frame_, last_commands_in_tiles_[last_begin + k]);
+            }
+        }
+        if (is_dirty) {
+            dirty_tiles.emplace_back(tile_index);
+        }
+    }
+
+    // Restore dirty tiles from background, and repaint their commands in recorded order.
+    const int64_t stride = static_cast<int64_t>(cols_) * GetChannelsOfImage(canvas);
+    auto repaint_tile = [&](int32_t tile_index) {
+        const int32_t row_offset = tile_index * kRowsOfTile;
+        const int32_t rows_of_tile = std::min(kRowsOfTile, rows_ - row_offset);
+        std::memcpy(canvas.data() + row_offset * stride, background_.data() + row_offset * stride, rows_of_tile * stride);
+        ImageType tile = GetRowTileOfImage(canvas, row_offset, rows_of_tile);
+        for (int32_t k = offsets_of_tiles[tile_index]; k < offsets_of_tiles[tile_index + 1]; ++k) {
+            frame.ExecuteCommandInTile(commands_in_tiles[k], tile, row_offset);
+        }
+    };
+    const int32_t num_of_dirty_tiles = static_cast<int32_t>(dirty_tiles.size());
+    if (use_multi_thread) {
+        ForEachTileInParallel(num_of_dirty_tiles, [&](int32_t i) { repaint_tile(dirty_tiles[i]); });
+    } else {
+        for (const int32_t tile_index: dirty_tiles) {
+            repaint_tile(tile_index);
+        }
+    }
+
+    // Update statistics and dirty rectangles.
+    statistics_ = Statistics();
+    statistics_.num_of_tiles = num_of_tiles;
+    statistics_.num_of_dirty_tiles = num_of_dirty_tiles;
+    dirty_rectangles_.clear();
+    for (const int32_t tile_index: dirty_tiles) {
+        const int32_t row_offset = tile_index * kRowsOfTile;
+        const int32_t rows_of_tile = std::min(kRowsOfTile, rows_ - row_offset);
+        statistics_.num_of_touched_pixels += static_cast<int64_t>(rows_of_tile) * cols_;
+        statistics_.num_of_executed_commands += offsets_of_tiles[tile_index + 1] - offsets_of_tiles[tile_index];
+        if (!dirty_rectangles_.empty() && dirty_rectangles_.back().y + dirty_rectangles_.back().height == row_offset) {
+            dirty_rectangles_.back().height += rows_of_tile;
+        } else {
+            dirty_rectangles_.emplace_back(ImagePainter::Rectangle{0, row_offset, cols_, rows_of_tile});
+        }
+    }
+
+    // Keep this frame for the next one.
+    last_frame_ = frame;
+    last_offsets_of_tiles_.swap(offsets_of_tiles);
+    last_commands_in_tiles_.swap(commands_in_tiles);
+    last_canvas_data_ = canvas.data();
+    is_valid_ = true;
+    return true;
+}
+
+template class RetainedCanvas<GrayImage, uint8_t>;
+template class RetainedCanvas<RgbImage, RgbPixel>;
+
+}  // namespace image_painter
@@ -0,0 +1,65 @@
+#ifndef _IMAGE_PAINTER_RETAINED_CANVAS_H_
+#define _IMAGE_PAINTER_RETAINED_CANVAS_H_
+
+#include "basic_type.h"
+#include "datatype_image.h"
+#include "image_painter.h"
+#include "image_painter_display_list.h"
+
+namespace image_painter {
+
+/* Class RetainedCanvas Declaration. */
+template <typename ImageType, typename PixelType>
+class RetainedCanvas {
+
+public:
+    using FrameType = DisplayList<ImageType, PixelType>;
+
+    // Canvas is split into tiles of rows, which are the unit of restoring and repainting.
+    static constexpr int32_t kRowsOfTile = 16;
+
+    struct Statistics {
+        int32_t num_of_tiles = 0;
+        int32_t num_of_dirty_tiles = 0;
+        int64_t num_of_touched_pixels = 0;
+        int32_t num_of_executed_commands = 0;
+    };
+
+public:
+    RetainedCanvas() = default;
+    virtual ~RetainedCanvas() = default;
+
+    // Background is copied, and the whole canvas is repainted on next frame.
+    bool SetBackground(const ImageType &background);
+    // Repaint the whole canvas on next frame.
+    void Invalidate() { is_valid_ = false; }
+
+    // Paint frame onto canvas, which should keep the content of the last presented frame. Tiles are dirty if the commands covering them
+    // differ from the last frame in value or order. Only dirty tiles are restored from background and repainted, so the result is the
+    // same as drawing the frame on background.
+    bool Present(const FrameType &frame, ImageType &canvas, bool use_multi_thread = false);
+
+    // Reference for member variables.
+    const Statistics &statistics() const { return statistics_; }
+    // Dirty rectangles of the last presented frame. Adjacent dirty tiles are merged.
+    const std::vector<ImagePainter::Rectangle> &dirty_rectangles() const { return dirty_rectangles_; }
+
+private:
+    std::vector<uint8_t> background_;
+    int32_t rows_ = 0;
+    int32_t cols_ = 0;
+
+    // Last presented frame, with its commands binned into tiles.
+    FrameType last_frame_;
+    std::vector<int32_t> last_offsets_of_tiles_;
+    std::vector<int32_t> last_commands_in_tiles_;
+    const uint8_t *last_canvas_data_ = nullptr;
+    bool is_valid_ = false;
+
+    Statistics statistics_;
+    std::vector<ImagePainter::Rectangle> dirty_rectangles_;
+};
+
+}  // namespace image_painter
+
+#endif  // end of _IMAGE_PAINTER_RETAINED_CANVAS_H_
@@ -0,0 +1,448 @@
+#include "image_painter_simd.h"
+
+#include "slam_log_reporter.h"
+#include "slam_memory.h"
+
+#include "atomic"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define IMAGE_PAINTER_SIMD_X86 1
+#include "immintrin.h"
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define IMAGE_PAINTER_SIMD_NEON 1
+#include "arm_neon.h"
+#endif
+
+namespace image_painter {
+
+namespace {
+    /* Scalar reference kernels. */
+    void ConvertGrayToRgbScalar(const uint8_t *gray, uint8_t *rgb, int32_t size) {
+        for (int32_t i = 0; i < size; ++i) {
+            const int32_t idx = i * 3;
+            std::fill_n(rgb + idx, 3, gray[i]);
+        }
+    }
+
+    void ConvertRgbToGrayScalar(const uint8_t *rgb, uint8_t *gray, int32_t size) {
+        for (int32_t i = 0; i < size; ++i) {
+            const int32_t idx = i * 3;
+            gray[i] = static_cast<uint8_t>(static_cast<float>(rgb[idx]) * 0.299f + static_cast<float>(rgb[idx + 1]) * 0.587f +
+                                           static_cast<float>(rgb[idx + 2]) * 0.114f);
+        }
+    }
+
+    void ConvertRgbToBgrScalar(const uint8_t *rgb, uint8_t *bgr, int32_t size) {
+        for (int32_t i = 0; i < size; ++i) {
+            const int32_t idx = i * 3;
+            const uint8_t r = rgb[idx];
+            bgr[idx + 1] = rgb[idx + 1];
+            bgr[idx] = rgb[idx + 2];
+            bgr[idx + 2] = r;
+        }
+    }
+
+    // Fixed-point version of rgb -> gray, used for the tail pixels of simd kernels.
+    void ConvertRgbToGrayFixedPoint(const uint8_t *rgb, uint8_t *gray, int32_t size) {
+        for (int32_t i = 0; i < size; ++i) {
+            const int32_t idx = i * 3;
+            gray[i] = static_cast<uint8_t>((rgb[idx] * kLumaWeightR + rgb[idx + 1] * kLumaWeightG + rgb[idx + 2] * kLumaWeightB) >> kLumaWeightShift);
+        }
+    }
+
+    // Blend bytes of span, whose first byte is at offset of pattern. It is also used for the tail bytes of simd kernels.
+    void BlendSpanFromOffsetScalar(uint8_t *span, int32_t size, const BlendPattern &pattern, int32_t offset) {
+        const int32_t inverse_alpha = 255 - pattern.alpha;
+        for (int32_t i = 0; i < size; ++i) {
+            const int32_t j = (offset + i) % kBlendPatternSize;
+            switch (pattern.mode) {
+                default:
+                case ImagePainter::BlendMode::kAlpha: {
+                    // weighted already contains the rounding bias of DivideBy255.
+                    const int32_t value = span[i] * inverse_alpha + pattern.weighted[j];
+                    span[i] = static_cast<uint8_t>((value + (value >> 8)) >> 8);
+                    break;
+                }
+                case ImagePainter::BlendMode::kAdditive:
+                    span[i] = static_cast<uint8_t>(std::min(span[i] + pattern.scaled[j], 255));
+                    break;
+                case ImagePainter::BlendMode::kMax:
+                    span[i] = std::max(span[i], pattern.scaled[j]);
+                    break;
+            }
+        }
+    }
+
+    void BlendSpanScalar(uint8_t *span, int32_t size, const BlendPattern &pattern) { BlendSpanFromOffsetScalar(span, size, pattern, 0); }
+
+#ifdef IMAGE_PAINTER_SIMD_X86
+    /* Sse4.1 kernels. Rgb pixels are loaded 4 by 4 with overlapped 16 bytes loads, and reordered by pshufb. */
+    __attribute__((target("sse4.1"))) void ConvertGrayToRgbSse41(const uint8_t *gray, uint8_t *rgb, int32_t size) {
+        const __m128i mask_0 = _mm_setr_epi8(0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5);
+        const __m128i mask_1 = _mm_setr_epi8(5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10);
+        const __m128i mask_2 = _mm_setr_epi8(10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15);
+        int32_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(gray + i));
+            __m128i *output = reinterpret_cast<__m128i *>(rgb + i * 3);
+            _mm_storeu_si128(output, _mm_shuffle_epi8(value, mask_0));
+            _mm_storeu_si128(output + 1, _mm_shuffle_epi8(value, mask_1));
+            _mm_storeu_si128(output + 2, _mm_shuffle_epi8(value, mask_2));
+        }
+        ConvertGrayToRgbScalar(gray + i, rgb + i * 3, size - i);
+    }
+
+    __attribute__((target("sse4.1"))) __m128i ComputeLumaOfFourPixelsSse41(const uint8_t *rgb) {
+        const __m128i mask_rg = _mm_setr_epi8(0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10, -1);
+        const __m128i mask_b = _mm_setr_epi8(2, -1, -1, -1, 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1);
+        const __m128i weight_rg = _mm_set1_epi32((kLumaWeightG << 16) | kLumaWeightR);
+        const __m128i weight_b = _mm_set1_epi32(kLumaWeightB);
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgb));
+        const __m128i sum_rg = _mm_madd_epi16(_mm_shuffle_epi8(value, mask_rg), weight_rg);
+        const __m128i sum_b = _mm_madd_epi16(_mm_shuffle_epi8(value, mask_b), weight_b);
+        return _mm_srli_epi32(_mm_add_epi32(sum_rg, sum_b), kLumaWeightShift);
+    }
+
+    __attribute__((target("sse4.1"))) void ConvertRgbToGraySse41(const uint8_t *rgb, uint8_t *gray, int32_t size) {
+        int32_t i = 0;
+        // The last load reads 16 bytes from the 12th pixel, so 52 bytes should be valid.
+        for (; 3 * i + 52 <= 3 * size; i += 16) {
+            const uint8_t *input = rgb + i * 3;
+            const __m128i luma_0 = ComputeLumaOfFourPixelsSse41(input);
+            const __m128i luma_1 = ComputeLumaOfFourPixelsSse41(input + 12);
+            const __m128i luma_2 = ComputeLumaOfFourPixelsSse41(input + 24);
+            const __m128i luma_3 = ComputeLumaOfFourPixelsSse41(input + 36);
+            const __m128i luma = _mm_packus_epi16(_mm_packus_epi32(luma_0, luma_1), _mm_packus_epi32(luma_2, luma_3));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(gray + i), luma);
+        }
+        ConvertRgbToGrayFixedPoint(rgb + i * 3, gray + i, size - i);
+    }
+
+    __attribute__((target("sse4.1"))) void ConvertRgbToBgrSse41(const uint8_t *rgb, uint8_t *bgr, int32_t size) {
+        // Swap 4 pixels in each 16 bytes, and keep the last 4 bytes unchanged. These bytes are overwritten by the
+        // next step, which also keeps in-place convertion correct.
+        const __m128i mask = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15);
+        int32_t i = 0;
+        for (; 3 * i + 16 <= 3 * size; i += 4) {
+            const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgb + i * 3));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(bgr + i * 3), _mm_shuffle_epi8(value, mask));
+        }
+        ConvertRgbToBgrScalar(rgb + i * 3, bgr + i * 3, size - i);
+    }
+
+    // Blend 8 bytes extended into 16 bits, by (value * inverse_alpha + weighted) / 255 in fixed-point.
+    __attribute__((target("sse4.1"))) __m128i BlendAlphaOfEightBytesSse41(__m128i value, __m128i inverse_alpha, const uint16_t *weighted) {
+        const __m128i sum = _mm_add_epi16(_mm_mullo_epi16(value, inverse_alpha), _mm_loadu_si128(reinterpret_cast<const __m128i *>(weighted)));
+        return _mm_srli_epi16(_mm_add_epi16(sum, _mm_srli_epi16(sum, 8)), 8);
+    }
+
+    __attribute__((target("sse4.1"))) void BlendSpanSse41(uint8_t *span, int32_t size, const BlendPattern &pattern) {
+        const __m128i inverse_alpha = _mm_set1_epi16(static_cast<int16_t>(255 - pattern.alpha));
+        int32_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            const int32_t j = i % kBlendPatternSize;
+            __m128i *output = reinterpret_cast<__m128i *>(span + i);
+            const __m128i value = _mm_loadu_si128(output);
+            switch (pattern.mode) {
+                default:
+                case ImagePainter::BlendMode::kAlpha: {
+                    const __m128i low = BlendAlphaOfEightBytesSse41(_mm_cvtepu8_epi16(value), inverse_alpha, pattern.weighted.data() + j);
+                    const __m128i high = BlendAlphaOfEightBytesSse41(_mm_cvtepu8_epi16(_mm_srli_si128(value, 8)), inverse_alpha, pattern.weighted.data() + j + 8);
+                    _mm_storeu_si128(output, _mm_packus_epi16(low, high));
+                    break;
+                }
+                case ImagePainter::BlendMode::kAdditive:
+                    _mm_storeu_si128(output, _mm_adds_epu8(value, _mm_loadu_si128(reinterpret_cast<const __m128i *>(pattern.scaled.data() + j))));
+                    break;
+                case ImagePainter::BlendMode::kMax:
+                    _mm_storeu_si128(output, _mm_max_epu8(value, _mm_loadu_si128(reinterpret_cast<const __m128i *>(pattern.scaled.data() + j))));
+                    break;
+            }
+        }
+        BlendSpanFromOffsetScalar(span + i, size - i, pattern, i % kBlendPatternSize);
+    }
+
+    /* Avx2 kernels. Two groups of 4 rgb pixels are loaded into the two 128-bit lanes, so the sse4.1 shuffle masks still work. */
+    __attribute__((target("avx2"))) __m256i LoadTwoGroupsOfPixelsAvx2(const uint8_t *rgb) {
+        const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgb));
+        const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgb + 12));
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+    }
+
+    __attribute__((target("avx2"))) void ConvertGrayToRgbAvx2(const uint8_t *gray, uint8_t *rgb, int32_t size) {
+        const __m256i mask_01 = _mm256_setr_epi8(0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5, 5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10);
+        const __m128i mask_2 = _mm_setr_epi8(10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15);
+        int32_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(gray + i));
+            uint8_t *output = rgb + i * 3;
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(output), _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(value), mask_01));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + 32), _mm_shuffle_epi8(value, mask_2));
+        }
+        ConvertGrayToRgbScalar(gray + i, rgb + i * 3, size - i);
+    }
+
+    __attribute__((target("avx2"))) __m256i ComputeLumaOfEightPixelsAvx2(const uint8_t *rgb) {
+        const __m256i mask_rg = _mm256_setr_epi8(0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10, -1, 0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10, -1);
+        const __m256i mask_b = _mm256_setr_epi8(2, -1, -1, -1, 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1, 2, -1, -1, -1, 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1);
+        const __m256i weight_rg = _mm256_set1_epi32((kLumaWeightG << 16) | kLumaWeightR);
+        const __m256i weight_b = _mm256_set1_epi32(kLumaWeightB);
+        const __m256i value = LoadTwoGroupsOfPixelsAvx2(rgb);
+        const __m256i sum_rg = _mm256_madd_epi16(_mm256_shuffle_epi8(value, mask_rg), weight_rg);
+        const __m256i sum_b = _mm256_madd_epi16(_mm256_shuffle_epi8(value, mask_b), weight_b);
+        return _mm256_srli_epi32(_mm256_add_epi32(sum_rg, sum_b), kLumaWeightShift);
+    }
+
+    __attribute__((target("avx2"))) void ConvertRgbToGrayAvx2(const uint8_t *rgb, uint8_t *gray, int32_t size) {
+        // Packing works inside 128-bit lanes, so 32-bit groups are reordered at last.
+        const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        int32_t i = 0;
+        // The last load reads 16 bytes from the 28th pixel, so 100 bytes should be valid.
+        for (; 3 * i + 100 <= 3 * size; i += 32) {
+            const uint8_t *input = rgb + i * 3;
+            const __m256i luma_0 = ComputeLumaOfEightPixelsAvx2(input);
+            const __m256i luma_1 = ComputeLumaOfEightPixelsAvx2(input + 24);
+            const __m256i luma_2 = ComputeLumaOfEightPixelsAvx2(input + 48);
+            const __m256i luma_3 = ComputeLumaOfEightPixelsAvx2(input + 72);
+            const __m256i luma = _mm256_packus_epi16(_mm256_packus_epi32(luma_0, luma_1), _mm256_packus_epi32(luma_2, luma_3));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(gray + i), _mm256_permutevar8x32_epi32(luma, order));
+        }
+        ConvertRgbToGraySse41(rgb + i * 3, gray + i, size - i);
+    }
+
+    __attribute__((target("avx2"))) void ConvertRgbToBgrAvx2(const uint8_t *rgb, uint8_t *bgr, int32_t size) {
+        const __m256i mask = _mm256_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15, 2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15);
+        int32_t i = 0;
+        for (; 3 * i + 28 <= 3 * size; i += 8) {
+            const __m256i value = _mm256_shuffle_epi8(LoadTwoGroupsOfPixelsAvx2(rgb + i * 3), mask);
+            // Store the low lane first, so the unchanged 4 bytes of it are overwritten by the high lane.
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(bgr + i * 3), _mm256_castsi256_si128(value));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(bgr + i * 3 + 12), _mm256_extracti128_si256(value, 1));
+        }
+        ConvertRgbToBgrSse41(rgb + i * 3, bgr + i * 3, size - i);
+    }
+
+    __attribute__((target("avx2"))) __m256i BlendAlphaOfSixteenBytesAvx2(__m256i value, __m256i inverse_alpha, const uint16_t *weighted) {
+        const __m256i sum =
+            _mm256_add_epi16(_mm256_mullo_epi16(value, inverse_alpha), _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weighted)));
+        return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_srli_epi16(sum, 8)), 8);
+    }
+
+    __attribute__((target("avx2"))) void BlendSpanAvx2(uint8_t *span, int32_t size, const BlendPattern &pattern) {
+        const __m256i inverse_alpha = _mm256_set1_epi16(static_cast<int16_t>(255 - pattern.alpha));
+        int32_t i = 0;
+        for (; i + 32 <= size; i += 32) {
+            const int32_t j = i % kBlendPatternSize;
+            __m256i *output = reinterpret_cast<__m256i *>(span + i);
+            const __m256i value = _mm256_loadu_si256(output);
+            switch (pattern.mode) {
+                default:
+                case ImagePainter::BlendMode::kAlpha: {
+                    // Packing works inside 128-bit lanes, so 64-bit groups are reordered at last.
+                    const __m256i low = BlendAlphaOfSixteenBytesAvx2(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(value)), inverse_alpha,
+                                                                     pattern.weighted.data() + j);
+                    const __m256i high = BlendAlphaOfSixteenBytesAvx2(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(value, 1)), inverse_alpha,
+                                                                      pattern.weighted.data() + j + 16);
+                    _mm256_storeu_si256(output, _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xd8));
+                    break;
+                }
+                case ImagePainter::BlendMode::kAdditive:
+                    _mm256_storeu_si256(output, _mm256_adds_epu8(value, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pattern.scaled.data() + j))));
+                    break;
+                case ImagePainter::BlendMode::kMax:
+                    _mm256_storeu_si256(output, _mm256_max_epu8(value, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pattern.scaled.data() + j))));
+                    break;
+            }
+        }
+        BlendSpanFromOffsetScalar(span + i, size - i, pattern, i % kBlendPatternSize);
+    }
+#endif  // end of IMAGE_PAINTER_SIMD_X86
+
+#ifdef IMAGE_PAINTER_SIMD_NEON
+    /* Neon kernels. Interleaved rgb pixels are split by vld3 / vst3 directly. */
+    void ConvertGrayToRgbNeon(const uint8_t *gray, uint8_t *rgb, int32_t size) {
+        int32_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            const uint8x16_t value = vld1q_u8(gray + i);
+            uint8x16x3_t output;
+            output.val[0] = value;
+            output.val[1] = value;
+            output.val[2] = value;
+            vst3q_u8(rgb + i * 3, output);
+        }
+        ConvertGrayToRgbScalar(gray + i, rgb + i * 3, size - i);
+    }
+
+    uint16x8_t ComputeLumaOfEightPixelsNeon(uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+        const uint16x8_t r_16 = vmovl_u8(r);
+        const uint16x8_t g_16 = vmovl_u8(g);
+        const uint16x8_t b_16 = vmovl_u8(b);
+        uint32x4_t low = vmull_n_u16(vget_low_u16(r_16), kLumaWeightR);
+        low = vmlal_n_u16(low, vget_low_u16(g_16), kLumaWeightG);
+        low = vmlal_n_u16(low, vget_low_u16(b_16), kLumaWeightB);
+        uint32x4_t high = vmull_n_u16(vget_high_u16(r_16), kLumaWeightR);
+        high = vmlal_n_u16(high, vget_high_u16(g_16), kLumaWeightG);
+        high = vmlal_n_u16(high, vget_high_u16(b_16), kLumaWeightB);
+        return vcombine_u16(vshrn_n_u32(low, kLumaWeightShift), vshrn_n_u32(high, kLumaWeightShift));
+    }
+
+    void ConvertRgbToGrayNeon(const uint8_t *rgb, uint8_t *gray, int32_t size) {
+        int32_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            const uint8x16x3_t value = vld3q_u8(rgb + i * 3);
+            const uint16x8_t luma_low = ComputeLumaOfEightPixelsNeon(vget_low_u8(value.val[0]), vget_low_u8(value.val[1]), vget_low_u8(value.val[2]));
+            const uint16x8_t luma_high = ComputeLumaOfEightPixelsNeon(vget_high_u8(value.val[0]), vget_high_u8(value.val[1]), vget_high_u8(value.val[2]));
+            vst1q_u8(gray + i, vcombine_u8(vmovn_u16(luma_low), vmovn_u16(luma_high)));
+        }
+        ConvertRgbToGrayFixedPoint(rgb + i * 3, gray + i, size - i);
+    }
+
+    void ConvertRgbToBgrNeon(const uint8_t *rgb, uint8_t *bgr, int32_t size) {
+        int32_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            uint8x16x3_t value = vld3q_u8(rgb + i * 3);
+            const uint8x16_t r = value.val[0];
+            value.val[0] = value.val[2];
+            value.val[2] = r;
+            vst3q_u8(bgr + i * 3, value);
+        }
+        ConvertRgbToBgrScalar(rgb + i * 3, bgr + i * 3, size - i);
+    }
+
+    uint8x8_t BlendAlphaOfEightBytesNeon(uint8x8_t value, uint16x8_t inverse_alpha, const uint16_t *weighted) {
+        const uint16x8_t sum = vmlaq_u16(vld1q_u16(weighted), vmovl_u8(value), inverse_alpha);
+        return vshrn_n_u16(vsraq_n_u16(sum, sum, 8), 8);
+    }
+
+    void BlendSpanNeon(uint8_t *span, int32_t size, const BlendPattern &pattern) {
+        const uint16x8_t inverse_alpha = vdupq_n_u16(static_cast<uint16_t>(255 - pattern.alpha));
+        int32_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            const int32_t j = i % kBlendPatternSize;
+            const uint8x16_t value = vld1q_u8(span + i);
+            switch (pattern.mode) {
+                default:
+                case ImagePainter::BlendMode::kAlpha: {
+                    const uint8x8_t low = BlendAlphaOfEightBytesNeon(vget_low_u8(value), inverse_alpha, pattern.weighted.data() + j);
+                    const uint8x8_t high = BlendAlphaOfEightBytesNeon(vget_high_u8(value), inverse_alpha, pattern.weighted.data() + j + 8);
+                    vst1q_u8(span + i, vcombine_u8(low, high));
+                    break;
+                }
+                case ImagePainter::BlendMode::kAdditive:
+                    vst1q_u8(span + i, vqaddq_u8(value, vld1q_u8(pattern.scaled.data() + j)));
+                    break;
+                case ImagePainter::BlendMode::kMax:
+                    vst1q_u8(span + i, vmaxq_u8(value, vld1q_u8(pattern.scaled.data() + j)));
+                    break;
+            }
+        }
+        BlendSpanFromOffsetScalar(span + i, size - i, pattern, i % kBlendPatternSize);
+    }
+#endif  // end of IMAGE_PAINTER_SIMD_NEON
+
+    SimdKernels CreateSimdKernels(ImagePainter::SimdLevel level) {
+        SimdKernels kernels;
+        kernels.convert_gray_to_rgb = ConvertGrayToRgbScalar;
+        kernels.convert_rgb_to_gray = ConvertRgbToGrayScalar;
+        kernels.convert_rgb_to_bgr = ConvertRgbToBgrScalar;
+        kernels.blend_span = BlendSpanScalar;
+
+        switch (level) {
+#ifdef IMAGE_PAINTER_SIMD_X86
+            case ImagePainter::SimdLevel::kSse41: {
+                kernels.convert_gray_to_rgb = ConvertGrayToRgbSse41;
+                kernels.convert_rgb_to_gray = ConvertRgbToGraySse41;
+                kernels.convert_rgb_to_bgr = ConvertRgbToBgrSse41;
+                kernels.blend_span = BlendSpanSse41;
+                break;
+            }
+            case ImagePainter::SimdLevel::kAvx2: {
+                kernels.convert_gray_to_rgb = ConvertGrayToRgbAvx2;
+                kernels.convert_rgb_to_gray = ConvertRgbToGrayAvx2;
+                kernels.convert_rgb_to_bgr = ConvertRgbToBgrAvx2;
+                kernels.blend_span = BlendSpanAvx2;
+                break;
+            }
+#endif
+#ifdef IMAGE_PAINTER_SIMD_NEON
+            case ImagePainter::SimdLevel::kNeon: {
+                kernels.convert_gray_to_rgb = ConvertGrayToRgbNeon;
+                kernels.convert_rgb_to_gray = ConvertRgbToGrayNeon;
+                kernels.convert_rgb_to_bgr = ConvertRgbToBgrNeon;
+                kernels.blend_span = BlendSpanNeon;
+                break;
+            }
+#endif
+            default:
+                break;
+        }
+        return kernels;
+    }
+
+    std::atomic<ImagePainter::SimdLevel> &CurrentSimdLevel() {
+        static std::atomic<ImagePainter::SimdLevel> level(ImagePainter::GetSupportedSimdLevel());
+        return level;
+    }
+}  // namespace
+
+const SimdKernels &GetSimdKernels(ImagePainter::SimdLevel level) {
+    static const SimdKernels kScalarKernels = CreateSimdKernels(ImagePainter::SimdLevel::kScalar);
+    static const SimdKernels kSse41Kernels = CreateSimdKernels(ImagePainter::SimdLevel::kSse41);
+    static const SimdKernels kAvx2Kernels = CreateSimdKernels(ImagePainter::SimdLevel::kAvx2);
+    static const SimdKernels kNeonKernels = CreateSimdKernels(ImagePainter::SimdLevel::kNeon);
+    switch (level) {
+        case ImagePainter::SimdLevel::kSse41:
+            return kSse41Kernels;
+        case ImagePainter::SimdLevel::kAvx2:
+            return kAvx2Kernels;
+        case ImagePainter::SimdLevel::kNeon:
+            return kNeonKernels;
+        default:
+            return kScalarKernels;
+    }
+}
+
+const SimdKernels &GetSimdKernels() { return GetSimdKernels(CurrentSimdLevel().load(std::memory_order_relaxed)); }
+
+bool ImagePainter::IsSimdLevelSupported(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::kScalar:
+            return true;
+#ifdef IMAGE_PAINTER_SIMD_X86
+        case SimdLevel::kSse41:
+            return __builtin_cpu_supports("sse4.1");
+        case SimdLevel::kAvx2:
+            return __builtin_cpu_supports("avx2");
+#endif
+#ifdef IMAGE_PAINTER_SIMD_NEON
+        case SimdLevel::kNeon:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+ImagePainter::SimdLevel ImagePainter::GetSupportedSimdLevel() {
+    for (const SimdLevel level: {SimdLevel::kAvx2, SimdLevel::kSse41, SimdLevel::kNeon}) {
+        if (IsSimdLevelSupported(level)) {
+            return level;
+        }
+    }
+    return SimdLevel::kScalar;
+}
+
+ImagePainter::SimdLevel ImagePainter::GetSimdLevel() { return CurrentSimdLevel().load(std::memory_order_relaxed); }
+
+bool ImagePainter::SetSimdLevel(SimdLevel level) {
+    if (!IsSimdLevelSupported(level)) {
+        ReportError("[ImagePainter] Simd level " << static_cast<int32_t>(level) << " is not supported by this cpu.");
+        return false;
+    }
+    CurrentSimdLevel().store(level, std::memory_order_relaxed);
+    return true;
+}
+
+}  // namespace image_painter
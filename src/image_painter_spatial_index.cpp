@@ -0,0 +1,222 @@
+#include "image_painter_spatial_index.h"
+
+#include "slam_log_reporter.h"
+#include "slam_operations.h"
+
+#include "algorithm"
+#include "cmath"
+
+namespace image_painter {
+
+namespace {
+    // Voxels are padded in frustum test, so rounding error of projection never culls a visible item.
+    constexpr float kVoxelPaddingRatio = 0.01f;
+
+    uint64_t ComputeVoxelKey(const std::array<int32_t, 3> &coord) {
+        const uint64_t x = static_cast<uint64_t>(coord[0] + SpatialIndex::kMaxVoxelCoordinate + 1);
+        const uint64_t y = static_cast<uint64_t>(coord[1] + SpatialIndex::kMaxVoxelCoordinate + 1);
+        const uint64_t z = static_cast<uint64_t>(coord[2] + SpatialIndex::kMaxVoxelCoordinate + 1);
+        return (x << 42) | (y << 21) | z;
+    }
+
+    // Candidates are marked in bitmap, so they are collected in ascending order without sorting, and items in several voxels are merged.
+    void MarkIndicesInBitmap(const std::vector<int32_t> &indices, std::vector<uint64_t> &bitmap) {
+        for (const int32_t index: indices) {
+            bitmap[index >> 6] |= uint64_t(1) << (index & 63);
+        }
+    }
+
+    void CollectIndicesFromBitmap(const std::vector<uint64_t> &bitmap, std::vector<int32_t> &indices) {
+        indices.clear();
+        for (int32_t i = 0; i < static_cast<int32_t>(bitmap.size()); ++i) {
+            for (uint64_t word = bitmap[i]; word != 0; word &= word - 1) {
+                indices.emplace_back((i << 6) + __builtin_ctzll(word));
+            }
+        }
+    }
+}  // namespace
+
+SpatialIndex::SpatialIndex(float voxel_size) : voxel_size_(voxel_size) {
+    if (!(voxel_size_ > 0.0f)) {
+        ReportError("[SpatialIndex] Voxel size " << voxel_size_ << " should be positive, use 1.0 instead.");
+        voxel_size_ = 1.0f;
+    }
+}
+
+bool SpatialIndex::ComputeVoxelCoordinate(const Vec3 &p_w, std::array<int32_t, 3> &coord) const {
+    // Point out of range would be stored in a boundary voxel whose box does not contain it, and be culled even if it is visible.
+    for (int32_t i = 0; i < 3; ++i) {
+        const float value = std::floor(p_w[i] / voxel_size_);
+        RETURN_FALSE_IF(!(std::abs(value) <= static_cast<float>(kMaxVoxelCoordinate)));
+        coord[i] = static_cast<int32_t>(value);
+    }
+    return true;
+}
+
+SpatialIndex::Voxel &SpatialIndex::GetOrCreateVoxel(const std::array<int32_t, 3> &coord) {
+    const auto result = voxel_indices_.emplace(ComputeVoxelKey(coord), static_cast<int32_t>(voxels_.size()));
+    if (result.second) {
+        voxels_.emplace_back();
+        voxels_.back().min_corner = Vec3(coord[0], coord[1], coord[2]) * voxel_size_;
+
+        // Register new voxel in its block.
+        std::array<int32_t, 3> block_coord = {};
+        for (int32_t i = 0; i < 3; ++i) {
+            block_coord[i] = coord[i] >= 0 ? coord[i] / kVoxelsOfBlockInAxis : (coord[i] + 1) / kVoxelsOfBlockInAxis - 1;
+        }
+        const auto block_result = block_indices_.emplace(ComputeVoxelKey(block_coord), static_cast<int32_t>(blocks_.size()));
+        if (block_result.second) {
+            blocks_.emplace_back();
+            blocks_.back().min_corner = Vec3(block_coord[0], block_coord[1], block_coord[2]) * (voxel_size_ * kVoxelsOfBlockInAxis);
+        }
+        blocks_[block_result.first->second].voxels.emplace_back(result.first->second);
+    }
+    return voxels_[result.first->second];
+}
+
+void SpatialIndex::AddPoint(const Vec3 &point_in_w) {
+    const int32_t index = static_cast<int32_t>(points_.size());
+    points_.emplace_back(point_in_w);
+    // Points which are not finite are never visible, so they are kept only to reserve the index.
+    RETURN_IF(!point_in_w.allFinite());
+    std::array<int32_t, 3> coord = {};
+    if (!ComputeVoxelCoordinate(point_in_w, coord)) {
+        far_points_.emplace_back(index);
+        return;
+    }
+    GetOrCreateVoxel(coord).points.emplace_back(index);
+}
+
+void SpatialIndex::AddPoints(const PointCloudBatch &points_in_w) {
+    points_.reserve(points_.size() + points_in_w.cols());
+    for (int32_t i = 0; i < static_cast<int32_t>(points_in_w.cols()); ++i) {
+        AddPoint(points_in_w.col(i));
+    }
+}
+
+void SpatialIndex::AddLineSegment(const Vec3 &line_s_point, const Vec3 &line_e_point) {
+    const int32_t index = static_cast<int32_t>(line_segments_.size());
+    line_segments_.emplace_back(LineSegment{line_s_point, line_e_point});
+    RETURN_IF(!line_s_point.allFinite() || !line_e_point.allFinite());
+
+    // Line segment is added into all voxels overlapped by its bounding box.
+    std::array<int32_t, 3> min_coord = {};
+    std::array<int32_t, 3> max_coord = {};
+    if (!ComputeVoxelCoordinate(line_s_point.cwiseMin(line_e_point), min_coord) || !ComputeVoxelCoordinate(line_s_point.cwiseMax(line_e_point), max_coord)) {
+        large_line_segments_.emplace_back(index);
+        return;
+    }
+    int64_t num_of_voxels = 1;
+    for (int32_t i = 0; i < 3; ++i) {
+        num_of_voxels *= static_cast<int64_t>(max_coord[i]) - min_coord[i] + 1;
+    }
+    if (num_of_voxels > kMaxVoxelsOfLineSegment) {
+        large_line_segments_.emplace_back(index);
+        return;
+    }
+    for (int32_t x = min_coord[0]; x <= max_coord[0]; ++x) {
+        for (int32_t y = min_coord[1]; y <= max_coord[1]; ++y) {
+            for (int32_t z = min_coord[2]; z <= max_coord[2]; ++z) {
+                GetOrCreateVoxel({x, y, z}).line_segments.emplace_back(index);
+            }
+        }
+    }
+}
+
+void SpatialIndex::Clear() {
+    points_.clear();
+    line_segments_.clear();
+    far_points_.clear();
+    large_line_segments_.clear();
+    voxels_.clear();
+    voxel_indices_.clear();
+    blocks_.clear();
+    block_indices_.clear();
+}
+
+SpatialIndex::Frustum SpatialIndex::ComputeFrustum(const CameraView &cam, int32_t rows, int32_t cols, int32_t margin) const {
+    // Bounds of visible pixels before casting to integer, with one more pixel for rounding.
+    const float min_u = -static_cast<float>(margin) - 2.0f;
+    const float max_u = static_cast<float>(cols + margin) + 1.0f;
+    const float min_v = -static_cast<float>(margin) - 2.0f;
+    const float max_v = static_cast<float>(rows + margin) + 1.0f;
+
+    // Planes in camera frame. Perspective planes pass through the optical center, while orthographic planes are parallel to optical axis.
+    Frustum frustum;
+    frustum[0] = Plane{Vec3(0.0f, 0.0f, 1.0f), -ImagePainter::kMinValidViewDepth};
+    if (cam.is_ortho) {
+        frustum[1] = Plane{Vec3(cam.ortho_scale, 0.0f, 0.0f), cam.cx - min_u};
+        frustum[2] = Plane{Vec3(-cam.ortho_scale, 0.0f, 0.0f), max_u - cam.cx};
+        frustum[3] = Plane{Vec3(0.0f, cam.ortho_scale, 0.0f), cam.cy - min_v};
+        frustum[4] = Plane{Vec3(0.0f, -cam.ortho_scale, 0.0f), max_v - cam.cy};
+    } else {
+        frustum[1] = Plane{Vec3(cam.fx, 0.0f, cam.cx - min_u), 0.0f};
+        frustum[2] = Plane{Vec3(-cam.fx, 0.0f, max_u - cam.cx), 0.0f};
+        frustum[3] = Plane{Vec3(0.0f, cam.fy, cam.cy - min_v), 0.0f};
+        frustum[4] = Plane{Vec3(0.0f, -cam.fy, max_v - cam.cy), 0.0f};
+    }
+
+    // Transform planes into world frame, where p_c = q_wc.inverse() * (p_w - p_wc).
+    for (Plane &plane: frustum) {
+        plane.normal = cam.q_wc * plane.normal;
+        plane.d -= plane.normal.dot(cam.p_wc);
+    }
+    return frustum;
+}
+
+SpatialIndex::BoxState SpatialIndex::ClassifyBoxWithFrustum(const Vec3 &min_corner, float size, const Frustum &frustum) const {
+    const float padding = voxel_size_ * kVoxelPaddingRatio;
+    const Vec3 padded_min_corner = min_corner - Vec3::Constant(padding);
+    const Vec3 padded_max_corner = min_corner + Vec3::Constant(size + padding);
+    // Box is outside if its corner farthest along the normal is outside of any plane, and inside if its nearest corner is inside of all planes.
+    BoxState state = BoxState::kInside;
+    for (const Plane &plane: frustum) {
+        Vec3 farthest_corner = padded_min_corner;
+        Vec3 nearest_corner = padded_max_corner;
+        for (int32_t i = 0; i < 3; ++i) {
+            if (plane.normal[i] >= 0.0f) {
+                SlamOperation::ExchangeValue(farthest_corner[i], nearest_corner[i]);
+            }
+        }
+        if (plane.normal.dot(farthest_corner) + plane.d < 0.0f) {
+            return BoxState::kOutside;
+        }
+        if (plane.normal.dot(nearest_corner) + plane.d < 0.0f) {
+            state = BoxState::kIntersected;
+        }
+    }
+    return state;
+}
+
+template <typename Function>
+void SpatialIndex::ForEachVoxelInFrustum(const Frustum &frustum, const Function &function) const {
+    const float block_size = voxel_size_ * kVoxelsOfBlockInAxis;
+    for (const Block &block: blocks_) {
+        const BoxState block_state = ClassifyBoxWithFrustum(block.min_corner, block_size, frustum);
+        CONTINUE_IF(block_state == BoxState::kOutside);
+        for (const int32_t voxel_index: block.voxels) {
+            const Voxel &voxel = voxels_[voxel_index];
+            CONTINUE_IF(block_state == BoxState::kIntersected && ClassifyBoxWithFrustum(voxel.min_corner, voxel_size_, frustum) == BoxState::kOutside);
+            function(voxel);
+        }
+    }
+}
+
+void SpatialIndex::QueryPointsInCameraView(const CameraView &cam, int32_t rows, int32_t cols, int32_t margin, std::vector<int32_t> &indices) const {
+    const Frustum frustum = ComputeFrustum(cam, rows, cols, margin);
+    std::vector<uint64_t> bitmap((points_.size() + 63) / 64, 0);
+    MarkIndicesInBitmap(far_points_, bitmap);
+    ForEachVoxelInFrustum(frustum, [&](const Voxel &voxel) { MarkIndicesInBitmap(voxel.points, bitmap); });
+    CollectIndicesFromBitmap(bitmap, indices);
+}
+
+void SpatialIndex::QueryLineSegmentsInCameraView(const CameraView &cam, int32_t rows, int32_t cols, int32_t margin,
+                                                 std::vector<int32_t> &indices) const {
+    const Frustum frustum = ComputeFrustum(cam, rows, cols, margin);
+    std::vector<uint64_t> bitmap((line_segments_.size() + 63) / 64, 0);
+    MarkIndicesInBitmap(large_line_segments_, bitmap);
+    ForEachVoxelInFrustum(frustum, [&](const Voxel &voxel) { MarkIndicesInBitmap(voxel.line_segments, bitmap); });
+    CollectIndicesFromBitmap(bitmap, indices);
+}
+
+}  // namespace image_painter
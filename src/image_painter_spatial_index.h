@@ -0,0 +1,98 @@
+#ifndef _IMAGE_PAINTER_SPATIAL_INDEX_H_
+#define _IMAGE_PAINTER_SPATIAL_INDEX_H_
+
+#include "basic_type.h"
+#include "image_painter.h"
+
+#include "array"
+#include "unordered_map"
+
+namespace image_painter {
+
+/* Class SpatialIndex Declaration. */
+class SpatialIndex {
+
+public:
+    using CameraView = ImagePainter::CameraView;
+    using PointCloudBatch = ImagePainter::PointCloudBatch;
+
+    struct LineSegment {
+        Vec3 s_point = Vec3::Zero();
+        Vec3 e_point = Vec3::Zero();
+    };
+
+    // Line segments covering more voxels than this are not hashed, and they are always candidates of queries. So are the items out of the
+    // range of voxel coordinates, which is [-kMaxVoxelCoordinate, kMaxVoxelCoordinate] in each axis.
+    static constexpr int32_t kMaxVoxelsOfLineSegment = 64;
+    static constexpr int32_t kMaxVoxelCoordinate = (1 << 20) - 1;
+    // Voxels are grouped into blocks of 8 x 8 x 8 voxels. Blocks are tested with frustum before their voxels.
+    static constexpr int32_t kVoxelsOfBlockInAxis = 8;
+
+public:
+    explicit SpatialIndex(float voxel_size = 1.0f);
+    virtual ~SpatialIndex() = default;
+
+    // Items are added incrementally, and index of item is the order of adding.
+    void AddPoint(const Vec3 &point_in_w);
+    void AddPoints(const PointCloudBatch &points_in_w);
+    void AddLineSegment(const Vec3 &line_s_point, const Vec3 &line_e_point);
+    void Clear();
+
+    // Collect indices of items in voxels which intersect view frustum of image with rows x cols, extended by margin pixels. Candidates may be
+    // invisible, but visible items are never missed. Indices are sorted in ascending order.
+    void QueryPointsInCameraView(const CameraView &cam, int32_t rows, int32_t cols, int32_t margin, std::vector<int32_t> &indices) const;
+    void QueryLineSegmentsInCameraView(const CameraView &cam, int32_t rows, int32_t cols, int32_t margin, std::vector<int32_t> &indices) const;
+
+    // Reference for member variables.
+    float voxel_size() const { return voxel_size_; }
+    const std::vector<Vec3> &points() const { return points_; }
+    const std::vector<LineSegment> &line_segments() const { return line_segments_; }
+    int32_t num_of_voxels() const { return static_cast<int32_t>(voxels_.size()); }
+    int32_t num_of_blocks() const { return static_cast<int32_t>(blocks_.size()); }
+
+private:
+    struct Voxel {
+        Vec3 min_corner = Vec3::Zero();
+        std::vector<int32_t> points;
+        std::vector<int32_t> line_segments;
+    };
+    struct Block {
+        Vec3 min_corner = Vec3::Zero();
+        std::vector<int32_t> voxels;
+    };
+    // Plane n * p + d >= 0 bounds the inside of view frustum.
+    struct Plane {
+        Vec3 normal = Vec3::Zero();
+        float d = 0.0f;
+    };
+    using Frustum = std::array<Plane, 5>;
+    enum class BoxState : uint8_t {
+        kOutside = 0,
+        kIntersected = 1,
+        kInside = 2,
+    };
+
+    // Return false if point is out of the range of voxel coordinates.
+    bool ComputeVoxelCoordinate(const Vec3 &p_w, std::array<int32_t, 3> &coord) const;
+    Voxel &GetOrCreateVoxel(const std::array<int32_t, 3> &coord);
+    Frustum ComputeFrustum(const CameraView &cam, int32_t rows, int32_t cols, int32_t margin) const;
+    BoxState ClassifyBoxWithFrustum(const Vec3 &min_corner, float size, const Frustum &frustum) const;
+    // Visit voxels which intersect view frustum by function(voxel).
+    template <typename Function>
+    void ForEachVoxelInFrustum(const Frustum &frustum, const Function &function) const;
+
+private:
+    float voxel_size_ = 1.0f;
+    std::vector<Vec3> points_;
+    std::vector<LineSegment> line_segments_;
+    std::vector<int32_t> far_points_;
+    std::vector<int32_t> large_line_segments_;
+    std::vector<Voxel> voxels_;
+    std::unordered_map<uint64_t, int32_t> voxel_indices_;
+    std::vector<Block> blocks_;
+    std::unordered_map<uint64_t, int32_t> block_indices_;
+};
+
+}  // namespace image_painter
+
+#endif  // end of _IMAGE_PAINTER_SPATIAL_INDEX_H_
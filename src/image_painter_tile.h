@@ -0,0 +1,89 @@
+#ifndef _IMAGE_PAINTER_TILE_H_
+#define _IMAGE_PAINTER_TILE_H_
+
+#include "basic_type.h"
+#include "datatype_image.h"
+#include "image_painter_parallel.h"
+#include "image_painter_pixel.h"
+
+#include "atomic"
+
+namespace image_painter {
+
+/* Rasterizers of primitives whose float interpolation changes with integer translation, so they can not be drawn into a tile by shifting
+   coordinates. Tile is a view of rows [row_offset, row_offset + tile.rows()) of the whole image, and coordinates are still in the whole
+   image. Drawing the whole image with row_offset = 0 is the same as ImagePainter. */
+template <typename ImageType, typename PixelType>
+void DrawNaiveLineInTile(ImageType &tile, int32_t row_offset, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const PixelType &color,
+                         const ImagePainter::Blend &blend = ImagePainter::Blend());
+template <typename ImageType, typename PixelType>
+void DrawDashedLineInTile(ImageType &tile, int32_t row_offset, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t step, const PixelType &color,
+                          const ImagePainter::Blend &blend = ImagePainter::Blend());
+template <typename ImageType, typename PixelType>
+void DrawTrustRegionOfGaussianInTile(ImageType &tile, int32_t row_offset, const Vec2 &center, const Mat2 &covariance, const PixelType &color,
+                                     const float sigma_scale, bool is_solid = false, const ImagePainter::Blend &blend = ImagePainter::Blend());
+
+// View of rows [row_offset, row_offset + rows) of image, which shares its buffer. Row offset of planar images should be even.
+template <typename ImageType>
+inline ImageType GetRowTileOfImage(ImageType &image, int32_t row_offset, int32_t rows) {
+    return ImageType(GetPixelUnchecked(image, row_offset, 0), rows, image.cols());
+}
+
+// Bin items into tiles of rows_of_tile rows by stable counting sort. get_row_range(i, row_min, row_max) returns false if item i is skipped,
+// and its rows are clipped into [0, rows). Items of tile t are items[offsets[t], offsets[t + 1]) in the original order.
+template <typename Function>
+void BinItemsIntoRowTiles(int32_t num_of_items, int32_t rows, int32_t rows_of_tile, const Function &get_row_range, std::vector<int32_t> &offsets,
+                          std::vector<int32_t> &items) {
+    const int32_t num_of_tiles = (rows + rows_of_tile - 1) / rows_of_tile;
+    auto get_tile_range = [&](int32_t i, int32_t &tile_begin, int32_t &tile_end) {
+        int32_t row_min = 0;
+        int32_t row_max = 0;
+        if (!get_row_range(i, row_min, row_max)) {
+            return false;
+        }
+        row_min = std::max(row_min, 0);
+        row_max = std::min(row_max, rows - 1);
+        tile_begin = row_min / rows_of_tile;
+        tile_end = row_max / rows_of_tile;
+        return row_min <= row_max;
+    };
+
+    offsets.assign(num_of_tiles + 1, 0);
+    for (int32_t i = 0; i < num_of_items; ++i) {
+        int32_t tile_begin = 0;
+        int32_t tile_end = 0;
+        CONTINUE_IF(!get_tile_range(i, tile_begin, tile_end));
+        for (int32_t tile_index = tile_begin; tile_index <= tile_end; ++tile_index) {
+            ++offsets[tile_index + 1];
+        }
+    }
+    for (int32_t tile_index = 0; tile_index < num_of_tiles; ++tile_index) {
+        offsets[tile_index + 1] += offsets[tile_index];
+    }
+    items.resize(offsets.back());
+    std::vector<int32_t> fill_positions(offsets.begin(), offsets.end() - 1);
+    for (int32_t i = 0; i < num_of_items; ++i) {
+        int32_t tile_begin = 0;
+        int32_t tile_end = 0;
+        CONTINUE_IF(!get_tile_range(i, tile_begin, tile_end));
+        for (int32_t tile_index = tile_begin; tile_index <= tile_end; ++tile_index) {
+            items[fill_positions[tile_index]++] = i;
+        }
+    }
+}
+
+// Run function(tile_index) on each tile in parallel. Tiles are fetched dynamically by workers, since items are usually not evenly
+// distributed on image.
+template <typename Function>
+void ForEachTileInParallel(int32_t num_of_tiles, const Function &function) {
+    std::atomic<int32_t> next_tile_index(0);
+    ParallelFor(0, num_of_tiles, 1, [&](int32_t, int32_t) {
+        for (int32_t tile_index = next_tile_index++; tile_index < num_of_tiles; tile_index = next_tile_index++) {
+            function(tile_index);
+        }
+    });
+}
+
+}  // namespace image_painter
+
+#endif  // end of _IMAGE_PAINTER_TILE_H_
@@ -0,0 +1,334 @@
+#ifndef _IMAGE_PAINTER_YUV_H_
+#define _IMAGE_PAINTER_YUV_H_
+
+#include "basic_type.h"
+#include "image_painter.h"
+#include "image_painter_blend.h"
+#include "image_painter_pixel.h"
+#include "image_painter_profile.h"
+#include "image_painter_simd.h"
+
+#include "algorithm"
+#include "cstring"
+#include "vector"
+
+namespace image_painter {
+
+/* Class Yuv420Image Declaration. It is a view of yuv420 buffer, such as nv12 or i420 frame of camera. Luma plane has full resolution,
+   while chroma planes have half resolution in both axes, so chroma sample (row / 2, col / 2) is shared by 2 x 2 luma pixels. */
+class Yuv420Image {
+
+public:
+    Yuv420Image() = default;
+    // Continuous buffer of rows x cols luma, followed by its chroma planes without padding.
+    Yuv420Image(uint8_t *data, int32_t rows, int32_t cols, ImagePainter::YuvLayout layout = ImagePainter::YuvLayout::kNv12)
+        : rows_(rows), cols_(cols), layout_(layout), y_plane_(data), y_stride_(cols) {
+        RETURN_IF(data == nullptr);
+        const int32_t chroma_rows = (rows + 1) / 2;
+        const int32_t chroma_cols = (cols + 1) / 2;
+        uint8_t *chroma_plane = data + static_cast<int64_t>(rows) * cols;
+        if (layout == ImagePainter::YuvLayout::kNv12) {
+            SetChromaPlanes(chroma_plane, 2 * chroma_cols, nullptr, 0);
+        } else {
+            SetChromaPlanes(chroma_plane, chroma_cols, chroma_plane + static_cast<int64_t>(chroma_rows) * chroma_cols, chroma_cols);
+        }
+    }
+    // Planes with their own strides in bytes. For nv12, u_plane is the interleaved chroma plane, and v_plane is ignored.
+    Yuv420Image(ImagePainter::YuvLayout layout, int32_t rows, int32_t cols, uint8_t *y_plane, int32_t y_stride, uint8_t *u_plane, int32_t u_stride,
+                uint8_t *v_plane = nullptr, int32_t v_stride = 0)
+        : rows_(rows), cols_(cols), layout_(layout), y_plane_(y_plane), y_stride_(y_stride) {
+        SetChromaPlanes(u_plane, u_stride, v_plane, v_stride);
+    }
+    virtual ~Yuv420Image() = default;
+
+    // View of rows [row_offset, row_offset + rows). Row offset should be even, so the view does not share chroma rows with the rows above.
+    Yuv420Image GetRowsView(int32_t row_offset, int32_t rows) const {
+        Yuv420Image view = *this;
+        view.rows_ = rows;
+        view.y_plane_ = GetLuma(row_offset, 0);
+        view.u_plane_ = GetChromaU(row_offset / 2, 0);
+        view.v_plane_ = GetChromaV(row_offset / 2, 0);
+        return view;
+    }
+
+    uint8_t *GetLuma(int32_t row, int32_t col) const { return y_plane_ + static_cast<int64_t>(row) * y_stride_ + col; }
+    uint8_t *GetChromaU(int32_t chroma_row, int32_t chroma_col) const {
+        return u_plane_ + static_cast<int64_t>(chroma_row) * u_stride_ + static_cast<int64_t>(chroma_col) * chroma_step_;
+    }
+    uint8_t *GetChromaV(int32_t chroma_row, int32_t chroma_col) const {
+        return v_plane_ + static_cast<int64_t>(chroma_row) * v_stride_ + static_cast<int64_t>(chroma_col) * chroma_step_;
+    }
+
+    // Reference for member variables.
+    uint8_t *data() const { return y_plane_; }
+    int32_t rows() const { return rows_; }
+    int32_t cols() const { return cols_; }
+    ImagePainter::YuvLayout layout() const { return layout_; }
+    // Bytes between neighbor chroma samples of one plane, which is 2 for nv12 and 1 for i420.
+    int32_t chroma_step() const { return chroma_step_; }
+
+private:
+    void SetChromaPlanes(uint8_t *u_plane, int32_t u_stride, uint8_t *v_plane, int32_t v_stride) {
+        if (layout_ == ImagePainter::YuvLayout::kNv12) {
+            u_plane_ = u_plane;
+            u_stride_ = u_stride;
+            v_plane_ = u_plane == nullptr ? nullptr : u_plane + 1;
+            v_stride_ = u_stride;
+            chroma_step_ = 2;
+        } else {
+            u_plane_ = u_plane;
+            u_stride_ = u_stride;
+            v_plane_ = v_plane;
+            v_stride_ = v_stride;
+            chroma_step_ = 1;
+        }
+    }
+
+private:
+    int32_t rows_ = 0;
+    int32_t cols_ = 0;
+    ImagePainter::YuvLayout layout_ = ImagePainter::YuvLayout::kNv12;
+    uint8_t *y_plane_ = nullptr;
+    int32_t y_stride_ = 0;
+    uint8_t *u_plane_ = nullptr;
+    int32_t u_stride_ = 0;
+    uint8_t *v_plane_ = nullptr;
+    int32_t v_stride_ = 0;
+    int32_t chroma_step_ = 2;
+};
+
+inline int32_t GetProfileIndexOfImage(const Yuv420Image &) { return static_cast<int32_t>(ImagePainter::ProfileImageType::kYuv420); }
+
+inline Yuv420Image GetRowTileOfImage(Yuv420Image &image, int32_t row_offset, int32_t rows) { return image.GetRowsView(row_offset, rows); }
+
+// Chroma is offset by 128, so additive blend adds offset of color scaled by alpha. Max blend is only meaningful for luma, and chroma of it
+// is alpha blended.
+inline uint8_t BlendChromaByte(uint8_t value, uint8_t color, const ImagePainter::Blend &blend) {
+    switch (blend.mode) {
+        case ImagePainter::BlendMode::kAlpha:
+        case ImagePainter::BlendMode::kMax:
+            return DivideBy255(value * (255 - blend.alpha) + color * blend.alpha);
+        case ImagePainter::BlendMode::kAdditive: {
+            const int32_t offset = (static_cast<int32_t>(color) - 128) * blend.alpha;
+            const int32_t scaled_offset = offset >= 0 ? DivideBy255(offset) : -static_cast<int32_t>(DivideBy255(-offset));
+            return static_cast<uint8_t>(std::min(std::max(value + scaled_offset, 0), 255));
+        }
+        default:
+            return color;
+    }
+}
+
+// Fill chroma samples [chroma_col_begin, chroma_col_end] of one chroma row.
+inline void FillChromaSpanUnchecked(Yuv420Image &image, int32_t chroma_row, int32_t chroma_col_begin, int32_t chroma_col_end,
+                                    const ImagePainter::YuvPixel &color) {
+    const int32_t size = chroma_col_end - chroma_col_begin + 1;
+    if (image.layout() == ImagePainter::YuvLayout::kI420) {
+        std::memset(image.GetChromaU(chroma_row, chroma_col_begin), color.u, size);
+        std::memset(image.GetChromaV(chroma_row, chroma_col_begin), color.v, size);
+        return;
+    }
+    uint8_t *uv = image.GetChromaU(chroma_row, chroma_col_begin);
+    for (int32_t i = 0; i < size; ++i) {
+        uv[2 * i] = color.u;
+        uv[2 * i + 1] = color.v;
+    }
+}
+
+inline void BlendChromaSpanUnchecked(Yuv420Image &image, int32_t chroma_row, int32_t chroma_col_begin, int32_t chroma_col_end,
+                                     const ImagePainter::YuvPixel &color, const ImagePainter::Blend &blend) {
+    uint8_t *u = image.GetChromaU(chroma_row, chroma_col_begin);
+    uint8_t *v = image.GetChromaV(chroma_row, chroma_col_begin);
+    const int32_t step = image.chroma_step();
+    for (int32_t i = 0; i <= chroma_col_end - chroma_col_begin; ++i) {
+        u[i * step] = BlendChromaByte(u[i * step], color.u, blend);
+        v[i * step] = BlendChromaByte(v[i * step], color.v, blend);
+    }
+}
+
+/* Unchecked pixel writes of yuv420 image. Opaque writes set chroma of each covered pixel, which is the same for all pixels of one
+   primitive. Blended write of one pixel blends the chroma of its 2 x 2 block, while PixelWriter blends each touched block once. */
+inline void SetPixelValueUnchecked(Yuv420Image &image, int32_t row, int32_t col, const ImagePainter::YuvPixel &color) {
+    IMAGE_PAINTER_PROFILE_WRITTEN_PIXELS(1);
+    *image.GetLuma(row, col) = color.y;
+    *image.GetChromaU(row / 2, col / 2) = color.u;
+    *image.GetChromaV(row / 2, col / 2) = color.v;
+}
+
+inline void FillSpanUnchecked(Yuv420Image &image, int32_t row, int32_t col_begin, int32_t col_end, const ImagePainter::YuvPixel &color) {
+    IMAGE_PAINTER_PROFILE_WRITTEN_PIXELS(col_end - col_begin + 1);
+    std::memset(image.GetLuma(row, col_begin), color.y, col_end - col_begin + 1);
+    FillChromaSpanUnchecked(image, row / 2, col_begin / 2, col_end / 2, color);
+}
+
+// Luma rows are filled one by one, while each chroma row is filled once.
+inline void FillRectangleUnchecked(Yuv420Image &image, int32_t row_begin, int32_t row_end, int32_t col_begin, int32_t col_end,
+                                   const ImagePainter::YuvPixel &color) {
+    IMAGE_PAINTER_PROFILE_WRITTEN_PIXELS(static_cast<int64_t>(row_end - row_begin + 1) * (col_end - col_begin + 1));
+    for (int32_t row = row_begin; row <= row_end; ++row) {
+        std::memset(image.GetLuma(row, col_begin), color.y, col_end - col_begin + 1);
+    }
+    for (int32_t chroma_row = row_begin / 2; chroma_row <= row_end / 2; ++chroma_row) {
+        FillChromaSpanUnchecked(image, chroma_row, col_begin / 2, col_end / 2, color);
+    }
+}
+
+inline void BlendPixelUnchecked(Yuv420Image &image, int32_t row, int32_t col, const ImagePainter::YuvPixel &color, const ImagePainter::Blend &blend) {
+    IMAGE_PAINTER_PROFILE_WRITTEN_PIXELS(1);
+    uint8_t *luma = image.GetLuma(row, col);
+    *luma = BlendByte(*luma, color.y, blend);
+    BlendChromaSpanUnchecked(image, row / 2, col / 2, col / 2, color, blend);
+}
+
+/* Class PixelWriter Declaration of yuv420 image. Luma spans are blended by simd kernels. Chroma of each 2 x 2 block touched by the
+   primitive is blended exactly once, which is tracked by a quarter resolution bitmap of blended chroma samples. */
+template <typename PixelType>
+class PixelWriter<Yuv420Image, PixelType> {
+
+public:
+    PixelWriter(Yuv420Image &image, const PixelType &color, const ImagePainter::Blend &blend) : image_(image), color_(color), blend_(blend) {
+        // Alpha blend with full alpha is the same as opaque one.
+        if (blend_.mode == ImagePainter::BlendMode::kAlpha && blend_.alpha == 255) {
+            blend_.mode = ImagePainter::BlendMode::kOpaque;
+        }
+        RETURN_IF(blend_.mode == ImagePainter::BlendMode::kOpaque);
+
+        pattern_.mode = blend_.mode;
+        pattern_.alpha = blend_.alpha;
+        for (int32_t i = 0; i < kBlendPatternSize; ++i) {
+            pattern_.weighted[i] = static_cast<uint16_t>(color_.y * blend_.alpha + 128);
+            pattern_.scaled[i] = DivideBy255(color_.y * blend_.alpha);
+        }
+        blend_span_ = GetSimdKernels().blend_span;
+    }
+    virtual ~PixelWriter() = default;
+
+    // Nothing is changed by blend with zero alpha, so primitives can be skipped.
+    bool IsVisible() const { return blend_.mode == ImagePainter::BlendMode::kOpaque || blend_.alpha > 0; }
+
+    void SetPixelUnchecked(int32_t row, int32_t col) const {
+        if (blend_.mode == ImagePainter::BlendMode::kOpaque) {
+            SetPixelValueUnchecked(image_, row, col, color_);
+            return;
+        }
+        IMAGE_PAINTER_PROFILE_WRITTEN_PIXELS(1);
+        uint8_t *luma = image_.GetLuma(row, col);
+        *luma = BlendByte(*luma, color_.y, blend_);
+        BlendChromaOnceUnchecked(row / 2, col / 2, blend_);
+    }
+
+    // Blend fragment of glyph by blend of writer scaled by coverage. Chroma of its block is blended by the first pixel touching it.
+    void BlendFragmentUnchecked(int32_t row, int32_t col, uint8_t coverage) const {
+        const ImagePainter::Blend blend = ScaleBlendByCoverage(blend_, coverage);
+        IMAGE_PAINTER_PROFILE_WRITTEN_PIXELS(1);
+        uint8_t *luma = image_.GetLuma(row, col);
+        *luma = BlendByte(*luma, color_.y, blend);
+        BlendChromaOnceUnchecked(row / 2, col / 2, blend);
+    }
+
+    void SetPixel(int32_t row, int32_t col) const {
+        if (row < 0 || row >= image_.rows() || col < 0 || col >= image_.cols()) {
+            IMAGE_PAINTER_PROFILE_REJECTED_PIXELS(1);
+            return;
+        }
+        SetPixelUnchecked(row, col);
+    }
+
+    // Write [col_begin, col_end] of one row.
+    void FillSpanUnchecked(int32_t row, int32_t col_begin, int32_t col_end) const {
+        if (blend_.mode == ImagePainter::BlendMode::kOpaque) {
+            image_painter::FillSpanUnchecked(image_, row, col_begin, col_end, color_);
+            return;
+        }
+        IMAGE_PAINTER_PROFILE_WRITTEN_PIXELS(col_end - col_begin + 1);
+        blend_span_(image_.GetLuma(row, col_begin), col_end - col_begin + 1, pattern_);
+        for (int32_t chroma_col = col_begin / 2; chroma_col <= col_end / 2; ++chroma_col) {
+            BlendChromaOnceUnchecked(row / 2, chroma_col, blend_);
+        }
+    }
+
+    // Clip [col_begin, col_end] of one row into image, and write it.
+    void FillSpan(int32_t row, int32_t col_begin, int32_t col_end) const {
+        RETURN_IF(col_begin > col_end);
+        if (row < 0 || row >= image_.rows()) {
+            IMAGE_PAINTER_PROFILE_REJECTED_PIXELS(static_cast<int64_t>(col_end) - col_begin + 1);
+            return;
+        }
+        const int32_t clipped_col_begin = std::max(col_begin, 0);
+        const int32_t clipped_col_end = std::min(col_end, image_.cols() - 1);
+        IMAGE_PAINTER_PROFILE_REJECTED_PIXELS(static_cast<int64_t>(col_end) - col_begin + 1 - std::max(clipped_col_end - clipped_col_begin + 1, 0));
+        RETURN_IF(clipped_col_begin > clipped_col_end);
+        FillSpanUnchecked(row, clipped_col_begin, clipped_col_end);
+    }
+
+    void FillRectangleUnchecked(int32_t row_begin, int32_t row_end, int32_t col_begin, int32_t col_end) const {
+        if (blend_.mode == ImagePainter::BlendMode::kOpaque) {
+            image_painter::FillRectangleUnchecked(image_, row_begin, row_end, col_begin, col_end, color_);
+            return;
+        }
+        for (int32_t row = row_begin; row <= row_end; ++row) {
+            FillSpanUnchecked(row, col_begin, col_end);
+        }
+    }
+
+    // Reference for member variables.
+    Yuv420Image &image() const { return image_; }
+    const PixelType &color() const { return color_; }
+    const ImagePainter::Blend &blend() const { return blend_; }
+
+private:
+    void BlendChromaOnceUnchecked(int32_t chroma_row, int32_t chroma_col, const ImagePainter::Blend &blend) const {
+        RETURN_IF(!MarkChromaBlended(chroma_row, chroma_col));
+        BlendChromaSpanUnchecked(image_, chroma_row, chroma_col, chroma_col, color_, blend);
+    }
+
+    // Mark chroma sample as blended, and return false if it is already marked. Bitmap only covers the chroma rows touched by this writer,
+    // so small primitives on large image do not clear the whole of it.
+    bool MarkChromaBlended(int32_t chroma_row, int32_t chroma_col) const {
+        if (blended_chroma_.empty()) {
+            first_chroma_row_ = chroma_row;
+            chroma_row_end_ = chroma_row;
+        }
+        if (chroma_row < first_chroma_row_ || chroma_row >= chroma_row_end_) {
+            GrowBlendedChromaRows(chroma_row);
+        }
+        uint64_t &word = blended_chroma_[static_cast<size_t>(chroma_row - first_chroma_row_) * GetWordsOfChromaRow() + chroma_col / 64];
+        const uint64_t bit = uint64_t{1} << (chroma_col % 64);
+        RETURN_FALSE_IF((word & bit) != 0);
+        word |= bit;
+        return true;
+    }
+
+    // Grow rows of bitmap to cover chroma row. Rows are at least doubled towards it, so upward lines and tall primitives grow it in
+    // amortized linear time.
+    void GrowBlendedChromaRows(int32_t chroma_row) const {
+        const int32_t chroma_rows = (image_.rows() + 1) / 2;
+        const int32_t num_of_rows = chroma_row_end_ - first_chroma_row_;
+        const int32_t row_begin =
+            chroma_row < first_chroma_row_ ? std::max(std::min(chroma_row, first_chroma_row_ - num_of_rows), 0) : first_chroma_row_;
+        const int32_t row_end =
+            chroma_row >= chroma_row_end_ ? std::min(std::max(chroma_row + 1, chroma_row_end_ + num_of_rows), chroma_rows) : chroma_row_end_;
+        const int32_t words_of_row = GetWordsOfChromaRow();
+        std::vector<uint64_t> bitmap(static_cast<size_t>(row_end - row_begin) * words_of_row, 0);
+        std::copy(blended_chroma_.begin(), blended_chroma_.end(), bitmap.begin() + static_cast<size_t>(first_chroma_row_ - row_begin) * words_of_row);
+        blended_chroma_.swap(bitmap);
+        first_chroma_row_ = row_begin;
+        chroma_row_end_ = row_end;
+    }
+
+    int32_t GetWordsOfChromaRow() const { return ((image_.cols() + 1) / 2 + 63) / 64; }
+
+private:
+    Yuv420Image &image_;
+    PixelType color_;
+    ImagePainter::Blend blend_;
+    BlendPattern pattern_;
+    void (*blend_span_)(uint8_t *span, int32_t size, const BlendPattern &pattern) = nullptr;
+    // Bits of blended chroma samples of chroma rows [first_chroma_row_, chroma_row_end_). Writer methods are const, so they are mutable.
+    mutable std::vector<uint64_t> blended_chroma_;
+    mutable int32_t first_chroma_row_ = 0;
+    mutable int32_t chroma_row_end_ = 0;
+};
+
+}  // namespace image_painter
+
+#endif  // end of _IMAGE_PAINTER_YUV_H_
@@ -0,0 +1,724 @@
+#include "image_painter.h"
+#include "image_painter_spatial_index.h"
+#include "image_painter_yuv.h"
+
+#include "basic_type.h"
+
+#include "algorithm"
+#include "chrono"
+#include "cmath"
+#include "cstdio"
+#include "cstdlib"
+#include "cstring"
+#include "fstream"
+#include "functional"
+#include "iostream"
+#include "random"
+#include "sstream"
+#include "string"
+#include "vector"
+
+using namespace image_painter;
+
+namespace {
+constexpr uint32_t kRandomSeed = 20240601;
+constexpr int32_t kNumOfShapes = 1000;
+constexpr int32_t kNumOfLabels = 200;
+constexpr int32_t kNumOfPointsInCloud = 100000;
+constexpr int32_t kNumOfLandmarks = 5000;
+
+struct ImageSize {
+    std::string name;
+    int32_t rows = 0;
+    int32_t cols = 0;
+};
+
+struct Options {
+    std::vector<std::string> sizes = {"vga", "hd", "fhd", "4k"};
+    std::string filter;
+    double min_time_ms = 100.0;
+    bool use_multi_thread = false;
+    std::string output_file;
+    std::string baseline_file;
+    double max_slowdown = 1.2;
+};
+
+struct Result {
+    std::string name;
+    std::string image;
+    std::string size;
+    int32_t rows = 0;
+    int32_t cols = 0;
+    int32_t primitives = 0;
+    int64_t iterations = 0;
+    double ns_per_primitive = 0.0;
+    double pixels_per_second = 0.0;
+};
+
+template <typename PixelType>
+PixelType GetColor(int32_t index);
+template <>
+uint8_t GetColor<uint8_t>(int32_t index) {
+    return static_cast<uint8_t>(64 + index % 192);
+}
+template <>
+RgbPixel GetColor<RgbPixel>(int32_t index) {
+    return RgbPixel{static_cast<uint8_t>(64 + index % 192), static_cast<uint8_t>(255 - index % 128), static_cast<uint8_t>(32 + index % 224)};
+}
+
+template <typename ImageType>
+std::string GetNameOfImage();
+template <>
+std::string GetNameOfImage<GrayImage>() {
+    return "gray";
+}
+template <>
+std::string GetNameOfImage<RgbImage>() {
+    return "rgb";
+}
+template <>
+std::string GetNameOfImage<Yuv420Image>() {
+    return "nv12";
+}
+
+std::string GetNameOfSimdLevel(ImagePainter::SimdLevel level) {
+    switch (level) {
+        case ImagePainter::SimdLevel::kSse41:
+            return "sse4.1";
+        case ImagePainter::SimdLevel::kAvx2:
+            return "avx2";
+        case ImagePainter::SimdLevel::kNeon:
+            return "neon";
+        default:
+            return "scalar";
+    }
+}
+
+/* Random shapes of one image size. Positions cover the image with 10% margin, so some shapes are partially or fully off-screen, and sizes
+   are log-uniform, so most shapes are small with a long tail of large ones. */
+class ShapeGenerator {
+
+public:
+    ShapeGenerator(int32_t rows, int32_t cols) : rows_(rows), cols_(cols), engine_(kRandomSeed) {}
+
+    int32_t GetX() { return Uniform(-cols_ / 10, cols_ + cols_ / 10); }
+    int32_t GetY() { return Uniform(-rows_ / 10, rows_ + rows_ / 10); }
+    int32_t GetSize() { return static_cast<int32_t>(std::exp(std::uniform_real_distribution<float>(std::log(2.0f), std::log(MaxSize()))(engine_))); }
+    float GetFloat(float min_value, float max_value) { return std::uniform_real_distribution<float>(min_value, max_value)(engine_); }
+    int32_t Uniform(int32_t min_value, int32_t max_value) { return std::uniform_int_distribution<int32_t>(min_value, max_value)(engine_); }
+
+private:
+    float MaxSize() const { return std::max(static_cast<float>(std::min(rows_, cols_)) * 0.25f, 4.0f); }
+
+    int32_t rows_ = 0;
+    int32_t cols_ = 0;
+    std::mt19937 engine_;
+};
+
+/* Class Bench Declaration. Each case is run once to count pixels it covers, and then repeated until min time is reached. */
+class Bench {
+
+public:
+    explicit Bench(const Options &options) : options_(options) {}
+    virtual ~Bench() = default;
+
+    // Count distinct pixels changed by one run on a cleared image, which is the number of pixels of one run.
+    template <typename ImageType>
+    void RunDraw(const std::string &name, const ImageSize &size, ImageType &image, int32_t primitives, const std::function<void()> &run) {
+        RETURN_IF(!IsSelected(name));
+        const int32_t channels = std::is_same<ImageType, RgbImage>::value ? 3 : 1;
+        const int64_t size_of_buffer = static_cast<int64_t>(image.rows()) * image.cols() * channels;
+        std::memset(image.data(), 0, size_of_buffer);
+        run();
+        int64_t pixels = 0;
+        for (int64_t i = 0; i < size_of_buffer; i += channels) {
+            bool is_changed = false;
+            for (int32_t c = 0; c < channels; ++c) {
+                is_changed = is_changed || image.data()[i + c] != 0;
+            }
+            pixels += is_changed ? 1 : 0;
+        }
+        Measure(name, GetNameOfImage<ImageType>(), size, primitives, pixels, run);
+    }
+
+    // Pixels of convertion are the pixels of its output.
+    void RunConvert(const std::string &name, const std::string &image, const ImageSize &size, int64_t pixels, const std::function<void()> &run) {
+        RETURN_IF(!IsSelected(name));
+        run();
+        Measure(name, image, size, 1, pixels, run);
+    }
+
+    void WriteJson(std::ostream &stream) const;
+    // Compare with results of baseline, and return false if any case is slower than max slowdown.
+    bool CompareWithBaseline(const std::string &baseline_file) const;
+
+    const Options &options() const { return options_; }
+    const std::vector<Result> &results() const { return results_; }
+
+private:
+    bool IsSelected(const std::string &name) const { return options_.filter.empty() || name.find(options_.filter) != std::string::npos; }
+
+    void Measure(const std::string &name, const std::string &image, const ImageSize &size, int32_t primitives, int64_t pixels,
+                 const std::function<void()> &run) {
+        using Clock = std::chrono::steady_clock;
+        int64_t iterations = 0;
+        double elapsed_ns = 0.0;
+        const Clock::time_point begin = Clock::now();
+        while (elapsed_ns < options_.min_time_ms * 1e6) {
+            run();
+            ++iterations;
+            elapsed_ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+        }
+
+        Result result;
+        result.name = name;
+        result.image = image;
+        result.size = size.name;
+        result.rows = size.rows;
+        result.cols = size.cols;
+        result.primitives = primitives;
+        result.iterations = iterations;
+        result.ns_per_primitive = elapsed_ns / static_cast<double>(iterations * std::max(primitives, 1));
+        result.pixels_per_second = static_cast<double>(pixels) * static_cast<double>(iterations) / (elapsed_ns * 1e-9);
+        results_.emplace_back(result);
+        std::fprintf(stderr, "%-40s %-4s %-4s %14.1f ns/primitive %10.3f Mpixels/s\n", name.c_str(), image.c_str(), size.name.c_str(),
+                     result.ns_per_primitive, result.pixels_per_second * 1e-6);
+    }
+
+    Options options_;
+    std::vector<Result> results_;
+};
+
+/* Class Bench Definition. */
+void Bench::WriteJson(std::ostream &stream) const {
+    // One result per line, so results can be diffed and parsed line by line.
+    stream << "{\n";
+    stream << "  \"simd_level\": \"" << GetNameOfSimdLevel(ImagePainter::GetSimdLevel()) << "\",\n";
+    stream << "  \"max_number_of_threads\": " << ImagePainter::GetMaxNumberOfThreads() << ",\n";
+    stream << "  \"use_multi_thread\": " << (options_.use_multi_thread ? "true" : "false") << ",\n";
+    stream << "  \"results\": [\n";
+    for (uint32_t i = 0; i < results_.size(); ++i) {
+        const Result &result = results_[i];
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "    {\"name\": \"%s\", \"image\": \"%s\", \"size\": \"%s\", \"rows\": %d, \"cols\": %d, \"primitives\": %d, "
+                      "\"iterations\": %lld, \"ns_per_primitive\": %.3f, \"pixels_per_second\": %.1f}%s\n",
+                      result.name.c_str(), result.image.c_str(), result.size.c_str(), result.rows, result.cols, result.primitives,
+                      static_cast<long long>(result.iterations), result.ns_per_primitive, result.pixels_per_second, i + 1 < results_.size() ? "," : "");
+        stream << line;
+    }
+    stream << "  ]\n";
+    stream << "}\n";
+}
+
+bool Bench::CompareWithBaseline(const std::string &baseline_file) const {
+    std::ifstream file(baseline_file);
+    if (!file.is_open()) {
+        std::fprintf(stderr, "Failed to open baseline %s.\n", baseline_file.c_str());
+        return false;
+    }
+
+    // Value of key in one line written by WriteJson.
+    auto get_value = [](const std::string &line, const std::string &key) {
+        const std::string pattern = "\"" + key + "\": ";
+        const size_t begin = line.find(pattern);
+        if (begin == std::string::npos) {
+            return std::string();
+        }
+        size_t value_begin = begin + pattern.size();
+        const bool is_string = line[value_begin] == '"';
+        value_begin += is_string ? 1 : 0;
+        const size_t value_end = line.find_first_of(is_string ? "\"" : ",}", value_begin);
+        return line.substr(value_begin, value_end - value_begin);
+    };
+
+    bool is_passed = true;
+    std::string line;
+    while (std::getline(file, line)) {
+        const std::string name = get_value(line, "name");
+        CONTINUE_IF(name.empty());
+        const std::string image = get_value(line, "image");
+        const std::string size = get_value(line, "size");
+        const double baseline_ns = std::atof(get_value(line, "ns_per_primitive").c_str());
+        for (const Result &result: results_) {
+            CONTINUE_IF(result.name != name || result.image != image || result.size != size || baseline_ns <= 0.0);
+            const double ratio = result.ns_per_primitive / baseline_ns;
+            const bool is_slower = ratio > options_.max_slowdown;
+            is_passed = is_passed && !is_slower;
+            std::fprintf(stderr, "%s %-40s %-4s %-4s %8.3fx of baseline\n", is_slower ? "[SLOWER]" : "[  OK  ]", name.c_str(), image.c_str(),
+                         size.c_str(), ratio);
+        }
+    }
+    return is_passed;
+}
+
+template <typename ImageType, typename PixelType>
+void BenchDraw(Bench &bench, const ImageSize &size) {
+    const int32_t channels = std::is_same<ImageType, RgbImage>::value ? 3 : 1;
+    std::vector<uint8_t> buffer(static_cast<size_t>(size.rows) * size.cols * channels);
+    ImageType image(buffer.data(), size.rows, size.cols);
+    const bool use_multi_thread = bench.options().use_multi_thread;
+    ShapeGenerator generator(size.rows, size.cols);
+
+    // Shapes shared by single and batch draws.
+    std::vector<ImagePainter::Rectangle> rectangles(kNumOfShapes);
+    Eigen::Matrix<int32_t, Eigen::Dynamic, 4> lines(kNumOfShapes, 4);
+    Eigen::Matrix<int32_t, Eigen::Dynamic, 3> circles(kNumOfShapes, 3);
+    Eigen::Matrix<int32_t, Eigen::Dynamic, 2> radii(kNumOfShapes, 2);
+    Eigen::Matrix<float, Eigen::Dynamic, 5> gaussians(kNumOfShapes, 5);
+    std::vector<PixelType> colors(kNumOfShapes);
+    for (int32_t i = 0; i < kNumOfShapes; ++i) {
+        rectangles[i] = ImagePainter::Rectangle{generator.GetX(), generator.GetY(), generator.GetSize(), generator.GetSize()};
+        const int32_t x = generator.GetX();
+        const int32_t y = generator.GetY();
+        const float angle = generator.GetFloat(0.0f, 6.28f);
+        const int32_t length = generator.GetSize();
+        lines.row(i) << x, y, x + static_cast<int32_t>(length * std::cos(angle)), y + static_cast<int32_t>(length * std::sin(angle));
+        circles.row(i) << generator.GetX(), generator.GetY(), generator.GetSize() / 2;
+        radii.row(i) << std::max(generator.GetSize() / 2, 1), std::max(generator.GetSize() / 2, 1);
+        // Covariance of ellipse with 3-sigma radii of the generated sizes.
+        const float sigma_a = static_cast<float>(generator.GetSize()) / 1.5f;
+        const float sigma_b = static_cast<float>(generator.GetSize()) / 1.5f;
+        Mat2 rotation;
+        rotation << std::cos(angle), -std::sin(angle), std::sin(angle), std::cos(angle);
+        const Mat2 covariance = rotation * Vec2(sigma_a * sigma_a, sigma_b * sigma_b).asDiagonal() * rotation.transpose();
+        gaussians.row(i) << generator.GetX(), generator.GetY(), covariance(0, 0), covariance(1, 0), covariance(1, 1);
+        colors[i] = GetColor<PixelType>(i);
+    }
+    Eigen::Matrix<int32_t, Eigen::Dynamic, 2> points(kNumOfShapes * 10, 2);
+    std::vector<PixelType> colors_of_points(points.rows());
+    for (int32_t i = 0; i < points.rows(); ++i) {
+        points.row(i) << generator.GetX(), generator.GetY();
+        colors_of_points[i] = GetColor<PixelType>(i);
+    }
+    // Polylines are random walks with steps of log-uniform sizes.
+    Eigen::Matrix<int32_t, Eigen::Dynamic, 2> polyline(kNumOfShapes, 2);
+    polyline.row(0) << size.cols / 2, size.rows / 2;
+    for (int32_t i = 1; i < kNumOfShapes; ++i) {
+        const float angle = generator.GetFloat(0.0f, 6.28f);
+        const int32_t step = std::min(generator.GetSize(), 64);
+        polyline(i, 0) = std::min(std::max(polyline(i - 1, 0) + static_cast<int32_t>(step * std::cos(angle)), 0), size.cols - 1);
+        polyline(i, 1) = std::min(std::max(polyline(i - 1, 1) + static_cast<int32_t>(step * std::sin(angle)), 0), size.rows - 1);
+    }
+    std::vector<ImagePainter::Label> labels(kNumOfLabels);
+    for (int32_t i = 0; i < kNumOfLabels; ++i) {
+        labels[i] = ImagePainter::Label{"landmark " + std::to_string(i), generator.GetX(), generator.GetY()};
+    }
+    const ImagePainter::Blend alpha_blend(ImagePainter::BlendMode::kAlpha, 128);
+
+    // Single primitives.
+    bench.RunDraw("DrawSolidRectangle", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            const ImagePainter::Rectangle &r = rectangles[i];
+            ImagePainter::DrawSolidRectangle(image, r.x, r.y, r.width, r.height, colors[i]);
+        }
+    });
+    bench.RunDraw("DrawSolidRectangle/alpha", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            const ImagePainter::Rectangle &r = rectangles[i];
+            ImagePainter::DrawSolidRectangle(image, r.x, r.y, r.width, r.height, colors[i], alpha_blend);
+        }
+    });
+    bench.RunDraw("DrawHollowRectangle", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            const ImagePainter::Rectangle &r = rectangles[i];
+            ImagePainter::DrawHollowRectangle(image, r.x, r.y, r.width, r.height, colors[i]);
+        }
+    });
+    bench.RunDraw("DrawHollowRectangle/width_5", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            const ImagePainter::Rectangle &r = rectangles[i];
+            ImagePainter::DrawHollowRectangle(image, r.x, r.y, r.width, r.height, colors[i], 5);
+        }
+    });
+    bench.RunDraw("DrawBressenhanLine", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            ImagePainter::DrawBressenhanLine(image, lines(i, 0), lines(i, 1), lines(i, 2), lines(i, 3), colors[i]);
+        }
+    });
+    bench.RunDraw("DrawNaiveLine", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            ImagePainter::DrawNaiveLine(image, lines(i, 0), lines(i, 1), lines(i, 2), lines(i, 3), colors[i]);
+        }
+    });
+    bench.RunDraw("DrawDashedLine", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            ImagePainter::DrawDashedLine(image, lines(i, 0), lines(i, 1), lines(i, 2), lines(i, 3), 4, colors[i]);
+        }
+    });
+    bench.RunDraw("DrawThickLine", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            ImagePainter::DrawThickLine(image, lines(i, 0), lines(i, 1), lines(i, 2), lines(i, 3), 5, colors[i], ImagePainter::LineCap::kRound);
+        }
+    });
+    bench.RunDraw("DrawSolidCircle", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            ImagePainter::DrawSolidCircle(image, circles(i, 0), circles(i, 1), circles(i, 2), colors[i]);
+        }
+    });
+    bench.RunDraw("DrawHollowCircle", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            ImagePainter::DrawHollowCircle(image, circles(i, 0), circles(i, 1), circles(i, 2), colors[i]);
+        }
+    });
+    bench.RunDraw("DrawMidBresenhamEllipse", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            ImagePainter::DrawMidBresenhamEllipse(image, circles(i, 0), circles(i, 1), radii(i, 0), radii(i, 1), colors[i]);
+        }
+    });
+    bench.RunDraw("DrawSolidEllipse", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            ImagePainter::DrawSolidEllipse(image, circles(i, 0), circles(i, 1), radii(i, 0), radii(i, 1), colors[i]);
+        }
+    });
+    bench.RunDraw("DrawTrustRegionOfGaussian", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            Mat2 covariance;
+            covariance << gaussians(i, 2), gaussians(i, 3), gaussians(i, 3), gaussians(i, 4);
+            ImagePainter::DrawTrustRegionOfGaussian(image, Vec2(gaussians(i, 0), gaussians(i, 1)), covariance, colors[i]);
+        }
+    });
+    bench.RunDraw("DrawSolidTrustRegionOfGaussian", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            Mat2 covariance;
+            covariance << gaussians(i, 2), gaussians(i, 3), gaussians(i, 3), gaussians(i, 4);
+            ImagePainter::DrawSolidTrustRegionOfGaussian(image, Vec2(gaussians(i, 0), gaussians(i, 1)), covariance, colors[i]);
+        }
+    });
+    bench.RunDraw("DrawString", size, image, kNumOfLabels, [&]() {
+        for (int32_t i = 0; i < kNumOfLabels; ++i) {
+            ImagePainter::DrawString(image, labels[i].text, labels[i].x, labels[i].y, colors[i]);
+        }
+    });
+    bench.RunDraw("DrawString/font_20_smooth", size, image, kNumOfLabels, [&]() {
+        for (int32_t i = 0; i < kNumOfLabels; ++i) {
+            ImagePainter::DrawString(image, labels[i].text, labels[i].x, labels[i].y, colors[i], 20, true);
+        }
+    });
+    bench.RunDraw("DrawSolidPolygon", size, image, 1, [&]() { ImagePainter::DrawSolidPolygon(image, polyline, colors[0]); });
+    bench.RunDraw("DrawThickPolyline", size, image, kNumOfShapes - 1, [&]() {
+        ImagePainter::DrawThickPolyline(image, polyline, 5, colors[0], false, ImagePainter::LineJoin::kMiter);
+    });
+
+    // Batch primitives.
+    bench.RunDraw("DrawSolidRectangles", size, image, kNumOfShapes, [&]() { ImagePainter::DrawSolidRectangles(image, rectangles, colors[0]); });
+    bench.RunDraw("DrawPoints", size, image, static_cast<int32_t>(points.rows()),
+                  [&]() { ImagePainter::DrawPoints(image, points, colors_of_points, use_multi_thread); });
+    bench.RunDraw("DrawLines", size, image, kNumOfShapes, [&]() { ImagePainter::DrawLines(image, lines, colors, use_multi_thread); });
+    bench.RunDraw("DrawCircles", size, image, kNumOfShapes, [&]() { ImagePainter::DrawCircles(image, circles, colors, true, use_multi_thread); });
+    bench.RunDraw("DrawPolyline", size, image, kNumOfShapes - 1, [&]() { ImagePainter::DrawPolyline(image, polyline, colors[0], false, use_multi_thread); });
+    bench.RunDraw("DrawTrustRegionsOfGaussian", size, image, kNumOfShapes,
+                  [&]() { ImagePainter::DrawTrustRegionsOfGaussian(image, gaussians, colors, false, 3.0f, use_multi_thread); });
+    bench.RunDraw("DrawStrings", size, image, kNumOfLabels,
+                  [&]() { ImagePainter::DrawStrings(image, labels, std::vector<PixelType>(1, colors[0]), 12, false, use_multi_thread); });
+}
+
+template <typename ImageType, typename PixelType>
+void BenchRender(Bench &bench, const ImageSize &size) {
+    const int32_t channels = std::is_same<ImageType, RgbImage>::value ? 3 : 1;
+    std::vector<uint8_t> buffer(static_cast<size_t>(size.rows) * size.cols * channels);
+    ImageType image(buffer.data(), size.rows, size.cols);
+    const bool use_multi_thread = bench.options().use_multi_thread;
+    ShapeGenerator generator(size.rows, size.cols);
+
+    // Camera looks along z axis of world, and world items are in a box in front of it, some of which are out of view.
+    ImagePainter::CameraView cam;
+    cam.fx = static_cast<float>(size.cols) * 0.6f;
+    cam.fy = static_cast<float>(size.cols) * 0.6f;
+    cam.cx = static_cast<float>(size.cols) * 0.5f;
+    cam.cy = static_cast<float>(size.rows) * 0.5f;
+    auto get_point = [&]() { return Vec3(generator.GetFloat(-12.0f, 12.0f), generator.GetFloat(-8.0f, 8.0f), generator.GetFloat(-2.0f, 30.0f)); };
+
+    Eigen::Matrix<float, 3, Eigen::Dynamic> cloud(3, kNumOfPointsInCloud);
+    std::vector<PixelType> colors_of_cloud(kNumOfPointsInCloud);
+    for (int32_t i = 0; i < kNumOfPointsInCloud; ++i) {
+        cloud.col(i) = get_point();
+        colors_of_cloud[i] = GetColor<PixelType>(i);
+    }
+    Eigen::Matrix<float, 3, Eigen::Dynamic> means(3, kNumOfLandmarks);
+    Eigen::Matrix<float, 6, Eigen::Dynamic> covariances(6, kNumOfLandmarks);
+    std::vector<Mat3> covariances_3d(kNumOfLandmarks);
+    std::vector<PixelType> colors(kNumOfLandmarks);
+    for (int32_t i = 0; i < kNumOfLandmarks; ++i) {
+        means.col(i) = get_point();
+        Mat3 factor = Mat3::Zero();
+        for (int32_t r = 0; r < 3; ++r) {
+            for (int32_t c = 0; c < 3; ++c) {
+                factor(r, c) = generator.GetFloat(-0.2f, 0.2f);
+            }
+        }
+        const Mat3 covariance = factor * factor.transpose() + Mat3::Identity() * 1e-3f;
+        covariances_3d[i] = covariance;
+        covariances.col(i) << covariance(0, 0), covariance(0, 1), covariance(0, 2), covariance(1, 1), covariance(1, 2), covariance(2, 2);
+        colors[i] = GetColor<PixelType>(i);
+    }
+    std::vector<SpatialIndex::LineSegment> segments(kNumOfShapes);
+    SpatialIndex index(1.0f);
+    index.AddPoints(cloud);
+    for (int32_t i = 0; i < kNumOfShapes; ++i) {
+        segments[i].s_point = means.col(i);
+        segments[i].e_point = means.col(i) + Vec3(generator.GetFloat(-2.0f, 2.0f), generator.GetFloat(-2.0f, 2.0f), generator.GetFloat(-2.0f, 2.0f));
+        index.AddLineSegment(segments[i].s_point, segments[i].e_point);
+    }
+
+    bench.RunDraw("RenderPointInCameraView", size, image, kNumOfLandmarks, [&]() {
+        for (int32_t i = 0; i < kNumOfLandmarks; ++i) {
+            ImagePainter::RenderPointInCameraView(image, cam, means.col(i), colors[i], 2);
+        }
+    });
+    bench.RunDraw("RenderPointsInCameraView", size, image, kNumOfPointsInCloud,
+                  [&]() { ImagePainter::RenderPointsInCameraView(image, cam, cloud, colors_of_cloud, 1, use_multi_thread); });
+    bench.RunDraw("RenderPointsInCameraView/index", size, image, kNumOfPointsInCloud,
+                  [&]() { ImagePainter::RenderPointsInCameraView(image, cam, index, std::vector<PixelType>(1, colors[0]), 1, use_multi_thread); });
+    bench.RunDraw("RenderLineSegmentInCameraView", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            ImagePainter::RenderLineSegmentInCameraView(image, cam, segments[i].s_point, segments[i].e_point, colors[i]);
+        }
+    });
+    bench.RunDraw("RenderLineSegmentsInCameraView/index", size, image, kNumOfShapes,
+                  [&]() { ImagePainter::RenderLineSegmentsInCameraView(image, cam, index, std::vector<PixelType>(1, colors[0])); });
+    bench.RunDraw("RenderDashedLineSegmentInCameraView", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            ImagePainter::RenderDashedLineSegmentInCameraView(image, cam, segments[i].s_point, segments[i].e_point, 4, colors[i]);
+        }
+    });
+    bench.RunDraw("RenderTextInCameraView", size, image, kNumOfLabels, [&]() {
+        for (int32_t i = 0; i < kNumOfLabels; ++i) {
+            ImagePainter::RenderTextInCameraView(image, cam, means.col(i), "landmark", colors[i]);
+        }
+    });
+    bench.RunDraw("RenderEllipseInCameraView", size, image, kNumOfLandmarks, [&]() {
+        for (int32_t i = 0; i < kNumOfLandmarks; ++i) {
+            ImagePainter::RenderEllipseInCameraView(image, cam, means.col(i), covariances_3d[i], colors[i]);
+        }
+    });
+    bench.RunDraw("RenderEllipsesInCameraView", size, image, kNumOfLandmarks,
+                  [&]() { ImagePainter::RenderEllipsesInCameraView(image, cam, means, covariances, colors, false, use_multi_thread); });
+}
+
+// Overlays drawn into nv12 camera buffer directly, whose pixels are counted on luma plane.
+void BenchYuv420(Bench &bench, const ImageSize &size) {
+    const size_t size_of_chroma = static_cast<size_t>((size.rows + 1) / 2) * ((size.cols + 1) / 2) * 2;
+    std::vector<uint8_t> buffer(static_cast<size_t>(size.rows) * size.cols + size_of_chroma);
+    Yuv420Image image(buffer.data(), size.rows, size.cols);
+    ShapeGenerator generator(size.rows, size.cols);
+
+    std::vector<ImagePainter::Rectangle> rectangles(kNumOfShapes);
+    Eigen::Matrix<int32_t, Eigen::Dynamic, 3> circles(kNumOfShapes, 3);
+    std::vector<ImagePainter::YuvPixel> colors(kNumOfShapes);
+    for (int32_t i = 0; i < kNumOfShapes; ++i) {
+        rectangles[i] = ImagePainter::Rectangle{generator.GetX(), generator.GetY(), generator.GetSize(), generator.GetSize()};
+        circles.row(i) << generator.GetX(), generator.GetY(), generator.GetSize() / 2;
+        colors[i] = ImagePainter::ConvertRgbToYuv(GetColor<RgbPixel>(i));
+    }
+    std::vector<ImagePainter::Label> labels(kNumOfLabels);
+    for (int32_t i = 0; i < kNumOfLabels; ++i) {
+        labels[i] = ImagePainter::Label{"landmark " + std::to_string(i), generator.GetX(), generator.GetY()};
+    }
+    const ImagePainter::Blend alpha_blend(ImagePainter::BlendMode::kAlpha, 128);
+
+    bench.RunDraw("DrawSolidRectangle/alpha", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            const ImagePainter::Rectangle &r = rectangles[i];
+            ImagePainter::DrawSolidRectangle(image, r.x, r.y, r.width, r.height, colors[i], alpha_blend);
+        }
+    });
+    bench.RunDraw("DrawHollowRectangle/width_5", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            const ImagePainter::Rectangle &r = rectangles[i];
+            ImagePainter::DrawHollowRectangle(image, r.x, r.y, r.width, r.height, colors[i], 5);
+        }
+    });
+    bench.RunDraw("DrawSolidCircle", size, image, kNumOfShapes, [&]() {
+        for (int32_t i = 0; i < kNumOfShapes; ++i) {
+            ImagePainter::DrawSolidCircle(image, circles(i, 0), circles(i, 1), circles(i, 2), colors[i]);
+        }
+    });
+    bench.RunDraw("DrawString", size, image, kNumOfLabels, [&]() {
+        for (int32_t i = 0; i < kNumOfLabels; ++i) {
+            ImagePainter::DrawString(image, labels[i].text, labels[i].x, labels[i].y, colors[i]);
+        }
+    });
+}
+
+void BenchConvert(Bench &bench, const ImageSize &size) {
+    const int64_t pixels = static_cast<int64_t>(size.rows) * size.cols;
+    std::vector<uint8_t> gray_buffer(pixels);
+    std::vector<uint8_t> rgb_buffer(pixels * 3);
+    std::vector<uint8_t> other_rgb_buffer(pixels * 3);
+    GrayImage gray_image(gray_buffer.data(), size.rows, size.cols);
+    RgbImage rgb_image(rgb_buffer.data(), size.rows, size.cols);
+    std::vector<uint8_t> other_gray_buffer(pixels);
+    for (int64_t i = 0; i < pixels; ++i) {
+        gray_buffer[i] = static_cast<uint8_t>(i * 7);
+    }
+    for (int64_t i = 0; i < pixels * 3; ++i) {
+        rgb_buffer[i] = static_cast<uint8_t>(i * 13);
+    }
+
+    // Dense matrices are scaled up by 4, or downsampled by 2. Sparse matrix has 1% nonzeros.
+    constexpr int32_t kScale = 4;
+    const Mat matrix = Mat::Random(size.rows / kScale, size.cols / kScale) * 10.0f;
+    const Mat large_matrix = Mat::Random(size.rows * 2, size.cols * 2) * 10.0f;
+    std::mt19937 engine(kRandomSeed);
+    std::vector<Eigen::Triplet<float>> triplets;
+    for (int64_t i = 0; i < static_cast<int64_t>(matrix.size()) / 100; ++i) {
+        triplets.emplace_back(engine() % matrix.rows(), engine() % matrix.cols(), 5.0f);
+    }
+    Eigen::SparseMatrix<float> sparse_matrix(matrix.rows(), matrix.cols());
+    sparse_matrix.setFromTriplets(triplets.begin(), triplets.end());
+    triplets.clear();
+    for (int64_t i = 0; i < static_cast<int64_t>(large_matrix.size()) / 100; ++i) {
+        triplets.emplace_back(engine() % large_matrix.rows(), engine() % large_matrix.cols(), 5.0f);
+    }
+    Eigen::SparseMatrix<float> large_sparse_matrix(large_matrix.rows(), large_matrix.cols());
+    large_sparse_matrix.setFromTriplets(triplets.begin(), triplets.end());
+    const ColorMap &color_map = ColorMap::Get(ColorMap::Type::kTurbo);
+
+    bench.RunConvert("ConvertValueToUint8", "none", size, pixels, [&]() {
+        uint32_t sum = 0;
+        for (int64_t i = 0; i < pixels; ++i) {
+            sum += ImagePainter::ConvertValueToUint8<float>(static_cast<float>(i & 1023), 1000.0f);
+        }
+        gray_buffer[0] = static_cast<uint8_t>(sum);
+    });
+    bench.RunConvert("ConvertMatrixToImage", "gray", size, pixels, [&]() { ImagePainter::ConvertMatrixToImage<float>(matrix, gray_image, 10.0f, kScale); });
+    bench.RunConvert("ConvertMatrixToImage", "rgb", size, pixels, [&]() { ImagePainter::ConvertMatrixToImage<float>(matrix, rgb_image, 10.0f, kScale); });
+    bench.RunConvert("ConvertMatrixToImage/turbo", "rgb", size, pixels,
+                     [&]() { ImagePainter::ConvertMatrixToImage<float>(matrix, rgb_image, color_map, 10.0f, kScale); });
+    bench.RunConvert("ConvertMatrixToImageWithDownsample", "gray", size, pixels, [&]() {
+        ImagePainter::ConvertMatrixToImageWithDownsample<float>(large_matrix, gray_image, color_map, 10.0f, ImagePainter::CellAggregation::kMaxAbs);
+    });
+    bench.RunConvert("ConvertMatrixToImageWithDownsample", "rgb", size, pixels, [&]() {
+        ImagePainter::ConvertMatrixToImageWithDownsample<float>(large_matrix, rgb_image, color_map, 10.0f, ImagePainter::CellAggregation::kMaxAbs);
+    });
+    bench.RunConvert("ConvertSparseMatrixToImage", "gray", size, pixels,
+                     [&]() { ImagePainter::ConvertSparseMatrixToImage<float>(sparse_matrix, gray_image, color_map, 10.0f, kScale); });
+    bench.RunConvert("ConvertSparseMatrixToImage", "rgb", size, pixels,
+                     [&]() { ImagePainter::ConvertSparseMatrixToImage<float>(sparse_matrix, rgb_image, color_map, 10.0f, kScale); });
+    bench.RunConvert("ConvertSparseMatrixToImageWithDownsample", "gray", size, pixels, [&]() {
+        ImagePainter::ConvertSparseMatrixToImageWithDownsample<float>(large_sparse_matrix, gray_image, color_map, 10.0f,
+                                                                      ImagePainter::CellAggregation::kNonZeroCount);
+    });
+    bench.RunConvert("ConvertSparseMatrixToImageWithDownsample", "rgb", size, pixels, [&]() {
+        ImagePainter::ConvertSparseMatrixToImageWithDownsample<float>(large_sparse_matrix, rgb_image, color_map, 10.0f,
+                                                                      ImagePainter::CellAggregation::kNonZeroCount);
+    });
+    bench.RunConvert("ConvertUint8ToRgb", "rgb", size, pixels,
+                     [&]() { ImagePainter::ConvertUint8ToRgb(gray_buffer.data(), other_rgb_buffer.data(), static_cast<int32_t>(pixels)); });
+    bench.RunConvert("ConvertRgbToUint8", "gray", size, pixels,
+                     [&]() { ImagePainter::ConvertRgbToUint8(rgb_buffer.data(), other_gray_buffer.data(), static_cast<int32_t>(pixels)); });
+    bench.RunConvert("ConvertUint8ToRgbAndUpsideDown", "rgb", size, pixels,
+                     [&]() { ImagePainter::ConvertUint8ToRgbAndUpsideDown(gray_buffer.data(), other_rgb_buffer.data(), size.rows, size.cols); });
+    bench.RunConvert("ConvertRgbToBgr", "rgb", size, pixels,
+                     [&]() { ImagePainter::ConvertRgbToBgr(rgb_buffer.data(), other_rgb_buffer.data(), size.rows, size.cols); });
+    bench.RunConvert("ConvertRgbToBgrAndUpsideDown", "rgb", size, pixels,
+                     [&]() { ImagePainter::ConvertRgbToBgrAndUpsideDown(rgb_buffer.data(), other_rgb_buffer.data(), size.rows, size.cols); });
+
+    const std::vector<std::pair<std::string, ImagePainter::ImageGeometry>> geometries = {
+        {"flip_vertical", ImagePainter::ImageGeometry::kFlipVertical},
+        {"flip_horizontal", ImagePainter::ImageGeometry::kFlipHorizontal},
+        {"rotate_90", ImagePainter::ImageGeometry::kRotate90},
+        {"rotate_180", ImagePainter::ImageGeometry::kRotate180},
+        {"rotate_270", ImagePainter::ImageGeometry::kRotate270},
+        {"transpose", ImagePainter::ImageGeometry::kTranspose},
+    };
+    for (const auto &geometry: geometries) {
+        // Rotate 90 / 270 and transpose swap rows and cols.
+        const bool is_swapped = geometry.second == ImagePainter::ImageGeometry::kRotate90 || geometry.second == ImagePainter::ImageGeometry::kRotate270 ||
+                                geometry.second == ImagePainter::ImageGeometry::kTranspose;
+        GrayImage converted_gray(other_gray_buffer.data(), is_swapped ? size.cols : size.rows, is_swapped ? size.rows : size.cols);
+        RgbImage converted_rgb(other_rgb_buffer.data(), is_swapped ? size.cols : size.rows, is_swapped ? size.rows : size.cols);
+        bench.RunConvert("ConvertImageGeometry/" + geometry.first, "gray", size, pixels,
+                         [&]() { ImagePainter::ConvertImageGeometry(gray_image, converted_gray, geometry.second); });
+        bench.RunConvert("ConvertImageGeometry/" + geometry.first, "rgb", size, pixels,
+                         [&]() { ImagePainter::ConvertImageGeometry(rgb_image, converted_rgb, geometry.second); });
+    }
+}
+
+std::vector<std::string> SplitString(const std::string &str, char separator) {
+    std::vector<std::string> items;
+    std::stringstream stream(str);
+    std::string item;
+    while (std::getline(stream, item, separator)) {
+        if (!item.empty()) {
+            items.emplace_back(item);
+        }
+    }
+    return items;
+}
+
+void PrintUsage() {
+    std::fprintf(stderr,
+                 "Usage: bench_image_painter [options]\n"
+                 "  --sizes vga,hd,fhd,4k   Image sizes to run.\n"
+                 "  --filter name           Only run cases whose name contains it.\n"
+                 "  --min_time_ms 100       Min time of each case.\n"
+                 "  --multi_thread          Enable multi-thread of batch draw and render.\n"
+                 "  --output file.json      Write results into file instead of stdout.\n"
+                 "  --baseline file.json    Compare results with baseline, and fail if any case is slower than max slowdown.\n"
+                 "  --max_slowdown 1.2      Max ratio of ns per primitive to baseline.\n");
+}
+
+bool ParseOptions(int argc, char **argv, Options &options) {
+    for (int32_t i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--sizes" && has_value) {
+            options.sizes = SplitString(argv[++i], ',');
+        } else if (arg == "--filter" && has_value) {
+            options.filter = argv[++i];
+        } else if (arg == "--min_time_ms" && has_value) {
+            options.min_time_ms = std::atof(argv[++i]);
+        } else if (arg == "--multi_thread") {
+            options.use_multi_thread = true;
+        } else if (arg == "--output" && has_value) {
+            options.output_file = argv[++i];
+        } else if (arg == "--baseline" && has_value) {
+            options.baseline_file = argv[++i];
+        } else if (arg == "--max_slowdown" && has_value) {
+            options.max_slowdown = std::atof(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    const std::vector<ImageSize> all_sizes = {{"vga", 480, 640}, {"hd", 720, 1280}, {"fhd", 1080, 1920}, {"4k", 2160, 3840}};
+    Bench bench(options);
+    for (const std::string &name: options.sizes) {
+        const auto it = std::find_if(all_sizes.begin(), all_sizes.end(), [&](const ImageSize &size) { return size.name == name; });
+        if (it == all_sizes.end()) {
+            std::fprintf(stderr, "Unknown image size %s.\n", name.c_str());
+            PrintUsage();
+            return 1;
+        }
+        BenchDraw<GrayImage, uint8_t>(bench, *it);
+        BenchDraw<RgbImage, RgbPixel>(bench, *it);
+        BenchRender<GrayImage, uint8_t>(bench, *it);
+        BenchRender<RgbImage, RgbPixel>(bench, *it);
+        BenchYuv420(bench, *it);
+        BenchConvert(bench, *it);
+    }
+
+    if (options.output_file.empty()) {
+        bench.WriteJson(std::cout);
+    } else {
+        std::ofstream file(options.output_file);
+        bench.WriteJson(file);
+    }
+    if (!options.baseline_file.empty() && !bench.CompareWithBaseline(options.baseline_file)) {
+        return 2;
+    }
+    return 0;
+}
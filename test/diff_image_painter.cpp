@@ -0,0 +1,2492 @@
+#include "assic_fonts.h"
+#include "image_painter.h"
+#include "image_painter_display_list.h"
+#include "image_painter_draw.h"
+#include "image_painter_profile.h"
+#include "image_painter_render_context.h"
+#include "image_painter_retained_canvas.h"
+#include "image_painter_spatial_index.h"
+#include "image_painter_yuv.h"
+
+#include "basic_type.h"
+
+#include "algorithm"
+#include "array"
+#include "chrono"
+#include "cmath"
+#include "cstdio"
+#include "cstdlib"
+#include "functional"
+#include "limits"
+#include "random"
+#include "sstream"
+#include "string"
+#include "type_traits"
+#include "vector"
+
+using namespace image_painter;
+
+namespace image_painter {
+
+// Images of pixel types which are not instantiated in library. They are drawn by templates of image_painter_draw.h.
+struct RgbaPixel {
+    uint8_t r = 0;
+    uint8_t g = 0;
+    uint8_t b = 0;
+    uint8_t a = 0;
+};
+
+template <typename ChannelType, int32_t kChannels>
+class TestImage {
+
+public:
+    TestImage(ChannelType *data, int32_t rows, int32_t cols) : data_(data), rows_(rows), cols_(cols) {}
+    virtual ~TestImage() = default;
+
+    ChannelType *data() const { return data_; }
+    int32_t rows() const { return rows_; }
+    int32_t cols() const { return cols_; }
+
+private:
+    ChannelType *data_ = nullptr;
+    int32_t rows_ = 0;
+    int32_t cols_ = 0;
+};
+
+using RgbaImage = TestImage<uint8_t, 4>;
+using Gray16Image = TestImage<uint16_t, 1>;
+
+template <>
+struct PixelTraits<RgbaImage> {
+    using PixelType = RgbaPixel;
+    using ChannelType = uint8_t;
+    static constexpr int32_t kChannels = 4;
+    static constexpr ChannelType kMaxValue = 255;
+    static ChannelType GetChannel(const PixelType &pixel, int32_t channel) {
+        return channel == 0 ? pixel.r : (channel == 1 ? pixel.g : (channel == 2 ? pixel.b : pixel.a));
+    }
+};
+
+template <>
+struct PixelTraits<Gray16Image> {
+    using PixelType = uint16_t;
+    using ChannelType = uint16_t;
+    static constexpr int32_t kChannels = 1;
+    static constexpr ChannelType kMaxValue = 65535;
+    static ChannelType GetChannel(const PixelType &pixel, int32_t) { return pixel; }
+};
+
+}  // namespace image_painter
+
+namespace {
+constexpr uint32_t kDefaultSeed = 20240601;
+constexpr int32_t kDefaultIterations = 30;
+constexpr int32_t kMaxImageSize = 160;
+constexpr int32_t kNumOfPrimitives = 24;
+// Coordinates of very large shapes. Radii of ellipses are smaller, so their int64 equations do not overflow.
+constexpr int32_t kLargeCoordinate = 100000;
+constexpr int32_t kLargeRadiusOfEllipse = 30000;
+
+struct Options {
+    uint32_t seed = kDefaultSeed;
+    int32_t iterations = kDefaultIterations;
+    double soak_seconds = 0.0;
+    std::string filter;
+};
+
+/* Differences between expected and actual image. */
+struct Mismatch {
+    int64_t num_of_diff_pixels = 0;
+    int32_t row = -1;
+    int32_t col = -1;
+    std::string expected;
+    std::string actual;
+};
+
+template <typename ImageType>
+constexpr int32_t GetChannels() {
+    return std::is_same<ImageType, RgbImage>::value ? 3 : 1;
+}
+
+template <typename ImageType>
+std::string GetNameOfImage() {
+    return std::is_same<ImageType, RgbImage>::value ? "rgb" : "gray";
+}
+
+std::string GetNameOfSimdLevel(ImagePainter::SimdLevel level) {
+    switch (level) {
+        case ImagePainter::SimdLevel::kSse41:
+            return "sse4.1";
+        case ImagePainter::SimdLevel::kAvx2:
+            return "avx2";
+        case ImagePainter::SimdLevel::kNeon:
+            return "neon";
+        default:
+            return "scalar";
+    }
+}
+
+std::vector<ImagePainter::SimdLevel> GetSupportedSimdLevels() {
+    std::vector<ImagePainter::SimdLevel> levels;
+    for (const auto level: {ImagePainter::SimdLevel::kScalar, ImagePainter::SimdLevel::kSse41, ImagePainter::SimdLevel::kAvx2, ImagePainter::SimdLevel::kNeon}) {
+        if (ImagePainter::IsSimdLevelSupported(level)) {
+            levels.emplace_back(level);
+        }
+    }
+    return levels;
+}
+
+// Set simd level in scope, and restore the last one when leaving it.
+class ScopedSimdLevel {
+
+public:
+    explicit ScopedSimdLevel(ImagePainter::SimdLevel level) : last_level_(ImagePainter::GetSimdLevel()) { ImagePainter::SetSimdLevel(level); }
+    virtual ~ScopedSimdLevel() { ImagePainter::SetSimdLevel(last_level_); }
+
+private:
+    ImagePainter::SimdLevel last_level_ = ImagePainter::SimdLevel::kScalar;
+};
+
+/* Image with its own buffer, which is filled with random background of seed, so blended pixels are checked against varied values. */
+template <typename ImageType>
+struct Canvas {
+    Canvas(int32_t rows, int32_t cols, uint32_t seed) : buffer(static_cast<size_t>(rows) * cols * GetChannels<ImageType>()), image(buffer.data(), rows, cols) {
+        std::mt19937 engine(seed);
+        for (auto &value: buffer) {
+            value = static_cast<uint8_t>(engine());
+        }
+    }
+    Canvas(const Canvas &) = delete;
+    Canvas &operator=(const Canvas &) = delete;
+
+    std::vector<uint8_t> buffer;
+    ImageType image;
+};
+
+std::string GetStringOfPixel(const uint8_t *pixel, int32_t channels) {
+    std::ostringstream stream;
+    stream << "(";
+    for (int32_t c = 0; c < channels; ++c) {
+        stream << (c == 0 ? "" : ", ") << static_cast<int32_t>(pixel[c]);
+    }
+    stream << ")";
+    return stream.str();
+}
+
+// Compare pixels of two buffers. Channels of a pixel may differ by at most tolerance.
+Mismatch ComparePixels(const std::vector<uint8_t> &expected, const std::vector<uint8_t> &actual, int32_t cols, int32_t channels, int32_t tolerance = 0) {
+    Mismatch mismatch;
+    if (expected.size() != actual.size() || cols <= 0) {
+        mismatch.num_of_diff_pixels = -1;
+        return mismatch;
+    }
+    const int64_t num_of_pixels = static_cast<int64_t>(expected.size()) / channels;
+    for (int64_t i = 0; i < num_of_pixels; ++i) {
+        bool is_same = true;
+        for (int32_t c = 0; c < channels; ++c) {
+            is_same = is_same && std::abs(static_cast<int32_t>(expected[i * channels + c]) - actual[i * channels + c]) <= tolerance;
+        }
+        CONTINUE_IF(is_same);
+        if (mismatch.num_of_diff_pixels == 0) {
+            mismatch.row = static_cast<int32_t>(i / cols);
+            mismatch.col = static_cast<int32_t>(i % cols);
+            mismatch.expected = GetStringOfPixel(expected.data() + i * channels, channels);
+            mismatch.actual = GetStringOfPixel(actual.data() + i * channels, channels);
+        }
+        ++mismatch.num_of_diff_pixels;
+    }
+    return mismatch;
+}
+
+template <typename PixelType>
+PixelType GetRandomColor(std::mt19937 &engine);
+template <>
+uint8_t GetRandomColor<uint8_t>(std::mt19937 &engine) {
+    return static_cast<uint8_t>(engine());
+}
+template <>
+RgbPixel GetRandomColor<RgbPixel>(std::mt19937 &engine) {
+    return RgbPixel{static_cast<uint8_t>(engine()), static_cast<uint8_t>(engine()), static_cast<uint8_t>(engine())};
+}
+
+std::string GetStringOfColor(uint8_t color) { return "static_cast<uint8_t>(" + std::to_string(color) + ")"; }
+std::string GetStringOfColor(const RgbPixel &color) {
+    return "RgbPixel{" + std::to_string(color.r) + ", " + std::to_string(color.g) + ", " + std::to_string(color.b) + "}";
+}
+
+std::string GetStringOfBlend(const ImagePainter::Blend &blend) {
+    const char *names[] = {"kOpaque", "kAlpha", "kAdditive", "kMax"};
+    return "ImagePainter::Blend(ImagePainter::BlendMode::" + std::string(names[static_cast<int32_t>(blend.mode)]) + ", " + std::to_string(blend.alpha) + ")";
+}
+
+/* Reference oracles. They are the plain scalar implementations, which visit every pixel of primitive and write it through a coverage mask,
+   so each covered pixel is blended once. They are kept simple rather than fast, and optimized paths should match them pixel by pixel.
+   Shapes which are rounded in float or resampled are known up to a tolerance band, whose pixels may take any accepted coverage. */
+namespace reference {
+
+    struct Mask {
+        Mask(int32_t rows, int32_t cols) : rows(rows), cols(cols), covered(static_cast<size_t>(rows) * cols, 0) {}
+
+        void Cover(int64_t row, int64_t col) {
+            RETURN_IF(row < 0 || row >= rows || col < 0 || col >= cols);
+            covered[row * cols + col] = 1;
+        }
+
+        int32_t rows = 0;
+        int32_t cols = 0;
+        std::vector<uint8_t> covered;
+    };
+
+    // Coverage of pixels whose reference is only known up to a tolerance band. Pixel may be blended once with any coverage in
+    // [min_coverage, max_coverage], where coverage 0 leaves it unchanged. Binary pixel only takes the two ends of its range.
+    struct ToleranceMask {
+        ToleranceMask(int32_t rows, int32_t cols, bool is_binary = true)
+            : rows(rows), cols(cols), is_binary(is_binary), min_coverage(static_cast<size_t>(rows) * cols, 0), max_coverage(min_coverage) {}
+
+        void Tolerate(int64_t row, int64_t col, uint8_t min_value, uint8_t max_value) {
+            RETURN_IF(row < 0 || row >= rows || col < 0 || col >= cols);
+            min_coverage[row * cols + col] = min_value;
+            max_coverage[row * cols + col] = max_value;
+        }
+
+        int32_t rows = 0;
+        int32_t cols = 0;
+        bool is_binary = true;
+        std::vector<uint8_t> min_coverage;
+        std::vector<uint8_t> max_coverage;
+    };
+
+    // Pixel which is either inside, outside, or in tolerance band of a region.
+    enum class Region : uint8_t {
+        kOutside = 0,
+        kBand = 1,
+        kInside = 2,
+    };
+
+    // round(value / 255), with ties rounded up.
+    uint8_t RoundDivideBy255(int32_t value) { return static_cast<uint8_t>((2 * value + 255) / 510); }
+
+    uint8_t BlendByte(uint8_t value, uint8_t color, const ImagePainter::Blend &blend) {
+        switch (blend.mode) {
+            case ImagePainter::BlendMode::kAlpha:
+                return RoundDivideBy255(value * (255 - blend.alpha) + color * blend.alpha);
+            case ImagePainter::BlendMode::kAdditive:
+                return static_cast<uint8_t>(std::min(value + RoundDivideBy255(color * blend.alpha), 255));
+            case ImagePainter::BlendMode::kMax:
+                return std::max(value, RoundDivideBy255(color * blend.alpha));
+            default:
+                return color;
+        }
+    }
+
+    // Chroma is offset by 128, so additive blend adds scaled offset of color. Max blend of chroma is alpha blend.
+    uint8_t BlendChromaByte(uint8_t value, uint8_t color, const ImagePainter::Blend &blend) {
+        switch (blend.mode) {
+            case ImagePainter::BlendMode::kAlpha:
+            case ImagePainter::BlendMode::kMax:
+                return RoundDivideBy255(value * (255 - blend.alpha) + color * blend.alpha);
+            case ImagePainter::BlendMode::kAdditive: {
+                const int32_t offset = (static_cast<int32_t>(color) - 128) * blend.alpha;
+                const int32_t scaled_offset = offset >= 0 ? RoundDivideBy255(offset) : -static_cast<int32_t>(RoundDivideBy255(-offset));
+                return static_cast<uint8_t>(std::min(std::max(value + scaled_offset, 0), 255));
+            }
+            default:
+                return color;
+        }
+    }
+
+    template <typename ImageType, typename PixelType>
+    void ApplyMask(ImageType &image, const Mask &mask, const PixelType &color, const ImagePainter::Blend &blend) {
+        constexpr int32_t kChannels = GetChannels<ImageType>();
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&color);
+        for (size_t i = 0; i < mask.covered.size(); ++i) {
+            CONTINUE_IF(!mask.covered[i]);
+            for (int32_t c = 0; c < kChannels; ++c) {
+                uint8_t &value = image.data()[i * kChannels + c];
+                value = reference::BlendByte(value, bytes[c], blend);
+            }
+        }
+    }
+
+    // Partially covered pixel is blended with alpha scaled by coverage, where opaque blend becomes alpha one.
+    uint8_t BlendByteByCoverage(uint8_t value, uint8_t color, const ImagePainter::Blend &blend, int32_t coverage) {
+        if (coverage <= 0) {
+            return value;
+        }
+        if (coverage >= 255) {
+            return reference::BlendByte(value, color, blend);
+        }
+        const ImagePainter::BlendMode mode = blend.mode == ImagePainter::BlendMode::kOpaque ? ImagePainter::BlendMode::kAlpha : blend.mode;
+        return reference::BlendByte(value, color, ImagePainter::Blend(mode, RoundDivideBy255(blend.alpha * coverage)));
+    }
+
+    // Pixel of image takes the value of actual one if it is blended by any accepted coverage. Otherwise it is blended with max coverage, so only
+    // pixels out of tolerance differ from actual image.
+    template <typename ImageType, typename PixelType>
+    void ApplyToleranceMask(ImageType &image, const std::vector<uint8_t> &actual, const ToleranceMask &mask, const PixelType &color,
+                            const ImagePainter::Blend &blend) {
+        constexpr int32_t kChannels = GetChannels<ImageType>();
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&color);
+        for (size_t i = 0; i < mask.max_coverage.size(); ++i) {
+            const int32_t min_coverage = mask.min_coverage[i];
+            const int32_t max_coverage = mask.max_coverage[i];
+            CONTINUE_IF(max_coverage == 0);
+            uint8_t *pixel = image.data() + i * kChannels;
+            std::array<uint8_t, kChannels> expected = {};
+            for (int32_t coverage = max_coverage; coverage >= min_coverage; --coverage) {
+                CONTINUE_IF(mask.is_binary && coverage != min_coverage && coverage != max_coverage);
+                std::array<uint8_t, kChannels> blended;
+                for (int32_t c = 0; c < kChannels; ++c) {
+                    blended[c] = BlendByteByCoverage(pixel[c], bytes[c], blend, coverage);
+                }
+                if (coverage == max_coverage) {
+                    expected = blended;
+                }
+                if (std::equal(blended.begin(), blended.end(), actual.begin() + i * kChannels)) {
+                    expected = blended;
+                    break;
+                }
+            }
+            std::copy(expected.begin(), expected.end(), pixel);
+        }
+    }
+
+    void SolidRectangle(Mask &mask, int64_t x, int64_t y, int64_t width, int64_t height) {
+        RETURN_IF(width < 0 || height < 0);
+        for (int64_t row = std::max<int64_t>(y, 0); row < std::min<int64_t>(y + height, mask.rows); ++row) {
+            for (int64_t col = std::max<int64_t>(x, 0); col < std::min<int64_t>(x + width, mask.cols); ++col) {
+                mask.Cover(row, col);
+            }
+        }
+    }
+
+    void HollowRectangle(Mask &mask, int64_t x, int64_t y, int64_t width, int64_t height, int32_t line_width) {
+        RETURN_IF(width < 0 || height < 0);
+        const int64_t x0 = x;
+        const int64_t x1 = x + width;
+        const int64_t y0 = y;
+        const int64_t y1 = y + height;
+        if (line_width > 1) {
+            // Box [x0, x1] x [y0, y1] without its inner hole, which exists only if both sides are thick enough.
+            const bool has_hole = 2 * line_width <= std::min(width, height);
+            for (int64_t row = std::max<int64_t>(y0, 0); row <= std::min<int64_t>(y1, mask.rows - 1); ++row) {
+                for (int64_t col = std::max<int64_t>(x0, 0); col <= std::min<int64_t>(x1, mask.cols - 1); ++col) {
+                    const bool is_in_hole = row >= y0 + line_width && row <= y1 - line_width && col >= x0 + line_width && col <= x1 - line_width;
+                    if (!has_hole || !is_in_hole) {
+                        mask.Cover(row, col);
+                    }
+                }
+            }
+            return;
+        }
+        for (int64_t u = x0; u < x1; ++u) {
+            mask.Cover(y0, u);
+            mask.Cover(y1, u);
+        }
+        for (int64_t v = y0; v < y1; ++v) {
+            mask.Cover(v, x0);
+            mask.Cover(v, x1);
+        }
+    }
+
+    void BressenhanLine(Mask &mask, int64_t x1, int64_t y1, int64_t x2, int64_t y2) {
+        int64_t dx = std::abs(x2 - x1);
+        int64_t dy = std::abs(y2 - y1);
+        const bool is_larger_than_45_deg = dx < dy;
+        if (is_larger_than_45_deg) {
+            std::swap(x1, y1);
+            std::swap(x2, y2);
+            std::swap(dx, dy);
+        }
+        const int64_t ix = (x2 - x1) > 0 ? 1 : -1;
+        const int64_t iy = (y2 - y1) > 0 ? 1 : -1;
+        int64_t cx = x1;
+        int64_t cy = y1;
+        int64_t dy_2_dx = dy * 2 - dx;
+        while (cx != x2) {
+            if (dy_2_dx < 0) {
+                dy_2_dx += dy * 2;
+            } else {
+                cy += iy;
+                dy_2_dx += (dy - dx) * 2;
+            }
+            if (is_larger_than_45_deg) {
+                mask.Cover(cx, cy);
+            } else {
+                mask.Cover(cy, cx);
+            }
+            cx += ix;
+        }
+    }
+
+    // Bresenham line whose major delta is twice of its minor one, so pixel of step k is at minor step (k + 2) / 2. Only steps inside the
+    // image are visited, so lines between any int32 endpoints are checked in time of image size.
+    void BressenhanLineOfHalfSlope(Mask &mask, int64_t x1, int64_t y1, int64_t x2, int64_t y2) {
+        const bool is_larger_than_45_deg = std::abs(x2 - x1) < std::abs(y2 - y1);
+        if (is_larger_than_45_deg) {
+            std::swap(x1, y1);
+            std::swap(x2, y2);
+        }
+        const int64_t dx = std::abs(x2 - x1);
+        const int64_t ix = (x2 - x1) > 0 ? 1 : -1;
+        const int64_t iy = (y2 - y1) > 0 ? 1 : -1;
+        const int64_t major_size = is_larger_than_45_deg ? mask.rows : mask.cols;
+        for (int64_t cx = 0; cx < major_size; ++cx) {
+            const int64_t k = (cx - x1) * ix;
+            CONTINUE_IF(k < 0 || k >= dx);
+            const int64_t cy = y1 + (k + 2) / 2 * iy;
+            if (is_larger_than_45_deg) {
+                mask.Cover(cx, cy);
+            } else {
+                mask.Cover(cy, cx);
+            }
+        }
+    }
+
+    int64_t Interpolate(int64_t x1, int64_t y1, int64_t x2, int64_t y2, int64_t x) {
+        const float lambda = static_cast<float>(x - x1) / static_cast<float>(x2 - x1);
+        return static_cast<int32_t>(static_cast<float>(y1) * (1.0f - lambda) + static_cast<float>(y2) * lambda);
+    }
+
+    // Naive line and dashed line interpolate minor coordinate at every step of major axis. Single point draws nothing.
+    void DashedLine(Mask &mask, int64_t x1, int64_t y1, int64_t x2, int64_t y2, int64_t step, bool has_end_point) {
+        RETURN_IF(step <= 0);
+        const bool is_steep = std::abs(x1 - x2) < std::abs(y1 - y2);
+        if (is_steep) {
+            std::swap(x1, y1);
+            std::swap(x2, y2);
+        }
+        if (x1 > x2) {
+            std::swap(x1, x2);
+            std::swap(y1, y2);
+        }
+        RETURN_IF(x1 == x2);
+        auto cover = [&](int64_t x) {
+            const int64_t y = Interpolate(x1, y1, x2, y2, x);
+            if (is_steep) {
+                mask.Cover(x, y);
+            } else {
+                mask.Cover(y, x);
+            }
+        };
+        for (int64_t x = x1; x <= x2; x += step) {
+            cover(x);
+        }
+        if (has_end_point) {
+            cover(x2);
+        }
+    }
+
+    void SolidCircle(Mask &mask, int64_t center_x, int64_t center_y, int64_t radius) {
+        RETURN_IF(radius < 0);
+        for (int64_t row = std::max<int64_t>(center_y - radius, 0); row <= std::min<int64_t>(center_y + radius, mask.rows - 1); ++row) {
+            for (int64_t col = std::max<int64_t>(center_x - radius, 0); col <= std::min<int64_t>(center_x + radius, mask.cols - 1); ++col) {
+                const int64_t dx = col - center_x;
+                const int64_t dy = row - center_y;
+                if (dx * dx + dy * dy < radius * radius) {
+                    mask.Cover(row, col);
+                }
+            }
+        }
+    }
+
+    void HollowCircle(Mask &mask, int64_t center_x, int64_t center_y, int64_t radius, int32_t line_width) {
+        RETURN_IF(radius < 0);
+        const double radius_in = static_cast<double>(static_cast<float>(radius) - static_cast<float>(std::max(line_width, 1)) - 0.1f);
+        for (int64_t row = std::max<int64_t>(center_y - radius, 0); row <= std::min<int64_t>(center_y + radius, mask.rows - 1); ++row) {
+            for (int64_t col = std::max<int64_t>(center_x - radius, 0); col <= std::min<int64_t>(center_x + radius, mask.cols - 1); ++col) {
+                const int64_t dx = col - center_x;
+                const int64_t dy = row - center_y;
+                const int64_t distance_2 = dx * dx + dy * dy;
+                if (distance_2 < radius * radius && (radius_in < 0.0 || static_cast<double>(distance_2) > radius_in * radius_in)) {
+                    mask.Cover(row, col);
+                }
+            }
+        }
+    }
+
+    void MidBresenhamEllipse(Mask &mask, int64_t center_x, int64_t center_y, int32_t radius_x, int32_t radius_y) {
+        auto cover = [&](int64_t y, int64_t x) {
+            mask.Cover(center_y + y, center_x + x);
+            mask.Cover(center_y - y, center_x - x);
+            mask.Cover(center_y - y, center_x + x);
+            mask.Cover(center_y + y, center_x - x);
+        };
+        int32_t y = 0;
+        int32_t x = radius_x;
+        const float a = radius_y;
+        const float b = radius_x;
+        const float a2 = a * a;
+        const float b2 = b * b;
+        cover(y, x);
+
+        float d1 = b2 + a2 * (0.5f - b);
+        while (b2 * (y + 1) < a2 * (x - 0.5f)) {
+            if (d1 <= 0) {
+                d1 += b2 * (2 * y + 3);
+                ++y;
+            } else {
+                d1 += b2 * (2 * y + 3) + a2 * (2 - 2 * x);
+                ++y;
+                --x;
+            }
+            cover(y, x);
+        }
+
+        float d2 = b2 * (y + 0.5f) * (y + 0.5f) + a2 * (x - 1) * (x - 1) - a2 * b2;
+        while (x > 0) {
+            if (d2 <= 0) {
+                d2 += b2 * (2 * y + 2) + a2 * (3 - 2 * x);
+                ++y;
+                --x;
+            } else {
+                d2 += a2 * (3 - 2 * x);
+                --x;
+            }
+            cover(y, x);
+        }
+    }
+
+    void SolidEllipse(Mask &mask, int64_t center_x, int64_t center_y, int64_t radius_x, int64_t radius_y) {
+        RETURN_IF(radius_x < 0 || radius_y < 0);
+        for (int64_t row = std::max<int64_t>(center_y - radius_y, 0); row <= std::min<int64_t>(center_y + radius_y, mask.rows - 1); ++row) {
+            for (int64_t col = std::max<int64_t>(center_x - radius_x, 0); col <= std::min<int64_t>(center_x + radius_x, mask.cols - 1); ++col) {
+                const int64_t dx = col - center_x;
+                const int64_t dy = row - center_y;
+                if (dx * dx * radius_y * radius_y + dy * dy * radius_x * radius_x <= radius_x * radius_x * radius_y * radius_y) {
+                    mask.Cover(row, col);
+                }
+            }
+        }
+    }
+
+    // Glyph of ascii font 12, 16 or 24 with font_size x (font_size / 2) pixels in row major order, whose bytes are columns of bits from top
+    // to bottom.
+    std::vector<uint8_t> Glyph(char character, int32_t font_size) {
+        const int32_t idx = static_cast<int32_t>(character - ' ');
+        const int32_t cols = font_size >> 1;
+        const int32_t size = ((font_size >> 3) + ((font_size % 8) ? 1 : 0)) * cols;
+        std::vector<uint8_t> glyph(static_cast<size_t>(font_size) * cols, 0);
+        int32_t col = 0;
+        int32_t row = 0;
+        for (int32_t i = 0; i < size; ++i) {
+            uint8_t item = font_size == 16 ? AssicFonts::ascii_1608()[idx][i] : font_size == 24 ? AssicFonts::ascii_2412()[idx][i] : AssicFonts::ascii_1206()[idx][i];
+            for (int32_t j = 0; j < 8; ++j) {
+                if (item & 0x80) {
+                    glyph[row * cols + col] = 1;
+                }
+                item <<= 1;
+                ++row;
+                if (row == font_size) {
+                    row = 0;
+                    ++col;
+                    break;
+                }
+            }
+        }
+        return glyph;
+    }
+
+    void String(Mask &mask, const std::string &str, int64_t x, int64_t y, int32_t font_size) {
+        const int32_t cols = font_size >> 1;
+        for (const char character: str) {
+            const std::vector<uint8_t> glyph = Glyph(character, font_size);
+            for (int32_t row = 0; row < font_size; ++row) {
+                for (int32_t col = 0; col < cols; ++col) {
+                    if (glyph[row * cols + col]) {
+                        mask.Cover(y + row, x + col);
+                    }
+                }
+            }
+            x += cols;
+        }
+    }
+
+    // Glyphs of other font sizes are resampled from the nearest ascii font, whose size is clamped into [6, 256] and prefers the larger one on
+    // ties. Pixel without smoothing is covered if the source pixel under its center is. Smoothed pixel is compared with the box filter of source
+    // pixels it overlaps, which its 4 x 4 samples approximate within 1 / 4 of full coverage. Pixels which overlap no or only covered source
+    // pixels are exact.
+    void ScaledString(ToleranceMask &mask, const std::string &str, int64_t x, int64_t y, int32_t font_size, bool is_smooth) {
+        constexpr double kToleranceOfSmoothCoverage = 0.25;
+        const int32_t rows = std::min(std::max(font_size, 6), 256);
+        const int32_t cols = rows >> 1;
+        int32_t src_rows = 24;
+        for (const int32_t size: {16, 12}) {
+            if (std::abs(size - rows) < std::abs(src_rows - rows)) {
+                src_rows = size;
+            }
+        }
+        const int32_t src_cols = src_rows >> 1;
+
+        // Source pixel i covers [i * size, (i + 1) * size) and pixel j covers [j * src_size, (j + 1) * src_size) in the same units.
+        auto overlap = [](int64_t i, int64_t size, int64_t j, int64_t src_size) {
+            return std::max<int64_t>(std::min((i + 1) * size, (j + 1) * src_size) - std::max(i * size, j * src_size), 0);
+        };
+        for (const char character: str) {
+            const std::vector<uint8_t> glyph = Glyph(character, src_rows);
+            for (int32_t row = 0; row < rows; ++row) {
+                for (int32_t col = 0; col < cols; ++col) {
+                    if (!is_smooth) {
+                        const int32_t src_row = (2 * row + 1) * src_rows / (2 * rows);
+                        const int32_t src_col = (2 * col + 1) * src_cols / (2 * cols);
+                        const uint8_t coverage = glyph[src_row * src_cols + src_col] ? 255 : 0;
+                        mask.Tolerate(y + row, x + col, coverage, coverage);
+                        continue;
+                    }
+                    int64_t area = 0;
+                    for (int32_t i = 0; i < src_rows; ++i) {
+                        for (int32_t j = 0; j < src_cols; ++j) {
+                            area += glyph[i * src_cols + j] ? overlap(i, rows, row, src_rows) * overlap(j, cols, col, src_cols) : 0;
+                        }
+                    }
+                    const int64_t full_area = static_cast<int64_t>(src_rows) * src_cols;
+                    const double coverage = 255.0 * static_cast<double>(area) / static_cast<double>(full_area);
+                    const double tolerance = 255.0 * kToleranceOfSmoothCoverage;
+                    const bool is_exact = area == 0 || area == full_area;
+                    const double min_coverage = is_exact ? coverage : std::max(std::ceil(coverage - tolerance), 0.0);
+                    const double max_coverage = is_exact ? coverage : std::min(std::floor(coverage + tolerance), 255.0);
+                    mask.Tolerate(y + row, x + col, static_cast<uint8_t>(min_coverage), static_cast<uint8_t>(max_coverage));
+                }
+            }
+            x += cols;
+        }
+    }
+
+    // Pixel (row, col) is inside if point (col, row) has nonzero winding number, where edges cover rows [ceil(y_top), ceil(y_bottom) - 1]
+    // and crossing at x covers cols from ceil(x).
+    void SolidPolygon(Mask &mask, const std::vector<int32_t> &points) {
+        const int32_t size = static_cast<int32_t>(points.size() / 2);
+        RETURN_IF(size < 3);
+        for (int32_t row = 0; row < mask.rows; ++row) {
+            for (int32_t col = 0; col < mask.cols; ++col) {
+                int32_t winding = 0;
+                for (int32_t i = 0; i < size; ++i) {
+                    const int32_t j = i + 1 == size ? 0 : i + 1;
+                    const float xs = static_cast<float>(points[2 * i]);
+                    const float ys = static_cast<float>(points[2 * i + 1]);
+                    const float xe = static_cast<float>(points[2 * j]);
+                    const float ye = static_cast<float>(points[2 * j + 1]);
+                    CONTINUE_IF(ys == ye);
+                    const bool is_downward = ys < ye;
+                    const float x_top = is_downward ? xs : xe;
+                    const float y_top = is_downward ? ys : ye;
+                    const float x_bottom = is_downward ? xe : xs;
+                    const float y_bottom = is_downward ? ye : ys;
+                    CONTINUE_IF(row < std::ceil(y_top) || row > std::ceil(y_bottom) - 1);
+                    const float dx_dy = (x_bottom - x_top) / (y_bottom - y_top);
+                    const float x = x_top + (static_cast<float>(row) - y_top) * dx_dy;
+                    if (std::ceil(x) <= static_cast<float>(col)) {
+                        winding += is_downward ? 1 : -1;
+                    }
+                }
+                if (winding != 0) {
+                    mask.Cover(row, col);
+                }
+            }
+        }
+    }
+
+    // Stroke of polyline with half width max(line_width, 1) / 2 covers pixel whose center is within half width of a segment, where its
+    // projection is on the segment, or within half width of a round cap or join. Square caps extend the end segments by half width, and
+    // single point is covered by its square or round cap only. Discs are polygons and corners are rounded in float, so pixels within
+    // kToleranceOfStroke of the boundary may be either covered or not. Miter joins are only bounded by the miter limit.
+    void ThickPolyline(ToleranceMask &mask, const std::vector<int32_t> &points, int32_t line_width, bool is_closed, ImagePainter::LineJoin join,
+                       ImagePainter::LineCap cap) {
+        constexpr double kToleranceOfStroke = 0.25;
+        std::vector<Eigen::Vector2d> vertices;
+        for (size_t i = 0; i + 1 < points.size(); i += 2) {
+            const Eigen::Vector2d point(points[i], points[i + 1]);
+            CONTINUE_IF(!vertices.empty() && point == vertices.back());
+            vertices.emplace_back(point);
+        }
+        if (is_closed && vertices.size() > 2 && vertices.front() == vertices.back()) {
+            vertices.pop_back();
+        }
+        const int32_t size = static_cast<int32_t>(vertices.size());
+        RETURN_IF(size == 0);
+        is_closed = is_closed && size > 2;
+
+        const double half_width = 0.5 * std::max(line_width, 1);
+        const double inner_width = half_width - kToleranceOfStroke;
+        const double outer_width = half_width + kToleranceOfStroke;
+        const double miter_width = ImagePainter::kMaxMiterRatio * 2.0 * half_width + kToleranceOfStroke;
+        if (size > 1 && !is_closed && cap == ImagePainter::LineCap::kSquare) {
+            vertices.front() -= half_width * (vertices[1] - vertices.front()).normalized();
+            vertices.back() += half_width * (vertices.back() - vertices[size - 2]).normalized();
+        }
+        const int32_t num_of_segments = size == 1 ? 0 : is_closed ? size : size - 1;
+
+        for (int32_t row = 0; row < mask.rows; ++row) {
+            for (int32_t col = 0; col < mask.cols; ++col) {
+                const Eigen::Vector2d pixel(col, row);
+                bool is_inside = false;
+                bool is_outside = true;
+                for (int32_t i = 0; i < num_of_segments; ++i) {
+                    const Eigen::Vector2d &point_s = vertices[i];
+                    const Eigen::Vector2d &point_e = vertices[(i + 1) % size];
+                    const Eigen::Vector2d direction = point_e - point_s;
+                    const double length = direction.norm();
+                    const double t = (pixel - point_s).dot(direction) / (length * length);
+                    const double distance = (pixel - point_s - std::min(std::max(t, 0.0), 1.0) * direction).norm();
+                    const bool is_on_segment = t * length >= kToleranceOfStroke && (1.0 - t) * length >= kToleranceOfStroke;
+                    is_inside = is_inside || (is_on_segment && distance <= inner_width);
+                    is_outside = is_outside && distance > outer_width;
+                }
+                for (int32_t i = 0; i < size; ++i) {
+                    const bool is_end = !is_closed && (i == 0 || i == size - 1);
+                    const bool is_round = is_end ? cap == ImagePainter::LineCap::kRound : join == ImagePainter::LineJoin::kRound;
+                    const double distance = (pixel - vertices[i]).norm();
+                    if (size == 1 && cap == ImagePainter::LineCap::kSquare) {
+                        const double chebyshev_distance = (pixel - vertices[i]).cwiseAbs().maxCoeff();
+                        is_inside = is_inside || chebyshev_distance <= inner_width;
+                        is_outside = is_outside && chebyshev_distance > outer_width;
+                    } else if (is_round) {
+                        is_inside = is_inside || distance <= inner_width;
+                        is_outside = is_outside && distance > outer_width;
+                    } else if (!is_end && join == ImagePainter::LineJoin::kMiter) {
+                        is_outside = is_outside && distance > miter_width;
+                    }
+                }
+                if (is_inside) {
+                    mask.Tolerate(row, col, 255, 255);
+                } else if (!is_outside) {
+                    mask.Tolerate(row, col, 0, 255);
+                }
+            }
+        }
+    }
+
+    // Gaussian trust region d^T * covariance^-1 * d <= r^2 with d = (col, row) - center and r = 0.5 * sigma_scale. It is evaluated along
+    // eigen vectors of covariance, where the region is an ellipse with semi axes a >= b. Pixels of flat chords are kept and bridged to be
+    // 8-connected, so pixels within kToleranceOfGaussian outside the ellipse may be covered. Inside is shrunk by kToleranceOfRounding.
+    class GaussianRegion {
+
+    public:
+        GaussianRegion(const Vec2 &center, const Mat2 &covariance, float sigma_scale) {
+            const double cov_xx = covariance(0, 0);
+            const double cov_yy = covariance(1, 1);
+            const double cov_xy = covariance(1, 0);
+            is_valid_ = std::isfinite(cov_xx) && std::isfinite(cov_yy) && std::isfinite(cov_xy) && std::isfinite(sigma_scale) && cov_xx >= 0.0 &&
+                        cov_yy >= 0.0;
+            center_x_ = center.x();
+            center_y_ = center.y();
+            const double lambda_1 = 0.5 * (cov_xx + cov_yy) + std::sqrt(0.25 * (cov_xx - cov_yy) * (cov_xx - cov_yy) + cov_xy * cov_xy);
+            const double lambda_2 = lambda_1 > 0.0 ? std::max(cov_xx * cov_yy - cov_xy * cov_xy, 0.0) / lambda_1 : 0.0;
+            const double angle = 0.5 * std::atan2(2.0 * cov_xy, cov_xx - cov_yy);
+            cos_ = std::cos(angle);
+            sin_ = std::sin(angle);
+            a_ = 0.5 * std::fabs(sigma_scale) * std::sqrt(lambda_1);
+            b_ = 0.5 * std::fabs(sigma_scale) * std::sqrt(lambda_2);
+        }
+
+        Region Classify(int64_t row, int64_t col) const {
+            constexpr double kToleranceOfGaussian = 1.5;
+            constexpr double kToleranceOfRounding = 0.05;
+            if (!is_valid_) {
+                return Region::kOutside;
+            }
+            const double dx = static_cast<double>(col) - center_x_;
+            const double dy = static_cast<double>(row) - center_y_;
+            const double u = dx * cos_ + dy * sin_;
+            const double v = dy * cos_ - dx * sin_;
+            // Ellipse shrunk by k keeps distance (1 - k) * b to the boundary.
+            const double k = 1.0 - kToleranceOfRounding / b_;
+            if (b_ > kToleranceOfRounding && u * u / (a_ * a_) + v * v / (b_ * b_) <= k * k) {
+                return Region::kInside;
+            }
+            // Ellipse with semi axes squared (1 + 1 / p) * a^2 + (1 + p) * t^2 contains all points within t of the ellipse for any p > 0.
+            const double t_2 = kToleranceOfGaussian * kToleranceOfGaussian;
+            for (const double semi_axis: {a_, b_, std::sqrt(a_ * b_)}) {
+                const double p = semi_axis > 0.0 ? kToleranceOfGaussian / semi_axis : 1e-9;
+                const double m_1 = (1.0 + 1.0 / p) * a_ * a_ + (1.0 + p) * t_2;
+                const double m_2 = (1.0 + 1.0 / p) * b_ * b_ + (1.0 + p) * t_2;
+                if (u * u / m_1 + v * v / m_2 > 1.0) {
+                    return Region::kOutside;
+                }
+            }
+            return Region::kBand;
+        }
+
+    private:
+        bool is_valid_ = false;
+        double center_x_ = 0.0;
+        double center_y_ = 0.0;
+        double cos_ = 1.0;
+        double sin_ = 0.0;
+        double a_ = 0.0;
+        double b_ = 0.0;
+    };
+
+    void SolidTrustRegionOfGaussian(ToleranceMask &mask, const GaussianRegion &region) {
+        for (int32_t row = 0; row < mask.rows; ++row) {
+            for (int32_t col = 0; col < mask.cols; ++col) {
+                const Region inside = region.Classify(row, col);
+                mask.Tolerate(row, col, inside == Region::kInside ? 255 : 0, inside == Region::kOutside ? 0 : 255);
+            }
+        }
+    }
+
+    // Boundary pixels are inside ones which have any 4-neighbor outside. Pixels in tolerance band of region are resolved by raster of the
+    // solid region, which is checked against the region itself, so only boundary next to undecided pixels out of image may vary.
+    void TrustRegionOfGaussian(ToleranceMask &mask, const GaussianRegion &region, const Mask &raster) {
+        auto classify = [&](int64_t row, int64_t col) {
+            const Region inside = region.Classify(row, col);
+            if (inside != Region::kBand || row < 0 || row >= mask.rows || col < 0 || col >= mask.cols) {
+                return inside;
+            }
+            return raster.covered[row * mask.cols + col] ? Region::kInside : Region::kOutside;
+        };
+        for (int32_t row = 0; row < mask.rows; ++row) {
+            for (int32_t col = 0; col < mask.cols; ++col) {
+                CONTINUE_IF(classify(row, col) != Region::kInside);
+                // Pixel is on boundary if any neighbor is outside, and it is undecided if the others are inside but some is in band.
+                bool is_boundary = false;
+                bool is_undecided = false;
+                for (const auto &offset: {std::make_pair(-1, 0), std::make_pair(1, 0), std::make_pair(0, -1), std::make_pair(0, 1)}) {
+                    const Region neighbor = classify(row + offset.first, col + offset.second);
+                    is_boundary = is_boundary || neighbor == Region::kOutside;
+                    is_undecided = is_undecided || neighbor == Region::kBand;
+                }
+                mask.Tolerate(row, col, is_boundary ? 255 : 0, is_boundary || is_undecided ? 255 : 0);
+            }
+        }
+    }
+
+}  // namespace reference
+
+/* Randomized primitive of single draw. Its arguments are kept as plain values, so it can be printed as a reproducer. */
+enum class PrimitiveType : uint8_t {
+    kSolidRectangle = 0,
+    kHollowRectangle,
+    kBressenhanLine,
+    kNaiveLine,
+    kDashedLine,
+    kSolidCircle,
+    kHollowCircle,
+    kMidBresenhamEllipse,
+    kSolidEllipse,
+    kString,
+    kSolidPolygon,
+    kThickPolyline,
+    kTrustRegionOfGaussian,
+    kSolidTrustRegionOfGaussian,
+    kNumOfTypes,
+};
+
+const char *GetNameOfPrimitive(PrimitiveType type) {
+    const char *names[] = {"DrawSolidRectangle", "DrawHollowRectangle", "DrawBressenhanLine", "DrawNaiveLine", "DrawDashedLine",
+                           "DrawSolidCircle", "DrawHollowCircle", "DrawMidBresenhamEllipse", "DrawSolidEllipse", "DrawString",
+                           "DrawSolidPolygon", "DrawThickPolyline", "DrawTrustRegionOfGaussian", "DrawSolidTrustRegionOfGaussian"};
+    return names[static_cast<int32_t>(type)];
+}
+
+template <typename PixelType>
+struct Primitive {
+    PrimitiveType type = PrimitiveType::kSolidRectangle;
+    std::vector<int32_t> args;
+    // Points of polygon and polyline.
+    std::vector<int32_t> points;
+    // Center and covariance of gaussian.
+    Vec2 center = Vec2::Zero();
+    Mat2 covariance = Mat2::Identity();
+    std::string text;
+    PixelType color = PixelType();
+    ImagePainter::Blend blend;
+};
+
+/* Generator of random shapes. Most shapes are near the image, and the others are off-screen, degenerate or very large. */
+class ShapeGenerator {
+
+public:
+    ShapeGenerator(int32_t rows, int32_t cols, uint32_t seed) : rows_(rows), cols_(cols), engine_(seed) {}
+
+    enum class Kind : uint8_t {
+        kNormal = 0,
+        kOffScreen = 1,
+        kDegenerate = 2,
+        kLarge = 3,
+    };
+
+    Kind GetKind() {
+        const int32_t value = Uniform(0, 99);
+        return value < 70 ? Kind::kNormal : value < 85 ? Kind::kOffScreen : value < 95 ? Kind::kDegenerate : Kind::kLarge;
+    }
+
+    int32_t GetX(Kind kind) { return GetCoordinate(kind, cols_); }
+    int32_t GetY(Kind kind) { return GetCoordinate(kind, rows_); }
+    int32_t GetSize(Kind kind) {
+        switch (kind) {
+            case Kind::kDegenerate:
+                return Uniform(-1, 1);
+            case Kind::kLarge:
+                return Uniform(std::max(rows_, cols_), kLargeCoordinate);
+            default:
+                return Uniform(0, std::max(rows_, cols_) / 2);
+        }
+    }
+
+    int32_t Uniform(int32_t min_value, int32_t max_value) { return std::uniform_int_distribution<int32_t>(min_value, max_value)(engine_); }
+    float UniformFloat(float min_value, float max_value) { return std::uniform_real_distribution<float>(min_value, max_value)(engine_); }
+    std::mt19937 &engine() { return engine_; }
+
+private:
+    int32_t GetCoordinate(Kind kind, int32_t size) {
+        switch (kind) {
+            case Kind::kOffScreen:
+                return Uniform(0, 1) ? Uniform(-3 * size, -1) : Uniform(size, 4 * size);
+            case Kind::kLarge:
+                return Uniform(-kLargeCoordinate, kLargeCoordinate);
+            default:
+                return Uniform(-size / 4, size + size / 4);
+        }
+    }
+
+    int32_t rows_ = 0;
+    int32_t cols_ = 0;
+    std::mt19937 engine_;
+};
+
+template <typename PixelType>
+Primitive<PixelType> GeneratePrimitive(PrimitiveType type, ShapeGenerator &generator) {
+    using Kind = ShapeGenerator::Kind;
+    Primitive<PixelType> primitive;
+    primitive.type = type;
+    primitive.color = GetRandomColor<PixelType>(generator.engine());
+    const int32_t mode = generator.Uniform(0, 5);
+    primitive.blend = mode < 2 ? ImagePainter::Blend() : ImagePainter::Blend(static_cast<ImagePainter::BlendMode>(mode - 2), static_cast<uint8_t>(generator.Uniform(0, 255)));
+    if (mode == 5) {
+        primitive.blend.mode = ImagePainter::BlendMode::kMax;
+    }
+
+    const Kind kind = generator.GetKind();
+    const int32_t x = generator.GetX(kind);
+    const int32_t y = generator.GetY(kind);
+    switch (type) {
+        case PrimitiveType::kSolidRectangle:
+            primitive.args = {x, y, generator.GetSize(kind), generator.GetSize(kind)};
+            break;
+        case PrimitiveType::kHollowRectangle:
+            primitive.args = {x, y, generator.GetSize(kind), generator.GetSize(kind), generator.Uniform(0, 8)};
+            break;
+        case PrimitiveType::kBressenhanLine:
+        case PrimitiveType::kNaiveLine:
+        case PrimitiveType::kDashedLine: {
+            const bool is_point = kind == Kind::kDegenerate && generator.Uniform(0, 1);
+            const int32_t x2 = is_point ? x : generator.GetX(kind);
+            const int32_t y2 = is_point ? y : generator.GetY(kind);
+            primitive.args = {x, y, x2, y2, generator.Uniform(1, 9)};
+            break;
+        }
+        case PrimitiveType::kSolidCircle:
+        case PrimitiveType::kHollowCircle:
+            primitive.args = {x, y, generator.GetSize(kind) / 2, generator.Uniform(0, 6)};
+            break;
+        case PrimitiveType::kMidBresenhamEllipse:
+        case PrimitiveType::kSolidEllipse:
+            primitive.args = {x, y, std::min(generator.GetSize(kind) / 2, kLargeRadiusOfEllipse), std::min(generator.GetSize(kind) / 2, kLargeRadiusOfEllipse)};
+            break;
+        case PrimitiveType::kString: {
+            const int32_t length = kind == Kind::kDegenerate ? 0 : generator.Uniform(1, 12);
+            for (int32_t i = 0; i < length; ++i) {
+                primitive.text.push_back(static_cast<char>(generator.Uniform(' ', '~')));
+            }
+            // Fonts of 12, 16 and 24 have reference glyphs, while the others are scaled or smoothed.
+            const int32_t sizes[] = {12, 16, 24};
+            const bool is_scaled = generator.Uniform(0, 3) == 0;
+            const int32_t font_size = is_scaled ? generator.Uniform(4, 40) : sizes[generator.Uniform(0, 2)];
+            primitive.args = {x, y, font_size, is_scaled ? generator.Uniform(0, 1) : 0};
+            break;
+        }
+        case PrimitiveType::kSolidPolygon:
+        case PrimitiveType::kThickPolyline: {
+            const int32_t size = kind == Kind::kDegenerate ? generator.Uniform(0, 3) : generator.Uniform(3, 10);
+            const int32_t radius = std::max(generator.GetSize(kind), 1);
+            for (int32_t i = 0; i < size; ++i) {
+                const bool is_repeated = i > 0 && generator.Uniform(0, 9) == 0;
+                primitive.points.emplace_back(is_repeated ? primitive.points[2 * i - 2] : x + generator.Uniform(-radius, radius));
+                primitive.points.emplace_back(is_repeated ? primitive.points[2 * i - 1] : y + generator.Uniform(-radius, radius));
+            }
+            // Line width, is closed, join and cap of polyline.
+            primitive.args = {generator.Uniform(0, 12), generator.Uniform(0, 1), generator.Uniform(0, 2), generator.Uniform(0, 2)};
+            break;
+        }
+        case PrimitiveType::kTrustRegionOfGaussian:
+        case PrimitiveType::kSolidTrustRegionOfGaussian: {
+            // Degenerate covariance is singular, and large one covers the whole image.
+            const float scale = kind == Kind::kLarge ? 1000.0f : static_cast<float>(std::max(generator.GetSize(Kind::kNormal), 1));
+            const float sigma_a = generator.UniformFloat(0.0f, scale);
+            const float sigma_b = kind == Kind::kDegenerate ? 0.0f : generator.UniformFloat(0.0f, scale);
+            const float angle = generator.UniformFloat(0.0f, 3.1416f);
+            Mat2 rotation;
+            rotation << std::cos(angle), -std::sin(angle), std::sin(angle), std::cos(angle);
+            primitive.center = Vec2(static_cast<float>(x) + generator.UniformFloat(-0.5f, 0.5f), static_cast<float>(y) + generator.UniformFloat(-0.5f, 0.5f));
+            primitive.covariance = rotation * Vec2(sigma_a * sigma_a, sigma_b * sigma_b).asDiagonal() * rotation.transpose();
+            primitive.args = {generator.Uniform(1, 4)};
+            break;
+        }
+        default:
+            break;
+    }
+    return primitive;
+}
+
+// Primitives whose reference is only known up to a tolerance band, which are drawn by DrawByToleranceReference.
+template <typename PixelType>
+bool HasToleranceBand(const Primitive<PixelType> &primitive) {
+    switch (primitive.type) {
+        case PrimitiveType::kThickPolyline:
+        case PrimitiveType::kTrustRegionOfGaussian:
+        case PrimitiveType::kSolidTrustRegionOfGaussian:
+            return true;
+        case PrimitiveType::kString:
+            return primitive.args[2] != 12 && primitive.args[2] != 16 && primitive.args[2] != 24;
+        default:
+            return false;
+    }
+}
+
+Eigen::Matrix<int32_t, Eigen::Dynamic, 2> GetPointsBatch(const std::vector<int32_t> &points) {
+    Eigen::Matrix<int32_t, Eigen::Dynamic, 2> batch(points.size() / 2, 2);
+    for (int32_t i = 0; i < batch.rows(); ++i) {
+        batch.row(i) << points[2 * i], points[2 * i + 1];
+    }
+    return batch;
+}
+
+template <typename ImageType, typename PixelType>
+void DrawByImagePainter(ImageType &image, const Primitive<PixelType> &p) {
+    const std::vector<int32_t> &a = p.args;
+    switch (p.type) {
+        case PrimitiveType::kSolidRectangle:
+            ImagePainter::DrawSolidRectangle(image, a[0], a[1], a[2], a[3], p.color, p.blend);
+            break;
+        case PrimitiveType::kHollowRectangle:
+            ImagePainter::DrawHollowRectangle(image, a[0], a[1], a[2], a[3], p.color, a[4], p.blend);
+            break;
+        case PrimitiveType::kBressenhanLine:
+            ImagePainter::DrawBressenhanLine(image, a[0], a[1], a[2], a[3], p.color, p.blend);
+            break;
+        case PrimitiveType::kNaiveLine:
+            ImagePainter::DrawNaiveLine(image, a[0], a[1], a[2], a[3], p.color, p.blend);
+            break;
+        case PrimitiveType::kDashedLine:
+            ImagePainter::DrawDashedLine(image, a[0], a[1], a[2], a[3], a[4], p.color, p.blend);
+            break;
+        case PrimitiveType::kSolidCircle:
+            ImagePainter::DrawSolidCircle(image, a[0], a[1], a[2], p.color, p.blend);
+            break;
+        case PrimitiveType::kHollowCircle:
+            ImagePainter::DrawHollowCircle(image, a[0], a[1], a[2], p.color, a[3], p.blend);
+            break;
+        case PrimitiveType::kMidBresenhamEllipse:
+            ImagePainter::DrawMidBresenhamEllipse(image, a[0], a[1], a[2], a[3], p.color, p.blend);
+            break;
+        case PrimitiveType::kSolidEllipse:
+            ImagePainter::DrawSolidEllipse(image, a[0], a[1], a[2], a[3], p.color, p.blend);
+            break;
+        case PrimitiveType::kString:
+            ImagePainter::DrawString(image, p.text, a[0], a[1], p.color, a[2], a[3] != 0, p.blend);
+            break;
+        case PrimitiveType::kSolidPolygon:
+            ImagePainter::DrawSolidPolygon(image, GetPointsBatch(p.points), p.color, p.blend);
+            break;
+        case PrimitiveType::kThickPolyline:
+            ImagePainter::DrawThickPolyline(image, GetPointsBatch(p.points), a[0], p.color, a[1] != 0, static_cast<ImagePainter::LineJoin>(a[2]),
+                                            static_cast<ImagePainter::LineCap>(a[3]), p.blend);
+            break;
+        case PrimitiveType::kTrustRegionOfGaussian:
+            ImagePainter::DrawTrustRegionOfGaussian(image, p.center, p.covariance, p.color, static_cast<float>(a[0]), p.blend);
+            break;
+        case PrimitiveType::kSolidTrustRegionOfGaussian:
+            ImagePainter::DrawSolidTrustRegionOfGaussian(image, p.center, p.covariance, p.color, static_cast<float>(a[0]), p.blend);
+            break;
+        default:
+            break;
+    }
+}
+
+template <typename ImageType, typename PixelType>
+void DrawByReference(ImageType &image, const Primitive<PixelType> &p) {
+    const std::vector<int32_t> &a = p.args;
+    reference::Mask mask(image.rows(), image.cols());
+    switch (p.type) {
+        case PrimitiveType::kSolidRectangle:
+            reference::SolidRectangle(mask, a[0], a[1], a[2], a[3]);
+            break;
+        case PrimitiveType::kHollowRectangle:
+            reference::HollowRectangle(mask, a[0], a[1], a[2], a[3], a[4]);
+            break;
+        case PrimitiveType::kBressenhanLine:
+            reference::BressenhanLine(mask, a[0], a[1], a[2], a[3]);
+            break;
+        case PrimitiveType::kNaiveLine:
+            reference::DashedLine(mask, a[0], a[1], a[2], a[3], 1, false);
+            break;
+        case PrimitiveType::kDashedLine:
+            reference::DashedLine(mask, a[0], a[1], a[2], a[3], a[4], true);
+            break;
+        case PrimitiveType::kSolidCircle:
+            reference::SolidCircle(mask, a[0], a[1], a[2]);
+            break;
+        case PrimitiveType::kHollowCircle:
+            reference::HollowCircle(mask, a[0], a[1], a[2], a[3]);
+            break;
+        case PrimitiveType::kMidBresenhamEllipse:
+            reference::MidBresenhamEllipse(mask, a[0], a[1], a[2], a[3]);
+            break;
+        case PrimitiveType::kSolidEllipse:
+            reference::SolidEllipse(mask, a[0], a[1], a[2], a[3]);
+            break;
+        case PrimitiveType::kString:
+            reference::String(mask, p.text, a[0], a[1], a[2]);
+            break;
+        case PrimitiveType::kSolidPolygon:
+            reference::SolidPolygon(mask, p.points);
+            break;
+        default:
+            break;
+    }
+    reference::ApplyMask(image, mask, p.color, p.blend);
+}
+
+// Pixels in tolerance band take the values of actual image if they are accepted, so actual image should be drawn first.
+template <typename ImageType, typename PixelType>
+void DrawByToleranceReference(ImageType &image, const std::vector<uint8_t> &actual, const Primitive<PixelType> &p) {
+    const std::vector<int32_t> &a = p.args;
+    const bool is_smooth_string = p.type == PrimitiveType::kString && a[3] != 0;
+    reference::ToleranceMask mask(image.rows(), image.cols(), !is_smooth_string);
+    switch (p.type) {
+        case PrimitiveType::kString:
+            reference::ScaledString(mask, p.text, a[0], a[1], a[2], is_smooth_string);
+            break;
+        case PrimitiveType::kThickPolyline:
+            reference::ThickPolyline(mask, p.points, a[0], a[1] != 0, static_cast<ImagePainter::LineJoin>(a[2]), static_cast<ImagePainter::LineCap>(a[3]));
+            break;
+        case PrimitiveType::kTrustRegionOfGaussian: {
+            // Raster of solid region only resolves pixels in tolerance band, and it is checked by DrawSolidTrustRegionOfGaussian.
+            std::vector<uint8_t> buffer(static_cast<size_t>(image.rows()) * image.cols(), 0);
+            GrayImage solid(buffer.data(), image.rows(), image.cols());
+            ImagePainter::DrawSolidTrustRegionOfGaussian(solid, p.center, p.covariance, static_cast<uint8_t>(1), static_cast<float>(a[0]));
+            reference::Mask raster(image.rows(), image.cols());
+            raster.covered = buffer;
+            reference::TrustRegionOfGaussian(mask, reference::GaussianRegion(p.center, p.covariance, static_cast<float>(a[0])), raster);
+            break;
+        }
+        case PrimitiveType::kSolidTrustRegionOfGaussian:
+            reference::SolidTrustRegionOfGaussian(mask, reference::GaussianRegion(p.center, p.covariance, static_cast<float>(a[0])));
+            break;
+        default:
+            break;
+    }
+    reference::ApplyToleranceMask(image, actual, mask, p.color, p.blend);
+}
+
+template <typename PixelType>
+std::string DescribePrimitive(const Primitive<PixelType> &p) {
+    std::ostringstream stream;
+    const std::vector<int32_t> &a = p.args;
+    if (!p.points.empty() || p.type == PrimitiveType::kSolidPolygon || p.type == PrimitiveType::kThickPolyline) {
+        stream << "Eigen::Matrix<int32_t, Eigen::Dynamic, 2> points(" << p.points.size() / 2 << ", 2); points << ";
+        for (size_t i = 0; i < p.points.size(); ++i) {
+            stream << (i == 0 ? "" : ", ") << p.points[i];
+        }
+        stream << ";\n    ";
+    }
+    stream << "ImagePainter::" << GetNameOfPrimitive(p.type) << "(image, ";
+    switch (p.type) {
+        case PrimitiveType::kString:
+            stream << "\"" << p.text << "\", " << a[0] << ", " << a[1] << ", " << GetStringOfColor(p.color) << ", " << a[2] << ", " << (a[3] ? "true" : "false");
+            break;
+        case PrimitiveType::kSolidPolygon:
+            stream << "points, " << GetStringOfColor(p.color);
+            break;
+        case PrimitiveType::kThickPolyline:
+            stream << "points, " << a[0] << ", " << GetStringOfColor(p.color) << ", " << (a[1] ? "true" : "false") << ", static_cast<ImagePainter::LineJoin>("
+                   << a[2] << "), static_cast<ImagePainter::LineCap>(" << a[3] << ")";
+            break;
+        case PrimitiveType::kTrustRegionOfGaussian:
+        case PrimitiveType::kSolidTrustRegionOfGaussian: {
+            char buffer[256];
+            std::snprintf(buffer, sizeof(buffer), "Vec2(%.9gf, %.9gf), (Mat2() << %.9gf, %.9gf, %.9gf, %.9gf).finished(), %s, %d.0f", p.center.x(),
+                          p.center.y(), p.covariance(0, 0), p.covariance(0, 1), p.covariance(1, 0), p.covariance(1, 1), GetStringOfColor(p.color).c_str(),
+                          a[0]);
+            stream << buffer;
+            break;
+        }
+        case PrimitiveType::kSolidRectangle:
+        case PrimitiveType::kBressenhanLine:
+        case PrimitiveType::kNaiveLine:
+        case PrimitiveType::kSolidCircle:
+        case PrimitiveType::kMidBresenhamEllipse:
+        case PrimitiveType::kSolidEllipse: {
+            const int32_t num_of_args = p.type == PrimitiveType::kSolidCircle ? 3 : 4;
+            for (int32_t i = 0; i < num_of_args; ++i) {
+                stream << a[i] << ", ";
+            }
+            stream << GetStringOfColor(p.color);
+            break;
+        }
+        case PrimitiveType::kHollowRectangle:
+            stream << a[0] << ", " << a[1] << ", " << a[2] << ", " << a[3] << ", " << GetStringOfColor(p.color) << ", " << a[4];
+            break;
+        case PrimitiveType::kDashedLine:
+            stream << a[0] << ", " << a[1] << ", " << a[2] << ", " << a[3] << ", " << a[4] << ", " << GetStringOfColor(p.color);
+            break;
+        case PrimitiveType::kHollowCircle:
+            stream << a[0] << ", " << a[1] << ", " << a[2] << ", " << GetStringOfColor(p.color) << ", " << a[3];
+            break;
+        default:
+            break;
+    }
+    stream << ", " << GetStringOfBlend(p.blend) << ");";
+    return stream.str();
+}
+
+/* Class DiffHarness Declaration. Each check compares expected image with actual one on a subset of its items. On mismatch, items are
+   reduced to a minimal subset which still mismatches, and it is printed as reproducer. */
+class DiffHarness {
+
+public:
+    using CompareFunction = std::function<Mismatch(const std::vector<int32_t> &items)>;
+    using DescribeFunction = std::function<std::string(int32_t item)>;
+
+    explicit DiffHarness(const Options &options) : options_(options) {}
+    virtual ~DiffHarness() = default;
+
+    // Return false if check mismatches.
+    bool Check(const std::string &name, const std::string &setup, int32_t num_of_items, const CompareFunction &compare, const DescribeFunction &describe);
+    bool IsSelected(const std::string &name) const { return options_.filter.empty() || name.find(options_.filter) != std::string::npos; }
+
+    int64_t num_of_checks() const { return num_of_checks_; }
+    int64_t num_of_failures() const { return num_of_failures_; }
+
+private:
+    std::vector<int32_t> Minimize(const std::vector<int32_t> &items, const CompareFunction &compare) const;
+
+    Options options_;
+    int64_t num_of_checks_ = 0;
+    int64_t num_of_failures_ = 0;
+};
+
+/* Class DiffHarness Definition. */
+bool DiffHarness::Check(const std::string &name, const std::string &setup, int32_t num_of_items, const CompareFunction &compare,
+                        const DescribeFunction &describe) {
+    ++num_of_checks_;
+    std::vector<int32_t> items(num_of_items);
+    for (int32_t i = 0; i < num_of_items; ++i) {
+        items[i] = i;
+    }
+    const Mismatch mismatch = compare(items);
+    if (mismatch.num_of_diff_pixels == 0) {
+        return true;
+    }
+
+    ++num_of_failures_;
+    std::fprintf(stderr, "[FAILED] %s: %lld pixels differ, first at (row %d, col %d), expected %s, actual %s.\n", name.c_str(),
+                 static_cast<long long>(mismatch.num_of_diff_pixels), mismatch.row, mismatch.col, mismatch.expected.c_str(), mismatch.actual.c_str());
+    const std::vector<int32_t> minimal_items = Minimize(items, compare);
+    const Mismatch minimal_mismatch = compare(minimal_items);
+    std::fprintf(stderr, "  Minimal reproducer with %zu of %d items, %lld pixels differ, first at (row %d, col %d), expected %s, actual %s:\n",
+                 minimal_items.size(), num_of_items, static_cast<long long>(minimal_mismatch.num_of_diff_pixels), minimal_mismatch.row, minimal_mismatch.col,
+                 minimal_mismatch.expected.c_str(), minimal_mismatch.actual.c_str());
+    std::fprintf(stderr, "    %s\n", setup.c_str());
+    for (const int32_t item: minimal_items) {
+        std::fprintf(stderr, "    %s\n", describe(item).c_str());
+    }
+    return false;
+}
+
+std::vector<int32_t> DiffHarness::Minimize(const std::vector<int32_t> &items, const CompareFunction &compare) const {
+    // Single item is the best reproducer.
+    for (const int32_t item: items) {
+        if (compare({item}).num_of_diff_pixels != 0) {
+            return {item};
+        }
+    }
+    // Otherwise mismatch comes from interaction of items, so remove the items which are not needed one by one.
+    std::vector<int32_t> minimal_items = items;
+    for (int32_t i = static_cast<int32_t>(minimal_items.size()) - 1; i >= 0; --i) {
+        std::vector<int32_t> reduced_items = minimal_items;
+        reduced_items.erase(reduced_items.begin() + i);
+        if (compare(reduced_items).num_of_diff_pixels != 0) {
+            minimal_items = reduced_items;
+        }
+    }
+    return minimal_items;
+}
+
+std::string GetSetupOfImage(const std::string &image, int32_t rows, int32_t cols, uint32_t seed) {
+    return "// " + image + " image of " + std::to_string(rows) + " x " + std::to_string(cols) + ", background filled by std::mt19937(" + std::to_string(seed) +
+           ").";
+}
+
+// Each primitive is drawn by every simd level, and compared with reference oracle. Pixels in tolerance band of oracle may take any accepted
+// value, but the other pixels are compared exactly.
+template <typename ImageType, typename PixelType>
+void CheckDraw(DiffHarness &harness, uint32_t seed) {
+    std::mt19937 engine(seed);
+    const int32_t rows = std::uniform_int_distribution<int32_t>(1, kMaxImageSize)(engine);
+    const int32_t cols = std::uniform_int_distribution<int32_t>(1, kMaxImageSize)(engine);
+    ShapeGenerator generator(rows, cols, seed);
+    constexpr int32_t kChannels = GetChannels<ImageType>();
+
+    for (int32_t type = 0; type < static_cast<int32_t>(PrimitiveType::kNumOfTypes); ++type) {
+        std::vector<Primitive<PixelType>> primitives;
+        for (int32_t i = 0; i < kNumOfPrimitives; ++i) {
+            primitives.emplace_back(GeneratePrimitive<PixelType>(static_cast<PrimitiveType>(type), generator));
+        }
+        for (const ImagePainter::SimdLevel level: GetSupportedSimdLevels()) {
+            const std::string name = std::string(GetNameOfPrimitive(static_cast<PrimitiveType>(type))) + "/" + GetNameOfImage<ImageType>() + "/" +
+                                     GetNameOfSimdLevel(level) + "/seed_" + std::to_string(seed);
+            CONTINUE_IF(!harness.IsSelected(name));
+            harness.Check(
+                name, GetSetupOfImage(GetNameOfImage<ImageType>(), rows, cols, seed) + " Simd level is " + GetNameOfSimdLevel(level) + ".",
+                kNumOfPrimitives,
+                [&](const std::vector<int32_t> &items) {
+                    Canvas<ImageType> expected(rows, cols, seed);
+                    Canvas<ImageType> actual(rows, cols, seed);
+                    for (const int32_t i: items) {
+                        const Primitive<PixelType> &primitive = primitives[i];
+                        {
+                            const ScopedSimdLevel simd_level(level);
+                            DrawByImagePainter(actual.image, primitive);
+                        }
+                        if (HasToleranceBand(primitive)) {
+                            DrawByToleranceReference(expected.image, actual.buffer, primitive);
+                        } else {
+                            DrawByReference(expected.image, primitive);
+                        }
+                    }
+                    return ComparePixels(expected.buffer, actual.buffer, cols, kChannels);
+                },
+                [&](int32_t i) { return DescribePrimitive(primitives[i]); });
+        }
+    }
+}
+
+// Lines between endpoints near int32 limits, whose deltas overflow int32 and whose doubled products of deltas overflow int64. Major delta
+// of each line is twice of its minor one, so the reference does not traverse the whole line.
+void CheckExtremeLines(DiffHarness &harness) {
+    constexpr int32_t kRows = 64;
+    constexpr int32_t kCols = 96;
+    constexpr int32_t kMin = std::numeric_limits<int32_t>::min();
+    constexpr int32_t kMax = std::numeric_limits<int32_t>::max();
+    const std::vector<std::array<int32_t, 4>> lines = {
+        {kMin, kMin / 2, kMax - 1, kMax / 2}, {kMax - 1, kMax / 2, kMin, kMin / 2}, {kMin / 2, kMin, kMax / 2, kMax - 1},
+        {kMax / 2, kMax - 1, kMin / 2, kMin}, {kMin, kMin / 2 + 40, kMax - 1, kMax / 2 + 40},
+        {kMin / 2 - 30, kMin, kMax / 2 - 30, kMax - 1},
+    };
+    const std::string name = "DrawBressenhanLine/extreme";
+    RETURN_IF(!harness.IsSelected(name));
+    harness.Check(
+        name, GetSetupOfImage("gray", kRows, kCols, 0), static_cast<int32_t>(lines.size()),
+        [&](const std::vector<int32_t> &items) {
+            Canvas<GrayImage> expected(kRows, kCols, 0);
+            Canvas<GrayImage> actual(kRows, kCols, 0);
+            for (const int32_t i: items) {
+                const std::array<int32_t, 4> &l = lines[i];
+                reference::Mask mask(kRows, kCols);
+                reference::BressenhanLineOfHalfSlope(mask, l[0], l[1], l[2], l[3]);
+                reference::ApplyMask(expected.image, mask, static_cast<uint8_t>(255), ImagePainter::Blend());
+                ImagePainter::DrawBressenhanLine(actual.image, l[0], l[1], l[2], l[3], static_cast<uint8_t>(255));
+            }
+            return ComparePixels(expected.buffer, actual.buffer, kCols, 1);
+        },
+        [&](int32_t i) {
+            const std::array<int32_t, 4> &l = lines[i];
+            return "ImagePainter::DrawBressenhanLine(image, " + std::to_string(l[0]) + ", " + std::to_string(l[1]) + ", " + std::to_string(l[2]) + ", " +
+                   std::to_string(l[3]) + ", static_cast<uint8_t>(255));";
+        });
+}
+
+#ifdef IMAGE_PAINTER_ENABLE_PROFILE
+// Counters of profile are compared with known draws, whose time is ignored. Written pixels of draws inside image are the pixels they change
+// on a blank image, since each pixel is written once. Nested calls are recorded by the outermost one, and pixels written by worker threads
+// of batch draws are merged into the calling thread.
+void CheckProfile(DiffHarness &harness) {
+    constexpr int32_t kRows = 256;
+    constexpr int32_t kCols = 128;
+    struct ProfileCase {
+        std::string description;
+        std::function<void(GrayImage &image)> draw;
+        ImagePainter::Primitive primitive = ImagePainter::Primitive::kSolidRectangle;
+        // Rejected pixels, or -1 if written pixels are counted from changed pixels and none is rejected.
+        int64_t num_of_rejected_pixels = -1;
+        int64_t num_of_written_pixels = 0;
+        bool is_reset = false;
+        // Pixel type of drawn image. Draws of other pixel types use their own image of the same size.
+        ImagePainter::ProfileImageType image_type = ImagePainter::ProfileImageType::kGray;
+    };
+
+    Eigen::Matrix<int32_t, Eigen::Dynamic, 2> points(kRows * kCols / 3 + 2, 2);
+    for (int32_t i = 0; i < kRows * kCols / 3; ++i) {
+        points.row(i) << (3 * i) % kCols, (3 * i) / kCols;
+    }
+    points.row(kRows * kCols / 3) << -1, 0;
+    points.row(kRows * kCols / 3 + 1) << 0, kRows;
+    Eigen::Matrix<int32_t, Eigen::Dynamic, 3> circles(kRows / 16, 3);
+    for (int32_t i = 0; i < circles.rows(); ++i) {
+        circles.row(i) << (i % 2 == 0 ? 30 : 90), 16 * i + 8, 7;
+    }
+    const std::vector<ProfileCase> cases = {
+        {"ImagePainter::DrawSolidRectangle(image, -10, -10, 20, 20, static_cast<uint8_t>(255));",
+         [](GrayImage &image) { ImagePainter::DrawSolidRectangle(image, -10, -10, 20, 20, static_cast<uint8_t>(255)); },
+         ImagePainter::Primitive::kSolidRectangle, 300, 100},
+        {"ImagePainter::DrawThickLine(image, 10, 20, 90, 75, 7, static_cast<uint8_t>(255), ImagePainter::LineCap::kRound);",
+         [](GrayImage &image) { ImagePainter::DrawThickLine(image, 10, 20, 90, 75, 7, static_cast<uint8_t>(255), ImagePainter::LineCap::kRound); },
+         ImagePainter::Primitive::kThickLine},
+        {"ImagePainter::DrawPoints(image, points, {255}, true); // " + std::to_string(points.rows()) + " points of grid, two out of image.",
+         [&](GrayImage &image) { ImagePainter::DrawPoints(image, points, std::vector<uint8_t>{255}, true); }, ImagePainter::Primitive::kPoints},
+        {"ImagePainter::DrawCircles(image, circles, {255}, true, true); // " + std::to_string(circles.rows()) + " circles in column.",
+         [&](GrayImage &image) { ImagePainter::DrawCircles(image, circles, std::vector<uint8_t>{255}, true, true); }, ImagePainter::Primitive::kCircles},
+        {"ImagePainter::DrawSolidRectangle(image, 0, 0, 8, 8, static_cast<uint8_t>(255)); ImagePainter::ResetProfile();",
+         [](GrayImage &image) { ImagePainter::DrawSolidRectangle(image, 0, 0, 8, 8, static_cast<uint8_t>(255)); }, ImagePainter::Primitive::kSolidRectangle,
+         0, 0, true},
+        {"ImagePainter::DrawSolidRectangle(rgba, 0, 0, 8, 8, RgbaPixel{255, 255, 255, 255});",
+         [](GrayImage &) {
+             std::vector<uint8_t> buffer(kRows * kCols * 4, 0);
+             RgbaImage rgba(buffer.data(), kRows, kCols);
+             ImagePainter::DrawSolidRectangle(rgba, 0, 0, 8, 8, RgbaPixel{255, 255, 255, 255});
+         },
+         ImagePainter::Primitive::kSolidRectangle, 0, 64, false, ImagePainter::ProfileImageType::kOther},
+        {"ImagePainter::DrawSolidRectangle(yuv, 0, 0, 8, 8, ImagePainter::YuvPixel{255, 128, 128}); // Nv12 layout.",
+         [](GrayImage &) {
+             std::vector<uint8_t> buffer(kRows * kCols * 3 / 2, 0);
+             Yuv420Image yuv(buffer.data(), kRows, kCols, ImagePainter::YuvLayout::kNv12);
+             ImagePainter::DrawSolidRectangle(yuv, 0, 0, 8, 8, ImagePainter::YuvPixel{255, 128, 128});
+         },
+         ImagePainter::Primitive::kSolidRectangle, 0, 64, false, ImagePainter::ProfileImageType::kYuv420},
+    };
+
+    const std::string name = "Profile";
+    RETURN_IF(!harness.IsSelected(name));
+    harness.Check(
+        name, GetSetupOfImage("gray", kRows, kCols, 0) + " Profiling is enabled, and profile is reset before each draw.", static_cast<int32_t>(cases.size()),
+        [&](const std::vector<int32_t> &items) {
+            Mismatch mismatch;
+            ImagePainter::SetProfilingEnabled(true);
+            for (const int32_t i: items) {
+                const ProfileCase &profile_case = cases[i];
+                std::vector<uint8_t> buffer(kRows * kCols, 0);
+                GrayImage image(buffer.data(), kRows, kCols);
+                ImagePainter::ResetProfile();
+                profile_case.draw(image);
+                if (profile_case.is_reset) {
+                    ImagePainter::ResetProfile();
+                }
+                const ImagePainter::ProfileSnapshot snapshot = ImagePainter::GetProfileSnapshot();
+
+                ImagePainter::ProfileSnapshot expected = {};
+                if (!profile_case.is_reset) {
+                    ImagePainter::ProfileCounter &counter = expected[static_cast<int32_t>(profile_case.primitive)][static_cast<int32_t>(profile_case.image_type)];
+                    counter.num_of_calls = 1;
+                    counter.num_of_written_pixels = profile_case.num_of_rejected_pixels < 0 ? std::count(buffer.begin(), buffer.end(), 255)
+                                                                                            : profile_case.num_of_written_pixels;
+                    counter.num_of_rejected_pixels = std::max<int64_t>(profile_case.num_of_rejected_pixels, 0);
+                }
+                auto get_string_of_counter = [](const ImagePainter::ProfileCounter &counter) {
+                    return "calls " + std::to_string(counter.num_of_calls) + ", written " + std::to_string(counter.num_of_written_pixels) + ", rejected " +
+                           std::to_string(counter.num_of_rejected_pixels);
+                };
+                for (int32_t primitive = 0; primitive < static_cast<int32_t>(expected.size()); ++primitive) {
+                    for (int32_t index = 0; index < static_cast<int32_t>(expected[primitive].size()); ++index) {
+                        const std::string expected_counter = get_string_of_counter(expected[primitive][index]);
+                        const std::string actual_counter = get_string_of_counter(snapshot[primitive][index]);
+                        CONTINUE_IF(expected_counter == actual_counter);
+                        if (mismatch.num_of_diff_pixels == 0) {
+                            mismatch.row = primitive;
+                            mismatch.col = index;
+                            const std::string name_of_primitive = ImagePainter::GetNameOfPrimitive(static_cast<ImagePainter::Primitive>(primitive));
+                            mismatch.expected = name_of_primitive + " " + expected_counter;
+                            mismatch.actual = actual_counter;
+                        }
+                        ++mismatch.num_of_diff_pixels;
+                    }
+                }
+            }
+            ImagePainter::SetProfilingEnabled(false);
+            ImagePainter::ResetProfile();
+            return mismatch;
+        },
+        [&](int32_t i) { return cases[i].description; });
+}
+#endif
+
+// Images of other pixel traits are compared with gray and rgb images. Rgba image should be the same as rgb image of its color channels
+// and gray image of its alpha channel. Uint16 image is gray image scaled by 257, except rounding of blend.
+template <typename PixelType>
+Primitive<PixelType> ConvertColorOfPrimitive(const Primitive<uint8_t> &primitive, const PixelType &color) {
+    Primitive<PixelType> converted;
+    converted.type = primitive.type;
+    converted.args = primitive.args;
+    converted.points = primitive.points;
+    converted.center = primitive.center;
+    converted.covariance = primitive.covariance;
+    converted.text = primitive.text;
+    converted.color = color;
+    converted.blend = primitive.blend;
+    return converted;
+}
+
+void CheckPixelTraits(DiffHarness &harness, uint32_t seed) {
+    std::mt19937 engine(seed);
+    const int32_t rows = std::uniform_int_distribution<int32_t>(1, kMaxImageSize)(engine);
+    const int32_t cols = std::uniform_int_distribution<int32_t>(1, kMaxImageSize)(engine);
+    ShapeGenerator generator(rows, cols, seed);
+
+    for (int32_t type = 0; type < static_cast<int32_t>(PrimitiveType::kNumOfTypes); ++type) {
+        std::vector<Primitive<uint8_t>> primitives;
+        std::vector<RgbPixel> colors;
+        for (int32_t i = 0; i < kNumOfPrimitives; ++i) {
+            primitives.emplace_back(GeneratePrimitive<uint8_t>(static_cast<PrimitiveType>(type), generator));
+            colors.emplace_back(GetRandomColor<RgbPixel>(engine));
+        }
+        const std::string name = std::string(GetNameOfPrimitive(static_cast<PrimitiveType>(type))) + "/rgba/seed_" + std::to_string(seed);
+        if (harness.IsSelected(name)) {
+            harness.Check(
+                name, GetSetupOfImage("rgba", rows, cols, seed) + " Alpha channel is color of gray primitive.", kNumOfPrimitives,
+                [&](const std::vector<int32_t> &items) {
+                    Canvas<RgbImage> rgb(rows, cols, seed);
+                    Canvas<GrayImage> alpha(rows, cols, seed + 1);
+                    std::vector<uint8_t> buffer(static_cast<size_t>(rows) * cols * 4);
+                    std::vector<uint8_t> expected(buffer.size());
+                    for (int64_t i = 0; i < static_cast<int64_t>(rows) * cols; ++i) {
+                        std::copy_n(rgb.buffer.data() + i * 3, 3, buffer.data() + i * 4);
+                        buffer[i * 4 + 3] = alpha.buffer[i];
+                    }
+                    RgbaImage actual(buffer.data(), rows, cols);
+                    for (const int32_t i: items) {
+                        const RgbPixel &color = colors[i];
+                        DrawByImagePainter(rgb.image, ConvertColorOfPrimitive(primitives[i], color));
+                        DrawByImagePainter(alpha.image, primitives[i]);
+                        DrawByImagePainter(actual, ConvertColorOfPrimitive(primitives[i], RgbaPixel{color.r, color.g, color.b, primitives[i].color}));
+                    }
+                    for (int64_t i = 0; i < static_cast<int64_t>(rows) * cols; ++i) {
+                        std::copy_n(rgb.buffer.data() + i * 3, 3, expected.data() + i * 4);
+                        expected[i * 4 + 3] = alpha.buffer[i];
+                    }
+                    return ComparePixels(expected, buffer, cols, 4);
+                },
+                [&](int32_t i) { return DescribePrimitive(ConvertColorOfPrimitive(primitives[i], colors[i])); });
+        }
+
+        const std::string name_16 = std::string(GetNameOfPrimitive(static_cast<PrimitiveType>(type))) + "/gray16/seed_" + std::to_string(seed);
+        CONTINUE_IF(!harness.IsSelected(name_16));
+        harness.Check(
+            name_16, GetSetupOfImage("uint16", rows, cols, seed) + " Values are gray image scaled by 257.", kNumOfPrimitives,
+            [&](const std::vector<int32_t> &items) {
+                Canvas<GrayImage> expected(rows, cols, seed);
+                std::vector<uint16_t> buffer(expected.buffer.size());
+                for (size_t i = 0; i < buffer.size(); ++i) {
+                    buffer[i] = static_cast<uint16_t>(expected.buffer[i] * 257);
+                }
+                Gray16Image actual(buffer.data(), rows, cols);
+                for (const int32_t i: items) {
+                    DrawByImagePainter(expected.image, primitives[i]);
+                    DrawByImagePainter(actual, ConvertColorOfPrimitive(primitives[i], static_cast<uint16_t>(primitives[i].color * 257)));
+                }
+                std::vector<uint8_t> scaled(buffer.size());
+                for (size_t i = 0; i < buffer.size(); ++i) {
+                    scaled[i] = static_cast<uint8_t>((buffer[i] + 128) / 257);
+                }
+                // Blend of byte channels rounds each term, while blend of other channels rounds once.
+                return ComparePixels(expected.buffer, scaled, cols, 1, 1);
+            },
+            [&](int32_t i) { return DescribePrimitive(primitives[i]); });
+    }
+}
+
+// Batch draws are compared with single draws of their items, in both single and multiple threads.
+template <typename ImageType, typename PixelType>
+void CheckBatchDraw(DiffHarness &harness, uint32_t seed) {
+    using Kind = ShapeGenerator::Kind;
+    std::mt19937 engine(seed);
+    const int32_t rows = std::uniform_int_distribution<int32_t>(1, kMaxImageSize)(engine);
+    const int32_t cols = std::uniform_int_distribution<int32_t>(1, kMaxImageSize)(engine);
+    ShapeGenerator generator(rows, cols, seed);
+    constexpr int32_t kChannels = GetChannels<ImageType>();
+    const int32_t size = kNumOfPrimitives;
+
+    Eigen::Matrix<int32_t, Eigen::Dynamic, 2> points(size, 2);
+    Eigen::Matrix<int32_t, Eigen::Dynamic, 4> lines(size, 4);
+    Eigen::Matrix<int32_t, Eigen::Dynamic, 3> circles(size, 3);
+    Eigen::Matrix<float, Eigen::Dynamic, 5> gaussians(size, 5);
+    std::vector<ImagePainter::Label> labels(size);
+    std::vector<PixelType> colors(size);
+    for (int32_t i = 0; i < size; ++i) {
+        const Kind kind = generator.GetKind();
+        points.row(i) << generator.GetX(kind), generator.GetY(kind);
+        lines.row(i) << generator.GetX(kind), generator.GetY(kind), generator.GetX(kind), generator.GetY(kind);
+        circles.row(i) << generator.GetX(kind), generator.GetY(kind), generator.GetSize(kind) / 2;
+        const Primitive<PixelType> gaussian = GeneratePrimitive<PixelType>(PrimitiveType::kTrustRegionOfGaussian, generator);
+        gaussians.row(i) << gaussian.center.x(), gaussian.center.y(), gaussian.covariance(0, 0), gaussian.covariance(0, 1), gaussian.covariance(1, 1);
+        labels[i] = ImagePainter::Label{"label " + std::to_string(i), generator.GetX(kind), generator.GetY(kind)};
+        colors[i] = GetRandomColor<PixelType>(generator.engine());
+    }
+    const int32_t font_size = generator.Uniform(6, 30);
+    const bool is_smooth = generator.Uniform(0, 1) != 0;
+    const bool is_solid = generator.Uniform(0, 1) != 0;
+    const bool is_closed = generator.Uniform(0, 1) != 0;
+    // Blend of batch is shared by all of its items, and the same blend is given to each item drawn one by one.
+    const uint8_t alpha_of_batch = static_cast<uint8_t>(generator.Uniform(0, 255));
+    const ImagePainter::Blend blend_of_batch =
+        alpha_of_batch % 2 ? ImagePainter::Blend(ImagePainter::BlendMode::kAlpha, alpha_of_batch) : ImagePainter::Blend();
+    const std::string string_of_blend = GetStringOfBlend(blend_of_batch);
+
+    // Select rows of batch.
+    auto select = [](const auto &batch, const std::vector<int32_t> &items) {
+        std::remove_const_t<std::remove_reference_t<decltype(batch)>> selected(items.size(), batch.cols());
+        for (size_t i = 0; i < items.size(); ++i) {
+            selected.row(i) = batch.row(items[i]);
+        }
+        return selected;
+    };
+    auto select_colors = [&](const std::vector<int32_t> &items) {
+        std::vector<PixelType> selected;
+        for (const int32_t i: items) {
+            selected.emplace_back(colors[i]);
+        }
+        return selected;
+    };
+
+    for (const bool use_multi_thread: {false, true}) {
+        const std::string suffix = "/" + GetNameOfImage<ImageType>() + (use_multi_thread ? "/multi_thread" : "/single_thread") + "/seed_" + std::to_string(seed);
+        const std::string setup = GetSetupOfImage(GetNameOfImage<ImageType>(), rows, cols, seed);
+        auto check = [&](const std::string &name, const std::function<void(ImageType &, const std::vector<int32_t> &)> &draw_batch,
+                         const std::function<void(ImageType &, int32_t)> &draw_item, const std::function<std::string(int32_t)> &describe) {
+            RETURN_IF(!harness.IsSelected(name + suffix));
+            harness.Check(
+                name + suffix, setup, size,
+                [&](const std::vector<int32_t> &items) {
+                    Canvas<ImageType> expected(rows, cols, seed);
+                    Canvas<ImageType> actual(rows, cols, seed);
+                    for (const int32_t i: items) {
+                        draw_item(expected.image, i);
+                    }
+                    draw_batch(actual.image, items);
+                    return ComparePixels(expected.buffer, actual.buffer, cols, kChannels);
+                },
+                describe);
+        };
+
+        check(
+            "DrawPoints",
+            [&](ImageType &image, const std::vector<int32_t> &items) {
+                ImagePainter::DrawPoints(image, select(points, items), select_colors(items), use_multi_thread, blend_of_batch);
+            },
+            [&](ImageType &image, int32_t i) { ImagePainter::DrawSolidRectangle(image, points(i, 0), points(i, 1), 1, 1, colors[i], blend_of_batch); },
+            [&](int32_t i) { return "point (" + std::to_string(points(i, 0)) + ", " + std::to_string(points(i, 1)) + "), " + string_of_blend; });
+        check(
+            "DrawLines",
+            [&](ImageType &image, const std::vector<int32_t> &items) {
+                ImagePainter::DrawLines(image, select(lines, items), select_colors(items), use_multi_thread, blend_of_batch);
+            },
+            [&](ImageType &image, int32_t i) {
+                ImagePainter::DrawBressenhanLine(image, lines(i, 0), lines(i, 1), lines(i, 2), lines(i, 3), colors[i], blend_of_batch);
+            },
+            [&](int32_t i) {
+                return "ImagePainter::DrawBressenhanLine(image, " + std::to_string(lines(i, 0)) + ", " + std::to_string(lines(i, 1)) + ", " +
+                       std::to_string(lines(i, 2)) + ", " + std::to_string(lines(i, 3)) + ", " + GetStringOfColor(colors[i]) + ", " + string_of_blend + ");";
+            });
+        check(
+            "DrawCircles",
+            [&](ImageType &image, const std::vector<int32_t> &items) {
+                ImagePainter::DrawCircles(image, select(circles, items), select_colors(items), is_solid, use_multi_thread, blend_of_batch);
+            },
+            [&](ImageType &image, int32_t i) {
+                if (is_solid) {
+                    ImagePainter::DrawSolidCircle(image, circles(i, 0), circles(i, 1), circles(i, 2), colors[i], blend_of_batch);
+                } else {
+                    ImagePainter::DrawHollowCircle(image, circles(i, 0), circles(i, 1), circles(i, 2), colors[i], 1, blend_of_batch);
+                }
+            },
+            [&](int32_t i) {
+                return std::string("ImagePainter::Draw") + (is_solid ? "Solid" : "Hollow") + "Circle(image, " + std::to_string(circles(i, 0)) + ", " +
+                       std::to_string(circles(i, 1)) + ", " + std::to_string(circles(i, 2)) + ", " + GetStringOfColor(colors[i]) + (is_solid ? ", " : ", 1, ") +
+                       string_of_blend + ");";
+            });
+        check(
+            "DrawTrustRegionsOfGaussian",
+            [&](ImageType &image, const std::vector<int32_t> &items) {
+                ImagePainter::DrawTrustRegionsOfGaussian(image, select(gaussians, items), select_colors(items), is_solid, 3.0f, use_multi_thread,
+                                                         blend_of_batch);
+            },
+            [&](ImageType &image, int32_t i) {
+                Mat2 covariance;
+                covariance << gaussians(i, 2), gaussians(i, 3), gaussians(i, 3), gaussians(i, 4);
+                if (is_solid) {
+                    ImagePainter::DrawSolidTrustRegionOfGaussian(image, Vec2(gaussians(i, 0), gaussians(i, 1)), covariance, colors[i], 3.0f,
+                                                                 blend_of_batch);
+                } else {
+                    ImagePainter::DrawTrustRegionOfGaussian(image, Vec2(gaussians(i, 0), gaussians(i, 1)), covariance, colors[i], 3.0f, blend_of_batch);
+                }
+            },
+            [&](int32_t i) {
+                char buffer[256];
+                std::snprintf(buffer, sizeof(buffer), "gaussian (%.9g, %.9g, %.9g, %.9g, %.9g), is_solid %d, %s", gaussians(i, 0), gaussians(i, 1),
+                              gaussians(i, 2), gaussians(i, 3), gaussians(i, 4), is_solid, GetStringOfBlend(blend_of_batch).c_str());
+                return std::string(buffer);
+            });
+        check(
+            "DrawStrings",
+            [&](ImageType &image, const std::vector<int32_t> &items) {
+                std::vector<ImagePainter::Label> selected;
+                for (const int32_t i: items) {
+                    selected.emplace_back(labels[i]);
+                }
+                ImagePainter::DrawStrings(image, selected, select_colors(items), font_size, is_smooth, use_multi_thread, blend_of_batch);
+            },
+            [&](ImageType &image, int32_t i) {
+                ImagePainter::DrawString(image, labels[i].text, labels[i].x, labels[i].y, colors[i], font_size, is_smooth, blend_of_batch);
+            },
+            [&](int32_t i) {
+                return "ImagePainter::DrawString(image, \"" + labels[i].text + "\", " + std::to_string(labels[i].x) + ", " + std::to_string(labels[i].y) + ", " +
+                       GetStringOfColor(colors[i]) + ", " + std::to_string(font_size) + ", " + (is_smooth ? "true" : "false") + ", " +
+                       string_of_blend + ");";
+            });
+    }
+
+    // Polyline is the same as bressenhan lines of its segments.
+    for (const bool use_multi_thread: {false, true}) {
+        const std::string name = "DrawPolyline/lines/" + GetNameOfImage<ImageType>() + (use_multi_thread ? "/multi_thread" : "/single_thread") + "/seed_" +
+                                 std::to_string(seed);
+        CONTINUE_IF(!harness.IsSelected(name));
+        harness.Check(
+            name,
+            GetSetupOfImage(GetNameOfImage<ImageType>(), rows, cols, seed) + (is_closed ? " Polyline is closed." : "") + " Blend is " + string_of_blend + ".",
+            size,
+            [&](const std::vector<int32_t> &items) {
+                Canvas<ImageType> expected(rows, cols, seed);
+                Canvas<ImageType> actual(rows, cols, seed);
+                const int32_t num_of_items = static_cast<int32_t>(items.size());
+                const int32_t num_of_segments = is_closed && num_of_items > 2 ? num_of_items : num_of_items - 1;
+                for (int32_t k = 0; k < num_of_segments; ++k) {
+                    const int32_t i = items[k];
+                    const int32_t j = items[k + 1 == num_of_items ? 0 : k + 1];
+                    ImagePainter::DrawBressenhanLine(expected.image, points(i, 0), points(i, 1), points(j, 0), points(j, 1), colors[0], blend_of_batch);
+                }
+                ImagePainter::DrawPolyline(actual.image, select(points, items), colors[0], is_closed, use_multi_thread, blend_of_batch);
+                return ComparePixels(expected.buffer, actual.buffer, cols, kChannels);
+            },
+            [&](int32_t i) { return "vertex (" + std::to_string(points(i, 0)) + ", " + std::to_string(points(i, 1)) + ")"; });
+    }
+}
+
+ImagePainter::CameraView GenerateCameraView(int32_t rows, int32_t cols, std::mt19937 &engine) {
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    ImagePainter::CameraView cam;
+    cam.fx = static_cast<float>(cols) * (0.5f + 0.4f * uniform(engine));
+    cam.fy = static_cast<float>(cols) * (0.5f + 0.4f * uniform(engine));
+    cam.cx = static_cast<float>(cols) * (0.5f + 0.1f * uniform(engine));
+    cam.cy = static_cast<float>(rows) * (0.5f + 0.1f * uniform(engine));
+    cam.p_wc = Vec3(uniform(engine), uniform(engine), uniform(engine) - 2.0f);
+    cam.q_wc = Quat(Eigen::AngleAxisf(0.3f * uniform(engine), Vec3(uniform(engine), uniform(engine), uniform(engine) + 2.0f).normalized()));
+    cam.is_ortho = uniform(engine) > 0.6f;
+    cam.ortho_scale = static_cast<float>(cols) / 8.0f;
+    return cam;
+}
+
+std::string DescribeCameraView(const ImagePainter::CameraView &cam) {
+    char buffer[512];
+    std::snprintf(buffer, sizeof(buffer),
+                  "// cam: fx %.9g, fy %.9g, cx %.9g, cy %.9g, p_wc (%.9g, %.9g, %.9g), q_wc (w %.9g, x %.9g, y %.9g, z %.9g), is_ortho %d, ortho_scale %.9g.",
+                  cam.fx, cam.fy, cam.cx, cam.cy, cam.p_wc.x(), cam.p_wc.y(), cam.p_wc.z(), cam.q_wc.w(), cam.q_wc.x(), cam.q_wc.y(), cam.q_wc.z(), cam.is_ortho,
+                  cam.ortho_scale);
+    return std::string(buffer);
+}
+
+std::string DescribeVec3(const Vec3 &vector) {
+    char buffer[128];
+    std::snprintf(buffer, sizeof(buffer), "Vec3(%.9gf, %.9gf, %.9gf)", vector.x(), vector.y(), vector.z());
+    return std::string(buffer);
+}
+
+// Bulk renders are compared with single renders of their items, and spatial index renders are compared with bulk renders.
+template <typename ImageType, typename PixelType>
+void CheckRender(DiffHarness &harness, uint32_t seed) {
+    std::mt19937 engine(seed);
+    const int32_t rows = std::uniform_int_distribution<int32_t>(1, kMaxImageSize)(engine);
+    const int32_t cols = std::uniform_int_distribution<int32_t>(1, kMaxImageSize)(engine);
+    const ImagePainter::CameraView cam = GenerateCameraView(rows, cols, engine);
+    constexpr int32_t kChannels = GetChannels<ImageType>();
+    const int32_t size = kNumOfPrimitives * 4;
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+
+    // Points are around the view, including the ones behind camera and on the near plane.
+    Eigen::Matrix<float, 3, Eigen::Dynamic> points(3, size);
+    Eigen::Matrix<float, 3, Eigen::Dynamic> ends(3, size);
+    Eigen::Matrix<float, 6, Eigen::Dynamic> covariances(6, size);
+    std::vector<Mat3> covariances_3d(size);
+    std::vector<PixelType> colors(size);
+    for (int32_t i = 0; i < size; ++i) {
+        points.col(i) = cam.p_wc + cam.q_wc * Vec3(4.0f * uniform(engine), 4.0f * uniform(engine), 5.0f * uniform(engine) + 4.0f);
+        if (i % 16 == 0) {
+            points.col(i) = cam.p_wc + cam.q_wc * Vec3(uniform(engine), uniform(engine), ImagePainter::kMinValidViewDepth);
+        }
+        ends.col(i) = points.col(i) + 2.0f * Vec3(uniform(engine), uniform(engine), uniform(engine));
+        Mat3 factor;
+        for (int32_t k = 0; k < 9; ++k) {
+            factor(k / 3, k % 3) = 0.3f * uniform(engine);
+        }
+        covariances_3d[i] = factor * factor.transpose() + Mat3::Identity() * 1e-4f;
+        const Mat3 &c = covariances_3d[i];
+        covariances.col(i) << c(0, 0), c(0, 1), c(0, 2), c(1, 1), c(1, 2), c(2, 2);
+        colors[i] = GetRandomColor<PixelType>(engine);
+    }
+    const int32_t radius = std::uniform_int_distribution<int32_t>(0, 3)(engine);
+    const std::string setup = GetSetupOfImage(GetNameOfImage<ImageType>(), rows, cols, seed) + "\n    " + DescribeCameraView(cam);
+
+    auto select_points = [&](const Eigen::Matrix<float, 3, Eigen::Dynamic> &batch, const std::vector<int32_t> &items) {
+        Eigen::Matrix<float, 3, Eigen::Dynamic> selected(3, items.size());
+        for (size_t i = 0; i < items.size(); ++i) {
+            selected.col(i) = batch.col(items[i]);
+        }
+        return selected;
+    };
+    auto select_colors = [&](const std::vector<int32_t> &items) {
+        std::vector<PixelType> selected;
+        for (const int32_t i: items) {
+            selected.emplace_back(colors[i]);
+        }
+        return selected;
+    };
+    auto describe_point = [&](int32_t i) { return "point " + DescribeVec3(points.col(i)) + ", radius " + std::to_string(radius); };
+    auto describe_segment = [&](int32_t i) { return "line segment " + DescribeVec3(points.col(i)) + " - " + DescribeVec3(ends.col(i)); };
+    auto describe_ellipse = [&](int32_t i) {
+        std::ostringstream stream;
+        stream << "ellipse at " << DescribeVec3(points.col(i)) << ", covariance (" << covariances.col(i).transpose() << ")";
+        return stream.str();
+    };
+    auto check = [&](const std::string &name, const std::function<void(ImageType &, const std::vector<int32_t> &)> &draw_expected,
+                     const std::function<void(ImageType &, const std::vector<int32_t> &)> &draw_actual, const std::function<std::string(int32_t)> &describe) {
+        const std::string full_name = name + "/" + GetNameOfImage<ImageType>() + "/seed_" + std::to_string(seed);
+        RETURN_IF(!harness.IsSelected(full_name));
+        harness.Check(
+            full_name, setup, size,
+            [&](const std::vector<int32_t> &items) {
+                Canvas<ImageType> expected(rows, cols, seed);
+                Canvas<ImageType> actual(rows, cols, seed);
+                draw_expected(expected.image, items);
+                draw_actual(actual.image, items);
+                return ComparePixels(expected.buffer, actual.buffer, cols, kChannels);
+            },
+            describe);
+    };
+
+    for (const bool use_multi_thread: {false, true}) {
+        const std::string suffix = use_multi_thread ? "/multi_thread" : "/single_thread";
+        check(
+            "RenderPointsInCameraView" + suffix,
+            [&](ImageType &image, const std::vector<int32_t> &items) {
+                for (const int32_t i: items) {
+                    ImagePainter::RenderPointInCameraView(image, cam, points.col(i), colors[i], radius);
+                }
+            },
+            [&](ImageType &image, const std::vector<int32_t> &items) {
+                ImagePainter::RenderPointsInCameraView(image, cam, select_points(points, items), select_colors(items), radius, use_multi_thread);
+            },
+            describe_point);
+        check(
+            "RenderPointsInCameraView/index" + suffix,
+            [&](ImageType &image, const std::vector<int32_t> &items) {
+                ImagePainter::RenderPointsInCameraView(image, cam, select_points(points, items), select_colors(items), radius, false);
+            },
+            [&](ImageType &image, const std::vector<int32_t> &items) {
+                SpatialIndex index(0.5f);
+                index.AddPoints(select_points(points, items));
+                ImagePainter::RenderPointsInCameraView(image, cam, index, select_colors(items), radius, use_multi_thread);
+            },
+            describe_point);
+        check(
+            "RenderEllipsesInCameraView" + suffix,
+            [&](ImageType &image, const std::vector<int32_t> &items) {
+                Eigen::Matrix<float, 6, Eigen::Dynamic> selected(6, items.size());
+                for (size_t i = 0; i < items.size(); ++i) {
+                    selected.col(i) = covariances.col(items[i]);
+                }
+                ImagePainter::RenderEllipsesInCameraView(image, cam, select_points(points, items), selected, select_colors(items), radius > 1, false);
+            },
+            [&](ImageType &image, const std::vector<int32_t> &items) {
+                Eigen::Matrix<float, 6, Eigen::Dynamic> selected(6, items.size());
+                for (size_t i = 0; i < items.size(); ++i) {
+                    selected.col(i) = covariances.col(items[i]);
+                }
+                ImagePainter::RenderEllipsesInCameraView(image, cam, select_points(points, items), selected, select_colors(items), radius > 1, use_multi_thread);
+            },
+            describe_ellipse);
+
+        // Depth test of render context should not depend on the order of tiles.
+        check(
+            "RenderContext/RenderPointsInCameraView" + suffix,
+            [&](ImageType &image, const std::vector<int32_t> &items) {
+                RenderContext context(cam, rows, cols);
+                for (const int32_t i: items) {
+                    context.RenderPointInCameraView(image, points.col(i), colors[i], radius);
+                }
+            },
+            [&](ImageType &image, const std::vector<int32_t> &items) {
+                RenderContext context(cam, rows, cols);
+                context.RenderPointsInCameraView(image, select_points(points, items), select_colors(items), radius, use_multi_thread);
+            },
+            describe_point);
+    }
+
+    check(
+        "RenderLineSegmentsInCameraView/index",
+        [&](ImageType &image, const std::vector<int32_t> &items) {
+            for (const int32_t i: items) {
+                ImagePainter::RenderLineSegmentInCameraView(image, cam, points.col(i), ends.col(i), colors[i]);
+            }
+        },
+        [&](ImageType &image, const std::vector<int32_t> &items) {
+            SpatialIndex index(0.5f);
+            for (const int32_t i: items) {
+                index.AddLineSegment(points.col(i), ends.col(i));
+            }
+            ImagePainter::RenderLineSegmentsInCameraView(image, cam, index, select_colors(items));
+        },
+        describe_segment);
+    // Most points are out of the range of voxel coordinates of tiny voxels, and they should still be candidates.
+    check(
+        "RenderPointsInCameraView/index/tiny_voxel",
+        [&](ImageType &image, const std::vector<int32_t> &items) {
+            ImagePainter::RenderPointsInCameraView(image, cam, select_points(points, items), select_colors(items), radius, false);
+        },
+        [&](ImageType &image, const std::vector<int32_t> &items) {
+            SpatialIndex index(1e-6f);
+            index.AddPoints(select_points(points, items));
+            ImagePainter::RenderPointsInCameraView(image, cam, index, select_colors(items), radius, false);
+        },
+        describe_point);
+}
+
+// Offsets of u and v of chroma sample in continuous yuv420 buffer.
+void GetOffsetsOfChroma(ImagePainter::YuvLayout layout, int32_t rows, int32_t cols, int32_t chroma_row, int32_t chroma_col, int64_t &offset_u,
+                        int64_t &offset_v) {
+    const int64_t chroma_rows = (rows + 1) / 2;
+    const int64_t chroma_cols = (cols + 1) / 2;
+    const int64_t base = static_cast<int64_t>(rows) * cols;
+    if (layout == ImagePainter::YuvLayout::kNv12) {
+        offset_u = base + chroma_row * 2 * chroma_cols + 2 * chroma_col;
+        offset_v = offset_u + 1;
+    } else {
+        offset_u = base + chroma_row * chroma_cols + chroma_col;
+        offset_v = base + chroma_rows * chroma_cols + chroma_row * chroma_cols + chroma_col;
+    }
+}
+
+// Luma of yuv420 image should be the same as gray image. Opaque primitives set chroma samples whose 2 x 2 pixels are covered, while blended
+// ones blend each of these chroma samples once. Renders in parallel tiles should be the same as single thread ones.
+void CheckYuv420(DiffHarness &harness, uint32_t seed) {
+    std::mt19937 engine(seed);
+    const int32_t rows = std::uniform_int_distribution<int32_t>(1, kMaxImageSize)(engine);
+    const int32_t cols = std::uniform_int_distribution<int32_t>(1, kMaxImageSize)(engine);
+    const int64_t size_of_buffer = static_cast<int64_t>(rows) * cols + 2 * static_cast<int64_t>((rows + 1) / 2) * ((cols + 1) / 2);
+    ShapeGenerator generator(rows, cols, seed);
+    auto get_background = [&]() {
+        std::mt19937 background_engine(seed);
+        std::vector<uint8_t> buffer(size_of_buffer);
+        for (auto &value: buffer) {
+            value = static_cast<uint8_t>(background_engine());
+        }
+        return buffer;
+    };
+
+    for (const auto layout: {ImagePainter::YuvLayout::kNv12, ImagePainter::YuvLayout::kI420}) {
+        const std::string name_of_layout = layout == ImagePainter::YuvLayout::kNv12 ? "nv12" : "i420";
+        for (int32_t type = 0; type < static_cast<int32_t>(PrimitiveType::kNumOfTypes); ++type) {
+            std::vector<Primitive<uint8_t>> primitives;
+            std::vector<ImagePainter::YuvPixel> colors;
+            for (int32_t i = 0; i < kNumOfPrimitives; ++i) {
+                primitives.emplace_back(GeneratePrimitive<uint8_t>(static_cast<PrimitiveType>(type), generator));
+                // Fragments of smooth glyphs are blended by their coverage, which is not checked here.
+                if (primitives.back().type == PrimitiveType::kString) {
+                    primitives.back().args[3] = 0;
+                }
+                colors.emplace_back(ImagePainter::YuvPixel{primitives.back().color, static_cast<uint8_t>(engine()), static_cast<uint8_t>(engine())});
+            }
+            const std::string name = std::string(GetNameOfPrimitive(static_cast<PrimitiveType>(type))) + "/" + name_of_layout + "/seed_" + std::to_string(seed);
+            CONTINUE_IF(!harness.IsSelected(name));
+            harness.Check(
+                name, GetSetupOfImage(name_of_layout, rows, cols, seed), kNumOfPrimitives,
+                [&](const std::vector<int32_t> &items) {
+                    std::vector<uint8_t> expected = get_background();
+                    std::vector<uint8_t> actual = get_background();
+                    GrayImage luma(expected.data(), rows, cols);
+                    Yuv420Image image(actual.data(), rows, cols, layout);
+                    for (const int32_t i: items) {
+                        const Primitive<uint8_t> &primitive = primitives[i];
+                        const ImagePainter::YuvPixel &color = colors[i];
+                        DrawByImagePainter(image, ConvertColorOfPrimitive(primitive, color));
+                        DrawByImagePainter(luma, primitive);
+
+                        Primitive<uint8_t> opaque_primitive = primitive;
+                        opaque_primitive.color = 255;
+                        opaque_primitive.blend = ImagePainter::Blend();
+                        std::vector<uint8_t> mask(static_cast<size_t>(rows) * cols, 0);
+                        GrayImage mask_image(mask.data(), rows, cols);
+                        DrawByImagePainter(mask_image, opaque_primitive);
+                        const bool is_opaque = primitive.blend.mode == ImagePainter::BlendMode::kOpaque ||
+                                               (primitive.blend.mode == ImagePainter::BlendMode::kAlpha && primitive.blend.alpha == 255);
+                        for (int32_t chroma_row = 0; chroma_row < (rows + 1) / 2; ++chroma_row) {
+                            for (int32_t chroma_col = 0; chroma_col < (cols + 1) / 2; ++chroma_col) {
+                                bool is_covered = mask[2 * chroma_row * cols + 2 * chroma_col] != 0;
+                                for (int32_t k = 1; k < 4; ++k) {
+                                    const int32_t row = 2 * chroma_row + k / 2;
+                                    const int32_t col = 2 * chroma_col + k % 2;
+                                    is_covered = is_covered || (row < rows && col < cols && mask[row * cols + col] != 0);
+                                }
+                                CONTINUE_IF(!is_covered);
+                                int64_t offset_u = 0;
+                                int64_t offset_v = 0;
+                                GetOffsetsOfChroma(layout, rows, cols, chroma_row, chroma_col, offset_u, offset_v);
+                                expected[offset_u] = is_opaque ? color.u : reference::BlendChromaByte(expected[offset_u], color.u, primitive.blend);
+                                expected[offset_v] = is_opaque ? color.v : reference::BlendChromaByte(expected[offset_v], color.v, primitive.blend);
+                            }
+                        }
+                    }
+                    return ComparePixels(expected, actual, cols, 1);
+                },
+                [&](int32_t i) {
+                    return DescribePrimitive(primitives[i]) + " // u " + std::to_string(colors[i].u) + ", v " + std::to_string(colors[i].v);
+                });
+        }
+
+        // Points and ellipses are rendered by row tiles in parallel, whose chroma rows should not be shared.
+        const ImagePainter::CameraView cam = GenerateCameraView(rows, cols, engine);
+        const int32_t size = kNumOfPrimitives * 4;
+        std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+        Eigen::Matrix<float, 3, Eigen::Dynamic> points(3, size);
+        Eigen::Matrix<float, 6, Eigen::Dynamic> covariances(6, size);
+        std::vector<ImagePainter::YuvPixel> colors(size);
+        for (int32_t i = 0; i < size; ++i) {
+            points.col(i) = cam.p_wc + cam.q_wc * Vec3(4.0f * uniform(engine), 4.0f * uniform(engine), 5.0f * uniform(engine) + 4.0f);
+            Mat3 factor;
+            for (int32_t k = 0; k < 9; ++k) {
+                factor(k / 3, k % 3) = 0.3f * uniform(engine);
+            }
+            const Mat3 covariance = factor * factor.transpose() + Mat3::Identity() * 1e-4f;
+            covariances.col(i) << covariance(0, 0), covariance(0, 1), covariance(0, 2), covariance(1, 1), covariance(1, 2), covariance(2, 2);
+            colors[i] = ImagePainter::YuvPixel{static_cast<uint8_t>(engine()), static_cast<uint8_t>(engine()), static_cast<uint8_t>(engine())};
+        }
+        const int32_t radius = std::uniform_int_distribution<int32_t>(1, 3)(engine);
+        const std::string name = "RenderInCameraView/" + name_of_layout + "/seed_" + std::to_string(seed);
+        CONTINUE_IF(!harness.IsSelected(name));
+        harness.Check(
+            name, GetSetupOfImage(name_of_layout, rows, cols, seed) + "\n    " + DescribeCameraView(cam), size,
+            [&](const std::vector<int32_t> &items) {
+                std::vector<uint8_t> expected = get_background();
+                std::vector<uint8_t> actual = get_background();
+                Yuv420Image expected_image(expected.data(), rows, cols, layout);
+                Yuv420Image actual_image(actual.data(), rows, cols, layout);
+                Eigen::Matrix<float, 3, Eigen::Dynamic> selected_points(3, items.size());
+                Eigen::Matrix<float, 6, Eigen::Dynamic> selected_covariances(6, items.size());
+                std::vector<ImagePainter::YuvPixel> selected_colors;
+                for (size_t k = 0; k < items.size(); ++k) {
+                    selected_points.col(k) = points.col(items[k]);
+                    selected_covariances.col(k) = covariances.col(items[k]);
+                    selected_colors.emplace_back(colors[items[k]]);
+                }
+                for (const int32_t i: items) {
+                    ImagePainter::RenderPointInCameraView(expected_image, cam, points.col(i), colors[i], radius);
+                }
+                ImagePainter::RenderEllipsesInCameraView(expected_image, cam, selected_points, selected_covariances, selected_colors, true, false);
+                ImagePainter::RenderPointsInCameraView(actual_image, cam, selected_points, selected_colors, radius, true);
+                ImagePainter::RenderEllipsesInCameraView(actual_image, cam, selected_points, selected_covariances, selected_colors, true, true);
+                return ComparePixels(expected, actual, cols, 1);
+            },
+            [&](int32_t i) { return "point " + DescribeVec3(points.col(i)) + ", covariance (" + DescribeVec3(covariances.col(i).head<3>()) + " ...)"; });
+    }
+}
+
+// Commands of display list are flushed in parallel row tiles, and retained canvas only repaints dirty tiles. Both should be the same as
+// drawing commands one by one.
+template <typename ImageType, typename PixelType>
+void CheckDisplayList(DiffHarness &harness, uint32_t seed) {
+    std::mt19937 engine(seed);
+    const int32_t rows = std::uniform_int_distribution<int32_t>(1, kMaxImageSize)(engine);
+    const int32_t cols = std::uniform_int_distribution<int32_t>(1, kMaxImageSize)(engine);
+    ShapeGenerator generator(rows, cols, seed);
+    constexpr int32_t kChannels = GetChannels<ImageType>();
+
+    // Opaque primitives which are supported by display list.
+    const PrimitiveType types[] = {PrimitiveType::kSolidRectangle, PrimitiveType::kHollowRectangle, PrimitiveType::kBressenhanLine, PrimitiveType::kNaiveLine,
+                                   PrimitiveType::kDashedLine, PrimitiveType::kSolidCircle, PrimitiveType::kHollowCircle, PrimitiveType::kMidBresenhamEllipse,
+                                   PrimitiveType::kSolidEllipse, PrimitiveType::kString, PrimitiveType::kTrustRegionOfGaussian};
+    std::vector<Primitive<PixelType>> primitives;
+    for (int32_t i = 0; i < kNumOfPrimitives * 2; ++i) {
+        Primitive<PixelType> primitive = GeneratePrimitive<PixelType>(types[generator.Uniform(0, 10)], generator);
+        primitive.blend = ImagePainter::Blend();
+        if (primitive.type == PrimitiveType::kHollowRectangle || primitive.type == PrimitiveType::kHollowCircle) {
+            primitive.args.back() = 1;
+        }
+        primitives.emplace_back(primitive);
+    }
+    auto record = [&](DisplayList<ImageType, PixelType> &list, const Primitive<PixelType> &p) {
+        const std::vector<int32_t> &a = p.args;
+        switch (p.type) {
+            case PrimitiveType::kSolidRectangle:
+                list.DrawSolidRectangle(a[0], a[1], a[2], a[3], p.color);
+                break;
+            case PrimitiveType::kHollowRectangle:
+                list.DrawHollowRectangle(a[0], a[1], a[2], a[3], p.color);
+                break;
+            case PrimitiveType::kBressenhanLine:
+                list.DrawBressenhanLine(a[0], a[1], a[2], a[3], p.color);
+                break;
+            case PrimitiveType::kNaiveLine:
+                list.DrawNaiveLine(a[0], a[1], a[2], a[3], p.color);
+                break;
+            case PrimitiveType::kDashedLine:
+                list.DrawDashedLine(a[0], a[1], a[2], a[3], a[4], p.color);
+                break;
+            case PrimitiveType::kSolidCircle:
+                list.DrawSolidCircle(a[0], a[1], a[2], p.color);
+                break;
+            case PrimitiveType::kHollowCircle:
+                list.DrawHollowCircle(a[0], a[1], a[2], p.color);
+                break;
+            case PrimitiveType::kMidBresenhamEllipse:
+                list.DrawMidBresenhamEllipse(a[0], a[1], a[2], a[3], p.color);
+                break;
+            case PrimitiveType::kSolidEllipse:
+                list.DrawSolidEllipse(a[0], a[1], a[2], a[3], p.color);
+                break;
+            case PrimitiveType::kString:
+                list.DrawString(p.text, a[0], a[1], p.color, a[2], a[3] != 0);
+                break;
+            case PrimitiveType::kTrustRegionOfGaussian:
+                list.DrawTrustRegionOfGaussian(p.center, p.covariance, p.color, static_cast<float>(a[0]));
+                break;
+            default:
+                break;
+        }
+    };
+    const std::string setup = GetSetupOfImage(GetNameOfImage<ImageType>(), rows, cols, seed);
+    const int32_t size = static_cast<int32_t>(primitives.size());
+
+    std::string name = "DisplayList/Flush/" + GetNameOfImage<ImageType>() + "/seed_" + std::to_string(seed);
+    if (harness.IsSelected(name)) {
+        harness.Check(
+            name, setup, size,
+            [&](const std::vector<int32_t> &items) {
+                Canvas<ImageType> expected(rows, cols, seed);
+                Canvas<ImageType> actual(rows, cols, seed);
+                DisplayList<ImageType, PixelType> list;
+                for (const int32_t i: items) {
+                    DrawByImagePainter(expected.image, primitives[i]);
+                    record(list, primitives[i]);
+                }
+                list.Flush(actual.image);
+                return ComparePixels(expected.buffer, actual.buffer, cols, kChannels);
+            },
+            [&](int32_t i) { return DescribePrimitive(primitives[i]); });
+    }
+
+    // The first half of items is the first frame, and the second frame keeps about half of them and appends the others.
+    name = "RetainedCanvas/Present/" + GetNameOfImage<ImageType>() + "/seed_" + std::to_string(seed);
+    if (harness.IsSelected(name)) {
+        harness.Check(
+            name, setup + " Items of even index are kept from first frame, and the others are only in second frame.", size,
+            [&](const std::vector<int32_t> &items) {
+                Canvas<ImageType> background(rows, cols, seed);
+                Canvas<ImageType> expected(rows, cols, seed);
+                Canvas<ImageType> actual(rows, cols, seed);
+                DisplayList<ImageType, PixelType> first_frame;
+                DisplayList<ImageType, PixelType> second_frame;
+                for (const int32_t i: items) {
+                    if (i % 2 == 0 || i < size / 2) {
+                        record(first_frame, primitives[i]);
+                    }
+                    if (i % 2 == 0 || i >= size / 2) {
+                        record(second_frame, primitives[i]);
+                        DrawByImagePainter(expected.image, primitives[i]);
+                    }
+                }
+                RetainedCanvas<ImageType, PixelType> canvas;
+                canvas.SetBackground(background.image);
+                canvas.Present(first_frame, actual.image, false);
+                canvas.Present(second_frame, actual.image, true);
+                return ComparePixels(expected.buffer, actual.buffer, cols, kChannels);
+            },
+            [&](int32_t i) { return DescribePrimitive(primitives[i]); });
+    }
+}
+
+// Geometry convertion of reference, where destination pixel of source pixel (row, col) is computed directly.
+void ConvertImageGeometryByReference(const uint8_t *source, uint8_t *destination, int32_t rows, int32_t cols, int32_t channels,
+                                     ImagePainter::ImageGeometry geometry, bool swap_rgb_bgr) {
+    using ImageGeometry = ImagePainter::ImageGeometry;
+    const bool is_swapped = geometry == ImageGeometry::kRotate90 || geometry == ImageGeometry::kRotate270 || geometry == ImageGeometry::kTranspose;
+    const int32_t converted_cols = is_swapped ? rows : cols;
+    for (int32_t row = 0; row < rows; ++row) {
+        for (int32_t col = 0; col < cols; ++col) {
+            int32_t converted_row = row;
+            int32_t converted_col = col;
+            switch (geometry) {
+                case ImageGeometry::kFlipVertical:
+                    converted_row = rows - 1 - row;
+                    break;
+                case ImageGeometry::kFlipHorizontal:
+                    converted_col = cols - 1 - col;
+                    break;
+                case ImageGeometry::kRotate90:
+                    converted_row = col;
+                    converted_col = rows - 1 - row;
+                    break;
+                case ImageGeometry::kRotate180:
+                    converted_row = rows - 1 - row;
+                    converted_col = cols - 1 - col;
+                    break;
+                case ImageGeometry::kRotate270:
+                    converted_row = cols - 1 - col;
+                    converted_col = row;
+                    break;
+                case ImageGeometry::kTranspose:
+                    converted_row = col;
+                    converted_col = row;
+                    break;
+                default:
+                    break;
+            }
+            const uint8_t *pixel = source + (row * cols + col) * channels;
+            uint8_t *converted_pixel = destination + (converted_row * converted_cols + converted_col) * channels;
+            for (int32_t c = 0; c < channels; ++c) {
+                converted_pixel[c] = pixel[swap_rgb_bgr ? channels - 1 - c : c];
+            }
+        }
+    }
+}
+
+// Convertions of every simd level are compared with scalar reference. Rgb to gray of simd kernels uses fixed-point weights, which may
+// differ from float reference by 1.
+void CheckConvert(DiffHarness &harness, uint32_t seed) {
+    std::mt19937 engine(seed);
+    const int32_t rows = std::uniform_int_distribution<int32_t>(1, kMaxImageSize)(engine);
+    const int32_t cols = std::uniform_int_distribution<int32_t>(1, kMaxImageSize)(engine);
+    const int32_t size = rows * cols;
+    std::vector<uint8_t> gray(size);
+    std::vector<uint8_t> rgb(size * 3);
+    for (auto &value: gray) {
+        value = static_cast<uint8_t>(engine());
+    }
+    for (auto &value: rgb) {
+        value = static_cast<uint8_t>(engine());
+    }
+    const std::string setup = "// image of " + std::to_string(rows) + " x " + std::to_string(cols) + ", filled by std::mt19937(" + std::to_string(seed) + ").";
+    auto check = [&](const std::string &name, ImagePainter::SimdLevel level, int32_t tolerance, int32_t channels,
+                     const std::function<void(std::vector<uint8_t> &)> &convert_expected, const std::function<void(std::vector<uint8_t> &)> &convert_actual) {
+        const std::string full_name = name + "/" + GetNameOfSimdLevel(level) + "/seed_" + std::to_string(seed);
+        RETURN_IF(!harness.IsSelected(full_name));
+        harness.Check(
+            full_name, setup, 1,
+            [&](const std::vector<int32_t> &) {
+                std::vector<uint8_t> expected(size * channels, 0);
+                std::vector<uint8_t> actual(size * channels, 0);
+                convert_expected(expected);
+                const ScopedSimdLevel simd_level(level);
+                convert_actual(actual);
+                return ComparePixels(expected, actual, cols, channels, tolerance);
+            },
+            [&](int32_t) { return "ImagePainter::" + name + "(...);"; });
+    };
+
+    for (const ImagePainter::SimdLevel level: GetSupportedSimdLevels()) {
+        const int32_t luma_tolerance = level == ImagePainter::SimdLevel::kScalar ? 0 : 1;
+        check(
+            "ConvertUint8ToRgb", level, 0, 3,
+            [&](std::vector<uint8_t> &output) {
+                for (int32_t i = 0; i < size; ++i) {
+                    std::fill_n(output.data() + 3 * i, 3, gray[i]);
+                }
+            },
+            [&](std::vector<uint8_t> &output) { ImagePainter::ConvertUint8ToRgb(gray.data(), output.data(), size); });
+        check(
+            "ConvertRgbToUint8", level, luma_tolerance, 1,
+            [&](std::vector<uint8_t> &output) {
+                for (int32_t i = 0; i < size; ++i) {
+                    output[i] = static_cast<uint8_t>(static_cast<float>(rgb[3 * i]) * 0.299f + static_cast<float>(rgb[3 * i + 1]) * 0.587f +
+                                                     static_cast<float>(rgb[3 * i + 2]) * 0.114f);
+                }
+            },
+            [&](std::vector<uint8_t> &output) { ImagePainter::ConvertRgbToUint8(rgb.data(), output.data(), size); });
+        check(
+            "ConvertUint8ToRgbAndUpsideDown", level, 0, 3,
+            [&](std::vector<uint8_t> &output) {
+                for (int32_t row = 0; row < rows; ++row) {
+                    for (int32_t col = 0; col < cols; ++col) {
+                        std::fill_n(output.data() + ((rows - 1 - row) * cols + col) * 3, 3, gray[row * cols + col]);
+                    }
+                }
+            },
+            [&](std::vector<uint8_t> &output) { ImagePainter::ConvertUint8ToRgbAndUpsideDown(gray.data(), output.data(), rows, cols); });
+        check("ConvertRgbToBgr", level, 0, 3,
+              [&](std::vector<uint8_t> &output) { ConvertImageGeometryByReference(rgb.data(), output.data(), rows, cols, 3, ImagePainter::ImageGeometry::kIdentity, true); },
+              [&](std::vector<uint8_t> &output) { ImagePainter::ConvertRgbToBgr(rgb.data(), output.data(), rows, cols); });
+        check("ConvertRgbToBgr/in_place", level, 0, 3,
+              [&](std::vector<uint8_t> &output) { ConvertImageGeometryByReference(rgb.data(), output.data(), rows, cols, 3, ImagePainter::ImageGeometry::kIdentity, true); },
+              [&](std::vector<uint8_t> &output) {
+                  output = rgb;
+                  ImagePainter::ConvertRgbToBgr(output.data(), output.data(), rows, cols);
+              });
+        check("ConvertRgbToBgrAndUpsideDown", level, 0, 3,
+              [&](std::vector<uint8_t> &output) { ConvertImageGeometryByReference(rgb.data(), output.data(), rows, cols, 3, ImagePainter::ImageGeometry::kFlipVertical, true); },
+              [&](std::vector<uint8_t> &output) { ImagePainter::ConvertRgbToBgrAndUpsideDown(rgb.data(), output.data(), rows, cols); });
+    }
+
+    // Geometry convertions, out of place and in place.
+    const char *names[] = {"identity", "flip_vertical", "flip_horizontal", "rotate_90", "rotate_180", "rotate_270", "transpose"};
+    const int32_t square_size = std::min(rows, cols);
+    for (int32_t g = 0; g <= static_cast<int32_t>(ImagePainter::ImageGeometry::kTranspose); ++g) {
+        const auto geometry = static_cast<ImagePainter::ImageGeometry>(g);
+        const bool is_swapped = geometry == ImagePainter::ImageGeometry::kRotate90 || geometry == ImagePainter::ImageGeometry::kRotate270 ||
+                                geometry == ImagePainter::ImageGeometry::kTranspose;
+        const int32_t converted_rows = is_swapped ? cols : rows;
+        const int32_t converted_cols = is_swapped ? rows : cols;
+        for (const bool swap_rgb_bgr: {false, true}) {
+            const std::string suffix = std::string(names[g]) + (swap_rgb_bgr ? "/swap_rgb_bgr" : "");
+            check("ConvertImageGeometry/rgb/" + suffix, ImagePainter::GetSimdLevel(), 0, 3,
+                  [&](std::vector<uint8_t> &output) { ConvertImageGeometryByReference(rgb.data(), output.data(), rows, cols, 3, geometry, swap_rgb_bgr); },
+                  [&](std::vector<uint8_t> &output) {
+                      RgbImage image(rgb.data(), rows, cols);
+                      RgbImage converted_image(output.data(), converted_rows, converted_cols);
+                      ImagePainter::ConvertImageGeometry(image, converted_image, geometry, swap_rgb_bgr);
+                  });
+            // In place convertion of square image.
+            check("ConvertImageGeometry/rgb/in_place/" + suffix, ImagePainter::GetSimdLevel(), 0, 3,
+                  [&](std::vector<uint8_t> &output) {
+                      std::vector<uint8_t> square(rgb.begin(), rgb.begin() + square_size * square_size * 3);
+                      ConvertImageGeometryByReference(square.data(), output.data(), square_size, square_size, 3, geometry, swap_rgb_bgr);
+                  },
+                  [&](std::vector<uint8_t> &output) {
+                      std::copy_n(rgb.begin(), square_size * square_size * 3, output.begin());
+                      RgbImage image(output.data(), square_size, square_size);
+                      ImagePainter::ConvertImageGeometry(image, image, geometry, swap_rgb_bgr);
+                  });
+        }
+        check("ConvertImageGeometry/gray/" + std::string(names[g]), ImagePainter::GetSimdLevel(), 0, 1,
+              [&](std::vector<uint8_t> &output) { ConvertImageGeometryByReference(gray.data(), output.data(), rows, cols, 1, geometry, false); },
+              [&](std::vector<uint8_t> &output) {
+                  GrayImage image(gray.data(), rows, cols);
+                  GrayImage converted_image(output.data(), converted_rows, converted_cols);
+                  ImagePainter::ConvertImageGeometry(image, converted_image, geometry);
+              });
+        check("ConvertImageGeometry/gray/in_place/" + std::string(names[g]), ImagePainter::GetSimdLevel(), 0, 1,
+              [&](std::vector<uint8_t> &output) {
+                  std::vector<uint8_t> square(gray.begin(), gray.begin() + square_size * square_size);
+                  ConvertImageGeometryByReference(square.data(), output.data(), square_size, square_size, 1, geometry, false);
+              },
+              [&](std::vector<uint8_t> &output) {
+                  std::copy_n(gray.begin(), square_size * square_size, output.begin());
+                  GrayImage image(output.data(), square_size, square_size);
+                  ImagePainter::ConvertImageGeometry(image, image, geometry);
+              });
+    }
+
+    // Matrix is scaled into image, and nan cells are crossed by delete line. Rgb image of gray color map has the same value in all channels.
+    const int32_t scale = std::uniform_int_distribution<int32_t>(1, 4)(engine);
+    Mat matrix = Mat::Random(std::max(rows / scale, 1), std::max(cols / scale, 1)) * 12.0f;
+    for (int32_t i = 0; i < matrix.size() / 16; ++i) {
+        matrix(engine() % matrix.rows(), engine() % matrix.cols()) = std::nanf("");
+    }
+    const int32_t image_rows = static_cast<int32_t>(matrix.rows()) * scale;
+    const int32_t image_cols = static_cast<int32_t>(matrix.cols()) * scale;
+    for (const int32_t channels: {1, 3}) {
+        const std::string name = std::string("ConvertMatrixToImage/") + (channels == 1 ? "gray" : "rgb") + "/seed_" + std::to_string(seed);
+        CONTINUE_IF(!harness.IsSelected(name));
+        harness.Check(
+            name, "// matrix of " + std::to_string(matrix.rows()) + " x " + std::to_string(matrix.cols()) + ", scale " + std::to_string(scale) + ".", 1,
+            [&](const std::vector<int32_t> &) {
+                std::vector<uint8_t> expected(image_rows * image_cols * channels, 0);
+                std::vector<uint8_t> actual(image_rows * image_cols * channels, 0);
+                for (int32_t row = 0; row < image_rows; ++row) {
+                    for (int32_t col = 0; col < image_cols; ++col) {
+                        const float value = matrix(row / scale, col / scale);
+                        const bool is_delete_line = std::isnan(value) && row % scale == col % scale;
+                        const uint8_t pixel = is_delete_line ? 127 : ImagePainter::ConvertValueToUint8<float>(value, 10.0f);
+                        std::fill_n(expected.data() + (row * image_cols + col) * channels, channels, pixel);
+                    }
+                }
+                if (channels == 1) {
+                    GrayImage image(actual.data(), image_rows, image_cols);
+                    ImagePainter::ConvertMatrixToImage<float>(matrix, image, 10.0f, scale);
+                } else {
+                    RgbImage image(actual.data(), image_rows, image_cols);
+                    ImagePainter::ConvertMatrixToImage<float>(matrix, image, 10.0f, scale);
+                }
+                return ComparePixels(expected, actual, image_cols, channels);
+            },
+            [&](int32_t) { return std::string("ImagePainter::ConvertMatrixToImage<float>(matrix, image, 10.0f, scale);"); });
+    }
+}
+
+bool ParseOptions(int argc, char **argv, Options &options) {
+    for (int32_t i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--seed" && has_value) {
+            options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--iterations" && has_value) {
+            options.iterations = std::atoi(argv[++i]);
+        } else if (arg == "--soak_seconds" && has_value) {
+            options.soak_seconds = std::atof(argv[++i]);
+        } else if (arg == "--filter" && has_value) {
+            options.filter = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PrintUsage() {
+    std::fprintf(stderr,
+                 "Usage: diff_image_painter [options]\n"
+                 "  --seed 20240601         Seed of the first iteration. Iteration i uses seed + i.\n"
+                 "  --iterations 30         Number of randomized iterations.\n"
+                 "  --soak_seconds 0        Keep running new iterations until time is up, ignoring iterations.\n"
+                 "  --filter name           Only run checks whose name contains it, e.g. DrawSolidCircle/rgb/avx2/seed_20240601.\n");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    // Multi-thread paths are checked with several threads even on single core machines.
+    ImagePainter::SetMaxNumberOfThreads(std::max(ImagePainter::GetMaxNumberOfThreads(), 4));
+    DiffHarness harness(options);
+    const auto begin = std::chrono::steady_clock::now();
+    auto get_elapsed_seconds = [&]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count(); };
+    const bool is_soak = options.soak_seconds > 0.0;
+    CheckExtremeLines(harness);
+#ifdef IMAGE_PAINTER_ENABLE_PROFILE
+    CheckProfile(harness);
+#endif
+    for (int64_t i = 0; is_soak ? get_elapsed_seconds() < options.soak_seconds : i < options.iterations; ++i) {
+        const uint32_t seed = options.seed + static_cast<uint32_t>(i);
+        CheckDraw<GrayImage, uint8_t>(harness, seed);
+        CheckDraw<RgbImage, RgbPixel>(harness, seed);
+        CheckPixelTraits(harness, seed);
+        CheckBatchDraw<GrayImage, uint8_t>(harness, seed);
+        CheckBatchDraw<RgbImage, RgbPixel>(harness, seed);
+        CheckRender<GrayImage, uint8_t>(harness, seed);
+        CheckRender<RgbImage, RgbPixel>(harness, seed);
+        CheckYuv420(harness, seed);
+        CheckDisplayList<GrayImage, uint8_t>(harness, seed);
+        CheckDisplayList<RgbImage, RgbPixel>(harness, seed);
+        CheckConvert(harness, seed);
+        if (is_soak && i % 10 == 9) {
+            std::fprintf(stderr, "Soak: %lld iterations, %lld checks, %lld failures in %.0f s.\n", static_cast<long long>(i + 1),
+                         static_cast<long long>(harness.num_of_checks()), static_cast<long long>(harness.num_of_failures()), get_elapsed_seconds());
+        }
+    }
+
+    std::fprintf(stderr, "%lld checks, %lld failures, simd level %s.\n", static_cast<long long>(harness.num_of_checks()),
+                 static_cast<long long>(harness.num_of_failures()), GetNameOfSimdLevel(ImagePainter::GetSimdLevel()).c_str());
+    return harness.num_of_failures() == 0 ? 0 : 1;
+}
@@ -30,11 +30,17 @@ int main(int argc, char **argv) {
         ImagePainter::DrawBressenhanLine(image_matrix, 111 - 10 * i, 10 * i, 100, 100, static_cast<uint8_t>(255));
     }
     ImagePainter::DrawSolidCircle(image_matrix, 130, 200, 10, static_cast<uint8_t>(127));
-    ImagePainter::DrawString(image_matrix, "This is a string.", 240, 100 - 16, static_cast<uint8_t>(0), 99);
+    ImagePainter::DrawString(image_matrix, "This is a string.", 240, 100 - 20, static_cast<uint8_t>(0), 20, true);
     ImagePainter::DrawString(image_matrix, "This is a string.", 240, 100, static_cast<uint8_t>(127), 16);
     ImagePainter::DrawMidBresenhamEllipse(image_matrix, 180, 80, 40, 20, static_cast<uint8_t>(127));
+    ImagePainter::DrawSolidEllipse(image_matrix, 180, 80, 20, 10, static_cast<uint8_t>(200));
     ImagePainter::DrawDashedLine(image_matrix, 20, 20, 60, 80, 5, static_cast<uint8_t>(200));
 
+    // Create colorized image of matrix.
+    uint8_t *rgb_buf = (uint8_t *)malloc(matrix.rows() * matrix.cols() * kScale * kScale * 3 * sizeof(uint8_t));
+    RgbImage rgb_image_matrix(rgb_buf, matrix.rows() * kScale, matrix.cols() * kScale, true);
+    ImagePainter::ConvertMatrixToImage<float>(matrix, rgb_image_matrix, ColorMap::Get(ColorMap::Type::kTurbo), 15.0f, kScale);
+
     // Create image of png file.
     RgbImage rgb_image_png;
     Visualizor2D::LoadImage(png_image_file, rgb_image_png);
@@ -45,6 +51,10 @@ int main(int argc, char **argv) {
     ImagePainter::DrawHollowCircle(rgb_image_png, 130, 200, 10, RgbColor::kBlue);
     ImagePainter::DrawString(rgb_image_png, "This is a string.", 0, 0, RgbColor::kYellow, 24);
     ImagePainter::DrawMidBresenhamEllipse(rgb_image_png, 200, 200, 20, 70, RgbColor::kOrangeRed);
+    ImagePainter::DrawSolidEllipse(rgb_image_png, 300, 200, 60, 30, RgbColor::kViolet, ImagePainter::Blend(ImagePainter::BlendMode::kAlpha, 96));
+    Eigen::Matrix<int32_t, 4, 2> polyline;
+    polyline << 420, 40, 470, 90, 520, 40, 570, 90;
+    ImagePainter::DrawThickPolyline(rgb_image_png, polyline, 7, RgbColor::kOrangeRed, false, ImagePainter::LineJoin::kRound, ImagePainter::LineCap::kRound);
 
     // Draw ellipses and rectangle to check the size of ellipses.
     Mat2 cov = Mat2::Identity();
@@ -59,10 +69,14 @@ int main(int argc, char **argv) {
         }
     }
     ImagePainter::DrawHollowRectangle(rgb_image_png, 300, 300, 20, 70, RgbColor::kYellow);
+    ImagePainter::DrawSolidTrustRegionOfGaussian(rgb_image_png, Vec2(350, 200), cov, RgbColor::kYellow, 1.0f,
+                                                 ImagePainter::Blend(ImagePainter::BlendMode::kAlpha, 64));
 
     // Show painted image.
     Visualizor2D::ShowImage("Matrix image", image_matrix);
     Visualizor2D::WaitKey(1);
+    Visualizor2D::ShowImage("Colorized matrix image", rgb_image_matrix);
+    Visualizor2D::WaitKey(1);
     Visualizor2D::ShowImage("Rgb Png Image", rgb_image_png);
     Visualizor2D::WaitKey(0);
 